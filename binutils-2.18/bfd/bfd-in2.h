@@ -718,6 +718,8 @@ extern struct bfd_link_needed_list *bfd_elf_get_runpath_list
   (bfd *, struct bfd_link_info *);
 extern bfd_boolean bfd_elf_discard_info
   (bfd *, struct bfd_link_info *);
+extern bfd_boolean bfd_elf_fold_identical_sections
+  (bfd *, struct bfd_link_info *);
 extern unsigned int _bfd_elf_default_action_discarded
   (struct bfd_section *);
 
@@ -1378,6 +1380,7 @@ typedef struct bfd_section
 #define ELF_INFO_TYPE_MERGE     2
 #define ELF_INFO_TYPE_EH_FRAME  3
 #define ELF_INFO_TYPE_JUST_SYMS 4
+#define ELF_INFO_TYPE_FOLDED    5
 
   /* Nonzero if this section uses RELA relocations, rather than REL.  */
   unsigned int use_rela_p:1;
@@ -4624,6 +4627,12 @@ struct bfd
   /* File modified time, if mtime_set is TRUE.  */
   long mtime;
 
+  /* A read-only mapping of the whole file, made the first time
+     _bfd_get_file_view is asked for part of it.  */
+  void *mmap_base;
+  bfd_size_type mmap_size;
+  bfd_boolean mmap_tried;
+
   /* Reserved for an unimplemented file locking extension.  */
   int ifd;
 
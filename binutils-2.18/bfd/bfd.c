@@ -78,6 +78,12 @@ CODE_FRAGMENT
 .  {* File modified time, if mtime_set is TRUE.  *}
 .  long mtime;
 .
+.  {* A read-only mapping of the whole file, made the first time
+.     <<_bfd_get_file_view>> is asked for part of it.  *}
+.  void *mmap_base;
+.  bfd_size_type mmap_size;
+.  bfd_boolean mmap_tried;
+.
 .  {* Reserved for an unimplemented file locking extension.  *}
 .  int ifd;
 .
@@ -46,6 +46,18 @@ SUBSECTION
 #include "libbfd.h"
 #include "libiberty.h"
 
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#ifndef MAP_FILE
+#define MAP_FILE 0
+#endif
+
+#ifndef MAP_FAILED
+#define MAP_FAILED ((void *) -1)
+#endif
+
 /* In some cases we can optimize cache operation when reopening files.
    For instance, a flush is entirely unnecessary if the file is already
    closed, so a flush would use CACHE_NO_OPEN.  Similarly, a seek using
@@ -447,6 +459,109 @@ bfd_cache_close_all ()
   return ret;
 }
 
+/*
+INTERNAL_FUNCTION
+	_bfd_get_file_view
+
+SYNOPSIS
+	const bfd_byte *_bfd_get_file_view
+	  (bfd *abfd, file_ptr offset, bfd_size_type size);
+
+DESCRIPTION
+	Return a pointer to the @var{size} bytes at @var{offset} in
+	@var{abfd}, as <<bfd_seek>> would position it, without reading
+	them.  The first call maps the whole of the underlying file
+	read-only, and the mapping lasts until the BFD that owns the
+	file is closed.  Return <<NULL>>, without setting an error, if
+	the file cannot be mapped: it is not a plain file opened for
+	reading through the cache, it is in memory, the host has no
+	<<mmap>>, or the bytes lie outside it.  The caller should then
+	fall back to <<bfd_seek>> and <<bfd_bread>>.
+*/
+
+const bfd_byte *
+_bfd_get_file_view (bfd *abfd ATTRIBUTE_UNUSED,
+		    file_ptr offset ATTRIBUTE_UNUSED,
+		    bfd_size_type size ATTRIBUTE_UNUSED)
+{
+#ifdef HAVE_MMAP
+  bfd *file = abfd;
+
+  if ((abfd->flags & BFD_IN_MEMORY) != 0)
+    return NULL;
+
+  /* Stay within an archive element, and find where it starts in the
+     archive, just as bfd_bread and bfd_seek would.  */
+  if (abfd->arelt_data != NULL
+      && (bfd_size_type) offset + size > arelt_size (abfd))
+    return NULL;
+  if (abfd->my_archive != NULL)
+    {
+      offset += abfd->origin;
+      file = abfd->my_archive;
+    }
+
+  if (!file->mmap_tried)
+    {
+      FILE *f;
+      struct stat st;
+
+      file->mmap_tried = TRUE;
+      if (file->iovec == &cache_iovec
+	  && file->direction == read_direction
+	  && (file->flags & BFD_IN_MEMORY) == 0
+	  && (f = bfd_cache_lookup (file, CACHE_NO_SEEK)) != NULL
+	  && fstat (fileno (f), &st) == 0
+	  && S_ISREG (st.st_mode)
+	  && st.st_size > 0
+	  && (bfd_size_type) (size_t) st.st_size == (bfd_size_type) st.st_size)
+	{
+	  void *base = mmap (NULL, st.st_size, PROT_READ,
+			     MAP_FILE | MAP_PRIVATE, fileno (f), 0);
+
+	  if (base != MAP_FAILED)
+	    {
+	      file->mmap_base = base;
+	      file->mmap_size = st.st_size;
+	    }
+	}
+    }
+
+  if (file->mmap_base == NULL
+      || offset < 0
+      || (bfd_size_type) offset > file->mmap_size
+      || size > file->mmap_size - offset)
+    return NULL;
+
+  return (const bfd_byte *) file->mmap_base + offset;
+#else
+  return NULL;
+#endif
+}
+
+/*
+INTERNAL_FUNCTION
+	_bfd_unmap_file
+
+SYNOPSIS
+	void _bfd_unmap_file (bfd *abfd);
+
+DESCRIPTION
+	Remove any mapping <<_bfd_get_file_view>> made of the file
+	backing @var{abfd}.
+*/
+
+void
+_bfd_unmap_file (bfd *abfd ATTRIBUTE_UNUSED)
+{
+#ifdef HAVE_MMAP
+  if (abfd->mmap_base != NULL)
+    munmap (abfd->mmap_base, abfd->mmap_size);
+  abfd->mmap_base = NULL;
+  abfd->mmap_size = 0;
+#endif
+}
+
 /*
 INTERNAL_FUNCTION
 	bfd_open_file
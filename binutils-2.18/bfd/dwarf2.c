@@ -872,6 +872,8 @@ struct line_info_table
   struct fileinfo* files;
   struct line_info* last_line;  /* largest VMA */
   struct line_info* lcl_head;   /* local head; used in 'add_line_info' */
+  struct line_info** sorted_lines; /* The list by increasing VMA.  */
+  unsigned int num_lines;
 };
 
 /* Remember some information about each function.  If the function is
@@ -1171,6 +1173,8 @@ decode_line_info (struct comp_unit *unit, struct dwarf2_debug *stash)
   table->files = NULL;
   table->last_line = NULL;
   table->lcl_head = NULL;
+  table->sorted_lines = NULL;
+  table->num_lines = 0;
 
   line_ptr = stash->dwarf_line_buffer + unit->line_offset;
 
@@ -1452,6 +1456,31 @@ decode_line_info (struct comp_unit *unit, struct dwarf2_debug *stash)
   return table;
 }
 
+/* Copy the line_info list of TABLE into an array in increasing VMA
+   order, so that lookups can binary search it.  */
+
+static bfd_boolean
+sort_line_info_table (struct line_info_table *table)
+{
+  struct line_info* each_line;
+  unsigned int n;
+
+  n = 0;
+  for (each_line = table->last_line; each_line; each_line = each_line->prev_line)
+    n++;
+
+  table->sorted_lines = bfd_alloc (table->abfd,
+				   n * sizeof (struct line_info *));
+  if (table->sorted_lines == NULL)
+    return FALSE;
+
+  table->num_lines = n;
+  for (each_line = table->last_line; each_line; each_line = each_line->prev_line)
+    table->sorted_lines[--n] = each_line;
+
+  return TRUE;
+}
+
 /* If ADDR is within TABLE set the output parameters and return TRUE,
    otherwise return FALSE.  The output parameters, FILENAME_PTR and
    LINENUMBER_PTR, are pointers to the objects to be filled in.  */
@@ -1463,30 +1492,45 @@ lookup_address_in_line_info_table (struct line_info_table *table,
 				   const char **filename_ptr,
 				   unsigned int *linenumber_ptr)
 {
-  /* Note: table->last_line should be a descendingly sorted list. */
-  struct line_info* next_line = table->last_line;
-  struct line_info* each_line = NULL;
+  struct line_info** lines;
+  struct line_info* next_line;
+  struct line_info* each_line;
+  unsigned int lo, hi;
+
   *filename_ptr = NULL;
 
-  if (!next_line)
+  if (!table->last_line)
     return FALSE;
 
-  each_line = next_line->prev_line;
+  if (!table->sorted_lines && !sort_line_info_table (table))
+    return FALSE;
 
-  /* Check for large addresses */
-  if (addr > next_line->address)
-    each_line = NULL; /* ensure we skip over the normal case */
+  lines = table->sorted_lines;
 
-  /* Normal case: search the list; save  */
-  while (each_line && next_line)
+  /* Check for large addresses */
+  if (addr > lines[table->num_lines - 1]->address)
+    next_line = lines[table->num_lines - 1];
+  else
     {
-      /* If we have an address match, save this info.  This allows us
-	 to return as good as results as possible for strange debugging
-	 info.  */
-      bfd_boolean addr_match = FALSE;
-      if (each_line->address <= addr && addr < next_line->address)
+      /* Find the first line above ADDR; the one before it is the
+	 last line at or below ADDR, or the last of several lines that
+	 share its address.  */
+      lo = 0;
+      hi = table->num_lines;
+      while (lo < hi)
 	{
-	  addr_match = TRUE;
+	  unsigned int mid = (lo + hi) / 2;
+
+	  if (lines[mid]->address <= addr)
+	    lo = mid + 1;
+	  else
+	    hi = mid;
+	}
+
+      if (lo > 0 && lo < table->num_lines)
+	{
+	  each_line = lines[lo - 1];
+	  next_line = lines[lo];
 
 	  /* If this line appears to span functions, and addr is in the
 	     later function, return the first line of that function instead
@@ -1526,17 +1570,15 @@ lookup_address_in_line_info_table (struct line_info_table *table,
 	      *filename_ptr = each_line->filename;
 	      *linenumber_ptr = each_line->line;
 	    }
-	}
 
-      if (addr_match && !each_line->end_sequence)
-	return TRUE; /* we have definitely found what we want */
+	  if (!each_line->end_sequence)
+	    return TRUE; /* we have definitely found what we want */
+	}
 
-      next_line = each_line;
-      each_line = each_line->prev_line;
+      next_line = lines[0];
     }
 
-  /* At this point each_line is NULL but next_line is not.  If we found
-     a candidate end-of-sequence point in the loop above, we can return
+  /* If we found a candidate end-of-sequence point above, we can return
      that (compatibility with a bug in the Intel compiler); otherwise,
      assuming that we found the containing function for this address in
      this compilation unit, return the first line we have a number for
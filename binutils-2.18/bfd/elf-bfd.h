@@ -1007,6 +1007,20 @@ struct elf_backend_data
   bfd_boolean (*elf_backend_write_section)
     (bfd *, struct bfd_link_info *, asection *, bfd_byte *);
 
+  /* This function, if defined, returns TRUE if input sections of the
+     final link may be relocated in any order and by separate
+     processes: relocate_section must then change nothing but the
+     contents it is given, and must not return 2.  */
+  bfd_boolean (*elf_backend_can_relocate_in_parallel)
+    (bfd *, struct bfd_link_info *);
+
+  /* This function, if defined, returns TRUE if relocation REL of ABFD
+     only branches to or calls its target, so that the target's address
+     is never compared.  Identical code folding in safe mode treats any
+     other relocation as taking the address of its target.  */
+  bfd_boolean (*elf_backend_branch_reloc_p)
+    (bfd *abfd, const Elf_Internal_Rela *rel);
+
   /* The level of IRIX compatibility we're striving for.
      MIPS ELF specific function.  */
   irix_compat_t (*elf_backend_mips_irix_compat)
@@ -1227,6 +1241,11 @@ struct bfd_elf_section_data
 
   /* A pointer used for various section optimizations.  */
   void *sec_info;
+
+  /* Nonzero if identical code folding merged other sections into this
+     one.  Symbols of those sections keep their offsets into it, so it
+     must not be shrunk by relaxation.  */
+  unsigned int folded_into : 1;
 };
 
 #define elf_section_data(sec)  ((struct bfd_elf_section_data*)(sec)->used_by_bfd)
@@ -337,9 +337,11 @@ bfd_elf_get_elf_syms (bfd *ibfd,
 {
   Elf_Internal_Shdr *shndx_hdr;
   void *alloc_ext;
+  const bfd_byte *extsyms;
   const bfd_byte *esym;
   Elf_External_Sym_Shndx *alloc_extshndx;
-  Elf_External_Sym_Shndx *shndx;
+  const Elf_External_Sym_Shndx *extshndx;
+  const Elf_External_Sym_Shndx *shndx;
   Elf_Internal_Sym *isym;
   Elf_Internal_Sym *isymend;
   const struct elf_backend_data *bed;
@@ -355,44 +357,59 @@ bfd_elf_get_elf_syms (bfd *ibfd,
   if (symtab_hdr == &elf_tdata (ibfd)->symtab_hdr)
     shndx_hdr = &elf_tdata (ibfd)->symtab_shndx_hdr;
 
-  /* Read the symbols.  */
+  /* Read the symbols, or find them in the mapped input file.  */
   alloc_ext = NULL;
   alloc_extshndx = NULL;
   bed = get_elf_backend_data (ibfd);
   extsym_size = bed->s->sizeof_sym;
   amt = symcount * extsym_size;
   pos = symtab_hdr->sh_offset + symoffset * extsym_size;
-  if (extsym_buf == NULL)
+  extsyms = NULL;
+  if (amt / extsym_size == symcount)
+    extsyms = _bfd_get_file_view (ibfd, pos, amt);
+  if (extsyms == NULL)
     {
-      alloc_ext = bfd_malloc2 (symcount, extsym_size);
-      extsym_buf = alloc_ext;
-    }
-  if (extsym_buf == NULL
-      || bfd_seek (ibfd, pos, SEEK_SET) != 0
-      || bfd_bread (extsym_buf, amt, ibfd) != amt)
-    {
-      intsym_buf = NULL;
-      goto out;
+      if (extsym_buf == NULL)
+	{
+	  alloc_ext = bfd_malloc2 (symcount, extsym_size);
+	  extsym_buf = alloc_ext;
+	}
+      if (extsym_buf == NULL
+	  || bfd_seek (ibfd, pos, SEEK_SET) != 0
+	  || bfd_bread (extsym_buf, amt, ibfd) != amt)
+	{
+	  intsym_buf = NULL;
+	  goto out;
+	}
+      extsyms = extsym_buf;
     }
 
   if (shndx_hdr == NULL || shndx_hdr->sh_size == 0)
-    extshndx_buf = NULL;
+    extshndx = NULL;
   else
     {
       amt = symcount * sizeof (Elf_External_Sym_Shndx);
       pos = shndx_hdr->sh_offset + symoffset * sizeof (Elf_External_Sym_Shndx);
-      if (extshndx_buf == NULL)
+      extshndx = NULL;
+      if (amt / sizeof (Elf_External_Sym_Shndx) == symcount)
+	extshndx = (const Elf_External_Sym_Shndx *)
+	  _bfd_get_file_view (ibfd, pos, amt);
+      if (extshndx == NULL)
 	{
-	  alloc_extshndx = bfd_malloc2 (symcount,
-					sizeof (Elf_External_Sym_Shndx));
-	  extshndx_buf = alloc_extshndx;
-	}
-      if (extshndx_buf == NULL
-	  || bfd_seek (ibfd, pos, SEEK_SET) != 0
-	  || bfd_bread (extshndx_buf, amt, ibfd) != amt)
-	{
-	  intsym_buf = NULL;
-	  goto out;
+	  if (extshndx_buf == NULL)
+	    {
+	      alloc_extshndx = bfd_malloc2 (symcount,
+					    sizeof (Elf_External_Sym_Shndx));
+	      extshndx_buf = alloc_extshndx;
+	    }
+	  if (extshndx_buf == NULL
+	      || bfd_seek (ibfd, pos, SEEK_SET) != 0
+	      || bfd_bread (extshndx_buf, amt, ibfd) != amt)
+	    {
+	      intsym_buf = NULL;
+	      goto out;
+	    }
+	  extshndx = extshndx_buf;
 	}
     }
 
@@ -405,12 +422,12 @@ bfd_elf_get_elf_syms (bfd *ibfd,
 
   /* Convert the symbols to internal form.  */
   isymend = intsym_buf + symcount;
-  for (esym = extsym_buf, isym = intsym_buf, shndx = extshndx_buf;
+  for (esym = extsyms, isym = intsym_buf, shndx = extshndx;
        isym < isymend;
        esym += extsym_size, isym++, shndx = shndx != NULL ? shndx + 1 : NULL)
     if (!(*bed->s->swap_symbol_in) (ibfd, esym, shndx, isym))
       {
-	symoffset += (esym - (bfd_byte *) extsym_buf) / extsym_size;
+	symoffset += (esym - extsyms) / extsym_size;
 	(*_bfd_error_handler) (_("%B symbol number %lu references "
 				 "nonexistent SHT_SYMTAB_SHNDX section"),
 			       ibfd, (unsigned long) symoffset);
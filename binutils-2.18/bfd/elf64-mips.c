@@ -3125,6 +3125,8 @@ const struct elf_size_info mips_elf64_size_info =
 				_bfd_mips_elf_additional_program_headers
 #define elf_backend_modify_segment_map	_bfd_mips_elf_modify_segment_map
 #define elf_backend_gc_mark_hook	_bfd_mips_elf_gc_mark_hook
+#define elf_backend_gc_mark_extra_sections \
+					_bfd_mips_elf_gc_mark_extra_sections
 #define elf_backend_gc_sweep_hook	_bfd_mips_elf_gc_sweep_hook
 #define elf_backend_copy_indirect_symbol \
 					_bfd_mips_elf_copy_indirect_symbol
@@ -3148,6 +3150,9 @@ const struct elf_size_info mips_elf64_size_info =
 #define elf_backend_default_use_rela_p	1
 
 #define elf_backend_write_section	_bfd_mips_elf_write_section
+#define elf_backend_can_relocate_in_parallel \
+					_bfd_mips_elf_can_relocate_in_parallel
+#define elf_backend_branch_reloc_p	_bfd_mips_elf_branch_reloc_p
 
 /* We don't set bfd_elf64_bfd_is_local_label_name because the 32-bit
    MIPS-specific function only applies to IRIX5, which had no 64-bit
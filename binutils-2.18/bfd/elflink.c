@@ -29,6 +29,11 @@
 #include "libiberty.h"
 #include "objalloc.h"
 
+#if defined (HAVE_FORK) && defined (HAVE_SYS_WAIT_H)
+#include <sys/wait.h>
+#define ELF_PARALLEL_LINK 1
+#endif
+
 /* Define a symbol in a dynamic linkage section.  */
 
 struct elf_link_hash_entry *
@@ -2080,14 +2085,28 @@ elf_link_read_relocs_from_section (bfd *abfd,
   Elf_Internal_Rela *irela;
   Elf_Internal_Shdr *symtab_hdr;
   size_t nsyms;
+  void *alloc = NULL;
 
-  /* Position ourselves at the start of the section.  */
-  if (bfd_seek (abfd, shdr->sh_offset, SEEK_SET) != 0)
-    return FALSE;
+  /* Swap the relocations in straight from the input file if it can be
+     mapped, otherwise read them into EXTERNAL_RELOCS, or into a buffer
+     of our own if that is NULL.  */
+  erela = _bfd_get_file_view (abfd, shdr->sh_offset, shdr->sh_size);
+  if (erela == NULL)
+    {
+      if (external_relocs == NULL)
+	{
+	  alloc = bfd_malloc (shdr->sh_size);
+	  if (alloc == NULL)
+	    return FALSE;
+	  external_relocs = alloc;
+	}
 
-  /* Read the relocations.  */
-  if (bfd_bread (external_relocs, shdr->sh_size, abfd) != shdr->sh_size)
-    return FALSE;
+      if (bfd_seek (abfd, shdr->sh_offset, SEEK_SET) != 0
+	  || bfd_bread (external_relocs, shdr->sh_size, abfd) != shdr->sh_size)
+	goto error_return;
+
+      erela = external_relocs;
+    }
 
   symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
   nsyms = symtab_hdr->sh_size / symtab_hdr->sh_entsize;
@@ -2102,10 +2121,9 @@ elf_link_read_relocs_from_section (bfd *abfd,
   else
     {
       bfd_set_error (bfd_error_wrong_format);
-      return FALSE;
+      goto error_return;
     }
 
-  erela = external_relocs;
   erelaend = erela + shdr->sh_size;
   irela = internal_relocs;
   while (erela < erelaend)
@@ -2124,19 +2142,27 @@ elf_link_read_relocs_from_section (bfd *abfd,
 	     abfd, sec,
 	     (unsigned long) r_symndx, (unsigned long) nsyms, irela->r_offset);
 	  bfd_set_error (bfd_error_bad_value);
-	  return FALSE;
+	  goto error_return;
 	}
       irela += bed->s->int_rels_per_ext_rel;
       erela += shdr->sh_entsize;
     }
 
+  if (alloc != NULL)
+    free (alloc);
   return TRUE;
+
+ error_return:
+  if (alloc != NULL)
+    free (alloc);
+  return FALSE;
 }
 
 /* Read and swap the relocs for a section O.  They may have been
    cached.  If the EXTERNAL_RELOCS and INTERNAL_RELOCS arguments are
    not NULL, they are used as buffers to read into.  They are known to
-   be large enough.  If the INTERNAL_RELOCS relocs argument is NULL,
+   be large enough.  EXTERNAL_RELOCS is not used if the input file can
+   be mapped.  If the INTERNAL_RELOCS relocs argument is NULL,
    the return value is allocated using either malloc or bfd_alloc,
    according to the KEEP_MEMORY argument.  If O has two relocation
    sections (both REL and RELA relocations), then the REL_HDR
@@ -2151,7 +2177,6 @@ _bfd_elf_link_read_relocs (bfd *abfd,
 			   bfd_boolean keep_memory)
 {
   Elf_Internal_Shdr *rel_hdr;
-  void *alloc1 = NULL;
   Elf_Internal_Rela *alloc2 = NULL;
   const struct elf_backend_data *bed = get_elf_backend_data (abfd);
 
@@ -2177,18 +2202,6 @@ _bfd_elf_link_read_relocs (bfd *abfd,
 	goto error_return;
     }
 
-  if (external_relocs == NULL)
-    {
-      bfd_size_type size = rel_hdr->sh_size;
-
-      if (elf_section_data (o)->rel_hdr2)
-	size += elf_section_data (o)->rel_hdr2->sh_size;
-      alloc1 = bfd_malloc (size);
-      if (alloc1 == NULL)
-	goto error_return;
-      external_relocs = alloc1;
-    }
-
   if (!elf_link_read_relocs_from_section (abfd, o, rel_hdr,
 					  external_relocs,
 					  internal_relocs))
@@ -2197,7 +2210,9 @@ _bfd_elf_link_read_relocs (bfd *abfd,
       && (!elf_link_read_relocs_from_section
 	  (abfd, o,
 	   elf_section_data (o)->rel_hdr2,
-	   ((bfd_byte *) external_relocs) + rel_hdr->sh_size,
+	   (external_relocs != NULL
+	    ? ((bfd_byte *) external_relocs) + rel_hdr->sh_size
+	    : NULL),
 	   internal_relocs + (NUM_SHDR_ENTRIES (rel_hdr)
 			      * bed->s->int_rels_per_ext_rel))))
     goto error_return;
@@ -2206,17 +2221,12 @@ _bfd_elf_link_read_relocs (bfd *abfd,
   if (keep_memory)
     elf_section_data (o)->relocs = internal_relocs;
 
-  if (alloc1 != NULL)
-    free (alloc1);
-
   /* Don't free alloc2, since if it was allocated we are passing it
      back (under the name of internal_relocs).  */
 
   return internal_relocs;
 
  error_return:
-  if (alloc1 != NULL)
-    free (alloc1);
   if (alloc2 != NULL)
     free (alloc2);
   return NULL;
@@ -4621,7 +4631,9 @@ elf_link_add_object_symbols (bfd *abfd, struct bfd_link_info *info)
      The problem is that we must either (1) keep the relocs in memory,
      which causes the linker to require additional runtime memory or
      (2) read the relocs twice from the input file, which wastes time.
-     This would be a good case for using mmap.
+     When the input file can be mapped, _bfd_elf_link_read_relocs
+     swaps them in straight from the mapping, so reading them again
+     costs no I/O.
 
      I have no idea how to handle linking PIC code into a file of a
      different format.  It probably can't be done.  */
@@ -7152,6 +7164,38 @@ struct elf_final_link_info
   size_t symbuf_size;
   /* And same for symshndxbuf.  */
   size_t shndxbuf_size;
+  /* TRUE if ordinary input sections are being deferred to worker
+     processes.  */
+  bfd_boolean parallel;
+  /* The deferred sections, in link order.  */
+  struct elf_deferred_section *deferred;
+  size_t deferred_count;
+  size_t deferred_alloc;
+  /* The local symbols saved for them.  */
+  struct elf_deferred_locals *saved_locals;
+  /* Set when a reloc against a discarded section moves its symbol to
+     the kept section.  */
+  bfd_boolean retargeted;
+};
+
+/* The local symbols of an input file, saved for its deferred
+   sections.  */
+
+struct elf_deferred_locals
+{
+  struct elf_deferred_locals *next;
+  Elf_Internal_Sym *isymbuf;
+  asection **sections;
+  size_t locsymcount;
+  size_t extsymoff;
+};
+
+/* An input section a parallel final link relocates later.  */
+
+struct elf_deferred_section
+{
+  asection *sec;
+  struct elf_deferred_locals *locals;
 };
 
 /* This struct is used to pass information to elf_link_output_extsym.  */
@@ -8974,753 +9018,1020 @@ _bfd_elf_check_kept_section (asection *sec, struct bfd_link_info *info)
   return kept;
 }
 
-/* Link an input file into the linker output file.  This function
-   handles all the sections and relocations of the input file at once.
-   This is so that we only have to read the local symbols once, and
-   don't have to keep them in memory.  */
+/* Relocate input section O of INPUT_BFD and write it to the output
+   file.  ISYMBUF holds the LOCSYMCOUNT local symbols of INPUT_BFD and
+   SECTIONS the section each of them is defined in.  */
 
 static bfd_boolean
-elf_link_input_bfd (struct elf_final_link_info *finfo, bfd *input_bfd)
+elf_link_input_section (struct elf_final_link_info *finfo, bfd *input_bfd,
+			asection *o, Elf_Internal_Sym *isymbuf,
+			asection **sections, size_t locsymcount,
+			size_t extsymoff)
 {
   int (*relocate_section)
     (bfd *, struct bfd_link_info *, bfd *, asection *, bfd_byte *,
      Elf_Internal_Rela *, Elf_Internal_Sym *, asection **);
   bfd *output_bfd;
   Elf_Internal_Shdr *symtab_hdr;
-  size_t locsymcount;
-  size_t extsymoff;
-  Elf_Internal_Sym *isymbuf;
-  Elf_Internal_Sym *isym;
-  Elf_Internal_Sym *isymend;
-  long *pindex;
-  asection **ppsection;
-  asection *o;
   const struct elf_backend_data *bed;
   struct elf_link_hash_entry **sym_hashes;
+  bfd_byte *contents;
 
   output_bfd = finfo->output_bfd;
   bed = get_elf_backend_data (output_bfd);
   relocate_section = bed->elf_backend_relocate_section;
-
-  /* If this is a dynamic object, we don't want to do anything here:
-     we don't want the local symbols, and we don't want the section
-     contents.  */
-  if ((input_bfd->flags & DYNAMIC) != 0)
-    return TRUE;
-
   symtab_hdr = &elf_tdata (input_bfd)->symtab_hdr;
-  if (elf_bad_symtab (input_bfd))
-    {
-      locsymcount = symtab_hdr->sh_size / bed->s->sizeof_sym;
-      extsymoff = 0;
-    }
+  sym_hashes = elf_sym_hashes (input_bfd);
+
+  /* Get the contents of the section.  They have been cached by a
+     relaxation routine.  Note that o is a section in an input
+     file, so the contents field will not have been set by any of
+     the routines which work on output files.  */
+  if (elf_section_data (o)->this_hdr.contents != NULL)
+    contents = elf_section_data (o)->this_hdr.contents;
   else
     {
-      locsymcount = symtab_hdr->sh_info;
-      extsymoff = symtab_hdr->sh_info;
-    }
+      bfd_size_type amt = o->rawsize ? o->rawsize : o->size;
 
-  /* Read the local symbols.  */
-  isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
-  if (isymbuf == NULL && locsymcount != 0)
-    {
-      isymbuf = bfd_elf_get_elf_syms (input_bfd, symtab_hdr, locsymcount, 0,
-				      finfo->internal_syms,
-				      finfo->external_syms,
-				      finfo->locsym_shndx);
-      if (isymbuf == NULL)
+      contents = finfo->contents;
+      if (! bfd_get_section_contents (input_bfd, o, contents, 0, amt))
 	return FALSE;
     }
-  /* evaluate_complex_relocation_symbols looks for symbols in
-     finfo->internal_syms.  */
-  else if (isymbuf != NULL && locsymcount != 0)
-    {
-      bfd_elf_get_elf_syms (input_bfd, symtab_hdr, locsymcount, 0,
-			    finfo->internal_syms,
-			    finfo->external_syms,
-			    finfo->locsym_shndx);
-    }
 
-  /* Find local symbol sections and adjust values of symbols in
-     SEC_MERGE sections.  Write out those local symbols we know are
-     going into the output file.  */
-  isymend = isymbuf + locsymcount;
-  for (isym = isymbuf, pindex = finfo->indices, ppsection = finfo->sections;
-       isym < isymend;
-       isym++, pindex++, ppsection++)
+  if ((o->flags & SEC_RELOC) != 0)
     {
-      asection *isec;
-      const char *name;
-      Elf_Internal_Sym osym;
-
-      *pindex = -1;
+      Elf_Internal_Rela *internal_relocs;
+      bfd_vma r_type_mask;
+      int r_sym_shift;
+      int ret;
 
-      if (elf_bad_symtab (input_bfd))
-	{
-	  if (ELF_ST_BIND (isym->st_info) != STB_LOCAL)
-	    {
-	      *ppsection = NULL;
-	      continue;
-	    }
-	}
+      /* Get the swapped relocs.  */
+      internal_relocs
+	= _bfd_elf_link_read_relocs (input_bfd, o, finfo->external_relocs,
+				     finfo->internal_relocs, FALSE);
+      if (internal_relocs == NULL
+	  && o->reloc_count > 0)
+	return FALSE;
 
-      if (isym->st_shndx == SHN_UNDEF)
-	isec = bfd_und_section_ptr;
-      else if (isym->st_shndx < SHN_LORESERVE
-	       || isym->st_shndx > SHN_HIRESERVE)
+      if (bed->s->arch_size == 32)
 	{
-	  isec = bfd_section_from_elf_index (input_bfd, isym->st_shndx);
-	  if (isec
-	      && isec->sec_info_type == ELF_INFO_TYPE_MERGE
-	      && ELF_ST_TYPE (isym->st_info) != STT_SECTION)
-	    isym->st_value =
-	      _bfd_merged_section_offset (output_bfd, &isec,
-					  elf_section_data (isec)->sec_info,
-					  isym->st_value);
+	  r_type_mask = 0xff;
+	  r_sym_shift = 8;
 	}
-      else if (isym->st_shndx == SHN_ABS)
-	isec = bfd_abs_section_ptr;
-      else if (isym->st_shndx == SHN_COMMON)
-	isec = bfd_com_section_ptr;
       else
 	{
-	  /* Don't attempt to output symbols with st_shnx in the
-	     reserved range other than SHN_ABS and SHN_COMMON.  */
-	  *ppsection = NULL;
-	  continue;
+	  r_type_mask = 0xffffffff;
+	  r_sym_shift = 32;
 	}
 
-      *ppsection = isec;
-
-      /* Don't output the first, undefined, symbol.  */
-      if (ppsection == finfo->sections)
-	continue;
-
-      if (ELF_ST_TYPE (isym->st_info) == STT_SECTION)
+      /* Run through the relocs looking for any against symbols
+	 from discarded sections and section symbols from
+	 removed link-once sections.  Complain about relocs
+	 against discarded sections.  Zero relocs against removed
+	 link-once sections.  */
+      if (!elf_section_ignore_discarded_relocs (o))
 	{
-	  /* We never output section symbols.  Instead, we use the
-	     section symbol of the corresponding section in the output
-	     file.  */
-	  continue;
-	}
+	  Elf_Internal_Rela *rel, *relend;
+	  unsigned int action = (*bed->action_discarded) (o);
 
-      /* If we are stripping all symbols, we don't want to output this
-	 one.  */
-      if (finfo->info->strip == strip_all)
-	continue;
+	  rel = internal_relocs;
+	  relend = rel + o->reloc_count * bed->s->int_rels_per_ext_rel;
+	  for ( ; rel < relend; rel++)
+	    {
+	      unsigned long r_symndx = rel->r_info >> r_sym_shift;
+	      asection **ps, *sec;
+	      struct elf_link_hash_entry *h = NULL;
+	      const char *sym_name;
 
-      /* If we are discarding all local symbols, we don't want to
-	 output this one.  If we are generating a relocatable output
-	 file, then some of the local symbols may be required by
-	 relocs; we output them below as we discover that they are
-	 needed.  */
-      if (finfo->info->discard == discard_all)
-	continue;
+	      if (r_symndx == STN_UNDEF)
+		continue;
 
-      /* If this symbol is defined in a section which we are
-	 discarding, we don't need to keep it.  */
-      if (isym->st_shndx != SHN_UNDEF
-	  && (isym->st_shndx < SHN_LORESERVE || isym->st_shndx > SHN_HIRESERVE)
-	  && (isec == NULL
-	      || bfd_section_removed_from_list (output_bfd,
-						isec->output_section)))
-	continue;
+	      if (r_symndx >= locsymcount
+		  || (elf_bad_symtab (input_bfd)
+		      && sections[r_symndx] == NULL))
+		{
+		  h = sym_hashes[r_symndx - extsymoff];
 
-      /* Get the name of the symbol.  */
-      name = bfd_elf_string_from_elf_section (input_bfd, symtab_hdr->sh_link,
-					      isym->st_name);
-      if (name == NULL)
-	return FALSE;
+		  /* Badly formatted input files can contain relocs that
+		     reference non-existant symbols.  Check here so that
+		     we do not seg fault.  */
+		  if (h == NULL)
+		    {
+		      char buffer [32];
 
-      /* See if we are discarding symbols with this name.  */
-      if ((finfo->info->strip == strip_some
-	   && (bfd_hash_lookup (finfo->info->keep_hash, name, FALSE, FALSE)
-	       == NULL))
-	  || (((finfo->info->discard == discard_sec_merge
-		&& (isec->flags & SEC_MERGE) && ! finfo->info->relocatable)
-	       || finfo->info->discard == discard_l)
-	      && bfd_is_local_label_name (input_bfd, name)))
-	continue;
+		      sprintf_vma (buffer, rel->r_info);
+		      (*_bfd_error_handler)
+			(_("error: %B contains a reloc (0x%s) for section %A "
+			   "that references a non-existent global symbol"),
+			 input_bfd, o, buffer);
+		      bfd_set_error (bfd_error_bad_value);
+		      return FALSE;
+		    }
 
-      /* If we get here, we are going to output this symbol.  */
+		  while (h->root.type == bfd_link_hash_indirect
+			 || h->root.type == bfd_link_hash_warning)
+		    h = (struct elf_link_hash_entry *) h->root.u.i.link;
 
-      osym = *isym;
+		  if (h->root.type != bfd_link_hash_defined
+		      && h->root.type != bfd_link_hash_defweak)
+		    continue;
 
-      /* Adjust the section index for the output file.  */
-      osym.st_shndx = _bfd_elf_section_from_bfd_section (output_bfd,
-							 isec->output_section);
-      if (osym.st_shndx == SHN_BAD)
-	return FALSE;
+		  ps = &h->root.u.def.section;
+		  sym_name = h->root.root.string;
+		}
+	      else
+		{
+		  Elf_Internal_Sym *sym = isymbuf + r_symndx;
+		  ps = &sections[r_symndx];
+		  sym_name = bfd_elf_sym_name (input_bfd,
+					       symtab_hdr,
+					       sym, *ps);
+		}
 
-      *pindex = bfd_get_symcount (output_bfd);
+	      /* Complain if the definition comes from a
+		 discarded section.  */
+	      if ((sec = *ps) != NULL && elf_discarded_section (sec))
+		{
+		  BFD_ASSERT (r_symndx != 0);
+		  if (action & COMPLAIN)
+		    (*finfo->info->callbacks->einfo)
+		      (_("%X`%s' referenced in section `%A' of %B: "
+			 "defined in discarded section `%A' of %B\n"),
+		       sym_name, o, input_bfd, sec, sec->owner);
+
+		  /* Try to do the best we can to support buggy old
+		     versions of gcc.  Pretend that the symbol is
+		     really defined in the kept linkonce section.
+		     FIXME: This is quite broken.  Modifying the
+		     symbol here means we will be changing all later
+		     uses of the symbol, not just in this section.  */
+		  if (action & PRETEND)
+		    {
+		      asection *kept;
 
-      /* ELF symbols in relocatable files are section relative, but
-	 in executable files they are virtual addresses.  Note that
-	 this code assumes that all ELF sections have an associated
-	 BFD section with a reasonable value for output_offset; below
-	 we assume that they also have a reasonable value for
-	 output_section.  Any special sections must be set up to meet
-	 these requirements.  */
-      osym.st_value += isec->output_offset;
-      if (! finfo->info->relocatable)
-	{
-	  osym.st_value += isec->output_section->vma;
-	  if (ELF_ST_TYPE (osym.st_info) == STT_TLS)
-	    {
-	      /* STT_TLS symbols are relative to PT_TLS segment base.  */
-	      BFD_ASSERT (elf_hash_table (finfo->info)->tls_sec != NULL);
-	      osym.st_value -= elf_hash_table (finfo->info)->tls_sec->vma;
+		      kept = _bfd_elf_check_kept_section (sec,
+							  finfo->info);
+		      if (kept != NULL)
+			{
+			  *ps = kept;
+			  finfo->retargeted = TRUE;
+			  continue;
+			}
+		    }
+		}
 	    }
 	}
 
-      if (! elf_link_output_sym (finfo, name, &osym, isec, NULL))
-	return FALSE;
-    }
-
-  if (! evaluate_complex_relocation_symbols (input_bfd, finfo, locsymcount))
-    return FALSE;
+      /* Relocate the section by invoking a back end routine.
 
-  /* Relocate the contents of each section.  */
-  sym_hashes = elf_sym_hashes (input_bfd);
-  for (o = input_bfd->sections; o != NULL; o = o->next)
-    {
-      bfd_byte *contents;
+	 The back end routine is responsible for adjusting the
+	 section contents as necessary, and (if using Rela relocs
+	 and generating a relocatable output file) adjusting the
+	 reloc addend as necessary.
 
-      if (! o->linker_mark)
-	{
-	  /* This section was omitted from the link.  */
-	  continue;
-	}
+	 The back end routine does not have to worry about setting
+	 the reloc address or the reloc symbol index.
 
-      if ((o->flags & SEC_HAS_CONTENTS) == 0
-	  || (o->size == 0 && (o->flags & SEC_RELOC) == 0))
-	continue;
+	 The back end routine is given a pointer to the swapped in
+	 internal symbols, and can access the hash table entries
+	 for the external symbols via elf_sym_hashes (input_bfd).
 
-      if ((o->flags & SEC_LINKER_CREATED) != 0)
-	{
-	  /* Section was created by _bfd_elf_link_create_dynamic_sections
-	     or somesuch.  */
-	  continue;
-	}
+	 When generating relocatable output, the back end routine
+	 must handle STB_LOCAL/STT_SECTION symbols specially.  The
+	 output symbol is going to be a section symbol
+	 corresponding to the output section, which will require
+	 the addend to be adjusted.  */
 
-      /* Get the contents of the section.  They have been cached by a
-	 relaxation routine.  Note that o is a section in an input
-	 file, so the contents field will not have been set by any of
-	 the routines which work on output files.  */
-      if (elf_section_data (o)->this_hdr.contents != NULL)
-	contents = elf_section_data (o)->this_hdr.contents;
-      else
-	{
-	  bfd_size_type amt = o->rawsize ? o->rawsize : o->size;
+      ret = (*relocate_section) (output_bfd, finfo->info,
+				 input_bfd, o, contents,
+				 internal_relocs,
+				 isymbuf,
+				 sections);
+      if (!ret)
+	return FALSE;
 
-	  contents = finfo->contents;
-	  if (! bfd_get_section_contents (input_bfd, o, contents, 0, amt))
-	    return FALSE;
-	}
+      if (ret == 2
+	  || finfo->info->relocatable
+	  || finfo->info->emitrelocations)
+	{
+	  Elf_Internal_Rela *irela;
+	  Elf_Internal_Rela *irelaend;
+	  bfd_vma last_offset;
+	  struct elf_link_hash_entry **rel_hash;
+	  struct elf_link_hash_entry **rel_hash_list;
+	  Elf_Internal_Shdr *input_rel_hdr, *input_rel_hdr2;
+	  unsigned int next_erel;
+	  bfd_boolean rela_normal;
+
+	  input_rel_hdr = &elf_section_data (o)->rel_hdr;
+	  rela_normal = (bed->rela_normal
+			 && (input_rel_hdr->sh_entsize
+			     == bed->s->sizeof_rela));
+
+	  /* Adjust the reloc addresses and symbol indices.  */
+
+	  irela = internal_relocs;
+	  irelaend = irela + o->reloc_count * bed->s->int_rels_per_ext_rel;
+	  rel_hash = (elf_section_data (o->output_section)->rel_hashes
+		      + elf_section_data (o->output_section)->rel_count
+		      + elf_section_data (o->output_section)->rel_count2);
+	  rel_hash_list = rel_hash;
+	  last_offset = o->output_offset;
+	  if (!finfo->info->relocatable)
+	    last_offset += o->output_section->vma;
+	  for (next_erel = 0; irela < irelaend; irela++, next_erel++)
+	    {
+	      unsigned long r_symndx;
+	      asection *sec;
+	      Elf_Internal_Sym sym;
 
-      if ((o->flags & SEC_RELOC) != 0)
-	{
-	  Elf_Internal_Rela *internal_relocs;
-	  bfd_vma r_type_mask;
-	  int r_sym_shift;
-	  int ret;
-
-	  /* Get the swapped relocs.  */
-	  internal_relocs
-	    = _bfd_elf_link_read_relocs (input_bfd, o, finfo->external_relocs,
-					 finfo->internal_relocs, FALSE);
-	  if (internal_relocs == NULL
-	      && o->reloc_count > 0)
-	    return FALSE;
+	      if (next_erel == bed->s->int_rels_per_ext_rel)
+		{
+		  rel_hash++;
+		  next_erel = 0;
+		}
 
-	  if (bed->s->arch_size == 32)
-	    {
-	      r_type_mask = 0xff;
-	      r_sym_shift = 8;
-	    }
-	  else
-	    {
-	      r_type_mask = 0xffffffff;
-	      r_sym_shift = 32;
-	    }
+	      irela->r_offset = _bfd_elf_section_offset (output_bfd,
+							 finfo->info, o,
+							 irela->r_offset);
+	      if (irela->r_offset >= (bfd_vma) -2)
+		{
+		  /* This is a reloc for a deleted entry or somesuch.
+		     Turn it into an R_*_NONE reloc, at the same
+		     offset as the last reloc.  elf_eh_frame.c and
+		     bfd_elf_discard_info rely on reloc offsets
+		     being ordered.  */
+		  irela->r_offset = last_offset;
+		  irela->r_info = 0;
+		  irela->r_addend = 0;
+		  continue;
+		}
 
-	  /* Run through the relocs looking for any against symbols
-	     from discarded sections and section symbols from
-	     removed link-once sections.  Complain about relocs
-	     against discarded sections.  Zero relocs against removed
-	     link-once sections.  */
-	  if (!elf_section_ignore_discarded_relocs (o))
-	    {
-	      Elf_Internal_Rela *rel, *relend;
-	      unsigned int action = (*bed->action_discarded) (o);
+	      irela->r_offset += o->output_offset;
 
-	      rel = internal_relocs;
-	      relend = rel + o->reloc_count * bed->s->int_rels_per_ext_rel;
-	      for ( ; rel < relend; rel++)
-		{
-		  unsigned long r_symndx = rel->r_info >> r_sym_shift;
-		  asection **ps, *sec;
-		  struct elf_link_hash_entry *h = NULL;
-		  const char *sym_name;
+	      /* Relocs in an executable have to be virtual addresses.  */
+	      if (!finfo->info->relocatable)
+		irela->r_offset += o->output_section->vma;
 
-		  if (r_symndx == STN_UNDEF)
-		    continue;
+	      last_offset = irela->r_offset;
 
-		  if (r_symndx >= locsymcount
-		      || (elf_bad_symtab (input_bfd)
-			  && finfo->sections[r_symndx] == NULL))
-		    {
-		      h = sym_hashes[r_symndx - extsymoff];
+	      r_symndx = irela->r_info >> r_sym_shift;
+	      if (r_symndx == STN_UNDEF)
+		continue;
 
-		      /* Badly formatted input files can contain relocs that
-			 reference non-existant symbols.  Check here so that
-			 we do not seg fault.  */
-		      if (h == NULL)
-			{
-			  char buffer [32];
-
-			  sprintf_vma (buffer, rel->r_info);
-			  (*_bfd_error_handler)
-			    (_("error: %B contains a reloc (0x%s) for section %A "
-			       "that references a non-existent global symbol"),
-			     input_bfd, o, buffer);
-			  bfd_set_error (bfd_error_bad_value);
-			  return FALSE;
-			}
+	      if (r_symndx >= locsymcount
+		  || (elf_bad_symtab (input_bfd)
+		      && sections[r_symndx] == NULL))
+		{
+		  struct elf_link_hash_entry *rh;
+		  unsigned long indx;
+
+		  /* This is a reloc against a global symbol.  We
+		     have not yet output all the local symbols, so
+		     we do not know the symbol index of any global
+		     symbol.  We set the rel_hash entry for this
+		     reloc to point to the global hash table entry
+		     for this symbol.  The symbol index is then
+		     set at the end of bfd_elf_final_link.  */
+		  indx = r_symndx - extsymoff;
+		  rh = elf_sym_hashes (input_bfd)[indx];
+		  while (rh->root.type == bfd_link_hash_indirect
+			 || rh->root.type == bfd_link_hash_warning)
+		    rh = (struct elf_link_hash_entry *) rh->root.u.i.link;
+
+		  /* Setting the index to -2 tells
+		     elf_link_output_extsym that this symbol is
+		     used by a reloc.  */
+		  BFD_ASSERT (rh->indx < 0);
+		  rh->indx = -2;
+
+		  *rel_hash = rh;
 
-		      while (h->root.type == bfd_link_hash_indirect
-			     || h->root.type == bfd_link_hash_warning)
-			h = (struct elf_link_hash_entry *) h->root.u.i.link;
+		  continue;
+		}
 
-		      if (h->root.type != bfd_link_hash_defined
-			  && h->root.type != bfd_link_hash_defweak)
-			continue;
+	      /* This is a reloc against a local symbol.  */
 
-		      ps = &h->root.u.def.section;
-		      sym_name = h->root.root.string;
+	      *rel_hash = NULL;
+	      sym = isymbuf[r_symndx];
+	      sec = sections[r_symndx];
+	      if (ELF_ST_TYPE (sym.st_info) == STT_SECTION)
+		{
+		  /* I suppose the backend ought to fill in the
+		     section of any STT_SECTION symbol against a
+		     processor specific section.  */
+		  r_symndx = 0;
+		  if (bfd_is_abs_section (sec))
+		    ;
+		  else if (sec == NULL || sec->owner == NULL)
+		    {
+		      bfd_set_error (bfd_error_bad_value);
+		      return FALSE;
 		    }
 		  else
 		    {
-		      Elf_Internal_Sym *sym = isymbuf + r_symndx;
-		      ps = &finfo->sections[r_symndx];
-		      sym_name = bfd_elf_sym_name (input_bfd,
-						   symtab_hdr,
-						   sym, *ps);
+		      asection *osec = sec->output_section;
+
+		      /* If we have discarded a section, the output
+			 section will be the absolute section.  In
+			 case of discarded SEC_MERGE sections, use
+			 the kept section.  relocate_section should
+			 have already handled discarded linkonce
+			 sections.  */
+		      if (bfd_is_abs_section (osec)
+			  && sec->kept_section != NULL
+			  && sec->kept_section->output_section != NULL)
+			{
+			  osec = sec->kept_section->output_section;
+			  irela->r_addend -= osec->vma;
+			}
+
+		      if (!bfd_is_abs_section (osec))
+			{
+			  r_symndx = osec->target_index;
+			  if (r_symndx == 0)
+			    {
+			      struct elf_link_hash_table *htab;
+			      asection *oi;
+
+			      htab = elf_hash_table (finfo->info);
+			      oi = htab->text_index_section;
+			      if ((osec->flags & SEC_READONLY) == 0
+				  && htab->data_index_section != NULL)
+				oi = htab->data_index_section;
+
+			      if (oi != NULL)
+				{
+				  irela->r_addend += osec->vma - oi->vma;
+				  r_symndx = oi->target_index;
+				}
+			    }
+
+			  BFD_ASSERT (r_symndx != 0);
+			}
 		    }
 
-		  /* Complain if the definition comes from a
-		     discarded section.  */
-		  if ((sec = *ps) != NULL && elf_discarded_section (sec))
+		  /* Adjust the addend according to where the
+		     section winds up in the output section.  */
+		  if (rela_normal)
+		    irela->r_addend += sec->output_offset;
+		}
+	      else
+		{
+		  if (finfo->indices[r_symndx] == -1)
 		    {
-		      BFD_ASSERT (r_symndx != 0);
-		      if (action & COMPLAIN)
-			(*finfo->info->callbacks->einfo)
-			  (_("%X`%s' referenced in section `%A' of %B: "
-			     "defined in discarded section `%A' of %B\n"),
-			   sym_name, o, input_bfd, sec, sec->owner);
-
-		      /* Try to do the best we can to support buggy old
-			 versions of gcc.  Pretend that the symbol is
-			 really defined in the kept linkonce section.
-			 FIXME: This is quite broken.  Modifying the
-			 symbol here means we will be changing all later
-			 uses of the symbol, not just in this section.  */
-		      if (action & PRETEND)
+		      unsigned long shlink;
+		      const char *name;
+		      asection *osec;
+
+		      if (finfo->info->strip == strip_all)
 			{
-			  asection *kept;
+			  /* You can't do ld -r -s.  */
+			  bfd_set_error (bfd_error_invalid_operation);
+			  return FALSE;
+			}
 
-			  kept = _bfd_elf_check_kept_section (sec,
-							      finfo->info);
-			  if (kept != NULL)
+		      /* This symbol was skipped earlier, but
+			 since it is needed by a reloc, we
+			 must output it now.  */
+		      shlink = symtab_hdr->sh_link;
+		      name = (bfd_elf_string_from_elf_section
+			      (input_bfd, shlink, sym.st_name));
+		      if (name == NULL)
+			return FALSE;
+
+		      osec = sec->output_section;
+		      sym.st_shndx =
+			_bfd_elf_section_from_bfd_section (output_bfd,
+							   osec);
+		      if (sym.st_shndx == SHN_BAD)
+			return FALSE;
+
+		      sym.st_value += sec->output_offset;
+		      if (! finfo->info->relocatable)
+			{
+			  sym.st_value += osec->vma;
+			  if (ELF_ST_TYPE (sym.st_info) == STT_TLS)
 			    {
-			      *ps = kept;
-			      continue;
+			      /* STT_TLS symbols are relative to PT_TLS
+				 segment base.  */
+			      BFD_ASSERT (elf_hash_table (finfo->info)
+					  ->tls_sec != NULL);
+			      sym.st_value -= (elf_hash_table (finfo->info)
+					       ->tls_sec->vma);
 			    }
 			}
+
+		      finfo->indices[r_symndx]
+			= bfd_get_symcount (output_bfd);
+
+		      if (! elf_link_output_sym (finfo, name, &sym, sec,
+						 NULL))
+			return FALSE;
 		    }
+
+		  r_symndx = finfo->indices[r_symndx];
 		}
+
+	      irela->r_info = ((bfd_vma) r_symndx << r_sym_shift
+			       | (irela->r_info & r_type_mask));
 	    }
 
-	  /* Relocate the section by invoking a back end routine.
+	  /* Swap out the relocs.  */
+	  if (input_rel_hdr->sh_size != 0
+	      && !bed->elf_backend_emit_relocs (output_bfd, o,
+						input_rel_hdr,
+						internal_relocs,
+						rel_hash_list))
+	    return FALSE;
 
-	     The back end routine is responsible for adjusting the
-	     section contents as necessary, and (if using Rela relocs
-	     and generating a relocatable output file) adjusting the
-	     reloc addend as necessary.
+	  input_rel_hdr2 = elf_section_data (o)->rel_hdr2;
+	  if (input_rel_hdr2 && input_rel_hdr2->sh_size != 0)
+	    {
+	      internal_relocs += (NUM_SHDR_ENTRIES (input_rel_hdr)
+				  * bed->s->int_rels_per_ext_rel);
+	      rel_hash_list += NUM_SHDR_ENTRIES (input_rel_hdr);
+	      if (!bed->elf_backend_emit_relocs (output_bfd, o,
+						 input_rel_hdr2,
+						 internal_relocs,
+						 rel_hash_list))
+		return FALSE;
+	    }
+	}
+    }
 
-	     The back end routine does not have to worry about setting
-	     the reloc address or the reloc symbol index.
+  /* Write out the modified section contents.  */
+  if (bed->elf_backend_write_section
+      && (*bed->elf_backend_write_section) (output_bfd, finfo->info, o,
+					    contents))
+    {
+      /* Section written out.  */
+    }
+  else switch (o->sec_info_type)
+    {
+    case ELF_INFO_TYPE_STABS:
+      if (! (_bfd_write_section_stabs
+	     (output_bfd,
+	      &elf_hash_table (finfo->info)->stab_info,
+	      o, &elf_section_data (o)->sec_info, contents)))
+	return FALSE;
+      break;
+    case ELF_INFO_TYPE_MERGE:
+      if (! _bfd_write_merged_section (output_bfd, o,
+				       elf_section_data (o)->sec_info))
+	return FALSE;
+      break;
+    case ELF_INFO_TYPE_EH_FRAME:
+      {
+	if (! _bfd_elf_write_section_eh_frame (output_bfd, finfo->info,
+					       o, contents))
+	  return FALSE;
+      }
+      break;
+    default:
+      {
+	if (! (o->flags & SEC_EXCLUDE)
+	    && ! bfd_set_section_contents (output_bfd, o->output_section,
+					   contents,
+					   (file_ptr) o->output_offset,
+					   o->size))
+	  return FALSE;
+      }
+      break;
+    }
+  return TRUE;
+}
 
-	     The back end routine is given a pointer to the swapped in
-	     internal symbols, and can access the hash table entries
-	     for the external symbols via elf_sym_hashes (input_bfd).
+/* Save the LOCSYMCOUNT local symbols in ISYMBUF of the input BFD being
+   linked, and the sections they are defined in, for the sections of that
+   BFD a parallel final link defers.  */
 
-	     When generating relocatable output, the back end routine
-	     must handle STB_LOCAL/STT_SECTION symbols specially.  The
-	     output symbol is going to be a section symbol
-	     corresponding to the output section, which will require
-	     the addend to be adjusted.  */
+static struct elf_deferred_locals *
+elf_link_save_locals (struct elf_final_link_info *finfo,
+		      Elf_Internal_Sym *isymbuf, size_t locsymcount,
+		      size_t extsymoff)
+{
+  struct elf_deferred_locals *locals;
+  bfd_size_type amt;
 
-	  ret = (*relocate_section) (output_bfd, finfo->info,
-				     input_bfd, o, contents,
-				     internal_relocs,
-				     isymbuf,
-				     finfo->sections);
-	  if (!ret)
-	    return FALSE;
+  amt = (sizeof (*locals)
+	 + locsymcount * (sizeof (Elf_Internal_Sym) + sizeof (asection *)));
+  locals = bfd_malloc (amt);
+  if (locals == NULL)
+    return NULL;
 
-	  if (ret == 2
-	      || finfo->info->relocatable
-	      || finfo->info->emitrelocations)
-	    {
-	      Elf_Internal_Rela *irela;
-	      Elf_Internal_Rela *irelaend;
-	      bfd_vma last_offset;
-	      struct elf_link_hash_entry **rel_hash;
-	      struct elf_link_hash_entry **rel_hash_list;
-	      Elf_Internal_Shdr *input_rel_hdr, *input_rel_hdr2;
-	      unsigned int next_erel;
-	      bfd_boolean rela_normal;
-
-	      input_rel_hdr = &elf_section_data (o)->rel_hdr;
-	      rela_normal = (bed->rela_normal
-			     && (input_rel_hdr->sh_entsize
-				 == bed->s->sizeof_rela));
-
-	      /* Adjust the reloc addresses and symbol indices.  */
-
-	      irela = internal_relocs;
-	      irelaend = irela + o->reloc_count * bed->s->int_rels_per_ext_rel;
-	      rel_hash = (elf_section_data (o->output_section)->rel_hashes
-			  + elf_section_data (o->output_section)->rel_count
-			  + elf_section_data (o->output_section)->rel_count2);
-	      rel_hash_list = rel_hash;
-	      last_offset = o->output_offset;
-	      if (!finfo->info->relocatable)
-		last_offset += o->output_section->vma;
-	      for (next_erel = 0; irela < irelaend; irela++, next_erel++)
-		{
-		  unsigned long r_symndx;
-		  asection *sec;
-		  Elf_Internal_Sym sym;
+  locals->isymbuf = (Elf_Internal_Sym *) (locals + 1);
+  locals->sections = (asection **) (locals->isymbuf + locsymcount);
+  locals->locsymcount = locsymcount;
+  locals->extsymoff = extsymoff;
+  if (locsymcount != 0)
+    {
+      memcpy (locals->isymbuf, isymbuf,
+	      locsymcount * sizeof (Elf_Internal_Sym));
+      memcpy (locals->sections, finfo->sections,
+	      locsymcount * sizeof (asection *));
+    }
 
-		  if (next_erel == bed->s->int_rels_per_ext_rel)
-		    {
-		      rel_hash++;
-		      next_erel = 0;
-		    }
+  locals->next = finfo->saved_locals;
+  finfo->saved_locals = locals;
+  return locals;
+}
 
-		  irela->r_offset = _bfd_elf_section_offset (output_bfd,
-							     finfo->info, o,
-							     irela->r_offset);
-		  if (irela->r_offset >= (bfd_vma) -2)
-		    {
-		      /* This is a reloc for a deleted entry or somesuch.
-			 Turn it into an R_*_NONE reloc, at the same
-			 offset as the last reloc.  elf_eh_frame.c and
-			 bfd_elf_discard_info rely on reloc offsets
-			 being ordered.  */
-		      irela->r_offset = last_offset;
-		      irela->r_info = 0;
-		      irela->r_addend = 0;
-		      continue;
-		    }
+/* Queue input section O, whose local symbols are LOCALS, to be
+   relocated and written out later by elf_link_output_deferred.  */
 
-		  irela->r_offset += o->output_offset;
+static bfd_boolean
+elf_link_defer_section (struct elf_final_link_info *finfo, asection *o,
+			struct elf_deferred_locals *locals)
+{
+  struct elf_deferred_section *d;
 
-		  /* Relocs in an executable have to be virtual addresses.  */
-		  if (!finfo->info->relocatable)
-		    irela->r_offset += o->output_section->vma;
+  if (finfo->deferred_count == finfo->deferred_alloc)
+    {
+      size_t alloc = finfo->deferred_alloc ? 2 * finfo->deferred_alloc : 64;
 
-		  last_offset = irela->r_offset;
+      d = bfd_realloc (finfo->deferred, alloc * sizeof (*d));
+      if (d == NULL)
+	return FALSE;
+      finfo->deferred = d;
+      finfo->deferred_alloc = alloc;
+    }
 
-		  r_symndx = irela->r_info >> r_sym_shift;
-		  if (r_symndx == STN_UNDEF)
-		    continue;
+  d = finfo->deferred + finfo->deferred_count++;
+  d->sec = o;
+  d->locals = locals;
+  return TRUE;
+}
 
-		  if (r_symndx >= locsymcount
-		      || (elf_bad_symtab (input_bfd)
-			  && finfo->sections[r_symndx] == NULL))
-		    {
-		      struct elf_link_hash_entry *rh;
-		      unsigned long indx;
-
-		      /* This is a reloc against a global symbol.  We
-			 have not yet output all the local symbols, so
-			 we do not know the symbol index of any global
-			 symbol.  We set the rel_hash entry for this
-			 reloc to point to the global hash table entry
-			 for this symbol.  The symbol index is then
-			 set at the end of bfd_elf_final_link.  */
-		      indx = r_symndx - extsymoff;
-		      rh = elf_sym_hashes (input_bfd)[indx];
-		      while (rh->root.type == bfd_link_hash_indirect
-			     || rh->root.type == bfd_link_hash_warning)
-			rh = (struct elf_link_hash_entry *) rh->root.u.i.link;
-
-		      /* Setting the index to -2 tells
-			 elf_link_output_extsym that this symbol is
-			 used by a reloc.  */
-		      BFD_ASSERT (rh->indx < 0);
-		      rh->indx = -2;
-
-		      *rel_hash = rh;
+/* Relocate and write out deferred sections FIRST up to LAST.  */
 
-		      continue;
-		    }
+static bfd_boolean
+elf_link_input_deferred (struct elf_final_link_info *finfo,
+			 size_t first, size_t last)
+{
+  size_t i;
 
-		  /* This is a reloc against a local symbol.  */
+  for (i = first; i < last; i++)
+    {
+      struct elf_deferred_section *d = finfo->deferred + i;
 
-		  *rel_hash = NULL;
-		  sym = isymbuf[r_symndx];
-		  sec = finfo->sections[r_symndx];
-		  if (ELF_ST_TYPE (sym.st_info) == STT_SECTION)
-		    {
-		      /* I suppose the backend ought to fill in the
-			 section of any STT_SECTION symbol against a
-			 processor specific section.  */
-		      r_symndx = 0;
-		      if (bfd_is_abs_section (sec))
-			;
-		      else if (sec == NULL || sec->owner == NULL)
-			{
-			  bfd_set_error (bfd_error_bad_value);
-			  return FALSE;
-			}
-		      else
-			{
-			  asection *osec = sec->output_section;
-
-			  /* If we have discarded a section, the output
-			     section will be the absolute section.  In
-			     case of discarded SEC_MERGE sections, use
-			     the kept section.  relocate_section should
-			     have already handled discarded linkonce
-			     sections.  */
-			  if (bfd_is_abs_section (osec)
-			      && sec->kept_section != NULL
-			      && sec->kept_section->output_section != NULL)
-			    {
-			      osec = sec->kept_section->output_section;
-			      irela->r_addend -= osec->vma;
-			    }
+      if (! elf_link_input_section (finfo, d->sec->owner, d->sec,
+				    d->locals->isymbuf, d->locals->sections,
+				    d->locals->locsymcount,
+				    d->locals->extsymoff))
+	return FALSE;
+    }
+  return TRUE;
+}
 
-			  if (!bfd_is_abs_section (osec))
-			    {
-			      r_symndx = osec->target_index;
-			      if (r_symndx == 0)
-				{
-				  struct elf_link_hash_table *htab;
-				  asection *oi;
-
-				  htab = elf_hash_table (finfo->info);
-				  oi = htab->text_index_section;
-				  if ((osec->flags & SEC_READONLY) == 0
-				      && htab->data_index_section != NULL)
-				    oi = htab->data_index_section;
-
-				  if (oi != NULL)
-				    {
-				      irela->r_addend += osec->vma - oi->vma;
-				      r_symndx = oi->target_index;
-				    }
-				}
+#ifdef ELF_PARALLEL_LINK
 
-			      BFD_ASSERT (r_symndx != 0);
-			    }
-			}
+/* The body of a worker process of a parallel final link, relocating
+   deferred sections FIRST up to LAST.  Return the exit status: zero
+   only if every section was written out, nothing was reported, and
+   no symbol was moved to a kept section that other sections might
+   use.  A worker that fails has its sections done again by the
+   parent, so diagnostics come out once and in link order.  */
 
-		      /* Adjust the addend according to where the
-			 section winds up in the output section.  */
-		      if (rela_normal)
-			irela->r_addend += sec->output_offset;
-		    }
-		  else
-		    {
-		      if (finfo->indices[r_symndx] == -1)
-			{
-			  unsigned long shlink;
-			  const char *name;
-			  asection *osec;
+static int
+elf_link_deferred_worker (struct elf_final_link_info *finfo,
+			  size_t first, size_t last)
+{
+  FILE *err;
+  struct stat st;
 
-			  if (finfo->info->strip == strip_all)
-			    {
-			      /* You can't do ld -r -s.  */
-			      bfd_set_error (bfd_error_invalid_operation);
-			      return FALSE;
-			    }
+  err = tmpfile ();
+  if (err == NULL || dup2 (fileno (err), fileno (stderr)) < 0)
+    return 1;
 
-			  /* This symbol was skipped earlier, but
-			     since it is needed by a reloc, we
-			     must output it now.  */
-			  shlink = symtab_hdr->sh_link;
-			  name = (bfd_elf_string_from_elf_section
-				  (input_bfd, shlink, sym.st_name));
-			  if (name == NULL)
-			    return FALSE;
-
-			  osec = sec->output_section;
-			  sym.st_shndx =
-			    _bfd_elf_section_from_bfd_section (output_bfd,
-							       osec);
-			  if (sym.st_shndx == SHN_BAD)
-			    return FALSE;
-
-			  sym.st_value += sec->output_offset;
-			  if (! finfo->info->relocatable)
-			    {
-			      sym.st_value += osec->vma;
-			      if (ELF_ST_TYPE (sym.st_info) == STT_TLS)
-				{
-				  /* STT_TLS symbols are relative to PT_TLS
-				     segment base.  */
-				  BFD_ASSERT (elf_hash_table (finfo->info)
-					      ->tls_sec != NULL);
-				  sym.st_value -= (elf_hash_table (finfo->info)
-						   ->tls_sec->vma);
-				}
-			    }
+  finfo->retargeted = FALSE;
+  if (! elf_link_input_deferred (finfo, first, last)
+      || finfo->retargeted
+      || ! bfd_cache_close_all ())
+    return 1;
 
-			  finfo->indices[r_symndx]
-			    = bfd_get_symcount (output_bfd);
+  fflush (stderr);
+  if (fstat (fileno (stderr), &st) != 0 || st.st_size != 0)
+    return 1;
+  return 0;
+}
 
-			  if (! elf_link_output_sym (finfo, name, &sym, sec,
-						     NULL))
-			    return FALSE;
-			}
+/* Split the deferred sections into runs of about the same size and
+   relocate each run in its own worker process.  Return TRUE if every
+   worker succeeded.  */
 
-		      r_symndx = finfo->indices[r_symndx];
-		    }
+static bfd_boolean
+elf_link_fork_deferred (struct elf_final_link_info *finfo)
+{
+  size_t count = finfo->deferred_count;
+  unsigned int jobs = finfo->info->jobs;
+  unsigned int started, i;
+  bfd_size_type total, done;
+  size_t first, last;
+  pid_t *pids;
+  bfd_boolean ok;
+
+  if (jobs > count)
+    jobs = count;
+  pids = bfd_malloc (jobs * sizeof (*pids));
+  if (pids == NULL)
+    return FALSE;
 
-		  irela->r_info = ((bfd_vma) r_symndx << r_sym_shift
-				   | (irela->r_info & r_type_mask));
-		}
+  total = 0;
+  for (last = 0; last < count; last++)
+    total += finfo->deferred[last].sec->size;
 
-	      /* Swap out the relocs.  */
-	      if (input_rel_hdr->sh_size != 0
-		  && !bed->elf_backend_emit_relocs (output_bfd, o,
-						    input_rel_hdr,
-						    internal_relocs,
-						    rel_hash_list))
-		return FALSE;
+  /* The workers must not share file positions or buffered output with
+     the parent or each other, so let them all open files afresh.  */
+  ok = bfd_cache_close_all ();
+  fflush (NULL);
 
-	      input_rel_hdr2 = elf_section_data (o)->rel_hdr2;
-	      if (input_rel_hdr2 && input_rel_hdr2->sh_size != 0)
-		{
-		  internal_relocs += (NUM_SHDR_ENTRIES (input_rel_hdr)
-				      * bed->s->int_rels_per_ext_rel);
-		  rel_hash_list += NUM_SHDR_ENTRIES (input_rel_hdr);
-		  if (!bed->elf_backend_emit_relocs (output_bfd, o,
-						     input_rel_hdr2,
-						     internal_relocs,
-						     rel_hash_list))
-		    return FALSE;
-		}
-	    }
-	}
+  done = 0;
+  first = 0;
+  for (started = 0; ok && started < jobs && first < count; started++)
+    {
+      pid_t pid;
 
-      /* Write out the modified section contents.  */
-      if (bed->elf_backend_write_section
-	  && (*bed->elf_backend_write_section) (output_bfd, finfo->info, o,
-						contents))
-	{
-	  /* Section written out.  */
-	}
-      else switch (o->sec_info_type)
+      last = first;
+      while (last < count
+	     && (last == first
+		 || started == jobs - 1
+		 || done < total / jobs * (started + 1)))
+	done += finfo->deferred[last++].sec->size;
+
+      pid = fork ();
+      if (pid == 0)
+	_exit (elf_link_deferred_worker (finfo, first, last));
+      if (pid < 0)
 	{
-	case ELF_INFO_TYPE_STABS:
-	  if (! (_bfd_write_section_stabs
-		 (output_bfd,
-		  &elf_hash_table (finfo->info)->stab_info,
-		  o, &elf_section_data (o)->sec_info, contents)))
-	    return FALSE;
-	  break;
-	case ELF_INFO_TYPE_MERGE:
-	  if (! _bfd_write_merged_section (output_bfd, o,
-					   elf_section_data (o)->sec_info))
-	    return FALSE;
-	  break;
-	case ELF_INFO_TYPE_EH_FRAME:
-	  {
-	    if (! _bfd_elf_write_section_eh_frame (output_bfd, finfo->info,
-						   o, contents))
-	      return FALSE;
-	  }
-	  break;
-	default:
-	  {
-	    if (! (o->flags & SEC_EXCLUDE)
-		&& ! bfd_set_section_contents (output_bfd, o->output_section,
-					       contents,
-					       (file_ptr) o->output_offset,
-					       o->size))
-	      return FALSE;
-	  }
+	  ok = FALSE;
 	  break;
 	}
+      pids[started] = pid;
+      first = last;
+    }
+
+  for (i = 0; i < started; i++)
+    {
+      int status;
+
+      if (waitpid (pids[i], &status, 0) != pids[i]
+	  || ! WIFEXITED (status)
+	  || WEXITSTATUS (status) != 0)
+	ok = FALSE;
     }
 
+  free (pids);
+  return ok;
+}
+
+#endif /* ELF_PARALLEL_LINK */
+
+/* Relocate and write out the sections deferred so far, in parallel if
+   that works out and serially, in link order, otherwise.  */
+
+static bfd_boolean
+elf_link_output_deferred (struct elf_final_link_info *finfo)
+{
+  bfd_boolean done = FALSE;
+
+#ifdef ELF_PARALLEL_LINK
+  if (finfo->deferred_count > 1)
+    done = elf_link_fork_deferred (finfo);
+#endif
+
+  if (! done
+      && ! elf_link_input_deferred (finfo, 0, finfo->deferred_count))
+    return FALSE;
+
+  finfo->deferred_count = 0;
   return TRUE;
 }
 
-/* Generate a reloc when linking an ELF file.  This is a reloc
-   requested by the linker, and does not come from any input file.  This
-   is used to build constructor and destructor tables when linking
-   with -Ur.  */
+/* Link an input file into the linker output file.  This function
+   handles all the sections and relocations of the input file at once.
+   This is so that we only have to read the local symbols once, and
+   don't have to keep them in memory, unless a parallel link defers
+   some of the sections.  */
 
 static bfd_boolean
-elf_reloc_link_order (bfd *output_bfd,
-		      struct bfd_link_info *info,
-		      asection *output_section,
-		      struct bfd_link_order *link_order)
+elf_link_input_bfd (struct elf_final_link_info *finfo, bfd *input_bfd)
 {
-  reloc_howto_type *howto;
-  long indx;
-  bfd_vma offset;
-  bfd_vma addend;
-  struct elf_link_hash_entry **rel_hash_ptr;
-  Elf_Internal_Shdr *rel_hdr;
-  const struct elf_backend_data *bed = get_elf_backend_data (output_bfd);
-  Elf_Internal_Rela irel[MAX_INT_RELS_PER_EXT_REL];
-  bfd_byte *erel;
-  unsigned int i;
+  bfd *output_bfd;
+  Elf_Internal_Shdr *symtab_hdr;
+  size_t locsymcount;
+  size_t extsymoff;
+  Elf_Internal_Sym *isymbuf;
+  Elf_Internal_Sym *isym;
+  Elf_Internal_Sym *isymend;
+  long *pindex;
+  asection **ppsection;
+  asection **sections;
+  asection *o;
+  const struct elf_backend_data *bed;
+  struct elf_deferred_locals *locals;
 
-  howto = bfd_reloc_type_lookup (output_bfd, link_order->u.reloc.p->reloc);
-  if (howto == NULL)
-    {
-      bfd_set_error (bfd_error_bad_value);
-      return FALSE;
-    }
+  output_bfd = finfo->output_bfd;
+  bed = get_elf_backend_data (output_bfd);
 
-  addend = link_order->u.reloc.p->addend;
+  /* If this is a dynamic object, we don't want to do anything here:
+     we don't want the local symbols, and we don't want the section
+     contents.  */
+  if ((input_bfd->flags & DYNAMIC) != 0)
+    return TRUE;
 
-  /* Figure out the symbol index.  */
-  rel_hash_ptr = (elf_section_data (output_section)->rel_hashes
-		  + elf_section_data (output_section)->rel_count
-		  + elf_section_data (output_section)->rel_count2);
-  if (link_order->type == bfd_section_reloc_link_order)
+  symtab_hdr = &elf_tdata (input_bfd)->symtab_hdr;
+  if (elf_bad_symtab (input_bfd))
     {
-      indx = link_order->u.reloc.p->u.section->target_index;
-      BFD_ASSERT (indx != 0);
-      *rel_hash_ptr = NULL;
+      locsymcount = symtab_hdr->sh_size / bed->s->sizeof_sym;
+      extsymoff = 0;
     }
   else
     {
-      struct elf_link_hash_entry *h;
-
-      /* Treat a reloc against a defined symbol as though it were
-	 actually against the section.  */
-      h = ((struct elf_link_hash_entry *)
-	   bfd_wrapped_link_hash_lookup (output_bfd, info,
-					 link_order->u.reloc.p->u.name,
-					 FALSE, FALSE, TRUE));
-      if (h != NULL
-	  && (h->root.type == bfd_link_hash_defined
-	      || h->root.type == bfd_link_hash_defweak))
-	{
-	  asection *section;
+      locsymcount = symtab_hdr->sh_info;
+      extsymoff = symtab_hdr->sh_info;
+    }
 
-	  section = h->root.u.def.section;
+  /* Read the local symbols.  */
+  isymbuf = (Elf_Internal_Sym *) symtab_hdr->contents;
+  if (isymbuf == NULL && locsymcount != 0)
+    {
+      isymbuf = bfd_elf_get_elf_syms (input_bfd, symtab_hdr, locsymcount, 0,
+				      finfo->internal_syms,
+				      finfo->external_syms,
+				      finfo->locsym_shndx);
+      if (isymbuf == NULL)
+	return FALSE;
+    }
+  /* evaluate_complex_relocation_symbols looks for symbols in
+     finfo->internal_syms.  */
+  else if (isymbuf != NULL && locsymcount != 0)
+    {
+      bfd_elf_get_elf_syms (input_bfd, symtab_hdr, locsymcount, 0,
+			    finfo->internal_syms,
+			    finfo->external_syms,
+			    finfo->locsym_shndx);
+    }
+
+  /* Find local symbol sections and adjust values of symbols in
+     SEC_MERGE sections.  Write out those local symbols we know are
+     going into the output file.  */
+  isymend = isymbuf + locsymcount;
+  for (isym = isymbuf, pindex = finfo->indices, ppsection = finfo->sections;
+       isym < isymend;
+       isym++, pindex++, ppsection++)
+    {
+      asection *isec;
+      const char *name;
+      Elf_Internal_Sym osym;
+
+      *pindex = -1;
+
+      if (elf_bad_symtab (input_bfd))
+	{
+	  if (ELF_ST_BIND (isym->st_info) != STB_LOCAL)
+	    {
+	      *ppsection = NULL;
+	      continue;
+	    }
+	}
+
+      if (isym->st_shndx == SHN_UNDEF)
+	isec = bfd_und_section_ptr;
+      else if (isym->st_shndx < SHN_LORESERVE
+	       || isym->st_shndx > SHN_HIRESERVE)
+	{
+	  isec = bfd_section_from_elf_index (input_bfd, isym->st_shndx);
+	  /* Symbols in a section removed by identical code folding
+	     refer to the same offset in the section it was folded
+	     into.  */
+	  if (isec && isec->sec_info_type == ELF_INFO_TYPE_FOLDED)
+	    isec = isec->kept_section;
+	  if (isec
+	      && isec->sec_info_type == ELF_INFO_TYPE_MERGE
+	      && ELF_ST_TYPE (isym->st_info) != STT_SECTION)
+	    isym->st_value =
+	      _bfd_merged_section_offset (output_bfd, &isec,
+					  elf_section_data (isec)->sec_info,
+					  isym->st_value);
+	}
+      else if (isym->st_shndx == SHN_ABS)
+	isec = bfd_abs_section_ptr;
+      else if (isym->st_shndx == SHN_COMMON)
+	isec = bfd_com_section_ptr;
+      else
+	{
+	  /* Don't attempt to output symbols with st_shnx in the
+	     reserved range other than SHN_ABS and SHN_COMMON.  */
+	  *ppsection = NULL;
+	  continue;
+	}
+
+      *ppsection = isec;
+
+      /* Don't output the first, undefined, symbol.  */
+      if (ppsection == finfo->sections)
+	continue;
+
+      if (ELF_ST_TYPE (isym->st_info) == STT_SECTION)
+	{
+	  /* We never output section symbols.  Instead, we use the
+	     section symbol of the corresponding section in the output
+	     file.  */
+	  continue;
+	}
+
+      /* If we are stripping all symbols, we don't want to output this
+	 one.  */
+      if (finfo->info->strip == strip_all)
+	continue;
+
+      /* If we are discarding all local symbols, we don't want to
+	 output this one.  If we are generating a relocatable output
+	 file, then some of the local symbols may be required by
+	 relocs; we output them below as we discover that they are
+	 needed.  */
+      if (finfo->info->discard == discard_all)
+	continue;
+
+      /* If this symbol is defined in a section which we are
+	 discarding, we don't need to keep it.  */
+      if (isym->st_shndx != SHN_UNDEF
+	  && (isym->st_shndx < SHN_LORESERVE || isym->st_shndx > SHN_HIRESERVE)
+	  && (isec == NULL
+	      || bfd_section_removed_from_list (output_bfd,
+						isec->output_section)))
+	continue;
+
+      /* Get the name of the symbol.  */
+      name = bfd_elf_string_from_elf_section (input_bfd, symtab_hdr->sh_link,
+					      isym->st_name);
+      if (name == NULL)
+	return FALSE;
+
+      /* See if we are discarding symbols with this name.  */
+      if ((finfo->info->strip == strip_some
+	   && (bfd_hash_lookup (finfo->info->keep_hash, name, FALSE, FALSE)
+	       == NULL))
+	  || (((finfo->info->discard == discard_sec_merge
+		&& (isec->flags & SEC_MERGE) && ! finfo->info->relocatable)
+	       || finfo->info->discard == discard_l)
+	      && bfd_is_local_label_name (input_bfd, name)))
+	continue;
+
+      /* If we get here, we are going to output this symbol.  */
+
+      osym = *isym;
+
+      /* Adjust the section index for the output file.  */
+      osym.st_shndx = _bfd_elf_section_from_bfd_section (output_bfd,
+							 isec->output_section);
+      if (osym.st_shndx == SHN_BAD)
+	return FALSE;
+
+      *pindex = bfd_get_symcount (output_bfd);
+
+      /* ELF symbols in relocatable files are section relative, but
+	 in executable files they are virtual addresses.  Note that
+	 this code assumes that all ELF sections have an associated
+	 BFD section with a reasonable value for output_offset; below
+	 we assume that they also have a reasonable value for
+	 output_section.  Any special sections must be set up to meet
+	 these requirements.  */
+      osym.st_value += isec->output_offset;
+      if (! finfo->info->relocatable)
+	{
+	  osym.st_value += isec->output_section->vma;
+	  if (ELF_ST_TYPE (osym.st_info) == STT_TLS)
+	    {
+	      /* STT_TLS symbols are relative to PT_TLS segment base.  */
+	      BFD_ASSERT (elf_hash_table (finfo->info)->tls_sec != NULL);
+	      osym.st_value -= elf_hash_table (finfo->info)->tls_sec->vma;
+	    }
+	}
+
+      if (! elf_link_output_sym (finfo, name, &osym, isec, NULL))
+	return FALSE;
+    }
+
+  if (! evaluate_complex_relocation_symbols (input_bfd, finfo, locsymcount))
+    return FALSE;
+
+  /* Relocate the contents of each section.  */
+  locals = NULL;
+  sections = finfo->sections;
+  for (o = input_bfd->sections; o != NULL; o = o->next)
+    {
+      if (! o->linker_mark)
+	{
+	  /* This section was omitted from the link.  */
+	  continue;
+	}
+
+      if ((o->flags & SEC_HAS_CONTENTS) == 0
+	  || (o->size == 0 && (o->flags & SEC_RELOC) == 0))
+	continue;
+
+      if ((o->flags & SEC_LINKER_CREATED) != 0)
+	{
+	  /* Section was created by _bfd_elf_link_create_dynamic_sections
+	     or somesuch.  */
+	  continue;
+	}
+
+      /* In a parallel link, leave ordinary sections to worker
+	 processes.  From the first one on, this file's local symbols
+	 are a saved copy.  */
+      if (finfo->parallel && o->sec_info_type == ELF_INFO_TYPE_NONE)
+	{
+	  if (locals == NULL)
+	    {
+	      locals = elf_link_save_locals (finfo, isymbuf, locsymcount,
+					     extsymoff);
+	      if (locals == NULL)
+		return FALSE;
+	      isymbuf = locals->isymbuf;
+	      sections = locals->sections;
+	    }
+	  if (! elf_link_defer_section (finfo, o, locals))
+	    return FALSE;
+	  continue;
+	}
+
+      /* Checking O's relocs may move symbols to kept sections, which
+	 the sections deferred so far must not see.  */
+      if (finfo->deferred_count != 0
+	  && (o->flags & SEC_RELOC) != 0
+	  && ! elf_section_ignore_discarded_relocs (o)
+	  && ! elf_link_output_deferred (finfo))
+	return FALSE;
+
+      if (! elf_link_input_section (finfo, input_bfd, o, isymbuf, sections,
+				    locsymcount, extsymoff))
+	return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Generate a reloc when linking an ELF file.  This is a reloc
+   requested by the linker, and does not come from any input file.  This
+   is used to build constructor and destructor tables when linking
+   with -Ur.  */
+
+static bfd_boolean
+elf_reloc_link_order (bfd *output_bfd,
+		      struct bfd_link_info *info,
+		      asection *output_section,
+		      struct bfd_link_order *link_order)
+{
+  reloc_howto_type *howto;
+  long indx;
+  bfd_vma offset;
+  bfd_vma addend;
+  struct elf_link_hash_entry **rel_hash_ptr;
+  Elf_Internal_Shdr *rel_hdr;
+  const struct elf_backend_data *bed = get_elf_backend_data (output_bfd);
+  Elf_Internal_Rela irel[MAX_INT_RELS_PER_EXT_REL];
+  bfd_byte *erel;
+  unsigned int i;
+
+  howto = bfd_reloc_type_lookup (output_bfd, link_order->u.reloc.p->reloc);
+  if (howto == NULL)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return FALSE;
+    }
+
+  addend = link_order->u.reloc.p->addend;
+
+  /* Figure out the symbol index.  */
+  rel_hash_ptr = (elf_section_data (output_section)->rel_hashes
+		  + elf_section_data (output_section)->rel_count
+		  + elf_section_data (output_section)->rel_count2);
+  if (link_order->type == bfd_section_reloc_link_order)
+    {
+      indx = link_order->u.reloc.p->u.section->target_index;
+      BFD_ASSERT (indx != 0);
+      *rel_hash_ptr = NULL;
+    }
+  else
+    {
+      struct elf_link_hash_entry *h;
+
+      /* Treat a reloc against a defined symbol as though it were
+	 actually against the section.  */
+      h = ((struct elf_link_hash_entry *)
+	   bfd_wrapped_link_hash_lookup (output_bfd, info,
+					 link_order->u.reloc.p->u.name,
+					 FALSE, FALSE, TRUE));
+      if (h != NULL
+	  && (h->root.type == bfd_link_hash_defined
+	      || h->root.type == bfd_link_hash_defweak))
+	{
+	  asection *section;
+
+	  section = h->root.u.def.section;
 	  indx = section->output_section->target_index;
 	  *rel_hash_ptr = NULL;
 	  /* It seems that we ought to add the symbol value to the
@@ -10053,6 +10364,12 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
   finfo.symshndxbuf = NULL;
   finfo.symbuf_count = 0;
   finfo.shndxbuf_size = 0;
+  finfo.parallel = FALSE;
+  finfo.deferred = NULL;
+  finfo.deferred_count = 0;
+  finfo.deferred_alloc = 0;
+  finfo.saved_locals = NULL;
+  finfo.retargeted = FALSE;
 
   /* The object attributes have been merged.  Remove the input
      sections from the link, and set the contents of the output
@@ -10485,6 +10802,20 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
      we could write the relocs out and then read them again; I don't
      know how bad the memory loss will be.  */
 
+#ifdef ELF_PARALLEL_LINK
+  /* With more than one job, ordinary input sections are relocated and
+     written out by worker processes once all the input files have
+     been seen; each covers disjoint parts of the output file, so the
+     result is the same as a serial link.  Only the local symbols and
+     the sections with special handling are done as we go.  */
+  if (info->jobs > 1
+      && ! emit_relocs
+      && ! dynamic
+      && bed->elf_backend_can_relocate_in_parallel != NULL
+      && (*bed->elf_backend_can_relocate_in_parallel) (abfd, info))
+    finfo.parallel = TRUE;
+#endif
+
   for (sub = info->input_bfds; sub != NULL; sub = sub->link_next)
     sub->output_has_begun = FALSE;
   for (o = abfd->sections; o != NULL; o = o->next)
@@ -10517,6 +10848,10 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
 	}
     }
 
+  if (finfo.deferred_count != 0
+      && ! elf_link_output_deferred (&finfo))
+    goto error_return;
+
   /* Free symbol buffer if needed.  */
   if (!info->reduce_memory_overheads)
     {
@@ -11023,6 +11358,14 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
     free (finfo.symbuf);
   if (finfo.symshndxbuf != NULL)
     free (finfo.symshndxbuf);
+  if (finfo.deferred != NULL)
+    free (finfo.deferred);
+  while (finfo.saved_locals != NULL)
+    {
+      struct elf_deferred_locals *next = finfo.saved_locals->next;
+      free (finfo.saved_locals);
+      finfo.saved_locals = next;
+    }
   for (o = abfd->sections; o != NULL; o = o->next)
     {
       if ((o->flags & SEC_RELOC) != 0
@@ -11067,6 +11410,14 @@ bfd_elf_final_link (bfd *abfd, struct bfd_link_info *info)
     free (finfo.symbuf);
   if (finfo.symshndxbuf != NULL)
     free (finfo.symshndxbuf);
+  if (finfo.deferred != NULL)
+    free (finfo.deferred);
+  while (finfo.saved_locals != NULL)
+    {
+      struct elf_deferred_locals *next = finfo.saved_locals->next;
+      free (finfo.saved_locals);
+      finfo.saved_locals = next;
+    }
   for (o = abfd->sections; o != NULL; o = o->next)
     {
       if ((o->flags & SEC_RELOC) != 0
@@ -11602,6 +11953,686 @@ bfd_elf_gc_sections (bfd *abfd, struct bfd_link_info *info)
   return elf_gc_sweep (abfd, info);
 }
 
+/* Identical code folding.  */
+
+/* A relocation in a candidate for folding, with the symbol it refers
+   to resolved.  */
+
+struct elf_icf_reloc
+{
+  bfd_vma offset;
+  bfd_vma addend;
+  bfd_vma type;
+
+  /* The section the symbol is defined in and its value there.  SEC is
+     NULL for an undefined or common global symbol, which is then H.  */
+  asection *sec;
+  bfd_vma value;
+  struct elf_link_hash_entry *h;
+
+  /* The candidate for folding SEC is, if any.  */
+  struct elf_icf_section *icf;
+};
+
+/* A code section that may be folded into an identical one.  */
+
+struct elf_icf_section
+{
+  asection *sec;
+
+  /* The position of SEC among the candidates, in input order.  */
+  size_t index;
+
+  /* The contents of SEC, a hash of them, and its relocations.  */
+  bfd_byte *contents;
+  hashval_t hash;
+  struct elf_icf_reloc *relocs;
+  size_t reloc_count;
+
+  /* Candidates of the same class are identical as far as is known.  */
+  size_t class;
+
+  /* TRUE if SEC must stay distinct, because its relocations could not
+     be resolved.  */
+  bfd_boolean unique;
+
+  /* TRUE if the address of SEC may be compared, so that it can not be
+     folded into another section.  Only set for --icf=safe.  */
+  bfd_boolean address_taken;
+};
+
+static hashval_t
+elf_icf_hash (const void *entry)
+{
+  const struct elf_icf_section *icf = entry;
+
+  return htab_hash_pointer (icf->sec);
+}
+
+static int
+elf_icf_eq (const void *entry, const void *sec)
+{
+  const struct elf_icf_section *icf = entry;
+
+  return icf->sec == sec;
+}
+
+/* Return the candidate for folding SEC is, or NULL.  */
+
+static struct elf_icf_section *
+elf_icf_lookup (htab_t table, asection *sec)
+{
+  return htab_find_with_hash (table, sec, htab_hash_pointer (sec));
+}
+
+/* Return TRUE if SEC may be folded into an identical section.  */
+
+static bfd_boolean
+elf_icf_candidate_p (asection *sec)
+{
+  return ((sec->flags & (SEC_ALLOC | SEC_CODE | SEC_HAS_CONTENTS
+			 | SEC_EXCLUDE | SEC_KEEP | SEC_LINKER_CREATED))
+	  == (SEC_ALLOC | SEC_CODE | SEC_HAS_CONTENTS)
+	  && sec->sec_info_type == ELF_INFO_TYPE_NONE
+	  && sec->size != 0
+	  && sec->output_section != NULL
+	  && !bfd_is_abs_section (sec->output_section)
+	  && (strcmp (sec->name, ".text") == 0
+	      || CONST_STRNEQ (sec->name, ".text.")));
+}
+
+/* Resolve the symbol of relocation REL in COOKIE->abfd into R.  Return
+   FALSE if it is not a symbol folding can reason about.  */
+
+static bfd_boolean
+elf_icf_reloc_target (struct elf_reloc_cookie *cookie,
+		      const Elf_Internal_Rela *rel,
+		      struct elf_icf_reloc *r)
+{
+  unsigned long r_symndx = rel->r_info >> cookie->r_sym_shift;
+
+  r->sec = NULL;
+  r->value = 0;
+  r->h = NULL;
+  r->icf = NULL;
+
+  if (r_symndx == STN_UNDEF)
+    return TRUE;
+
+  if (r_symndx >= cookie->locsymcount
+      || ELF_ST_BIND (cookie->locsyms[r_symndx].st_info) != STB_LOCAL)
+    {
+      struct elf_link_hash_entry *h;
+
+      h = cookie->sym_hashes[r_symndx - cookie->extsymoff];
+      if (h == NULL)
+	return FALSE;
+      while (h->root.type == bfd_link_hash_indirect
+	     || h->root.type == bfd_link_hash_warning)
+	h = (struct elf_link_hash_entry *) h->root.u.i.link;
+
+      if (h->root.type == bfd_link_hash_defined
+	  || h->root.type == bfd_link_hash_defweak)
+	{
+	  r->sec = h->root.u.def.section;
+	  r->value = h->root.u.def.value;
+	}
+      else
+	r->h = h;
+    }
+  else
+    {
+      Elf_Internal_Sym *isym = &cookie->locsyms[r_symndx];
+
+      if (isym->st_shndx == SHN_ABS)
+	r->sec = bfd_abs_section_ptr;
+      else if (isym->st_shndx != SHN_UNDEF
+	       && (isym->st_shndx < SHN_LORESERVE
+		   || isym->st_shndx > SHN_HIRESERVE))
+	r->sec = bfd_section_from_elf_index (cookie->abfd, isym->st_shndx);
+      if (r->sec == NULL)
+	return FALSE;
+      r->value = isym->st_value;
+    }
+  return TRUE;
+}
+
+/* Compare what relocations R1 and R2 refer to.  Candidates for folding
+   compare by class if BY_CLASS, and as equal otherwise.  */
+
+static int
+elf_icf_target_cmp (const struct elf_icf_reloc *r1,
+		    const struct elf_icf_reloc *r2,
+		    bfd_boolean by_class)
+{
+  if (r1->icf != NULL || r2->icf != NULL)
+    {
+      if (r1->icf == NULL || r2->icf == NULL)
+	return r1->icf == NULL ? -1 : 1;
+      if (by_class && r1->icf->class != r2->icf->class)
+	return r1->icf->class < r2->icf->class ? -1 : 1;
+    }
+  else if (r1->sec != r2->sec)
+    {
+      if (r1->sec == NULL || r2->sec == NULL)
+	return r1->sec == NULL ? -1 : 1;
+      return r1->sec->id < r2->sec->id ? -1 : 1;
+    }
+  else if (r1->h != r2->h)
+    return strcmp (r1->h->root.root.string, r2->h->root.root.string);
+
+  if (r1->value != r2->value)
+    return r1->value < r2->value ? -1 : 1;
+  return 0;
+}
+
+/* Compare candidates ICF1 and ICF2.  If BY_CLASS, they are already
+   known to agree in everything but the classes of the candidates their
+   relocations refer to, so compare only those.  */
+
+static int
+elf_icf_compare (const struct elf_icf_section *icf1,
+		 const struct elf_icf_section *icf2,
+		 bfd_boolean by_class)
+{
+  const asection *s1 = icf1->sec;
+  const asection *s2 = icf2->sec;
+  size_t i;
+  int cmp;
+
+  if (icf1 == icf2)
+    return 0;
+  if (icf1->unique || icf2->unique)
+    return icf1->index < icf2->index ? -1 : 1;
+
+  if (!by_class)
+    {
+      if (icf1->hash != icf2->hash)
+	return icf1->hash < icf2->hash ? -1 : 1;
+      if (s1->output_section != s2->output_section)
+	return s1->output_section->id < s2->output_section->id ? -1 : 1;
+      if (s1->size != s2->size)
+	return s1->size < s2->size ? -1 : 1;
+      if (s1->alignment_power != s2->alignment_power)
+	return s1->alignment_power < s2->alignment_power ? -1 : 1;
+      if (s1->flags != s2->flags)
+	return s1->flags < s2->flags ? -1 : 1;
+      if (icf1->reloc_count != icf2->reloc_count)
+	return icf1->reloc_count < icf2->reloc_count ? -1 : 1;
+      cmp = memcmp (icf1->contents, icf2->contents, s1->size);
+      if (cmp != 0)
+	return cmp;
+      for (i = 0; i < icf1->reloc_count; i++)
+	{
+	  const struct elf_icf_reloc *r1 = &icf1->relocs[i];
+	  const struct elf_icf_reloc *r2 = &icf2->relocs[i];
+
+	  if (r1->offset != r2->offset)
+	    return r1->offset < r2->offset ? -1 : 1;
+	  if (r1->type != r2->type)
+	    return r1->type < r2->type ? -1 : 1;
+	  if (r1->addend != r2->addend)
+	    return r1->addend < r2->addend ? -1 : 1;
+	}
+    }
+
+  for (i = 0; i < icf1->reloc_count; i++)
+    {
+      cmp = elf_icf_target_cmp (&icf1->relocs[i], &icf2->relocs[i],
+				by_class);
+      if (cmp != 0)
+	return cmp;
+    }
+  return 0;
+}
+
+/* qsort comparison functions for the initial partition of the
+   candidates into classes and for splitting a class.  Ties go to input
+   order, so that the first member of a class is the first in input.  */
+
+static int
+elf_icf_section_cmp (const void *p1, const void *p2)
+{
+  const struct elf_icf_section *icf1 = *(const struct elf_icf_section **) p1;
+  const struct elf_icf_section *icf2 = *(const struct elf_icf_section **) p2;
+  int cmp;
+
+  cmp = elf_icf_compare (icf1, icf2, FALSE);
+  if (cmp != 0)
+    return cmp;
+  return icf1->index < icf2->index ? -1 : icf1->index > icf2->index;
+}
+
+static int
+elf_icf_refine_cmp (const void *p1, const void *p2)
+{
+  const struct elf_icf_section *icf1 = *(const struct elf_icf_section **) p1;
+  const struct elf_icf_section *icf2 = *(const struct elf_icf_section **) p2;
+  int cmp;
+
+  cmp = elf_icf_compare (icf1, icf2, TRUE);
+  if (cmp != 0)
+    return cmp;
+  return icf1->index < icf2->index ? -1 : icf1->index > icf2->index;
+}
+
+/* Number the classes of the COUNT candidates in ORDER, which is sorted
+   so that the members of a class are adjacent.  A class is named by the
+   position of its first member.  Members of a class that differ under
+   elf_icf_compare with BY_CLASS start new classes; CLASSES is scratch
+   space so that the comparisons all see the old classes.  Return the
+   number of classes.  */
+
+static size_t
+elf_icf_number_classes (struct elf_icf_section **order, size_t count,
+			size_t *classes, bfd_boolean by_class)
+{
+  size_t i, start = 0, nclasses = 0;
+
+  for (i = 0; i < count; i++)
+    {
+      if (i == 0
+	  || (by_class && order[i]->class != order[i - 1]->class)
+	  || elf_icf_compare (order[i - 1], order[i], by_class) != 0)
+	{
+	  start = i;
+	  nclasses++;
+	}
+      classes[i] = start;
+    }
+  for (i = 0; i < count; i++)
+    order[i]->class = classes[i];
+  return nclasses;
+}
+
+/* Set up COOKIE to look up the symbols of relocations in ABFD.  */
+
+static bfd_boolean
+elf_icf_init_cookie (bfd *abfd, struct elf_reloc_cookie *cookie)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (abfd);
+  Elf_Internal_Shdr *symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+
+  cookie->abfd = abfd;
+  cookie->sym_hashes = elf_sym_hashes (abfd);
+  cookie->bad_symtab = elf_bad_symtab (abfd);
+  if (cookie->bad_symtab)
+    {
+      cookie->locsymcount = symtab_hdr->sh_size / bed->s->sizeof_sym;
+      cookie->extsymoff = 0;
+    }
+  else
+    {
+      cookie->locsymcount = symtab_hdr->sh_info;
+      cookie->extsymoff = symtab_hdr->sh_info;
+    }
+
+  if (bed->s->arch_size == 32)
+    cookie->r_sym_shift = 8;
+  else
+    cookie->r_sym_shift = 32;
+
+  cookie->locsyms = (Elf_Internal_Sym *) symtab_hdr->contents;
+  if (cookie->locsyms == NULL && cookie->locsymcount != 0)
+    {
+      cookie->locsyms = bfd_elf_get_elf_syms (abfd, symtab_hdr,
+					      cookie->locsymcount, 0,
+					      NULL, NULL, NULL);
+      if (cookie->locsyms == NULL)
+	return FALSE;
+    }
+  return TRUE;
+}
+
+/* Read the contents and relocations of candidate ICF, resolving the
+   relocations with COOKIE and TABLE.  */
+
+static bfd_boolean
+elf_icf_read_section (struct elf_icf_section *icf,
+		      struct elf_reloc_cookie *cookie,
+		      htab_t table, struct bfd_link_info *info)
+{
+  asection *sec = icf->sec;
+  const struct elf_backend_data *bed = get_elf_backend_data (sec->owner);
+  Elf_Internal_Rela *relocs, *rel;
+  bfd_vma r_type_mask;
+  size_t i;
+
+  if (elf_section_data (sec)->this_hdr.contents != NULL)
+    icf->contents = elf_section_data (sec)->this_hdr.contents;
+  else if (!bfd_malloc_and_get_section (sec->owner, sec, &icf->contents))
+    return FALSE;
+  icf->hash = iterative_hash (icf->contents, sec->size, 0);
+
+  if ((sec->flags & SEC_RELOC) == 0 || sec->reloc_count == 0)
+    return TRUE;
+
+  relocs = _bfd_elf_link_read_relocs (sec->owner, sec, NULL, NULL,
+				      info->keep_memory);
+  if (relocs == NULL)
+    return FALSE;
+
+  icf->reloc_count = sec->reloc_count * bed->s->int_rels_per_ext_rel;
+  icf->relocs = bfd_malloc (icf->reloc_count * sizeof (*icf->relocs));
+  if (icf->relocs == NULL)
+    {
+      if (elf_section_data (sec)->relocs != relocs)
+	free (relocs);
+      return FALSE;
+    }
+
+  r_type_mask = cookie->r_sym_shift == 8 ? 0xff : 0xffffffff;
+  for (i = 0, rel = relocs; i < icf->reloc_count; i++, rel++)
+    {
+      struct elf_icf_reloc *r = &icf->relocs[i];
+
+      r->offset = rel->r_offset;
+      r->addend = rel->r_addend;
+      r->type = rel->r_info & r_type_mask;
+      if (!elf_icf_reloc_target (cookie, rel, r))
+	icf->unique = TRUE;
+      else if (r->sec != NULL)
+	r->icf = elf_icf_lookup (table, r->sec);
+    }
+
+  if (elf_section_data (sec)->relocs != relocs)
+    free (relocs);
+  return TRUE;
+}
+
+/* Mark the candidates that relocations in SEC take the address of,
+   rather than only branching to them.  */
+
+static bfd_boolean
+elf_icf_mark_address_taken (asection *sec, struct elf_reloc_cookie *cookie,
+			    htab_t table, struct bfd_link_info *info)
+{
+  const struct elf_backend_data *bed = get_elf_backend_data (sec->owner);
+  Elf_Internal_Rela *relocs, *rel, *relend;
+
+  relocs = _bfd_elf_link_read_relocs (sec->owner, sec, NULL, NULL,
+				      info->keep_memory);
+  if (relocs == NULL)
+    return FALSE;
+
+  relend = relocs + sec->reloc_count * bed->s->int_rels_per_ext_rel;
+  for (rel = relocs; rel < relend; rel++)
+    {
+      struct elf_icf_reloc r;
+      struct elf_icf_section *icf;
+
+      if (bed->elf_backend_branch_reloc_p != NULL
+	  && (*bed->elf_backend_branch_reloc_p) (sec->owner, rel))
+	continue;
+      if (!elf_icf_reloc_target (cookie, rel, &r) || r.sec == NULL)
+	continue;
+      icf = elf_icf_lookup (table, r.sec);
+      if (icf != NULL)
+	icf->address_taken = TRUE;
+    }
+
+  if (elf_section_data (sec)->relocs != relocs)
+    free (relocs);
+  return TRUE;
+}
+
+/* Point global symbols defined in folded sections at the sections they
+   were folded into.  */
+
+static bfd_boolean
+elf_icf_redirect_symbol (struct elf_link_hash_entry *h,
+			 void *data ATTRIBUTE_UNUSED)
+{
+  asection *sec;
+
+  if (h->root.type == bfd_link_hash_warning)
+    h = (struct elf_link_hash_entry *) h->root.u.i.link;
+
+  if (h->root.type != bfd_link_hash_defined
+      && h->root.type != bfd_link_hash_defweak)
+    return TRUE;
+
+  sec = h->root.u.def.section;
+  if (sec->sec_info_type == ELF_INFO_TYPE_FOLDED)
+    h->root.u.def.section = sec->kept_section;
+  return TRUE;
+}
+
+/* Fold identical code sections.  Candidates are first grouped by their
+   contents and relocations, with relocations against other candidates
+   taken to match.  Classes are then split until the candidates that
+   the relocations of each member refer to are in the same classes, so
+   that mutually recursive sections fold too.  All but one member of a
+   class are excluded from the link, and their symbols redirected to
+   the one that is kept.  */
+
+bfd_boolean
+bfd_elf_fold_identical_sections (bfd *abfd, struct bfd_link_info *info)
+{
+  gc_sweep_hook_fn gc_sweep_hook;
+  struct elf_icf_section *icfs = NULL, **order = NULL;
+  size_t count = 0, alloc = 0, nclasses, last, i, j, k;
+  size_t *classes = NULL;
+  htab_t table = NULL;
+  bfd_boolean ret = FALSE;
+  bfd *sub;
+
+  if (info->icf == icf_none)
+    return TRUE;
+
+  /* The output need not be ELF (--oformat binary), in which case neither
+     the hash table nor the backend data of ABFD is ours to look at.  */
+  if (info->relocatable
+      || info->emitrelocations
+      || info->shared
+      || bfd_get_flavour (abfd) != bfd_target_elf_flavour
+      || !is_elf_hash_table (info->hash)
+      || elf_hash_table (info)->dynamic_sections_created)
+    {
+      (*_bfd_error_handler)(_("Warning: --icf option ignored"));
+      return TRUE;
+    }
+
+  gc_sweep_hook = get_elf_backend_data (abfd)->gc_sweep_hook;
+
+  for (sub = info->input_bfds; sub != NULL; sub = sub->link_next)
+    {
+      asection *o;
+
+      if (bfd_get_flavour (sub) != bfd_target_elf_flavour
+	  || (sub->flags & DYNAMIC) != 0)
+	continue;
+
+      for (o = sub->sections; o != NULL; o = o->next)
+	{
+	  if (!elf_icf_candidate_p (o))
+	    continue;
+	  if (count == alloc)
+	    {
+	      struct elf_icf_section *n;
+
+	      alloc = alloc ? alloc * 2 : 64;
+	      n = bfd_realloc (icfs, alloc * sizeof (*icfs));
+	      if (n == NULL)
+		goto out;
+	      icfs = n;
+	    }
+	  memset (&icfs[count], 0, sizeof (*icfs));
+	  icfs[count].sec = o;
+	  icfs[count].index = count;
+	  count++;
+	}
+    }
+
+  if (count < 2)
+    {
+      ret = TRUE;
+      goto out;
+    }
+
+  table = htab_try_create (count * 2, elf_icf_hash, elf_icf_eq, NULL);
+  order = bfd_malloc (count * sizeof (*order));
+  classes = bfd_malloc (count * sizeof (*classes));
+  if (table == NULL || order == NULL || classes == NULL)
+    goto out;
+  for (i = 0; i < count; i++)
+    {
+      void **slot;
+
+      slot = htab_find_slot_with_hash (table, icfs[i].sec,
+				       htab_hash_pointer (icfs[i].sec),
+				       INSERT);
+      if (slot == NULL)
+	goto out;
+      *slot = &icfs[i];
+      order[i] = &icfs[i];
+    }
+
+  /* Read the candidates, and for --icf=safe find the ones whose address
+     is taken.  */
+  for (sub = info->input_bfds; sub != NULL; sub = sub->link_next)
+    {
+      struct elf_reloc_cookie cookie;
+      asection *o;
+      bfd_boolean ok = TRUE;
+
+      if (bfd_get_flavour (sub) != bfd_target_elf_flavour
+	  || (sub->flags & DYNAMIC) != 0)
+	continue;
+
+      if (!elf_icf_init_cookie (sub, &cookie))
+	goto out;
+
+      for (o = sub->sections; o != NULL && ok; o = o->next)
+	{
+	  struct elf_icf_section *icf = elf_icf_lookup (table, o);
+
+	  if (icf != NULL)
+	    ok = elf_icf_read_section (icf, &cookie, table, info);
+	  /* Unwind and exception tables refer to every function they
+	     describe without taking its address.  */
+	  if (ok
+	      && info->icf == icf_safe
+	      && (o->flags & (SEC_ALLOC | SEC_RELOC | SEC_EXCLUDE))
+		 == (SEC_ALLOC | SEC_RELOC)
+	      && o->reloc_count != 0
+	      && strcmp (o->name, ".eh_frame") != 0
+	      && !CONST_STRNEQ (o->name, ".gcc_except_table"))
+	    ok = elf_icf_mark_address_taken (o, &cookie, table, info);
+	}
+
+      if (cookie.locsyms != NULL
+	  && elf_tdata (sub)->symtab_hdr.contents
+	     != (unsigned char *) cookie.locsyms)
+	free (cookie.locsyms);
+      if (!ok)
+	goto out;
+    }
+
+  /* Group the candidates by everything but the classes of the
+     candidates their relocations refer to, then split the groups until
+     those agree as well.  */
+  qsort (order, count, sizeof (*order), elf_icf_section_cmp);
+  nclasses = elf_icf_number_classes (order, count, classes, FALSE);
+  do
+    {
+      last = nclasses;
+      for (i = 0; i < count; i = j)
+	{
+	  for (j = i + 1; j < count && order[j]->class == order[i]->class; j++)
+	    ;
+	  if (j - i > 1)
+	    qsort (order + i, j - i, sizeof (*order), elf_icf_refine_cmp);
+	}
+      nclasses = elf_icf_number_classes (order, count, classes, TRUE);
+    }
+  while (nclasses != last);
+
+  /* Keep the first member of each class whose address is taken, or
+     failing that its first member, and fold the others into it.  */
+  for (i = 0; i < count; i = j)
+    {
+      asection *kept;
+
+      for (j = i + 1; j < count && order[j]->class == order[i]->class; j++)
+	;
+      if (j - i < 2)
+	continue;
+
+      kept = order[i]->sec;
+      for (k = i; k < j; k++)
+	if (order[k]->address_taken)
+	  {
+	    kept = order[k]->sec;
+	    break;
+	  }
+
+      for (k = i; k < j; k++)
+	{
+	  asection *o = order[k]->sec;
+
+	  if (o == kept || order[k]->address_taken)
+	    continue;
+
+	  o->flags |= SEC_EXCLUDE;
+	  o->sec_info_type = ELF_INFO_TYPE_FOLDED;
+	  o->kept_section = kept;
+	  elf_section_data (kept)->folded_into = 1;
+
+	  if (info->print_icf_sections)
+	    _bfd_error_handler
+	      (_("Folding section '%A' in file '%B' into '%A' in file '%B'"),
+	       o, o->owner, kept, kept->owner);
+
+	  if (gc_sweep_hook
+	      && (o->flags & SEC_RELOC) != 0
+	      && o->reloc_count > 0)
+	    {
+	      Elf_Internal_Rela *internal_relocs;
+	      bfd_boolean r;
+
+	      internal_relocs
+		= _bfd_elf_link_read_relocs (o->owner, o, NULL, NULL,
+					     info->keep_memory);
+	      if (internal_relocs == NULL)
+		goto out;
+
+	      r = (*gc_sweep_hook) (o->owner, info, o, internal_relocs);
+
+	      if (elf_section_data (o)->relocs != internal_relocs)
+		free (internal_relocs);
+
+	      if (!r)
+		goto out;
+	    }
+	}
+    }
+
+  elf_link_hash_traverse (elf_hash_table (info), elf_icf_redirect_symbol,
+			  NULL);
+  ret = TRUE;
+
+ out:
+  for (i = 0; i < count; i++)
+    {
+      if (icfs[i].contents != NULL
+	  && (elf_section_data (icfs[i].sec)->this_hdr.contents
+	      != icfs[i].contents))
+	free (icfs[i].contents);
+      if (icfs[i].relocs != NULL)
+	free (icfs[i].relocs);
+    }
+  if (icfs != NULL)
+    free (icfs);
+  if (order != NULL)
+    free (order);
+  if (classes != NULL)
+    free (classes);
+  if (table != NULL)
+    htab_delete (table);
+  return ret;
+}
+
 /* Called from check_relocs to record the existence of a VTINHERIT reloc.  */
 
 bfd_boolean
@@ -11895,7 +12926,9 @@ bfd_elf_reloc_symbol_deleted_p (bfd_vma offset, void *cookie)
 	  if (isym->st_shndx < SHN_LORESERVE || isym->st_shndx > SHN_HIRESERVE)
 	    {
 	      isec = bfd_section_from_elf_index (rcookie->abfd, isym->st_shndx);
-	      if (isec != NULL && elf_discarded_section (isec))
+	      if (isec != NULL
+		  && (elf_discarded_section (isec)
+		      || isec->sec_info_type == ELF_INFO_TYPE_FOLDED))
 		return TRUE;
 	    }
 	}
@@ -36,6 +36,7 @@
 #include "elf-bfd.h"
 #include "elfxx-mips.h"
 #include "elf/mips.h"
+#include "elf/dwarf2.h"
 #include "elf-vxworks.h"
 
 /* Get the ECOFF swapping routines.  */
@@ -6754,6 +6755,1478 @@ _bfd_mips_elf_check_relocs (bfd *abfd, struct bfd_link_info *info,
   return TRUE;
 }
 
+/* Rigel relaxation.
+
+   The o32 objects this tree produces hold Rigel code; gas does not record
+   E_MIPS_ARCH_RIGEL32 in the ELF header, so there is nothing better to key
+   on than the ABI.  Rigel builds every global address with an
+   "mvui rX,%hi(sym)" (R_MIPS_HI16) followed by one or more instructions that
+   add %lo(sym) (R_MIPS_LO16) to rX.  When the final address fits in a signed
+   16-bit immediate the high half is zero, so the LO16 instructions can use
+   $zero as their base instead, and the mvui can go once nothing else reads
+   rX.  Far jumps and calls (lj and ljl) whose target is within reach of a
+   PC-relative branch become jmp and jal.
+
+   Deleting an instruction moves everything after it, so we also patch the
+   PC-relative branches the assembler resolved itself, the in-place addends
+   of relocations against the section symbol, the symbols defined in the
+   section and the address advances in .debug_line.  All the instructions a
+   pass deletes are taken out together.  A section whose relocations we
+   could not keep straight (for example, because its own address is taken
+   with a HI16/LO16 pair against the section symbol) is left alone, as is
+   one whose functions do not all have a type and a size: only the bytes
+   inside a function are read as instructions.
+
+   There is no $gp relaxation: $gp is an ordinary allocatable register on
+   Rigel and is not preserved across calls.  */
+
+#define RIGEL_RD(insn)		(((insn) >> 23) & 0x1f)
+#define RIGEL_RT(insn)		(((insn) >> 18) & 0x1f)
+#define RIGEL_RS(insn)		(((insn) >> 13) & 0x1f)
+#define RIGEL_RT_MASK		(0x1f << 18)
+
+#define RIGEL_IMM_MASK		0xf0030000
+#define RIGEL_ADDI		0x10000000
+#define RIGEL_ADDIU		0x10020000
+#define RIGEL_ORI		0x20010000
+#define RIGEL_LDW		0x90010000
+#define RIGEL_STW		0x90020000
+#define RIGEL_GLDW		0x90030000
+#define RIGEL_GSTW		0xa0000000
+#define RIGEL_MVUI		0x30000000	/* Mask 0xf07f0000.  */
+#define RIGEL_LJ		0x70000000	/* Mask 0xfc000000.  */
+#define RIGEL_LJL		0x74000000
+#define RIGEL_JMP		0x60020000	/* Mask 0xffff0000.  */
+#define RIGEL_JAL		0x3f810000
+#define RIGEL_JMPR		0x0000081e	/* Mask 0xff83ffff.  */
+#define RIGEL_JALR		0x0f80181f
+
+#define RIGEL_REG_RA		31
+
+/* Registers a call to a global function may clobber without reading them:
+   $at, $v0-$v1, $t0-$t5, $k0-$k1 and $gp.  */
+#define RIGEL_CALL_DEAD_REGS	0x1c03f00e
+
+/* Registers that are dead at a return: $at, $a0-$a7, $t0-$t5, $k0-$k1
+   and $gp.  */
+#define RIGEL_RETURN_DEAD_REGS	0x1c03fff2
+
+/* How far past an mvui we look for the instructions that use it.  */
+#define RIGEL_SCAN_LIMIT	32
+
+/* Alignment padding between input sections can grow as the code in front
+   of it shrinks, so only turn a far jump into a branch if it stays this
+   far inside the branch range.  */
+#define RIGEL_BRANCH_SLACK	0x1000
+
+enum rigel_insn_class
+{
+  /* Anything we do not model, including branches.  */
+  RIGEL_INSN_OTHER,
+  /* An instruction that falls through and whose registers we know.  */
+  RIGEL_INSN_PLAIN,
+  RIGEL_INSN_CALL,
+  RIGEL_INSN_RETURN
+};
+
+/* An mvui that can go, and the LO16 instructions to rebase on $zero.  */
+
+struct rigel_deletion
+{
+  Elf_Internal_Rela *irel;
+  bfd_vma lo_offsets[RIGEL_SCAN_LIMIT];
+  unsigned int nlo;
+};
+
+/* The bytes of a function in the section being relaxed.  */
+
+struct rigel_code_range
+{
+  bfd_vma start;
+  bfd_vma end;
+};
+
+struct rigel_relax_info
+{
+  bfd *abfd;
+  asection *sec;
+  struct bfd_link_info *link_info;
+  bfd_byte *contents;
+  Elf_Internal_Rela *relocs;
+  Elf_Internal_Rela *relend;
+  /* RELOCS sorted by offset.  Deleting bytes keeps the order.  */
+  Elf_Internal_Rela **index;
+  Elf_Internal_Shdr *symtab_hdr;
+  /* The symbols elf_link_input_bfd treats as local: all of them if the
+     BFD has a bad symbol table, since its locals need not come first.  */
+  Elf_Internal_Sym *isymbuf;
+  size_t locsymcount;
+  size_t extsymoff;
+  unsigned int shndx;
+  /* The functions in the section, by start address.  */
+  struct rigel_code_range *code;
+  size_t ncode;
+  /* The mvuis this pass has found it can delete.  */
+  struct rigel_deletion *dels;
+  size_t ndels;
+  size_t dels_alloc;
+  /* The offsets of the ones it does delete, in order.  */
+  bfd_vma *deleted;
+  size_t ndeleted;
+};
+
+/* Work out which registers Rigel instruction INSN reads and writes.  */
+
+static enum rigel_insn_class
+rigel_insn_regs (unsigned long insn, unsigned long *reads,
+		 unsigned long *writes)
+{
+  unsigned long rd = 1ul << RIGEL_RD (insn);
+  unsigned long rt = 1ul << RIGEL_RT (insn);
+  unsigned long rs = 1ul << RIGEL_RS (insn);
+  unsigned int func = insn & 0xff;
+
+  *reads = *writes = 0;
+  if ((insn & 0xf0001f00) == 0x00001c00)
+    {
+      /* Scalar arithmetic, compares and multiplies.  */
+      if (func <= 0x0e
+	  || (func >= 0x12 && func <= 0x19)
+	  || (func >= 0x43 && func <= 0x45)
+	  || (func >= 0x4e && func <= 0x52))
+	{
+	  *reads = rs | rt;
+	  *writes = rd;
+	  return RIGEL_INSN_PLAIN;
+	}
+      /* cmov.eq and cmov.neq keep their destination if the test fails.  */
+      if (func == 0x1a || func == 0x1b)
+	{
+	  *reads = rd | rs | rt;
+	  *writes = rd;
+	  return RIGEL_INSN_PLAIN;
+	}
+      return RIGEL_INSN_OTHER;
+    }
+
+  /* slli, srli and srai.  */
+  if ((insn & 0xf0001fff) >= 0x00001a0f && (insn & 0xf0001fff) <= 0x00001a11)
+    {
+      *reads = rt;
+      *writes = rd;
+      return RIGEL_INSN_PLAIN;
+    }
+
+  /* Single-operand forms: frcp to fmov, f2i, i2f, clz and the extends.  */
+  if ((insn & 0xf003ff00) == 0x00001800
+      && ((func >= 0x46 && func <= 0x4a)
+	  || func == 0x4c || func == 0x4d
+	  || (func >= 0x53 && func <= 0x57)))
+    {
+      *reads = rt;
+      *writes = rd;
+      return RIGEL_INSN_PLAIN;
+    }
+
+  switch (insn & RIGEL_IMM_MASK)
+    {
+    case 0x10000000:	/* addi */
+    case 0x10010000:	/* subi */
+    case 0x10020000:	/* addiu */
+    case 0x10030000:	/* subiu */
+    case 0x20000000:	/* andi */
+    case 0x20010000:	/* ori */
+    case 0x20020000:	/* xori */
+    case RIGEL_LDW:
+    case RIGEL_GLDW:
+      *reads = rt;
+      *writes = rd;
+      return RIGEL_INSN_PLAIN;
+
+    case RIGEL_STW:
+    case RIGEL_GSTW:
+      *reads = rd | rt;
+      return RIGEL_INSN_PLAIN;
+    }
+
+  if ((insn & 0xf07f0000) == RIGEL_MVUI)
+    {
+      *writes = rd;
+      return RIGEL_INSN_PLAIN;
+    }
+  if (insn == 0x0000002a)	/* nop */
+    return RIGEL_INSN_PLAIN;
+
+  if ((insn & 0xfc000000) == RIGEL_LJL
+      || (insn & 0xffff0000) == RIGEL_JAL)
+    return RIGEL_INSN_CALL;
+  if ((insn & 0xff83ffff) == RIGEL_JALR)
+    {
+      *reads = rt;
+      return RIGEL_INSN_CALL;
+    }
+  if ((insn & 0xff83ffff) == RIGEL_JMPR && RIGEL_RT (insn) == RIGEL_REG_RA)
+    {
+      *reads = rt;
+      return RIGEL_INSN_RETURN;
+    }
+
+  return RIGEL_INSN_OTHER;
+}
+
+/* Return TRUE if INSN is a branch with a 16-bit PC-relative offset.  */
+
+static bfd_boolean
+rigel_pc16_branch_p (unsigned long insn)
+{
+  return ((insn & RIGEL_IMM_MASK) == 0x20030000		/* beq */
+	  || (insn & RIGEL_IMM_MASK) == 0x40000000	/* bne */
+	  || (insn & 0xff800000) == 0x50000000		/* be, bnz, blt, bgt */
+	  || (insn & 0xff830000) == 0x60000000		/* ble */
+	  || (insn & 0xff830000) == 0x60010000		/* bge */
+	  || (insn & 0xffff0000) == RIGEL_JMP
+	  || (insn & 0xffff0000) == RIGEL_JAL);
+}
+
+/* Return TRUE if INSN may carry the R_MIPS_LO16 half of an address.  */
+
+static bfd_boolean
+rigel_lo16_insn_p (unsigned long insn)
+{
+  switch (insn & RIGEL_IMM_MASK)
+    {
+    case RIGEL_ADDI:
+    case RIGEL_ADDIU:
+    case RIGEL_ORI:
+    case RIGEL_LDW:
+    case RIGEL_STW:
+    case RIGEL_GLDW:
+    case RIGEL_GSTW:
+      return TRUE;
+    }
+  return FALSE;
+}
+
+static int
+rigel_reloc_offset_cmp (const void *a, const void *b)
+{
+  const Elf_Internal_Rela *ra = *(const Elf_Internal_Rela **) a;
+  const Elf_Internal_Rela *rb = *(const Elf_Internal_Rela **) b;
+
+  if (ra->r_offset != rb->r_offset)
+    return ra->r_offset < rb->r_offset ? -1 : 1;
+  return ra < rb ? -1 : ra > rb ? 1 : 0;
+}
+
+static int
+rigel_deletion_cmp (const void *a, const void *b)
+{
+  const struct rigel_deletion *da = a;
+  const struct rigel_deletion *db = b;
+
+  if (da->irel->r_offset != db->irel->r_offset)
+    return da->irel->r_offset < db->irel->r_offset ? -1 : 1;
+  return 0;
+}
+
+/* Return the live relocation at OFFSET in the section being relaxed, or
+   NULL if there is none.  */
+
+static Elf_Internal_Rela *
+rigel_reloc_at (struct rigel_relax_info *ri, bfd_vma offset)
+{
+  size_t lo = 0, hi = ri->relend - ri->relocs;
+
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+
+      if (ri->index[mid]->r_offset < offset)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  for (; lo < (size_t) (ri->relend - ri->relocs); lo++)
+    {
+      Elf_Internal_Rela *rel = ri->index[lo];
+
+      if (rel->r_offset != offset)
+	break;
+      if (ELF32_R_TYPE (rel->r_info) != R_MIPS_NONE)
+	return rel;
+    }
+  return NULL;
+}
+
+/* Return the contents of section SEC of ABFD, reading them in and caching
+   them for elf_link_input_bfd if need be.  */
+
+static bfd_byte *
+rigel_section_contents (bfd *abfd, asection *sec)
+{
+  bfd_byte *contents = elf_section_data (sec)->this_hdr.contents;
+
+  if (contents == NULL)
+    {
+      if (!bfd_malloc_and_get_section (abfd, sec, &contents))
+	{
+	  if (contents != NULL)
+	    free (contents);
+	  return NULL;
+	}
+      elf_section_data (sec)->this_hdr.contents = contents;
+    }
+  return contents;
+}
+
+/* Return symbol R_SYMNDX if it is local, or NULL if it is global.  */
+
+static Elf_Internal_Sym *
+rigel_local_sym (struct rigel_relax_info *ri, unsigned long r_symndx)
+{
+  if (r_symndx < ri->extsymoff
+      || (r_symndx < ri->locsymcount
+	  && ELF_ST_BIND (ri->isymbuf[r_symndx].st_info) == STB_LOCAL))
+    return ri->isymbuf + r_symndx;
+  return NULL;
+}
+
+/* Return the hash table entry for global symbol R_SYMNDX.  */
+
+static struct elf_link_hash_entry *
+rigel_global_sym (struct rigel_relax_info *ri, unsigned long r_symndx)
+{
+  struct elf_link_hash_entry *h;
+
+  h = elf_sym_hashes (ri->abfd)[r_symndx - ri->extsymoff];
+  while (h->root.type == bfd_link_hash_indirect
+	 || h->root.type == bfd_link_hash_warning)
+    h = (struct elf_link_hash_entry *) h->root.u.i.link;
+  return h;
+}
+
+/* Return TRUE if symbol R_SYMNDX is the symbol for the section being
+   relaxed.  */
+
+static bfd_boolean
+rigel_section_sym_p (struct rigel_relax_info *ri, unsigned long r_symndx)
+{
+  Elf_Internal_Sym *isym = rigel_local_sym (ri, r_symndx);
+
+  return (isym != NULL
+	  && isym->st_shndx == ri->shndx
+	  && ELF_ST_TYPE (isym->st_info) == STT_SECTION);
+}
+
+/* Set *VALUE to the final address of the symbol REL refers to.  Return
+   FALSE if it is not known yet or may change other than by relaxation.  */
+
+static bfd_boolean
+rigel_symbol_value (struct rigel_relax_info *ri, const Elf_Internal_Rela *rel,
+		    bfd_vma *value)
+{
+  unsigned long r_symndx = ELF32_R_SYM (rel->r_info);
+  Elf_Internal_Sym *isym = rigel_local_sym (ri, r_symndx);
+  asection *sym_sec;
+
+  if (isym == NULL)
+    {
+      struct elf_link_hash_entry *h = rigel_global_sym (ri, r_symndx);
+
+      if ((h->root.type != bfd_link_hash_defined
+	   && h->root.type != bfd_link_hash_defweak)
+	  || (ri->link_info->shared && !h->forced_local))
+	return FALSE;
+      sym_sec = h->root.u.def.section;
+      *value = h->root.u.def.value;
+    }
+  else
+    {
+      if (isym->st_shndx == SHN_UNDEF || isym->st_shndx == SHN_COMMON)
+	return FALSE;
+      if (isym->st_shndx == SHN_ABS)
+	{
+	  *value = isym->st_value;
+	  return TRUE;
+	}
+      sym_sec = bfd_section_from_elf_index (ri->abfd, isym->st_shndx);
+      if (sym_sec != NULL && sym_sec->sec_info_type == ELF_INFO_TYPE_FOLDED)
+	sym_sec = sym_sec->kept_section;
+      /* The offset into a merged section depends on the addend.  */
+      if (sym_sec != NULL
+	  && sym_sec->sec_info_type == ELF_INFO_TYPE_MERGE
+	  && ELF_ST_TYPE (isym->st_info) == STT_SECTION)
+	return FALSE;
+      *value = isym->st_value;
+    }
+
+  if (sym_sec == NULL
+      || sym_sec->output_section == NULL
+      || elf_discarded_section (sym_sec))
+    return FALSE;
+  *value += sym_sec->output_section->vma + sym_sec->output_offset;
+  return TRUE;
+}
+
+/* Return TRUE if we can keep every relocation against the section being
+   relaxed straight when it shrinks.  */
+
+static bfd_boolean
+rigel_relax_ok (struct rigel_relax_info *ri)
+{
+  asection *o;
+
+  for (o = ri->abfd->sections; o != NULL; o = o->next)
+    {
+      Elf_Internal_Rela *relocs, *rel, *relend;
+
+      if ((o->flags & SEC_RELOC) == 0 || o->reloc_count == 0)
+	continue;
+      relocs = _bfd_elf_link_read_relocs (ri->abfd, o, NULL, NULL, TRUE);
+      if (relocs == NULL)
+	return FALSE;
+      relend = relocs + o->reloc_count;
+      for (rel = relocs; rel < relend; rel++)
+	{
+	  if (!rigel_section_sym_p (ri, ELF32_R_SYM (rel->r_info)))
+	    continue;
+	  switch (ELF32_R_TYPE (rel->r_info))
+	    {
+	    case R_MIPS_NONE:
+	    case R_MIPS_32:
+	    case R_MIPS_26:
+	    case R_MIPS_PC16:
+	      break;
+	    default:
+	      return FALSE;
+	    }
+	}
+    }
+  return TRUE;
+}
+
+static int
+rigel_code_range_cmp (const void *a, const void *b)
+{
+  const struct rigel_code_range *ra = a;
+  const struct rigel_code_range *rb = b;
+
+  if (ra->start != rb->start)
+    return ra->start < rb->start ? -1 : 1;
+  return ra->end < rb->end ? -1 : ra->end > rb->end ? 1 : 0;
+}
+
+/* Add the function at VALUE of SIZE bytes to RI->CODE, which has room for
+   *ALLOC entries.  */
+
+static bfd_boolean
+rigel_add_code (struct rigel_relax_info *ri, size_t *alloc, bfd_vma value,
+		bfd_vma size)
+{
+  if (ri->ncode == *alloc)
+    {
+      struct rigel_code_range *code;
+
+      *alloc = *alloc ? *alloc * 2 : 16;
+      code = bfd_realloc (ri->code,
+			  *alloc * sizeof (struct rigel_code_range));
+      if (code == NULL)
+	return FALSE;
+      ri->code = code;
+    }
+  ri->code[ri->ncode].start = value;
+  ri->code[ri->ncode].end = value + size;
+  ri->ncode++;
+  return TRUE;
+}
+
+/* Fill in RI->CODE from the function symbols defined in the section being
+   relaxed.  Leave it empty if there are none, or if one has no size, since
+   then we cannot tell the code from anything else.  */
+
+static bfd_boolean
+rigel_find_code (struct rigel_relax_info *ri)
+{
+  struct elf_link_hash_entry **sym_hashes, **end_hashes;
+  Elf_Internal_Sym *isym, *isymend;
+  size_t alloc = 0;
+  bfd_boolean sized = TRUE;
+
+  ri->ncode = 0;
+  isymend = ri->isymbuf + ri->locsymcount;
+  for (isym = ri->isymbuf; isym < isymend; isym++)
+    if (isym->st_shndx == ri->shndx
+	&& ELF_ST_BIND (isym->st_info) == STB_LOCAL
+	&& ELF_ST_TYPE (isym->st_info) == STT_FUNC)
+      {
+	if (isym->st_size == 0)
+	  sized = FALSE;
+	if (!rigel_add_code (ri, &alloc, isym->st_value, isym->st_size))
+	  return FALSE;
+      }
+
+  sym_hashes = elf_sym_hashes (ri->abfd);
+  end_hashes = sym_hashes + (ri->symtab_hdr->sh_size
+			     / get_elf_backend_data (ri->abfd)->s->sizeof_sym
+			     - ri->extsymoff);
+  for (; sym_hashes < end_hashes; sym_hashes++)
+    {
+      struct elf_link_hash_entry *h = *sym_hashes;
+
+      if (h != NULL
+	  && (h->root.type == bfd_link_hash_defined
+	      || h->root.type == bfd_link_hash_defweak)
+	  && h->root.u.def.section == ri->sec
+	  && h->type == STT_FUNC)
+	{
+	  if (h->size == 0)
+	    sized = FALSE;
+	  if (!rigel_add_code (ri, &alloc, h->root.u.def.value, h->size))
+	    return FALSE;
+	}
+    }
+
+  if (!sized)
+    ri->ncode = 0;
+  qsort (ri->code, ri->ncode, sizeof (struct rigel_code_range),
+	 rigel_code_range_cmp);
+  return TRUE;
+}
+
+/* Return the number of bytes this pass deletes below OFFSET in the section
+   being relaxed.  */
+
+static bfd_vma
+rigel_deleted_below (struct rigel_relax_info *ri, bfd_signed_vma offset)
+{
+  size_t lo = 0, hi = ri->ndeleted;
+
+  if (offset <= 0)
+    return 0;
+  while (lo < hi)
+    {
+      size_t mid = (lo + hi) / 2;
+
+      if (ri->deleted[mid] < (bfd_vma) offset)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo * 4;
+}
+
+static bfd_vma
+rigel_read_uleb128 (bfd_byte **pp, bfd_byte *end, unsigned int *len)
+{
+  bfd_byte *p = *pp;
+  bfd_vma value = 0;
+  unsigned int shift = 0;
+
+  while (p < end)
+    {
+      bfd_byte byte = *p++;
+
+      value |= (bfd_vma) (byte & 0x7f) << shift;
+      shift += 7;
+      if ((byte & 0x80) == 0)
+	break;
+    }
+  *len = p - *pp;
+  *pp = p;
+  return value;
+}
+
+/* Set *OFFSET to the offset in the section being relaxed of the address
+   that REL, with addend ADDEND, refers to.  Return FALSE if that address is
+   in some other section.  */
+
+static bfd_boolean
+rigel_reloc_target (struct rigel_relax_info *ri, const Elf_Internal_Rela *rel,
+		    bfd_vma addend, bfd_vma *offset)
+{
+  unsigned long r_symndx = ELF32_R_SYM (rel->r_info);
+  Elf_Internal_Sym *isym = rigel_local_sym (ri, r_symndx);
+  struct elf_link_hash_entry *h;
+
+  if (isym != NULL)
+    {
+      *offset = isym->st_value + addend;
+      return isym->st_shndx == ri->shndx;
+    }
+  h = rigel_global_sym (ri, r_symndx);
+  *offset = h->root.u.def.value + addend;
+  return ((h->root.type == bfd_link_hash_defined
+	   || h->root.type == bfd_link_hash_defweak)
+	  && h->root.u.def.section == ri->sec);
+}
+
+/* Return the R_MIPS_32 relocation at offset WHERE among RELOCS..RELEND, or
+   NULL if there is none.  */
+
+static Elf_Internal_Rela *
+rigel_debug_reloc_at (Elf_Internal_Rela *relocs, Elf_Internal_Rela *relend,
+		      bfd_vma where)
+{
+  Elf_Internal_Rela *rel;
+
+  for (rel = relocs; rel < relend; rel++)
+    if (rel->r_offset == where && ELF32_R_TYPE (rel->r_info) == R_MIPS_32)
+      return rel;
+  return NULL;
+}
+
+/* Take *TAKE bytes off a .debug_line address advance of ADV bytes, if it
+   can be done in place, and clear *TAKE if so.  P points to the opcode of a
+   special opcode and to the LEN-byte operand of anything else.  */
+
+static void
+rigel_shrink_line_advance (bfd *abfd, bfd_byte *p, unsigned int len, int op,
+			   unsigned int opcode_base, unsigned int line_range,
+			   unsigned int min_inst, bfd_vma adv, bfd_vma *take)
+{
+  bfd_vma units, value;
+  unsigned int i;
+
+  if (*take > adv)
+    return;
+
+  if (op >= (int) opcode_base)
+    {
+      /* A special opcode.  */
+      units = *take / min_inst;
+      *p -= units * line_range;
+    }
+  else if (op == DW_LNS_advance_pc)
+    {
+      /* Rewrite the operand in the same number of bytes.  */
+      value = adv / min_inst - *take / min_inst;
+      for (i = 0; i < len; i++)
+	{
+	  p[i] = (value & 0x7f) | (i + 1 < len ? 0x80 : 0);
+	  value >>= 7;
+	}
+    }
+  else if (op == DW_LNS_fixed_advance_pc)
+    bfd_put_16 (abfd, bfd_get_16 (abfd, p) - *take, p);
+  else
+    /* DW_LNS_const_add_pc has no operand to change.  */
+    return;
+  *take = 0;
+}
+
+/* Adjust the line programs in .debug_line for the bytes this pass deletes
+   from the section being relaxed.  This must be done before the addends
+   and symbols that locate the programs are changed.  */
+
+static bfd_boolean
+rigel_adjust_line_info (struct rigel_relax_info *ri)
+{
+  bfd *abfd = ri->abfd;
+  asection *lsec = bfd_get_section_by_name (abfd, ".debug_line");
+  Elf_Internal_Rela *lrelocs, *lrelend;
+  bfd_byte *contents, *p, *end;
+
+  if (lsec == NULL || lsec->reloc_count == 0)
+    return TRUE;
+  contents = rigel_section_contents (abfd, lsec);
+  lrelocs = _bfd_elf_link_read_relocs (abfd, lsec, NULL, NULL, TRUE);
+  if (contents == NULL || lrelocs == NULL)
+    return FALSE;
+  lrelend = lrelocs + lsec->reloc_count;
+
+  p = contents;
+  end = contents + lsec->size;
+  while (p + 15 <= end)
+    {
+      bfd_vma unit_length = bfd_get_32 (abfd, p);
+      bfd_byte *unit_end, *std_lengths;
+      unsigned int min_inst, line_range, opcode_base, len = 0;
+      bfd_boolean in_sec = FALSE;
+      bfd_vma address = 0, take = 0;
+
+      /* Give up on anything we do not understand; the worst that can
+	 happen is a stale line table.  */
+      if (unit_length == 0xffffffff || unit_length > (bfd_vma) (end - p - 4))
+	break;
+      unit_end = p + 4 + unit_length;
+      min_inst = p[10];
+      line_range = p[13];
+      opcode_base = p[14];
+      std_lengths = p + 15;
+      p += 10 + bfd_get_32 (abfd, p + 6);
+      if (min_inst == 0 || line_range == 0 || opcode_base == 0
+	  || p > unit_end)
+	break;
+
+      while (p < unit_end)
+	{
+	  bfd_byte *opp = p;
+	  int op = *p++;
+	  bfd_vma adv = 0, value;
+	  Elf_Internal_Rela *rel;
+
+	  if (op >= (int) opcode_base)
+	    adv = ((op - opcode_base) / line_range) * min_inst;
+	  else if (op == DW_LNS_advance_pc)
+	    {
+	      opp = p;
+	      adv = rigel_read_uleb128 (&p, unit_end, &len) * min_inst;
+	    }
+	  else if (op == DW_LNS_const_add_pc)
+	    adv = ((255 - opcode_base) / line_range) * min_inst;
+	  else if (op == DW_LNS_fixed_advance_pc)
+	    {
+	      opp = p;
+	      adv = bfd_get_16 (abfd, p);
+	      p += 2;
+	    }
+	  else if (op == 0)
+	    {
+	      value = rigel_read_uleb128 (&p, unit_end, &len);
+	      if (value == 0 || p + value > unit_end)
+		break;
+	      if (*p == DW_LNE_end_sequence)
+		{
+		  in_sec = FALSE;
+		  take = 0;
+		}
+	      else if (*p == DW_LNE_set_address && value == 5)
+		{
+		  bfd_vma where = p + 1 - contents;
+
+		  in_sec = FALSE;
+		  take = 0;
+		  rel = rigel_debug_reloc_at (lrelocs, lrelend, where);
+		  if (rel != NULL)
+		    in_sec = rigel_reloc_target (ri, rel,
+						 bfd_get_32 (abfd, p + 1),
+						 &address);
+		}
+	      p += value;
+	      continue;
+	    }
+	  else if (op <= (int) opcode_base - 1)
+	    {
+	      /* Skip the operands of anything else.  */
+	      unsigned int n;
+
+	      for (n = std_lengths[op - 1]; n > 0; n--)
+		rigel_read_uleb128 (&p, unit_end, &len);
+	      continue;
+	    }
+
+	  if (!in_sec)
+	    continue;
+
+	  /* An advance loses the bytes deleted from the range it steps
+	     over.  One that cannot shrink in place hands them on to the
+	     next.  */
+	  take += (rigel_deleted_below (ri, address + adv)
+		   - rigel_deleted_below (ri, address));
+	  address += adv;
+	  if (take != 0)
+	    rigel_shrink_line_advance (abfd, opp, len, op, opcode_base,
+				       line_range, min_inst, adv, &take);
+	}
+      p = unit_end;
+    }
+  return TRUE;
+}
+
+/* Adjust the address ranges in .debug_aranges for the bytes this pass
+   deletes from the section being relaxed.  Each range is an address with an
+   R_MIPS_32 relocation followed by its length.  Like the line info, this
+   must be done before the addends and symbols are changed.  */
+
+static bfd_boolean
+rigel_adjust_aranges (struct rigel_relax_info *ri)
+{
+  bfd *abfd = ri->abfd;
+  asection *asec = bfd_get_section_by_name (abfd, ".debug_aranges");
+  Elf_Internal_Rela *arelocs, *arelend, *rel;
+  bfd_byte *contents;
+
+  if (asec == NULL || asec->reloc_count == 0)
+    return TRUE;
+  contents = rigel_section_contents (abfd, asec);
+  arelocs = _bfd_elf_link_read_relocs (abfd, asec, NULL, NULL, TRUE);
+  if (contents == NULL || arelocs == NULL)
+    return FALSE;
+  arelend = arelocs + asec->reloc_count;
+
+  for (rel = arelocs; rel < arelend; rel++)
+    {
+      bfd_vma start, length;
+
+      if (ELF32_R_TYPE (rel->r_info) != R_MIPS_32
+	  || rel->r_offset + 8 > asec->size
+	  || !rigel_reloc_target (ri, rel,
+				  bfd_get_32 (abfd, contents + rel->r_offset),
+				  &start))
+	continue;
+      length = bfd_get_32 (abfd, contents + rel->r_offset + 4);
+      length -= (rigel_deleted_below (ri, start + length)
+		 - rigel_deleted_below (ri, start));
+      bfd_put_32 (abfd, length, contents + rel->r_offset + 4);
+    }
+  return TRUE;
+}
+
+/* Set *CODE_ALIGN to the code alignment factor of the .debug_frame CIE at
+   P, which must end by END.  Return FALSE if it is not a CIE we can
+   handle.  */
+
+static bfd_boolean
+rigel_frame_cie (bfd *abfd, bfd_byte *p, bfd_byte *end,
+		 unsigned int *code_align)
+{
+  unsigned int len;
+  bfd_vma length;
+
+  if (p + 10 > end)
+    return FALSE;
+  length = bfd_get_32 (abfd, p);
+  if (length == 0xffffffff || length > (bfd_vma) (end - p - 4)
+      || bfd_get_32 (abfd, p + 4) != 0xffffffff
+      || (p[8] != 1 && p[8] != 3)
+      /* An augmentation could change the layout of the FDEs.  */
+      || p[9] != 0)
+    return FALSE;
+  end = p + 4 + length;
+  p += 10;
+  *code_align = rigel_read_uleb128 (&p, end, &len);
+  return *code_align != 0 && 4 % *code_align == 0;
+}
+
+/* Walk the FDEs in .debug_frame for the section being relaxed, and if
+   ADJUST, take the bytes this pass deletes out of their address ranges and
+   DW_CFA_advance_loc steps.  Return FALSE if .debug_frame has anything we
+   cannot follow.  With ADJUST, this must be done before the addends and
+   symbols are changed.  */
+
+static bfd_boolean
+rigel_debug_frame (struct rigel_relax_info *ri, bfd_boolean adjust)
+{
+  bfd *abfd = ri->abfd;
+  asection *fsec = bfd_get_section_by_name (abfd, ".debug_frame");
+  Elf_Internal_Rela *frelocs, *frelend, *rel;
+  bfd_byte *contents, *p, *end;
+
+  if (fsec == NULL || fsec->reloc_count == 0)
+    return TRUE;
+  contents = rigel_section_contents (abfd, fsec);
+  frelocs = _bfd_elf_link_read_relocs (abfd, fsec, NULL, NULL, TRUE);
+  if (contents == NULL || frelocs == NULL)
+    return FALSE;
+  frelend = frelocs + fsec->reloc_count;
+
+  p = contents;
+  end = contents + fsec->size;
+  while (p + 4 <= end)
+    {
+      bfd_vma length = bfd_get_32 (abfd, p);
+      bfd_vma cie, address, range, removed;
+      bfd_byte *fde_end, *q;
+      unsigned int code_align, len;
+
+      if (length == 0xffffffff || length > (bfd_vma) (end - p - 4))
+	return FALSE;
+      fde_end = p + 4 + length;
+      if (length < 12 || bfd_get_32 (abfd, p + 4) == 0xffffffff)
+	{
+	  /* A CIE, or padding.  */
+	  p = fde_end;
+	  continue;
+	}
+      rel = rigel_debug_reloc_at (frelocs, frelend, p + 8 - contents);
+      if (rel == NULL
+	  || !rigel_reloc_target (ri, rel, bfd_get_32 (abfd, p + 8),
+				  &address))
+	{
+	  p = fde_end;
+	  continue;
+	}
+      cie = bfd_get_32 (abfd, p + 4);
+      if (cie >= fsec->size
+	  || !rigel_frame_cie (abfd, contents + cie, end, &code_align))
+	return FALSE;
+
+      range = bfd_get_32 (abfd, p + 12);
+      if (adjust)
+	bfd_put_32 (abfd, range - (rigel_deleted_below (ri, address + range)
+				   - rigel_deleted_below (ri, address)),
+		    p + 12);
+
+      q = p + 16;
+      while (q < fde_end)
+	{
+	  bfd_byte *opp = q;
+	  int op = *q++;
+	  bfd_vma adv = 0;
+
+	  switch (op & 0xc0)
+	    {
+	    case DW_CFA_advance_loc:
+	      adv = (op & 0x3f) * code_align;
+	      break;
+
+	    case DW_CFA_offset:
+	      rigel_read_uleb128 (&q, fde_end, &len);
+	      continue;
+
+	    case DW_CFA_restore:
+	      continue;
+
+	    default:
+	      switch (op)
+		{
+		case DW_CFA_nop:
+		case DW_CFA_remember_state:
+		case DW_CFA_restore_state:
+		  continue;
+
+		case DW_CFA_advance_loc1:
+		  adv = q[0] * code_align;
+		  q += 1;
+		  break;
+
+		case DW_CFA_advance_loc2:
+		  adv = bfd_get_16 (abfd, q) * code_align;
+		  q += 2;
+		  break;
+
+		case DW_CFA_advance_loc4:
+		  adv = bfd_get_32 (abfd, q) * code_align;
+		  q += 4;
+		  break;
+
+		case DW_CFA_offset_extended:
+		case DW_CFA_register:
+		case DW_CFA_def_cfa:
+		case DW_CFA_offset_extended_sf:
+		case DW_CFA_def_cfa_sf:
+		case DW_CFA_val_offset:
+		case DW_CFA_val_offset_sf:
+		case DW_CFA_GNU_negative_offset_extended:
+		  rigel_read_uleb128 (&q, fde_end, &len);
+		  /* Fall through.  */
+		case DW_CFA_restore_extended:
+		case DW_CFA_undefined:
+		case DW_CFA_same_value:
+		case DW_CFA_def_cfa_register:
+		case DW_CFA_def_cfa_offset:
+		case DW_CFA_def_cfa_offset_sf:
+		case DW_CFA_GNU_args_size:
+		  rigel_read_uleb128 (&q, fde_end, &len);
+		  continue;
+
+		case DW_CFA_expression:
+		case DW_CFA_val_expression:
+		  rigel_read_uleb128 (&q, fde_end, &len);
+		  /* Fall through.  */
+		case DW_CFA_def_cfa_expression:
+		  q += rigel_read_uleb128 (&q, fde_end, &len);
+		  continue;
+
+		default:
+		  /* DW_CFA_set_loc, and anything we do not know.  */
+		  return FALSE;
+		}
+	      break;
+	    }
+	  if (q > fde_end)
+	    return FALSE;
+
+	  if (!adjust)
+	    continue;
+
+	  /* The deleted bytes all lie inside the step, so it can always
+	     shrink in place.  */
+	  removed = (rigel_deleted_below (ri, address + adv)
+		     - rigel_deleted_below (ri, address));
+	  address += adv;
+	  if (removed == 0)
+	    continue;
+	  adv = (adv - removed) / code_align;
+	  if ((op & 0xc0) == DW_CFA_advance_loc)
+	    *opp = DW_CFA_advance_loc | adv;
+	  else if (op == DW_CFA_advance_loc1)
+	    opp[1] = adv;
+	  else if (op == DW_CFA_advance_loc2)
+	    bfd_put_16 (abfd, adv, opp + 1);
+	  else
+	    bfd_put_32 (abfd, adv, opp + 1);
+	}
+      p = fde_end;
+    }
+  return TRUE;
+}
+
+/* Delete the instructions at RI->DELETED from the section being relaxed.
+   The caller has already dropped any relocation against them.  */
+
+static bfd_boolean
+rigel_delete_bytes (struct rigel_relax_info *ri)
+{
+  bfd *abfd = ri->abfd;
+  asection *sec = ri->sec;
+  asection *o;
+  Elf_Internal_Rela *rel;
+  Elf_Internal_Sym *isym, *isymend;
+  struct elf_link_hash_entry **sym_hashes, **end_hashes;
+  bfd_vma off, below, dst;
+  size_t i;
+
+  if (!rigel_adjust_line_info (ri)
+      || !rigel_adjust_aranges (ri)
+      || !rigel_debug_frame (ri, TRUE))
+    return FALSE;
+
+  /* Branches the assembler resolved itself.  */
+  off = 0;
+  for (i = 0; i < ri->ncode; i++)
+    {
+      if (off < ri->code[i].start)
+	off = ri->code[i].start;
+      for (; off + 4 <= ri->code[i].end && off + 4 <= sec->size; off += 4)
+	{
+	  unsigned long insn = bfd_get_32 (abfd, ri->contents + off);
+	  bfd_signed_vma disp, target;
+
+	  if (!rigel_pc16_branch_p (insn) || rigel_reloc_at (ri, off) != NULL)
+	    continue;
+	  disp = _bfd_mips_elf_sign_extend (insn & 0xffff, 16) << 2;
+	  target = off + 4 + disp;
+	  disp -= ((bfd_signed_vma) rigel_deleted_below (ri, target)
+		   - (bfd_signed_vma) rigel_deleted_below (ri, off));
+	  insn = (insn & ~0xffff) | ((disp >> 2) & 0xffff);
+	  bfd_put_32 (abfd, insn, ri->contents + off);
+	}
+    }
+
+  /* Addends against the section symbol, in any section of this BFD.  */
+  for (o = abfd->sections; o != NULL; o = o->next)
+    {
+      Elf_Internal_Rela *relocs, *relend;
+      bfd_byte *contents = NULL;
+
+      if ((o->flags & SEC_RELOC) == 0 || o->reloc_count == 0)
+	continue;
+      relocs = _bfd_elf_link_read_relocs (abfd, o, NULL, NULL, TRUE);
+      if (relocs == NULL)
+	return FALSE;
+      relend = relocs + o->reloc_count;
+      for (rel = relocs; rel < relend; rel++)
+	{
+	  unsigned int r_type = ELF32_R_TYPE (rel->r_info);
+	  bfd_vma x;
+	  bfd_signed_vma a;
+
+	  if (r_type == R_MIPS_NONE
+	      || !rigel_section_sym_p (ri, ELF32_R_SYM (rel->r_info)))
+	    continue;
+	  if (contents == NULL)
+	    {
+	      contents = rigel_section_contents (abfd, o);
+	      if (contents == NULL)
+		return FALSE;
+	    }
+	  x = bfd_get_32 (abfd, contents + rel->r_offset);
+	  switch (r_type)
+	    {
+	    case R_MIPS_32:
+	      x -= rigel_deleted_below (ri, x);
+	      break;
+
+	    case R_MIPS_26:
+	      a = (x & 0x3ffffff) << 2;
+	      a -= rigel_deleted_below (ri, a);
+	      x = (x & ~0x3ffffff) | ((a >> 2) & 0x3ffffff);
+	      break;
+
+	    case R_MIPS_PC16:
+	      a = _bfd_mips_elf_sign_extend ((x & 0xffff) << 2, 18);
+	      a -= rigel_deleted_below (ri, a + 4);
+	      x = (x & ~0xffff) | ((a >> 2) & 0xffff);
+	      break;
+	    }
+	  bfd_put_32 (abfd, x, contents + rel->r_offset);
+	}
+    }
+
+  /* Close up the gaps.  */
+  dst = ri->deleted[0];
+  for (i = 0; i < ri->ndeleted; i++)
+    {
+      bfd_vma from = ri->deleted[i] + 4;
+      bfd_vma to = i + 1 < ri->ndeleted ? ri->deleted[i + 1] : sec->size;
+
+      memmove (ri->contents + dst, ri->contents + from, to - from);
+      dst += to - from;
+    }
+  sec->size = dst;
+
+  for (rel = ri->relocs; rel < ri->relend; rel++)
+    rel->r_offset -= rigel_deleted_below (ri, rel->r_offset);
+
+  /* Symbols defined in the section.  */
+  isymend = ri->isymbuf + ri->locsymcount;
+  for (isym = ri->isymbuf; isym < isymend; isym++)
+    if (isym->st_shndx == ri->shndx
+	&& ELF_ST_BIND (isym->st_info) == STB_LOCAL)
+      {
+	below = rigel_deleted_below (ri, isym->st_value);
+	isym->st_size -= (rigel_deleted_below (ri, (isym->st_value
+						    + isym->st_size))
+			  - below);
+	isym->st_value -= below;
+      }
+
+  sym_hashes = elf_sym_hashes (abfd);
+  end_hashes = sym_hashes + (ri->symtab_hdr->sh_size
+			     / get_elf_backend_data (abfd)->s->sizeof_sym
+			     - ri->extsymoff);
+  for (; sym_hashes < end_hashes; sym_hashes++)
+    {
+      struct elf_link_hash_entry *h = *sym_hashes;
+
+      if (h != NULL
+	  && (h->root.type == bfd_link_hash_defined
+	   || h->root.type == bfd_link_hash_defweak)
+	  && h->root.u.def.section == sec)
+	{
+	  below = rigel_deleted_below (ri, h->root.u.def.value);
+	  h->size -= (rigel_deleted_below (ri, h->root.u.def.value + h->size)
+		      - below);
+	  h->root.u.def.value -= below;
+	}
+    }
+
+  return TRUE;
+}
+
+/* Add the mvui that IREL, an R_MIPS_HI16, applies to to RI->DELS if we
+   can do without it.  */
+
+static bfd_boolean
+rigel_relax_hi16 (struct rigel_relax_info *ri, Elf_Internal_Rela *irel)
+{
+  bfd *abfd = ri->abfd;
+  bfd_vma lo_offsets[RIGEL_SCAN_LIMIT];
+  unsigned int nlo = 0;
+  struct rigel_deletion *del;
+  unsigned long insn, reg, r_symndx;
+  bfd_vma symval, hi, off;
+  bfd_boolean dead = FALSE;
+
+  insn = bfd_get_32 (abfd, ri->contents + irel->r_offset);
+  if ((insn & 0xf07f0000) != RIGEL_MVUI)
+    return TRUE;
+  reg = RIGEL_RD (insn);
+  hi = insn & 0xffff;
+  r_symndx = ELF32_R_SYM (irel->r_info);
+  if (reg == 0 || !rigel_symbol_value (ri, irel, &symval))
+    return TRUE;
+
+  /* Find the LO16 instructions based on REG, and make sure that nothing
+     else reads REG before it is overwritten or dies.  */
+  for (off = irel->r_offset + 4;
+       off + 4 <= ri->sec->size
+	 && off <= irel->r_offset + 4 * RIGEL_SCAN_LIMIT;
+       off += 4)
+    {
+      Elf_Internal_Rela *rel = rigel_reloc_at (ri, off);
+      unsigned long reads, writes;
+      enum rigel_insn_class cls;
+
+      insn = bfd_get_32 (abfd, ri->contents + off);
+      cls = rigel_insn_regs (insn, &reads, &writes);
+      if (rel != NULL
+	  && ELF32_R_TYPE (rel->r_info) == R_MIPS_LO16
+	  && ELF32_R_SYM (rel->r_info) == r_symndx
+	  && rigel_lo16_insn_p (insn)
+	  && RIGEL_RT (insn) == reg)
+	{
+	  bfd_vma value;
+
+	  value = (symval + (hi << 16)
+		   + _bfd_mips_elf_sign_extend (insn & 0xffff, 16));
+	  if ((value & 0xffffffff) >= 0x8000)
+	    return TRUE;
+	  /* A store of REG itself needs the high half.  */
+	  if (((insn & RIGEL_IMM_MASK) == RIGEL_STW
+	       || (insn & RIGEL_IMM_MASK) == RIGEL_GSTW)
+	      && RIGEL_RD (insn) == reg)
+	    return TRUE;
+	  lo_offsets[nlo++] = off;
+	  reads &= ~(1ul << reg);
+	}
+
+      if ((reads & (1ul << reg)) != 0 || cls == RIGEL_INSN_OTHER)
+	return TRUE;
+      if (cls == RIGEL_INSN_CALL)
+	{
+	  /* Only a call to a global function keeps to the calling
+	     convention.  A local target, such as code the compiler
+	     outlined, may read any register.  */
+	  if (rel != NULL
+	      && (ELF32_R_TYPE (rel->r_info) == R_MIPS_26
+		  || ELF32_R_TYPE (rel->r_info) == R_MIPS_PC16)
+	      && rigel_local_sym (ri, ELF32_R_SYM (rel->r_info)) == NULL)
+	    dead = (RIGEL_CALL_DEAD_REGS & (1ul << reg)) != 0;
+	  break;
+	}
+      if (cls == RIGEL_INSN_RETURN)
+	{
+	  dead = (RIGEL_RETURN_DEAD_REGS & (1ul << reg)) != 0;
+	  break;
+	}
+      if ((writes & (1ul << reg)) != 0)
+	{
+	  dead = TRUE;
+	  break;
+	}
+    }
+  if (!dead || nlo == 0)
+    return TRUE;
+
+  if (ri->ndels == ri->dels_alloc)
+    {
+      ri->dels_alloc = ri->dels_alloc ? ri->dels_alloc * 2 : 16;
+      del = bfd_realloc (ri->dels,
+			 ri->dels_alloc * sizeof (struct rigel_deletion));
+      if (del == NULL)
+	return FALSE;
+      ri->dels = del;
+    }
+  del = ri->dels + ri->ndels++;
+  del->irel = irel;
+  memcpy (del->lo_offsets, lo_offsets, nlo * sizeof (bfd_vma));
+  del->nlo = nlo;
+  return TRUE;
+}
+
+/* Delete what we can of the mvuis in RI->DELS, and set *AGAIN if any
+   go.  */
+
+static bfd_boolean
+rigel_delete_some (struct rigel_relax_info *ri, bfd_boolean *again)
+{
+  bfd *abfd = ri->abfd;
+  size_t i, j, per_align;
+  unsigned int k;
+  bfd_boolean ret;
+
+  /* Deleting code moves the functions after it.  Keep each one as aligned
+     as the section by taking a multiple of the section alignment out in
+     front of it, and leave the last few mvuis before it where they are.  */
+  qsort (ri->dels, ri->ndels, sizeof (struct rigel_deletion),
+	 rigel_deletion_cmp);
+  per_align = (ri->sec->alignment_power > 2
+	       ? (size_t) 1 << (ri->sec->alignment_power - 2) : 1);
+  ri->deleted = bfd_malloc (ri->ndels * sizeof (bfd_vma));
+  if (ri->deleted == NULL)
+    return FALSE;
+  ri->ndeleted = 0;
+  for (i = j = 0; i <= ri->ncode; i++)
+    {
+      size_t first = j, n;
+
+      if (i < ri->ncode)
+	while (j < ri->ndels
+	       && ri->dels[j].irel->r_offset < ri->code[i].start)
+	  j++;
+      else
+	j = ri->ndels;
+      n = j - first;
+      if (i < ri->ncode)
+	n -= n % per_align;
+
+      for (; n > 0; n--, first++)
+	{
+	  struct rigel_deletion *del = ri->dels + first;
+
+	  for (k = 0; k < del->nlo; k++)
+	    {
+	      bfd_byte *p = ri->contents + del->lo_offsets[k];
+
+	      bfd_put_32 (abfd, bfd_get_32 (abfd, p) & ~RIGEL_RT_MASK, p);
+	    }
+	  del->irel->r_info = ELF32_R_INFO (0, R_MIPS_NONE);
+	  ri->deleted[ri->ndeleted++] = del->irel->r_offset;
+	}
+    }
+
+  ret = TRUE;
+  if (ri->ndeleted != 0)
+    {
+      ret = rigel_delete_bytes (ri);
+      *again = TRUE;
+    }
+  free (ri->deleted);
+  ri->deleted = NULL;
+  return ret;
+}
+
+/* Turn the lj or ljl that IREL, an R_MIPS_26, applies to into a jmp or jal
+   if its target is close enough.  */
+
+static void
+rigel_relax_jump (struct rigel_relax_info *ri, Elf_Internal_Rela *irel)
+{
+  bfd *abfd = ri->abfd;
+  unsigned long insn, r_symndx;
+  bfd_vma symval, pc;
+  bfd_signed_vma addend, disp;
+
+  insn = bfd_get_32 (abfd, ri->contents + irel->r_offset);
+  if ((insn & 0xf8000000) != RIGEL_LJ
+      || !rigel_symbol_value (ri, irel, &symval))
+    return;
+
+  r_symndx = ELF32_R_SYM (irel->r_info);
+  addend = (insn & 0x3ffffff) << 2;
+  if (rigel_local_sym (ri, r_symndx) == NULL)
+    addend = _bfd_mips_elf_sign_extend (addend, 28);
+  pc = (ri->sec->output_section->vma + ri->sec->output_offset
+	+ irel->r_offset + 4);
+  disp = symval + addend - pc;
+  if ((disp & 3) != 0
+      || disp < -0x20000 + RIGEL_BRANCH_SLACK
+      || disp >= 0x20000 - RIGEL_BRANCH_SLACK)
+    return;
+
+  /* The R_MIPS_PC16 addend is in place and includes the PC bias.  */
+  addend -= 4;
+  if (addend < -0x20000 || addend >= 0x20000)
+    return;
+  insn = (((insn & 0xfc000000) == RIGEL_LJL ? RIGEL_JAL : RIGEL_JMP)
+	  | ((addend >> 2) & 0xffff));
+  bfd_put_32 (abfd, insn, ri->contents + irel->r_offset);
+  irel->r_info = ELF32_R_INFO (r_symndx, R_MIPS_PC16);
+}
+
+/* Relax Rigel section SEC of ABFD.  Set *AGAIN if it shrank.  */
+
+static bfd_boolean
+mips_elf_rigel_relax_section (bfd *abfd, asection *sec,
+			      struct bfd_link_info *link_info,
+			      bfd_boolean *again)
+{
+  struct rigel_relax_info ri;
+  Elf_Internal_Rela *irel;
+  size_t i, count;
+
+  if ((sec->flags & SEC_CODE) == 0
+      || (sec->flags & SEC_RELOC) == 0
+      || sec->reloc_count == 0
+      || sec->output_section == NULL
+      || bfd_is_abs_section (sec->output_section)
+      || elf_section_data (sec)->folded_into)
+    return TRUE;
+
+  ri.abfd = abfd;
+  ri.sec = sec;
+  ri.link_info = link_info;
+  ri.symtab_hdr = &elf_tdata (abfd)->symtab_hdr;
+  ri.shndx = _bfd_elf_section_from_bfd_section (abfd, sec);
+  if (elf_bad_symtab (abfd))
+    {
+      ri.locsymcount = (ri.symtab_hdr->sh_size
+			/ get_elf_backend_data (abfd)->s->sizeof_sym);
+      ri.extsymoff = 0;
+    }
+  else
+    ri.locsymcount = ri.extsymoff = ri.symtab_hdr->sh_info;
+
+  /* Everything we change has to be kept for elf_link_input_bfd.  */
+  ri.isymbuf = (Elf_Internal_Sym *) ri.symtab_hdr->contents;
+  if (ri.isymbuf == NULL && ri.locsymcount != 0)
+    {
+      ri.isymbuf = bfd_elf_get_elf_syms (abfd, ri.symtab_hdr,
+					 ri.locsymcount, 0,
+					 NULL, NULL, NULL);
+      if (ri.isymbuf == NULL)
+	return FALSE;
+      ri.symtab_hdr->contents = (unsigned char *) ri.isymbuf;
+    }
+
+  ri.relocs = _bfd_elf_link_read_relocs (abfd, sec, NULL, NULL, TRUE);
+  if (ri.relocs == NULL)
+    return FALSE;
+  count = sec->reloc_count;
+  ri.relend = ri.relocs + count;
+
+  if (!rigel_relax_ok (&ri))
+    return TRUE;
+
+  /* Deleting code would leave stale unwind info behind.  */
+  if (!rigel_debug_frame (&ri, FALSE))
+    {
+      (*_bfd_error_handler)
+	(_("%B: warning: not relaxing %A: cannot update its .debug_frame"),
+	 abfd, sec);
+      return TRUE;
+    }
+
+  ri.code = NULL;
+  ri.index = NULL;
+  ri.dels = NULL;
+  ri.ndels = ri.dels_alloc = 0;
+
+  if (!rigel_find_code (&ri))
+    goto error_return;
+  if (ri.ncode == 0)
+    {
+      if (ri.code != NULL)
+	free (ri.code);
+      return TRUE;
+    }
+
+  ri.contents = rigel_section_contents (abfd, sec);
+  if (ri.contents == NULL)
+    goto error_return;
+
+  ri.index = bfd_malloc (count * sizeof (Elf_Internal_Rela *));
+  if (ri.index == NULL)
+    goto error_return;
+  for (i = 0; i < count; i++)
+    ri.index[i] = ri.relocs + i;
+  qsort (ri.index, count, sizeof (Elf_Internal_Rela *),
+	 rigel_reloc_offset_cmp);
+
+  for (irel = ri.relocs; irel < ri.relend; irel++)
+    switch (ELF32_R_TYPE (irel->r_info))
+      {
+      case R_MIPS_HI16:
+	if (!rigel_relax_hi16 (&ri, irel))
+	  goto error_return;
+	break;
+
+      case R_MIPS_26:
+	rigel_relax_jump (&ri, irel);
+	break;
+      }
+
+  if (ri.ndels != 0 && !rigel_delete_some (&ri, again))
+    goto error_return;
+
+  free (ri.code);
+  free (ri.index);
+  if (ri.dels != NULL)
+    free (ri.dels);
+  return TRUE;
+
+ error_return:
+  if (ri.code != NULL)
+    free (ri.code);
+  if (ri.index != NULL)
+    free (ri.index);
+  if (ri.dels != NULL)
+    free (ri.dels);
+  return FALSE;
+}
+
 bfd_boolean
 _bfd_mips_relax_section (bfd *abfd, asection *sec,
 			 struct bfd_link_info *link_info,
@@ -6768,10 +8241,13 @@ _bfd_mips_relax_section (bfd *abfd, asection *sec,
   bfd_vma sec_start = sec->output_section->vma + sec->output_offset;
   Elf_Internal_Sym *isymbuf = NULL;
 
-  /* We are not currently changing any sizes, so only one pass.  */
+  /* Only the Rigel relaxation below changes sizes; it sets *AGAIN if it
+     does.  */
   *again = FALSE;
 
-  if (link_info->relocatable)
+  /* Sections removed by identical code folding are not output.  */
+  if (link_info->relocatable
+      || sec->sec_info_type == ELF_INFO_TYPE_FOLDED)
     return TRUE;
 
   internal_relocs = _bfd_elf_link_read_relocs (abfd, sec, NULL, NULL,
@@ -6853,8 +8329,12 @@ _bfd_mips_relax_section (bfd *abfd, asection *sec,
 	  else if (isym->st_shndx == SHN_COMMON)
 	    sym_sec = bfd_com_section_ptr;
 	  else
-	    sym_sec
-	      = bfd_section_from_elf_index (abfd, isym->st_shndx);
+	    {
+	      sym_sec
+		= bfd_section_from_elf_index (abfd, isym->st_shndx);
+	      if (sym_sec->sec_info_type == ELF_INFO_TYPE_FOLDED)
+		sym_sec = sym_sec->kept_section;
+	    }
 	  symval = isym->st_value
 	    + sym_sec->output_section->vma
 	    + sym_sec->output_offset;
@@ -6915,6 +8395,9 @@ _bfd_mips_relax_section (bfd *abfd, asection *sec,
           elf_section_data (sec)->this_hdr.contents = contents;
         }
     }
+
+  if (!NEWABI_P (abfd))
+    return mips_elf_rigel_relax_section (abfd, sec, link_info, again);
   return TRUE;
 
  relax_return:
@@ -9597,6 +11080,32 @@ _bfd_mips_elf_gc_mark_hook (asection *sec,
   return _bfd_elf_gc_mark_hook (sec, info, rel, h, sym);
 }
 
+/* Keep the .pdr sections of the input files, without letting their
+   relocations keep the functions that they describe.
+   _bfd_mips_elf_discard_info later drops the records of functions
+   that were removed.  */
+
+bfd_boolean
+_bfd_mips_elf_gc_mark_extra_sections (struct bfd_link_info *info,
+				      elf_gc_mark_hook_fn gc_mark_hook
+				      ATTRIBUTE_UNUSED)
+{
+  bfd *sub;
+  asection *o;
+
+  for (sub = info->input_bfds; sub != NULL; sub = sub->link_next)
+    {
+      if (bfd_get_flavour (sub) != bfd_target_elf_flavour)
+	continue;
+
+      o = bfd_get_section_by_name (sub, ".pdr");
+      if (o != NULL)
+	o->gc_mark = 1;
+    }
+
+  return TRUE;
+}
+
 /* Update the got entry reference counts for the section being removed.  */
 
 bfd_boolean
@@ -9805,6 +11314,11 @@ _bfd_mips_elf_discard_info (bfd *abfd, struct elf_reloc_cookie *cookie,
   if (skip != 0)
     {
       mips_elf_section_data (o)->u.tdata = tdata;
+      /* The records are still relocated in place at their original
+	 offsets; _bfd_mips_elf_write_section squeezes out the ones
+	 that were skipped.  */
+      if (o->rawsize == 0)
+	o->rawsize = o->size;
       o->size -= skip * PDR_SIZE;
       ret = TRUE;
     }
@@ -9840,7 +11354,7 @@ _bfd_mips_elf_write_section (bfd *output_bfd,
     return FALSE;
 
   to = contents;
-  end = contents + sec->size;
+  end = contents + sec->rawsize;
   for (from = contents, i = 0;
        from < end;
        from += PDR_SIZE, i++)
@@ -9855,6 +11369,46 @@ _bfd_mips_elf_write_section (bfd *output_bfd,
 			    sec->output_offset, sec->size);
   return TRUE;
 }
+
+/* Relocating a section against the GOT may allocate local GOT entries
+   on the fly, which only one process can do.  Without a GOT, all
+   _bfd_mips_elf_relocate_section changes is the section's contents.  */
+
+bfd_boolean
+_bfd_mips_elf_can_relocate_in_parallel (bfd *output_bfd ATTRIBUTE_UNUSED,
+					struct bfd_link_info *info)
+{
+  bfd *dynobj;
+  asection *sgot;
+
+  dynobj = elf_hash_table (info)->dynobj;
+  if (dynobj == NULL)
+    return TRUE;
+
+  sgot = mips_elf_got_section (dynobj, TRUE);
+  return sgot == NULL || sgot->size == 0;
+}
+
+/* Jumps, branches and Rigel's ljl only transfer control to their
+   target.  R_MIPS_JALR just marks a call whose address is loaded by
+   some other relocation.  */
+
+bfd_boolean
+_bfd_mips_elf_branch_reloc_p (bfd *abfd, const Elf_Internal_Rela *rel)
+{
+  switch (ELF_R_TYPE (abfd, rel->r_info))
+    {
+    case R_MIPS_NONE:
+    case R_MIPS_26:
+    case R_MIPS_PC16:
+    case R_MIPS16_26:
+    case R_MIPS_JALR:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
 
 /* MIPS ELF uses a special find_nearest_line routine in order the
    handle the ECOFF debugging information.  */
@@ -520,6 +520,12 @@
 #ifndef elf_backend_write_section
 #define elf_backend_write_section		NULL
 #endif
+#ifndef elf_backend_can_relocate_in_parallel
+#define elf_backend_can_relocate_in_parallel	NULL
+#endif
+#ifndef elf_backend_branch_reloc_p
+#define elf_backend_branch_reloc_p		NULL
+#endif
 #ifndef elf_backend_mips_irix_compat
 #define elf_backend_mips_irix_compat		NULL
 #endif
@@ -680,6 +686,8 @@ static struct elf_backend_data elfNN_bed =
   elf_backend_can_make_lsda_relative_eh_frame,
   elf_backend_encode_eh_address,
   elf_backend_write_section,
+  elf_backend_can_relocate_in_parallel,
+  elf_backend_branch_reloc_p,
   elf_backend_mips_irix_compat,
   elf_backend_mips_rtype_to_howto,
   elf_backend_ecoff_debug_swap,
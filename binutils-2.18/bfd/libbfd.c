@@ -816,6 +816,8 @@ _bfd_generic_get_section_contents (bfd *abfd,
 				   bfd_size_type count)
 {
   bfd_size_type sz;
+  const bfd_byte *view;
+
   if (count == 0)
     return TRUE;
 
@@ -827,6 +829,13 @@ _bfd_generic_get_section_contents (bfd *abfd,
       return FALSE;
     }
 
+  view = _bfd_get_file_view (abfd, section->filepos + offset, count);
+  if (view != NULL)
+    {
+      memcpy (location, view, count);
+      return TRUE;
+    }
+
   if (bfd_seek (abfd, section->filepos + offset, SEEK_SET) != 0
       || bfd_bread (location, count, abfd) != count)
     return FALSE;
@@ -781,6 +781,11 @@ bfd_boolean bfd_cache_init (bfd *abfd);
 
 bfd_boolean bfd_cache_close (bfd *abfd);
 
+const bfd_byte *_bfd_get_file_view
+   (bfd *abfd, file_ptr offset, bfd_size_type size);
+
+void _bfd_unmap_file (bfd *abfd);
+
 FILE* bfd_open_file (bfd *abfd);
 
 /* Extracted from reloc.c.  */
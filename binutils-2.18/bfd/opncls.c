@@ -116,6 +116,7 @@ _bfd_new_bfd_contained_in (bfd *obfd)
 void
 _bfd_delete_bfd (bfd *abfd)
 {
+  _bfd_unmap_file (abfd);
   if (abfd->memory)
     {
       bfd_hash_table_free (&abfd->section_htab);
@@ -0,0 +1,598 @@
+/* BFD back-end for Rigel simulator memory images.
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This file is part of BFD, the Binary File Descriptor library.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street - Fifth Floor, Boston,
+   MA 02110-1301, USA.  */
+
+/* A memory image holds the loadable sections of a program laid out so
+   that the Rigel simulator can map it straight into simulated memory,
+   without parsing an ELF file and walking its program headers.
+
+   The file starts with a header followed by a table of segment
+   descriptors.  Every field is a 32-bit little-endian word.
+
+   HEADER
+   0	Magic number, the bytes "RIMG"
+   4	Format version, 1
+   8	Page size in bytes, a power of two
+   12	Size of the header and the segment table in bytes
+   16	Entry point address
+   20	Number of segments
+   24	CRC-32 of the header and the segment table, computed with this
+	field zero
+   28	Reserved, zero
+
+   SEGMENT DESCRIPTOR
+   0	Load address
+   4	File offset of the contents
+   8	Size of the contents in the file
+   12	Size in memory; memory past the contents is zero
+   16	Flags: 1 readable, 2 writable, 4 executable
+   20	CRC-32 of the contents
+   24	Reserved, zero
+   28	Reserved, zero
+
+   The contents of a segment start at a file offset equal to its load
+   address modulo the page size, so the pages holding it can be mapped
+   directly, and no two segments share a page of the file.  The CRCs
+   are those of bfd_calc_gnu_debuglink_crc32, which is the usual CRC-32.
+
+   A segment is made of allocated sections in order of load address.
+   Sections with the same flags that are less than a page apart share a
+   segment, with any gap between them filled with zeroes.  So do
+   sections with different flags that meet in the same page, since the
+   page can only be mapped once; the segment gets the flags of all of
+   them.  Sections without contents only take up file space when a
+   section with contents follows them in the same segment.  */
+
+#include "sysdep.h"
+#include "bfd.h"
+#include "libbfd.h"
+
+#define RIGELIMG_MAGIC		"RIMG"
+#define RIGELIMG_VERSION	1
+#define RIGELIMG_PAGE_SIZE	0x1000
+
+#define RIGELIMG_HEADER_SIZE	32
+#define RIGELIMG_SEGMENT_SIZE	32
+
+/* Offsets of the header fields.  */
+#define RIGELIMG_H_MAGIC	0
+#define RIGELIMG_H_VERSION	4
+#define RIGELIMG_H_PAGE_SIZE	8
+#define RIGELIMG_H_SIZE		12
+#define RIGELIMG_H_ENTRY	16
+#define RIGELIMG_H_NSEGMENTS	20
+#define RIGELIMG_H_CRC		24
+
+/* Offsets of the segment descriptor fields.  */
+#define RIGELIMG_S_ADDR		0
+#define RIGELIMG_S_OFFSET	4
+#define RIGELIMG_S_FILESZ	8
+#define RIGELIMG_S_MEMSZ	12
+#define RIGELIMG_S_FLAGS	16
+#define RIGELIMG_S_CRC		20
+
+/* Segment flags.  */
+#define RIGELIMG_F_READ		1
+#define RIGELIMG_F_WRITE	2
+#define RIGELIMG_F_EXEC		4
+
+/* A segment of an image being written.  */
+
+struct rigelimg_segment
+{
+  bfd_vma addr;
+  bfd_size_type filesz;
+  bfd_size_type memsz;
+  file_ptr offset;
+  unsigned int flags;
+
+  /* The sections in the segment.  */
+  asection **sections;
+  unsigned int count;
+};
+
+/* Create a memory image.  Invoked via bfd_set_format.  */
+
+static bfd_boolean
+rigelimg_mkobject (bfd *abfd ATTRIBUTE_UNUSED)
+{
+  return TRUE;
+}
+
+/* Return the segment flags for section SEC.  */
+
+static unsigned int
+rigelimg_section_flags (asection *sec)
+{
+  unsigned int flags = RIGELIMG_F_READ;
+
+  if ((sec->flags & SEC_READONLY) == 0)
+    flags |= RIGELIMG_F_WRITE;
+  if ((sec->flags & SEC_CODE) != 0)
+    flags |= RIGELIMG_F_EXEC;
+  return flags;
+}
+
+/* Return TRUE if SEC has contents that go into the image file.  */
+
+static bfd_boolean
+rigelimg_section_has_contents (asection *sec)
+{
+  return ((sec->flags & (SEC_LOAD | SEC_HAS_CONTENTS | SEC_NEVER_LOAD))
+	  == (SEC_LOAD | SEC_HAS_CONTENTS));
+}
+
+/* Try to recognize a memory image.  */
+
+static const bfd_target *
+rigelimg_object_p (bfd *abfd)
+{
+  bfd_byte header[RIGELIMG_HEADER_SIZE];
+  bfd_byte *table;
+  bfd_size_type size;
+  unsigned int nsegments, i, index;
+  unsigned long crc;
+
+  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0)
+    return NULL;
+  if (bfd_bread (header, sizeof (header), abfd) != sizeof (header))
+    {
+      if (bfd_get_error () == bfd_error_file_truncated)
+	bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+
+  nsegments = bfd_getl32 (header + RIGELIMG_H_NSEGMENTS);
+  size = bfd_getl32 (header + RIGELIMG_H_SIZE);
+  if (memcmp (header + RIGELIMG_H_MAGIC, RIGELIMG_MAGIC, 4) != 0
+      || bfd_getl32 (header + RIGELIMG_H_VERSION) != RIGELIMG_VERSION
+      || (nsegments
+	  > (0xffffffff - RIGELIMG_HEADER_SIZE) / RIGELIMG_SEGMENT_SIZE)
+      || size != (RIGELIMG_HEADER_SIZE
+		  + (bfd_size_type) nsegments * RIGELIMG_SEGMENT_SIZE))
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      return NULL;
+    }
+
+  table = bfd_malloc (size);
+  if (table == NULL)
+    return NULL;
+  memcpy (table, header, sizeof (header));
+  if (bfd_bread (table + sizeof (header), size - sizeof (header), abfd)
+      != size - sizeof (header))
+    {
+      if (bfd_get_error () == bfd_error_file_truncated)
+	bfd_set_error (bfd_error_wrong_format);
+      goto error_return;
+    }
+
+  crc = bfd_getl32 (table + RIGELIMG_H_CRC);
+  bfd_putl32 (0, table + RIGELIMG_H_CRC);
+  if (bfd_calc_gnu_debuglink_crc32 (0, table, size) != crc)
+    {
+      bfd_set_error (bfd_error_wrong_format);
+      goto error_return;
+    }
+
+  /* OK, it looks like it really is a memory image.  Make a section for
+     the contents of each segment and another for the zeroes after
+     them.  */
+  index = 0;
+  for (i = 0; i < nsegments; i++)
+    {
+      bfd_byte *seg = table + RIGELIMG_HEADER_SIZE + i * RIGELIMG_SEGMENT_SIZE;
+      bfd_vma addr = bfd_getl32 (seg + RIGELIMG_S_ADDR);
+      bfd_size_type filesz = bfd_getl32 (seg + RIGELIMG_S_FILESZ);
+      bfd_size_type memsz = bfd_getl32 (seg + RIGELIMG_S_MEMSZ);
+      unsigned int segflags = bfd_getl32 (seg + RIGELIMG_S_FLAGS);
+      flagword flags;
+      asection *sec;
+      char buf[20];
+      char *name;
+
+      flags = SEC_ALLOC;
+      if ((segflags & RIGELIMG_F_WRITE) == 0)
+	flags |= SEC_READONLY;
+      if ((segflags & RIGELIMG_F_EXEC) != 0)
+	flags |= SEC_CODE;
+      else
+	flags |= SEC_DATA;
+
+      if (memsz < filesz)
+	memsz = filesz;
+      while (memsz != 0)
+	{
+	  sprintf (buf, ".sec%u", ++index);
+	  name = bfd_alloc (abfd, strlen (buf) + 1);
+	  if (name == NULL)
+	    goto error_return;
+	  strcpy (name, buf);
+
+	  if (filesz != 0)
+	    {
+	      sec = bfd_make_section_with_flags (abfd, name,
+						 flags | SEC_LOAD
+						 | SEC_HAS_CONTENTS);
+	      if (sec == NULL)
+		goto error_return;
+	      sec->size = filesz;
+	      sec->filepos = bfd_getl32 (seg + RIGELIMG_S_OFFSET);
+	    }
+	  else
+	    {
+	      sec = bfd_make_section_with_flags (abfd, name,
+						 flags & ~SEC_DATA);
+	      if (sec == NULL)
+		goto error_return;
+	      sec->size = memsz;
+	    }
+	  sec->vma = addr;
+	  sec->lma = addr;
+
+	  addr += sec->size;
+	  memsz -= sec->size;
+	  filesz = 0;
+	}
+    }
+
+  abfd->start_address = bfd_getl32 (header + RIGELIMG_H_ENTRY);
+  free (table);
+  return abfd->xvec;
+
+ error_return:
+  free (table);
+  return NULL;
+}
+
+/* Read the contents of a section of a memory image.  */
+
+static bfd_boolean
+rigelimg_get_section_contents (bfd *abfd,
+			       asection *section,
+			       void *location,
+			       file_ptr offset,
+			       bfd_size_type count)
+{
+  if (bfd_seek (abfd, section->filepos + offset, SEEK_SET) != 0
+      || bfd_bread (location, count, abfd) != count)
+    return FALSE;
+  return TRUE;
+}
+
+/* Set the architecture of a memory image.  The image does not record
+   it, so we ignore errors about unknown architectures.  */
+
+static bfd_boolean
+rigelimg_set_arch_mach (bfd *abfd,
+			enum bfd_architecture arch,
+			unsigned long mach)
+{
+  if (! bfd_default_set_arch_mach (abfd, arch, mach))
+    {
+      if (arch != bfd_arch_unknown)
+	return FALSE;
+    }
+  return TRUE;
+}
+
+/* Set the contents of a section of a memory image.  The layout of the
+   file is only known once all the sections have been created, so the
+   contents are held in memory until the file is written.  */
+
+static bfd_boolean
+rigelimg_set_section_contents (bfd *abfd,
+			       asection *section,
+			       const void *location,
+			       file_ptr offset,
+			       bfd_size_type count)
+{
+  bfd_byte *contents;
+
+  if (count == 0
+      || (section->flags & SEC_ALLOC) == 0
+      || !rigelimg_section_has_contents (section))
+    return TRUE;
+
+  if (offset < 0 || (bfd_size_type) offset + count > section->size)
+    {
+      bfd_set_error (bfd_error_bad_value);
+      return FALSE;
+    }
+
+  contents = section->used_by_bfd;
+  if (contents == NULL)
+    {
+      contents = bfd_zalloc (abfd, section->size);
+      if (contents == NULL)
+	return FALSE;
+      section->used_by_bfd = contents;
+    }
+  memcpy (contents + offset, location, (size_t) count);
+  return TRUE;
+}
+
+/* qsort comparison function to order sections by load address.  */
+
+static int
+rigelimg_section_cmp (const void *p1, const void *p2)
+{
+  const asection *s1 = *(const asection **) p1;
+  const asection *s2 = *(const asection **) p2;
+
+  if (s1->lma != s2->lma)
+    return s1->lma < s2->lma ? -1 : 1;
+  if (s1->index != s2->index)
+    return s1->index < s2->index ? -1 : 1;
+  return 0;
+}
+
+/* Group the allocated sections of ABFD into segments, and lay them out
+   in the file.  Return the number of segments in *PCOUNT.  */
+
+static struct rigelimg_segment *
+rigelimg_make_segments (bfd *abfd, unsigned int *pcount)
+{
+  struct rigelimg_segment *segs, *seg;
+  asection **sections, *s;
+  unsigned int count, nsegs, i;
+  bfd_boolean new_seg;
+  file_ptr pos;
+
+  sections = bfd_alloc (abfd, (abfd->section_count + 1) * sizeof (*sections));
+  segs = bfd_zalloc (abfd, (abfd->section_count + 1) * sizeof (*segs));
+  if (sections == NULL || segs == NULL)
+    return NULL;
+
+  count = 0;
+  for (s = abfd->sections; s != NULL; s = s->next)
+    if ((s->flags & SEC_ALLOC) != 0 && s->size != 0)
+      sections[count++] = s;
+  qsort (sections, count, sizeof (*sections), rigelimg_section_cmp);
+
+  nsegs = 0;
+  seg = NULL;
+  for (i = 0; i < count; i++)
+    {
+      s = sections[i];
+      if (s->lma + s->size - 1 > 0xffffffff)
+	{
+	  (*_bfd_error_handler)
+	    (_("%B: section `%A' does not fit in a 32-bit memory image"),
+	     abfd, s);
+	  bfd_set_error (bfd_error_bad_value);
+	  return NULL;
+	}
+
+      new_seg = TRUE;
+      if (seg != NULL && s->lma >= seg->addr + seg->memsz)
+	{
+	  bfd_vma end = seg->addr + seg->memsz;
+
+	  /* Carry on if S starts in the page SEG ends in, or is like SEG
+	     and close by.  */
+	  new_seg = ((((end - 1) ^ s->lma) & -(bfd_vma) RIGELIMG_PAGE_SIZE) != 0
+		     && (seg->flags != rigelimg_section_flags (s)
+			 || s->lma - end >= RIGELIMG_PAGE_SIZE));
+	}
+      if (new_seg)
+	{
+	  seg = &segs[nsegs++];
+	  seg->addr = s->lma;
+	  seg->sections = sections + i;
+	}
+      seg->flags |= rigelimg_section_flags (s);
+      seg->count++;
+      seg->memsz = s->lma + s->size - seg->addr;
+      if (rigelimg_section_has_contents (s))
+	seg->filesz = seg->memsz;
+    }
+
+  pos = RIGELIMG_HEADER_SIZE + nsegs * RIGELIMG_SEGMENT_SIZE;
+  for (i = 0; i < nsegs; i++)
+    {
+      seg = &segs[i];
+      if (seg->filesz == 0)
+	continue;
+      pos = (pos + RIGELIMG_PAGE_SIZE - 1) & -(file_ptr) RIGELIMG_PAGE_SIZE;
+      seg->offset = pos + (seg->addr & (RIGELIMG_PAGE_SIZE - 1));
+      pos = seg->offset + seg->filesz;
+    }
+
+  *pcount = nsegs;
+  return segs;
+}
+
+/* Write out a memory image.  */
+
+static bfd_boolean
+rigelimg_write_object_contents (bfd *abfd)
+{
+  struct rigelimg_segment *segs;
+  bfd_byte *table, *buf = NULL;
+  bfd_size_type size, bufsize = 0;
+  unsigned int nsegs, i, j;
+
+  segs = rigelimg_make_segments (abfd, &nsegs);
+  if (segs == NULL)
+    return FALSE;
+
+  size = RIGELIMG_HEADER_SIZE + nsegs * RIGELIMG_SEGMENT_SIZE;
+  table = bfd_zalloc (abfd, size);
+  if (table == NULL)
+    return FALSE;
+
+  for (i = 0; i < nsegs; i++)
+    {
+      struct rigelimg_segment *seg = &segs[i];
+      bfd_byte *desc = table + RIGELIMG_HEADER_SIZE + i * RIGELIMG_SEGMENT_SIZE;
+      unsigned long crc = 0;
+
+      if (seg->filesz != 0)
+	{
+	  /* Build the contents of the segment, zeroes and all.  */
+	  if (seg->filesz > bufsize)
+	    {
+	      free (buf);
+	      bufsize = seg->filesz;
+	      buf = bfd_malloc (bufsize);
+	      if (buf == NULL)
+		return FALSE;
+	    }
+	  memset (buf, 0, seg->filesz);
+	  for (j = 0; j < seg->count; j++)
+	    {
+	      asection *s = seg->sections[j];
+
+	      if (s->used_by_bfd != NULL && s->lma - seg->addr < seg->filesz)
+		memcpy (buf + (s->lma - seg->addr), s->used_by_bfd,
+			(size_t) s->size);
+	    }
+
+	  crc = bfd_calc_gnu_debuglink_crc32 (0, buf, seg->filesz);
+	  if (bfd_seek (abfd, seg->offset, SEEK_SET) != 0
+	      || bfd_bwrite (buf, seg->filesz, abfd) != seg->filesz)
+	    {
+	      free (buf);
+	      return FALSE;
+	    }
+	}
+
+      bfd_putl32 (seg->addr, desc + RIGELIMG_S_ADDR);
+      bfd_putl32 (seg->offset, desc + RIGELIMG_S_OFFSET);
+      bfd_putl32 (seg->filesz, desc + RIGELIMG_S_FILESZ);
+      bfd_putl32 (seg->memsz, desc + RIGELIMG_S_MEMSZ);
+      bfd_putl32 (seg->flags, desc + RIGELIMG_S_FLAGS);
+      bfd_putl32 (crc, desc + RIGELIMG_S_CRC);
+    }
+  if (buf != NULL)
+    free (buf);
+
+  memcpy (table + RIGELIMG_H_MAGIC, RIGELIMG_MAGIC, 4);
+  bfd_putl32 (RIGELIMG_VERSION, table + RIGELIMG_H_VERSION);
+  bfd_putl32 (RIGELIMG_PAGE_SIZE, table + RIGELIMG_H_PAGE_SIZE);
+  bfd_putl32 (size, table + RIGELIMG_H_SIZE);
+  bfd_putl32 (bfd_get_start_address (abfd), table + RIGELIMG_H_ENTRY);
+  bfd_putl32 (nsegs, table + RIGELIMG_H_NSEGMENTS);
+  bfd_putl32 (bfd_calc_gnu_debuglink_crc32 (0, table, size),
+	      table + RIGELIMG_H_CRC);
+
+  if (bfd_seek (abfd, (file_ptr) 0, SEEK_SET) != 0
+      || bfd_bwrite (table, size, abfd) != size)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* No space is required for header information.  */
+
+static int
+rigelimg_sizeof_headers (bfd *abfd ATTRIBUTE_UNUSED,
+			 struct bfd_link_info *info ATTRIBUTE_UNUSED)
+{
+  return 0;
+}
+
+/* Some random definitions for the target vector.  */
+
+#define	rigelimg_close_and_cleanup                _bfd_generic_close_and_cleanup
+#define rigelimg_bfd_free_cached_info             _bfd_generic_bfd_free_cached_info
+#define rigelimg_new_section_hook                 _bfd_generic_new_section_hook
+#define rigelimg_get_section_contents_in_window   _bfd_generic_get_section_contents_in_window
+#define rigelimg_get_symtab_upper_bound           bfd_0l
+#define rigelimg_canonicalize_symtab              ((long (*) (bfd *, asymbol **)) bfd_0l)
+#define rigelimg_make_empty_symbol                _bfd_generic_make_empty_symbol
+#define rigelimg_print_symbol                     _bfd_nosymbols_print_symbol
+#define rigelimg_get_symbol_info                  _bfd_nosymbols_get_symbol_info
+#define rigelimg_bfd_is_target_special_symbol     ((bfd_boolean (*) (bfd *, asymbol *)) bfd_false)
+#define rigelimg_bfd_is_local_label_name          _bfd_nosymbols_bfd_is_local_label_name
+#define rigelimg_get_lineno                       _bfd_nosymbols_get_lineno
+#define rigelimg_find_nearest_line                _bfd_nosymbols_find_nearest_line
+#define rigelimg_find_inliner_info                _bfd_nosymbols_find_inliner_info
+#define rigelimg_bfd_make_debug_symbol            _bfd_nosymbols_bfd_make_debug_symbol
+#define rigelimg_read_minisymbols                 _bfd_nosymbols_read_minisymbols
+#define rigelimg_minisymbol_to_symbol             _bfd_nosymbols_minisymbol_to_symbol
+#define rigelimg_bfd_get_relocated_section_contents bfd_generic_get_relocated_section_contents
+#define rigelimg_bfd_relax_section                bfd_generic_relax_section
+#define rigelimg_bfd_gc_sections                  bfd_generic_gc_sections
+#define rigelimg_bfd_merge_sections               bfd_generic_merge_sections
+#define rigelimg_bfd_is_group_section             bfd_generic_is_group_section
+#define rigelimg_bfd_discard_group                bfd_generic_discard_group
+#define rigelimg_section_already_linked           _bfd_generic_section_already_linked
+#define rigelimg_bfd_link_hash_table_create       _bfd_generic_link_hash_table_create
+#define rigelimg_bfd_link_hash_table_free         _bfd_generic_link_hash_table_free
+#define rigelimg_bfd_link_add_symbols             _bfd_generic_link_add_symbols
+#define rigelimg_bfd_link_just_syms               _bfd_generic_link_just_syms
+#define rigelimg_bfd_final_link                   _bfd_generic_final_link
+#define rigelimg_bfd_link_split_section           _bfd_generic_link_split_section
+
+/* The Rigel memory image target vector.  */
+
+const bfd_target rigelimg_vec =
+{
+  "rigel-image",		/* Name.  */
+  bfd_target_unknown_flavour,
+  BFD_ENDIAN_UNKNOWN,		/* Target byte order.  */
+  BFD_ENDIAN_LITTLE,		/* Target headers byte order.  */
+  EXEC_P,			/* Object flags.  */
+  (SEC_ALLOC | SEC_LOAD | SEC_READONLY | SEC_CODE | SEC_DATA
+   | SEC_HAS_CONTENTS),		/* Section flags.  */
+  0,				/* Leading underscore.  */
+  ' ',				/* AR_pad_char.  */
+  16,				/* AR_max_namelen.  */
+  bfd_getl64, bfd_getl_signed_64, bfd_putl64,
+  bfd_getl32, bfd_getl_signed_32, bfd_putl32,
+  bfd_getl16, bfd_getl_signed_16, bfd_putl16,	/* Data.  */
+  bfd_getl64, bfd_getl_signed_64, bfd_putl64,
+  bfd_getl32, bfd_getl_signed_32, bfd_putl32,
+  bfd_getl16, bfd_getl_signed_16, bfd_putl16,	/* Headers. */
+
+  {
+    _bfd_dummy_target,
+    rigelimg_object_p,		/* bfd_check_format.  */
+    _bfd_dummy_target,
+    _bfd_dummy_target,
+  },
+  {
+    bfd_false,
+    rigelimg_mkobject,
+    bfd_false,
+    bfd_false,
+  },
+  {				/* bfd_write_contents.  */
+    bfd_false,
+    rigelimg_write_object_contents,
+    bfd_false,
+    bfd_false,
+  },
+
+  BFD_JUMP_TABLE_GENERIC (rigelimg),
+  BFD_JUMP_TABLE_COPY (_bfd_generic),
+  BFD_JUMP_TABLE_CORE (_bfd_nocore),
+  BFD_JUMP_TABLE_ARCHIVE (_bfd_noarchive),
+  BFD_JUMP_TABLE_SYMBOLS (rigelimg),
+  BFD_JUMP_TABLE_RELOCS (_bfd_norelocs),
+  BFD_JUMP_TABLE_WRITE (rigelimg),
+  BFD_JUMP_TABLE_LINK (rigelimg),
+  BFD_JUMP_TABLE_DYNAMIC (_bfd_nodynamic),
+
+  NULL,
+
+  NULL
+};
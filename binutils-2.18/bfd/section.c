@@ -373,6 +373,7 @@ CODE_FRAGMENT
 .#define ELF_INFO_TYPE_MERGE     2
 .#define ELF_INFO_TYPE_EH_FRAME  3
 .#define ELF_INFO_TYPE_JUST_SYMS 4
+.#define ELF_INFO_TYPE_FOLDED    5
 .
 .  {* Nonzero if this section uses RELA relocations, rather than REL.  *}
 .  unsigned int use_rela_p:1;
@@ -813,6 +813,7 @@ extern const bfd_target symbolsrec_vec;
 extern const bfd_target tekhex_vec;
 extern const bfd_target binary_vec;
 extern const bfd_target ihex_vec;
+extern const bfd_target rigelimg_vec;
 
 /* All of the xvecs for core files.  */
 extern const bfd_target aix386_core_vec;
@@ -1195,6 +1196,8 @@ static const bfd_target * const _bfd_target_vector[] =
 	&binary_vec,
 /* Likewise for ihex.  */
 	&ihex_vec,
+/* And Rigel simulator memory images.  */
+	&rigelimg_vec,
 
 /* Add any required traditional-core-file-handler.  */
 
@@ -29,7 +29,11 @@
    addr2line [options]
 
    both forms write results to stdout, the second form reads addresses
-   to be converted from stdin.  */
+   to be converted from stdin.
+
+   With --batch the answer for every code address is worked out once,
+   into a sorted table of address ranges that may be cached in a
+   sidecar file, and each query is then a binary search.  */
 
 #include "sysdep.h"
 #include "bfd.h"
@@ -37,24 +41,46 @@
 #include "libiberty.h"
 #include "demangle.h"
 #include "bucomm.h"
+#include <sys/stat.h>
+#ifdef HAVE_SYS_WAIT_H
+#include <sys/wait.h>
+#endif
 
 static bfd_boolean unwind_inlines;	/* -i, unwind inlined functions. */
 static bfd_boolean with_functions;	/* -f, show function names.  */
 static bfd_boolean do_demangle;		/* -C, demangle names.  */
 static bfd_boolean base_names;		/* -s, strip directory names.  */
+static bfd_boolean batch_mode;		/* -B, answer from an address index.  */
+static char *index_cache;		/* --index-cache, sidecar file.  */
+static int njobs = 1;			/* --jobs, worker processes.  */
 
 static int naddr;		/* Number of addresses to process.  */
 static char **addr;		/* Hex addresses to process.  */
 
 static asymbol **syms;		/* Symbol table.  */
 
+/* The file being examined.  Worker processes reopen it by name rather
+   than share the parent's file position.  */
+
+static const char *exe_name;
+static const char *exe_target;
+static const char *exe_section_name;
+static bfd *exe_bfd;
+static asection *exe_section;
+
+#define OPTION_INDEX_CACHE	150
+#define OPTION_JOBS		(OPTION_INDEX_CACHE + 1)
+
 static struct option long_options[] =
 {
   {"basenames", no_argument, NULL, 's'},
+  {"batch", no_argument, NULL, 'B'},
   {"demangle", optional_argument, NULL, 'C'},
   {"exe", required_argument, NULL, 'e'},
   {"functions", no_argument, NULL, 'f'},
+  {"index-cache", optional_argument, NULL, OPTION_INDEX_CACHE},
   {"inlines", no_argument, NULL, 'i'},
+  {"jobs", required_argument, NULL, OPTION_JOBS},
   {"section", required_argument, NULL, 'j'},
   {"target", required_argument, NULL, 'b'},
   {"help", no_argument, NULL, 'H'},
@@ -62,12 +88,47 @@ static struct option long_options[] =
   {0, no_argument, 0, 0}
 };
 
+/* A growable buffer of answer text.  */
+
+struct answer_buf
+{
+  char *data;
+  size_t len;
+  size_t alloc;
+};
+
+/* One run of the address index: every address in [START, END) gets
+   the NUL-terminated answer at offset ANSWER of the string pool.  */
+
+struct index_range
+{
+  bfd_vma start;
+  bfd_vma end;
+  size_t answer;
+};
+
+/* A stretch of addresses covered by the index.  */
+
+struct index_span
+{
+  bfd_vma base;
+  bfd_size_type size;
+  bfd_size_type first;		/* Number of granules in earlier spans.  */
+};
+
+static struct index_range *ranges;
+static size_t nranges;
+static struct answer_buf pool;
+
+static const char index_magic[] = "addr2line index 1\n";
+
 static void usage (FILE *, int);
 static void slurp_symtab (bfd *);
 static void find_address_in_section (bfd *, asection *, void *);
 static void find_offset_in_section (bfd *, asection *);
 static void translate_addresses (bfd *, asection *);
-
+static void batch_translate (void);
+
 /* Print a usage message to STREAM and exit with STATUS.  */
 
 static void
@@ -85,6 +146,10 @@ usage (FILE *stream, int status)
   -s --basenames         Strip directory names\n\
   -f --functions         Show function names\n\
   -C --demangle[=style]  Demangle function names\n\
+  -B --batch             Answer queries from an index built once\n\
+     --index-cache[=<file>]  Keep the --batch index in <file>\n\
+                         (default <executable>.a2l)\n\
+     --jobs=<n>          Use <n> worker processes in --batch mode\n\
   -h --help              Display this information\n\
   -v --version           Display the program's version\n\
 \n"));
@@ -94,7 +159,7 @@ usage (FILE *stream, int status)
     fprintf (stream, _("Report bugs to %s\n"), REPORT_BUGS_TO);
   exit (status);
 }
-
+
 /* Read in the symbol table.  */
 
 static void
@@ -113,7 +178,7 @@ slurp_symtab (bfd *abfd)
   if (symcount < 0)
     bfd_fatal (bfd_get_filename (abfd));
 }
-
+
 /* These global variables are used to pass information between
    translate_addresses and find_address_in_section.  */
 
@@ -172,6 +237,92 @@ find_offset_in_section (bfd *abfd, asection *section)
 				 &filename, &functionname, &line);
 }
 
+/* Append LEN bytes at S to BUF.  */
+
+static void
+buf_add (struct answer_buf *buf, const char *s, size_t len)
+{
+  if (buf->len + len > buf->alloc)
+    {
+      buf->alloc = (buf->len + len) * 2 + 256;
+      buf->data = xrealloc (buf->data, buf->alloc);
+    }
+  memcpy (buf->data + buf->len, s, len);
+  buf->len += len;
+}
+
+static void
+buf_add_str (struct answer_buf *buf, const char *s)
+{
+  buf_add (buf, s, strlen (s));
+}
+
+/* Look up PC in ABFD, either as an address or as an offset into
+   SECTION, and append the text addr2line prints for it to OUT.  */
+
+static void
+lookup_address (bfd *abfd, asection *section, bfd_vma addr,
+		struct answer_buf *out)
+{
+  pc = addr;
+  found = FALSE;
+  if (section)
+    find_offset_in_section (abfd, section);
+  else
+    bfd_map_over_sections (abfd, find_address_in_section, NULL);
+
+  if (! found)
+    {
+      if (with_functions)
+	buf_add_str (out, "??\n");
+      buf_add_str (out, "??:0\n");
+      return;
+    }
+
+  do {
+    char num[32];
+
+    if (with_functions)
+      {
+	const char *name;
+	char *alloc = NULL;
+
+	name = functionname;
+	if (name == NULL || *name == '\0')
+	  name = "??";
+	else if (do_demangle)
+	  {
+	    alloc = bfd_demangle (abfd, name, DMGL_ANSI | DMGL_PARAMS);
+	    if (alloc != NULL)
+	      name = alloc;
+	  }
+
+	buf_add_str (out, name);
+	buf_add_str (out, "\n");
+
+	if (alloc != NULL)
+	  free (alloc);
+      }
+
+    if (base_names && filename != NULL)
+      {
+	char *h;
+
+	h = strrchr (filename, '/');
+	if (h != NULL)
+	  filename = h + 1;
+      }
+
+    buf_add_str (out, filename ? filename : "??");
+    sprintf (num, ":%u\n", line);
+    buf_add_str (out, num);
+    if (!unwind_inlines)
+      found = FALSE;
+    else
+      found = bfd_find_inliner_info (abfd, &filename, &functionname, &line);
+  } while (found);
+}
+
 /* Read hexadecimal addresses from stdin, translate into
    file_name:line_number and optionally function name.  */
 
@@ -179,78 +330,31 @@ static void
 translate_addresses (bfd *abfd, asection *section)
 {
   int read_stdin = (naddr == 0);
+  struct answer_buf out = { NULL, 0, 0 };
 
   for (;;)
     {
+      bfd_vma a;
+
       if (read_stdin)
 	{
 	  char addr_hex[100];
 
 	  if (fgets (addr_hex, sizeof addr_hex, stdin) == NULL)
 	    break;
-	  pc = bfd_scan_vma (addr_hex, NULL, 16);
+	  a = bfd_scan_vma (addr_hex, NULL, 16);
 	}
       else
 	{
 	  if (naddr <= 0)
 	    break;
 	  --naddr;
-	  pc = bfd_scan_vma (*addr++, NULL, 16);
-	}
-
-      found = FALSE;
-      if (section)
-	find_offset_in_section (abfd, section);
-      else
-	bfd_map_over_sections (abfd, find_address_in_section, NULL);
-
-      if (! found)
-	{
-	  if (with_functions)
-	    printf ("??\n");
-	  printf ("??:0\n");
+	  a = bfd_scan_vma (*addr++, NULL, 16);
 	}
-      else
-	{
-	  do {
-	    if (with_functions)
-	      {
-		const char *name;
-		char *alloc = NULL;
-
-		name = functionname;
-		if (name == NULL || *name == '\0')
-		  name = "??";
-		else if (do_demangle)
-		  {
-		    alloc = bfd_demangle (abfd, name, DMGL_ANSI | DMGL_PARAMS);
-		    if (alloc != NULL)
-		      name = alloc;
-		  }
-
-		printf ("%s\n", name);
-
-		if (alloc != NULL)
-		  free (alloc);
-	      }
-
-	    if (base_names && filename != NULL)
-	      {
-		char *h;
-
-		h = strrchr (filename, '/');
-		if (h != NULL)
-		  filename = h + 1;
-	      }
-
-	    printf ("%s:%u\n", filename ? filename : "??", line);
-	    if (!unwind_inlines)
-	      found = FALSE;
-	    else
-	      found = bfd_find_inliner_info (abfd, &filename, &functionname, &line);
-	  } while (found);
 
-	}
+      out.len = 0;
+      lookup_address (abfd, section, a, &out);
+      fwrite (out.data, 1, out.len, stdout);
 
       /* fflush() is essential for using this command as a server
          child process that reads addresses from a pipe and responds
@@ -258,21 +362,18 @@ translate_addresses (bfd *abfd, asection *section)
          time.  */
       fflush (stdout);
     }
+
+  free (out.data);
 }
 
-/* Process a file.  Returns an exit value for main().  */
+/* Open FILE_NAME as an object file of format TARGET.  */
 
-static int
-process_file (const char *file_name, const char *section_name,
-	      const char *target)
+static bfd *
+open_file (const char *file_name, const char *target)
 {
   bfd *abfd;
-  asection *section;
   char **matching;
 
-  if (get_file_size (file_name) < 1)
-    return 1;
-
   abfd = bfd_openr (file_name, target);
   if (abfd == NULL)
     bfd_fatal (file_name);
@@ -291,6 +392,733 @@ process_file (const char *file_name, const char *section_name,
       xexit (1);
     }
 
+  return abfd;
+}
+
+/* Return the bfd and section lookups should use in this process,
+   opening the file again if this is a freshly forked worker.  */
+
+static bfd *
+current_bfd (void)
+{
+  if (exe_bfd == NULL)
+    {
+      exe_bfd = open_file (exe_name, exe_target);
+      syms = NULL;
+      slurp_symtab (exe_bfd);
+      exe_section = NULL;
+      if (exe_section_name != NULL)
+	exe_section = bfd_get_section_by_name (exe_bfd, exe_section_name);
+    }
+  return exe_bfd;
+}
+
+/* Run WORK for jobs 0 .. N-1, in separate processes where we can, and
+   return a temporary file per job holding what it wrote, rewound and
+   ready to read.  */
+
+static FILE **
+run_jobs (int n, void (*work) (int, FILE *, void *), void *arg)
+{
+  FILE **out;
+  int i;
+#ifdef HAVE_SYS_WAIT_H
+  pid_t *pids;
+
+  pids = xmalloc (n * sizeof (*pids));
+#endif
+  out = xmalloc (n * sizeof (*out));
+
+  fflush (stdout);
+  for (i = 0; i < n; i++)
+    {
+      out[i] = tmpfile ();
+      if (out[i] == NULL)
+	fatal (_("cannot create temporary file: %s"), strerror (errno));
+
+#ifdef HAVE_SYS_WAIT_H
+      pids[i] = n > 1 ? fork () : -1;
+      if (pids[i] == 0)
+	{
+	  exe_bfd = NULL;
+	  work (i, out[i], arg);
+	  _exit (fflush (out[i]) != 0 || ferror (out[i]));
+	}
+      if (pids[i] > 0)
+	continue;
+#endif
+      work (i, out[i], arg);
+    }
+
+  for (i = 0; i < n; i++)
+    {
+#ifdef HAVE_SYS_WAIT_H
+      int status;
+
+      if (pids[i] > 0
+	  && (waitpid (pids[i], &status, 0) != pids[i]
+	      || !WIFEXITED (status) || WEXITSTATUS (status) != 0))
+	fatal (_("worker process %d failed"), i);
+#endif
+      if (fflush (out[i]) != 0 || ferror (out[i]))
+	fatal (_("error writing temporary file: %s"), strerror (errno));
+      rewind (out[i]);
+    }
+
+#ifdef HAVE_SYS_WAIT_H
+  free (pids);
+#endif
+  return out;
+}
+
+/* The distance between addresses sampled when building the index.
+   Every instruction, and so every line table row and symbol that can
+   start a new answer, begins on a multiple of this.  */
+
+static unsigned int
+index_granule (bfd *abfd)
+{
+  switch (bfd_get_arch (abfd))
+    {
+    case bfd_arch_alpha:
+    case bfd_arch_mips:		/* Rigel has no MIPS16.  */
+    case bfd_arch_powerpc:
+    case bfd_arch_rs6000:
+    case bfd_arch_sparc:
+      return 4;
+    case bfd_arch_arm:
+    case bfd_arch_m68k:
+    case bfd_arch_sh:
+      return 2;
+    default:
+      return 1;
+    }
+}
+
+/* Work out which stretches of addresses the index covers: code
+   sections, in address order, skipping any that overlap.  */
+
+static struct index_span *
+index_spans (bfd *abfd, asection *section, unsigned int granule,
+	     int *nspans)
+{
+  struct index_span *spans;
+  asection *s;
+  int n, i;
+
+  n = 0;
+  spans = xmalloc ((bfd_count_sections (abfd) + 1) * sizeof (*spans));
+  for (s = abfd->sections; s != NULL; s = s->next)
+    {
+      flagword flags = bfd_get_section_flags (abfd, s);
+
+      if ((flags & (SEC_ALLOC | SEC_CODE)) != (SEC_ALLOC | SEC_CODE)
+	  || bfd_get_section_size (s) == 0
+	  || (section != NULL && s != section))
+	continue;
+
+      spans[n].base = section != NULL ? 0 : bfd_get_section_vma (abfd, s);
+      spans[n].size = bfd_get_section_size (s);
+
+      /* Keep the spans sorted by address.  */
+      for (i = n; i > 0 && spans[i - 1].base > spans[i].base; i--)
+	{
+	  struct index_span t = spans[i];
+
+	  spans[i] = spans[i - 1];
+	  spans[i - 1] = t;
+	}
+      n++;
+    }
+
+  for (i = 0; i < n; i++)
+    if (i > 0 && spans[i].base < spans[i - 1].base + spans[i - 1].size)
+      {
+	memmove (&spans[i], &spans[i + 1], (n - i - 1) * sizeof (*spans));
+	n--;
+	i--;
+      }
+
+  for (i = 0; i < n; i++)
+    spans[i].first = (i == 0 ? 0
+		      : (spans[i - 1].first
+			 + (spans[i - 1].size + granule - 1) / granule));
+
+  *nspans = n;
+  return spans;
+}
+
+struct index_job
+{
+  struct index_span *spans;
+  int nspans;
+  unsigned int granule;
+  bfd_size_type ngranules;
+};
+
+/* Write the run from START to END with answer TEXT to OUT.  */
+
+static void
+write_run (FILE *out, bfd_vma start, bfd_vma end, struct answer_buf *text)
+{
+  fwrite (&start, sizeof (start), 1, out);
+  fwrite (&end, sizeof (end), 1, out);
+  fwrite (&text->len, sizeof (text->len), 1, out);
+  fwrite (text->data, 1, text->len, out);
+}
+
+/* Index this job's share of the granules, writing a run to OUT
+   whenever the answer changes.  */
+
+static void
+index_job (int job, FILE *out, void *arg)
+{
+  struct index_job *ij = (struct index_job *) arg;
+  struct answer_buf cur = { NULL, 0, 0 };
+  struct answer_buf next = { NULL, 0, 0 };
+  bfd_size_type g, lo, hi;
+  bfd_vma start = 0, end = 0;
+  bfd *abfd;
+  int i;
+
+  abfd = current_bfd ();
+  lo = ij->ngranules * job / njobs;
+  hi = ij->ngranules * (job + 1) / njobs;
+
+  for (i = 0; i < ij->nspans && lo < hi; i++)
+    {
+      struct index_span *sp = &ij->spans[i];
+      bfd_size_type count = (sp->size + ij->granule - 1) / ij->granule;
+
+      for (g = lo; g < hi && g < sp->first + count; g++)
+	{
+	  bfd_vma a;
+	  bfd_vma a_end;
+
+	  a = sp->base + (g - sp->first) * ij->granule;
+	  a_end = a + ij->granule;
+	  if (a_end > sp->base + sp->size)
+	    a_end = sp->base + sp->size;
+
+	  next.len = 0;
+	  lookup_address (abfd, exe_section, a, &next);
+	  if (cur.len != 0 && end == a
+	      && next.len == cur.len
+	      && memcmp (next.data, cur.data, cur.len) == 0)
+	    {
+	      end = a_end;
+	      continue;
+	    }
+
+	  if (cur.len != 0)
+	    write_run (out, start, end, &cur);
+	  cur.len = 0;
+	  buf_add (&cur, next.data, next.len);
+	  start = a;
+	  end = a_end;
+	}
+      lo = g;
+    }
+
+  if (cur.len != 0)
+    write_run (out, start, end, &cur);
+
+  free (cur.data);
+  free (next.data);
+}
+
+/* Read back the runs the index jobs wrote to IN, appending them to the
+   index and joining them with the previous run where they continue
+   it.  */
+
+static void
+read_runs (FILE *in)
+{
+  static size_t ranges_alloc;
+  struct answer_buf text = { NULL, 0, 0 };
+  bfd_vma start, end;
+  size_t len;
+
+  while (fread (&start, sizeof (start), 1, in) == 1)
+    {
+      if (fread (&end, sizeof (end), 1, in) != 1
+	  || fread (&len, sizeof (len), 1, in) != 1)
+	fatal (_("error reading temporary file"));
+
+      text.len = 0;
+      if (len > 0)
+	{
+	  if (text.alloc < len)
+	    {
+	      text.alloc = len;
+	      text.data = xrealloc (text.data, text.alloc);
+	    }
+	  if (fread (text.data, 1, len, in) != len)
+	    fatal (_("error reading temporary file"));
+	  text.len = len;
+	}
+
+      if (nranges > 0
+	  && ranges[nranges - 1].end == start
+	  && strlen (pool.data + ranges[nranges - 1].answer) == len
+	  && memcmp (pool.data + ranges[nranges - 1].answer,
+		     text.data, len) == 0)
+	{
+	  ranges[nranges - 1].end = end;
+	  continue;
+	}
+
+      if (nranges == ranges_alloc)
+	{
+	  ranges_alloc = ranges_alloc * 2 + 256;
+	  ranges = xrealloc (ranges, ranges_alloc * sizeof (*ranges));
+	}
+      ranges[nranges].start = start;
+      ranges[nranges].end = end;
+      ranges[nranges].answer = pool.len;
+      nranges++;
+      buf_add (&pool, text.data, len);
+      buf_add (&pool, "", 1);
+    }
+
+  free (text.data);
+}
+
+/* Build the address index for ABFD.  */
+
+static void
+build_index (bfd *abfd)
+{
+  struct index_job ij;
+  FILE **out;
+  int i;
+
+  ij.granule = index_granule (abfd);
+  ij.spans = index_spans (abfd, exe_section, ij.granule, &ij.nspans);
+  ij.ngranules = 0;
+  if (ij.nspans > 0)
+    {
+      struct index_span *last = &ij.spans[ij.nspans - 1];
+
+      ij.ngranules = last->first + (last->size + ij.granule - 1) / ij.granule;
+    }
+
+  out = run_jobs (njobs, index_job, &ij);
+  for (i = 0; i < njobs; i++)
+    {
+      read_runs (out[i]);
+      fclose (out[i]);
+    }
+
+  free (out);
+  free (ij.spans);
+}
+
+/* Return a string identifying both the contents of ABFD and every
+   option that affects the answers, so that a cached index is only
+   used for the file and settings it was built for.  The GNU build ID
+   note identifies the contents if there is one; otherwise the file's
+   size and modification time do.  */
+
+static char *
+index_key (bfd *abfd)
+{
+  static const unsigned int one = 1;
+  struct answer_buf key = { NULL, 0, 0 };
+  asection *note;
+  char tmp[200];
+
+  note = bfd_get_section_by_name (abfd, ".note.gnu.build-id");
+  if (note != NULL && bfd_get_section_size (note) >= 16)
+    {
+      bfd_byte *contents;
+
+      if (bfd_malloc_and_get_section (abfd, note, &contents))
+	{
+	  bfd_size_type size = bfd_get_section_size (note);
+	  unsigned long namesz = bfd_get_32 (abfd, contents);
+	  unsigned long descsz = bfd_get_32 (abfd, contents + 4);
+	  unsigned long type = bfd_get_32 (abfd, contents + 8);
+	  bfd_size_type desc = 12 + ((namesz + 3) & ~(unsigned long) 3);
+
+	  if (type == 3 /* NT_GNU_BUILD_ID */
+	      && desc + descsz <= size && descsz > 0)
+	    {
+	      unsigned long j;
+
+	      buf_add_str (&key, "build-id=");
+	      for (j = 0; j < descsz; j++)
+		{
+		  sprintf (tmp, "%02x", contents[desc + j]);
+		  buf_add_str (&key, tmp);
+		}
+	    }
+	  free (contents);
+	}
+    }
+
+  if (key.len == 0)
+    {
+      struct stat st;
+
+      if (stat (exe_name, &st) != 0)
+	fatal (_("%s: %s"), exe_name, strerror (errno));
+      sprintf (tmp, "size=%lu mtime=%lu",
+	       (unsigned long) st.st_size, (unsigned long) st.st_mtime);
+      buf_add_str (&key, tmp);
+    }
+
+  sprintf (tmp, " target=%s granule=%u flags=%s%s%s%s style=%d",
+	   bfd_get_target (abfd), index_granule (abfd),
+	   with_functions ? "f" : "", do_demangle ? "C" : "",
+	   base_names ? "s" : "", unwind_inlines ? "i" : "",
+	   (int) current_demangling_style);
+  buf_add_str (&key, tmp);
+  /* The ranges are saved as they are laid out in memory.  */
+  sprintf (tmp, " host=%s vma=%u word=%u",
+	   *(const unsigned char *) &one ? "le" : "be",
+	   (unsigned int) sizeof (bfd_vma) * 8,
+	   (unsigned int) sizeof (size_t) * 8);
+  buf_add_str (&key, tmp);
+  if (exe_section_name != NULL)
+    {
+      buf_add_str (&key, " section=");
+      buf_add_str (&key, exe_section_name);
+    }
+  buf_add (&key, "\n", 2);
+
+  return key.data;
+}
+
+/* Check that the next LEN bytes of F are S.  */
+
+static bfd_boolean
+expect (FILE *f, const char *s, size_t len)
+{
+  char *tmp = xmalloc (len);
+  bfd_boolean ok;
+
+  ok = fread (tmp, 1, len, f) == len && memcmp (tmp, s, len) == 0;
+  free (tmp);
+  return ok;
+}
+
+/* Try to load the index from the cache file for KEY.  */
+
+static bfd_boolean
+load_index (const char *key)
+{
+  unsigned long n, poolsize;
+  size_t i;
+  FILE *f;
+
+  f = fopen (index_cache, FOPEN_RB);
+  if (f == NULL)
+    return FALSE;
+
+  if (!expect (f, index_magic, sizeof (index_magic) - 1)
+      || !expect (f, key, strlen (key))
+      || fscanf (f, "%lu %lu", &n, &poolsize) != 2
+      || getc (f) != '\n')
+    {
+      fclose (f);
+      return FALSE;
+    }
+
+  ranges = xmalloc ((n + 1) * sizeof (*ranges));
+  pool.data = xmalloc (poolsize + 1);
+  pool.alloc = poolsize + 1;
+  if (fread (ranges, sizeof (*ranges), n, f) != n
+      || fread (pool.data, 1, poolsize, f) != poolsize
+      || (poolsize > 0 && pool.data[poolsize - 1] != '\0'))
+    goto bad;
+
+  for (i = 0; i < n; i++)
+    if (ranges[i].answer >= poolsize
+	|| ranges[i].start >= ranges[i].end
+	|| (i > 0 && ranges[i].start < ranges[i - 1].end))
+      goto bad;
+
+  fclose (f);
+  nranges = n;
+  pool.len = poolsize;
+  return TRUE;
+
+ bad:
+  fclose (f);
+  free (ranges);
+  free (pool.data);
+  ranges = NULL;
+  pool.data = NULL;
+  pool.alloc = 0;
+  return FALSE;
+}
+
+/* Write the index to the cache file for KEY.  A failure here costs
+   only the next run's time, so it is reported but not fatal.  The
+   file is written under a temporary name and renamed into place so
+   that a concurrent reader never sees half of it.  */
+
+static void
+save_index (const char *key)
+{
+  char *tmpname;
+  FILE *f;
+
+  tmpname = make_tempname (index_cache);
+  if (tmpname == NULL)
+    {
+      non_fatal (_("%s: cannot create temporary file: %s"),
+		 index_cache, strerror (errno));
+      return;
+    }
+
+  f = fopen (tmpname, FOPEN_WB);
+  if (f != NULL)
+    {
+      fputs (index_magic, f);
+      fputs (key, f);
+      fprintf (f, "%lu %lu\n", (unsigned long) nranges,
+	       (unsigned long) pool.len);
+      fwrite (ranges, sizeof (*ranges), nranges, f);
+      fwrite (pool.data, 1, pool.len, f);
+    }
+
+  if (f == NULL
+      || ferror (f)
+      || fclose (f) != 0
+      || rename (tmpname, index_cache) != 0)
+    {
+      non_fatal (_("%s: cannot write address index: %s"),
+		 index_cache, strerror (errno));
+      unlink (tmpname);
+    }
+
+  free (tmpname);
+}
+
+/* Append the answer for the address in the hex string S to OUT.  */
+
+static void
+answer_query (const char *s, struct answer_buf *out)
+{
+  bfd_vma a = bfd_scan_vma (s, NULL, 16);
+  size_t lo = 0, hi = nranges;
+
+  /* Find the first range ending after A.  */
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (ranges[mid].end <= a)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo < nranges && ranges[lo].start <= a)
+    buf_add_str (out, pool.data + ranges[lo].answer);
+  else
+    {
+      bfd *abfd = current_bfd ();
+
+      lookup_address (abfd, exe_section, a, out);
+    }
+}
+
+/* Answer each line of addresses from P up to END, appending to OUT.  */
+
+static void
+answer_lines (char *p, char *end, struct answer_buf *out)
+{
+  while (p < end)
+    {
+      char *nl = memchr (p, '\n', end - p);
+
+      if (nl == NULL)
+	nl = end;
+      *nl = '\0';
+      answer_query (p, out);
+      p = nl + 1;
+    }
+}
+
+struct query_job
+{
+  char *data;
+  size_t size;
+};
+
+/* Answer this job's share of the lines of a file of addresses.  Each
+   share starts just after a newline.  */
+
+static void
+query_job (int job, FILE *out, void *arg)
+{
+  struct query_job *qj = (struct query_job *) arg;
+  struct answer_buf text = { NULL, 0, 0 };
+  size_t lo = qj->size * job / njobs;
+  size_t hi = qj->size * (job + 1) / njobs;
+
+  while (lo > 0 && lo < qj->size && qj->data[lo - 1] != '\n')
+    lo++;
+  while (hi > 0 && hi < qj->size && qj->data[hi - 1] != '\n')
+    hi++;
+  if (lo < hi)
+    answer_lines (qj->data + lo, qj->data + hi, &text);
+
+  fwrite (text.data, 1, text.len, out);
+  free (text.data);
+}
+
+/* Answer a whole file of addresses on stdin, sharing the lines out
+   among the worker processes.  */
+
+static void
+translate_file (size_t size)
+{
+  struct query_job qj;
+  FILE **out;
+  char buf[16384];
+  size_t n;
+  int i;
+
+  qj.data = xmalloc (size + 1);
+  qj.size = 0;
+  while ((n = fread (buf, 1, sizeof buf, stdin)) > 0)
+    {
+      if (qj.size + n > size)
+	{
+	  size = (qj.size + n) * 2;
+	  qj.data = xrealloc (qj.data, size + 1);
+	}
+      memcpy (qj.data + qj.size, buf, n);
+      qj.size += n;
+    }
+
+  out = run_jobs (njobs, query_job, &qj);
+  for (i = 0; i < njobs; i++)
+    {
+      while ((n = fread (buf, 1, sizeof buf, out[i])) > 0)
+	fwrite (buf, 1, n, stdout);
+      fclose (out[i]);
+    }
+
+  free (out);
+  free (qj.data);
+}
+
+/* Answer addresses from stdin as they arrive.  Input is read a block
+   at a time and the answers to every complete line in a block are
+   written together, flushing only before the next read could block,
+   so a client that sends one address and waits still gets its answer
+   while a pipe full of addresses is answered at full speed.  */
+
+static void
+translate_stream (void)
+{
+  struct answer_buf out = { NULL, 0, 0 };
+  char buf[65536];
+  size_t have = 0;
+
+  for (;;)
+    {
+      ssize_t n;
+      char *last;
+
+      n = read (fileno (stdin), buf + have, sizeof buf - 1 - have);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	break;
+      have += n;
+
+      last = NULL;
+      for (n = have; n > 0; n--)
+	if (buf[n - 1] == '\n')
+	  {
+	    last = buf + n;
+	    break;
+	  }
+      if (last == NULL)
+	{
+	  if (have < sizeof buf - 1)
+	    continue;
+	  last = buf + have;
+	}
+
+      out.len = 0;
+      answer_lines (buf, last, &out);
+      fwrite (out.data, 1, out.len, stdout);
+      fflush (stdout);
+
+      have -= last - buf;
+      memmove (buf, last, have);
+    }
+
+  if (have > 0)
+    {
+      out.len = 0;
+      answer_lines (buf, buf + have, &out);
+      fwrite (out.data, 1, out.len, stdout);
+    }
+  fflush (stdout);
+  free (out.data);
+}
+
+/* Translate addresses using the index, building it or loading it from
+   the cache first.  */
+
+static void
+batch_translate (void)
+{
+  bfd *abfd = exe_bfd;
+  struct stat st;
+  char *key = NULL;
+
+  if (index_cache != NULL)
+    key = index_key (abfd);
+
+  if (key == NULL || !load_index (key))
+    {
+      build_index (abfd);
+      if (key != NULL)
+	save_index (key);
+    }
+  free (key);
+
+  if (naddr > 0)
+    {
+      struct answer_buf out = { NULL, 0, 0 };
+
+      for (; naddr > 0; naddr--)
+	answer_query (*addr++, &out);
+      fwrite (out.data, 1, out.len, stdout);
+      fflush (stdout);
+      free (out.data);
+    }
+  else if (njobs > 1
+	   && fstat (fileno (stdin), &st) == 0
+	   && S_ISREG (st.st_mode))
+    translate_file (st.st_size);
+  else
+    translate_stream ();
+}
+
+/* Process a file.  Returns an exit value for main().  */
+
+static int
+process_file (const char *file_name, const char *section_name,
+	      const char *target)
+{
+  bfd *abfd;
+  asection *section;
+
+  if (get_file_size (file_name) < 1)
+    return 1;
+
+  abfd = open_file (file_name, target);
+
   if (section_name != NULL)
     {
       section = bfd_get_section_by_name (abfd, section_name);
@@ -302,7 +1130,16 @@ process_file (const char *file_name, const char *section_name,
 
   slurp_symtab (abfd);
 
-  translate_addresses (abfd, section);
+  exe_name = file_name;
+  exe_target = target;
+  exe_section_name = section_name;
+  exe_bfd = abfd;
+  exe_section = section;
+
+  if (batch_mode)
+    batch_translate ();
+  else
+    translate_addresses (abfd, section);
 
   if (syms != NULL)
     {
@@ -314,13 +1151,14 @@ process_file (const char *file_name, const char *section_name,
 
   return 0;
 }
-
+
 int
 main (int argc, char **argv)
 {
   const char *file_name;
   const char *section_name;
   char *target;
+  bfd_boolean use_cache;
   int c;
 
 #if defined (HAVE_SETLOCALE) && defined (HAVE_LC_MESSAGES)
@@ -343,7 +1181,8 @@ main (int argc, char **argv)
   file_name = NULL;
   section_name = NULL;
   target = NULL;
-  while ((c = getopt_long (argc, argv, "b:Ce:sfHhij:Vv", long_options, (int *) 0))
+  use_cache = FALSE;
+  while ((c = getopt_long (argc, argv, "b:BCe:sfHhij:Vv", long_options, (int *) 0))
 	 != EOF)
     {
       switch (c)
@@ -353,6 +1192,9 @@ main (int argc, char **argv)
 	case 'b':
 	  target = optarg;
 	  break;
+	case 'B':
+	  batch_mode = TRUE;
+	  break;
 	case 'C':
 	  do_demangle = TRUE;
 	  if (optarg != NULL)
@@ -390,6 +1232,18 @@ main (int argc, char **argv)
 	case 'j':
 	  section_name = optarg;
 	  break;
+	case OPTION_INDEX_CACHE:
+	  batch_mode = TRUE;
+	  use_cache = TRUE;
+	  if (optarg != NULL)
+	    index_cache = xstrdup (optarg);
+	  break;
+	case OPTION_JOBS:
+	  batch_mode = TRUE;
+	  njobs = atoi (optarg);
+	  if (njobs < 1)
+	    fatal (_("invalid number of jobs `%s'"), optarg);
+	  break;
 	default:
 	  usage (stderr, 1);
 	  break;
@@ -399,6 +1253,9 @@ main (int argc, char **argv)
   if (file_name == NULL)
     file_name = "a.out";
 
+  if (use_cache && index_cache == NULL)
+    index_cache = concat (file_name, ".a2l", (const char *) NULL);
+
   addr = argv + optind;
   naddr = argc - optind;
 
@@ -0,0 +1,26 @@
+# Two functions with line numbers for the addr2line tests.  Line entries
+# are only made for instructions, so this is written for Rigel.
+
+	.file	1 "addr2line.c"
+	.text
+	.globl	first
+	.type	first, @function
+first:
+	.loc	1 10 0
+	nop
+	nop
+	.loc	1 11 0
+	nop
+	.size	first, .-first
+
+	.globl	second
+	.type	second, @function
+second:
+	.loc	1 20 0
+	nop
+	.loc	1 21 0
+	nop
+	nop
+	.loc	1 22 0
+	nop
+	.size	second, .-second
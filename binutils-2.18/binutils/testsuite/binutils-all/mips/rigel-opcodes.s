@@ -0,0 +1,149 @@
+# Every Rigel opcode, once with its operand fields clear and once with
+# them filled in, followed by words that match no opcode.  Written as
+# data so that any MIPS assembler can build it.
+
+	.text
+rigel_opcodes:
+	.word	0x00001c00, 0x0a3c9c00	# add d,s,t
+	.word	0x00001c01, 0x0a3c9c01	# sub d,s,t
+	.word	0x00001c02, 0x0a3c9c02	# addu d,s,t
+	.word	0x00001c03, 0x0a3c9c03	# subu d,s,t
+	.word	0x10000000, 0x1a3c96e1	# addi d,t,j
+	.word	0x10010000, 0x1a3d96e1	# subi d,t,j
+	.word	0x10020000, 0x1a3e96e1	# addiu d,t,i
+	.word	0x10030000, 0x1a3f96e1	# subiu d,t,i
+	.word	0x00001c04, 0x0a3c9c04	# addc d,s,t
+	.word	0x00001c05, 0x0a3c9c05	# addg d,s,t
+	.word	0x00001c06, 0x0a3c9c06	# addcu d,s,t
+	.word	0x00001c07, 0x0a3c9c07	# addgu d,s,t
+	.word	0x00001c08, 0x0a3c9c08	# and d,s,t
+	.word	0x00001c09, 0x0a3c9c09	# or d,s,t
+	.word	0x00001c0a, 0x0a3c9c0a	# xor d,s,t
+	.word	0x00001c0b, 0x0a3c9c0b	# nor d,s,t
+	.word	0x20000000, 0x2a3c96e1	# andi d,t,i
+	.word	0x20010000, 0x2a3d96e1	# ori d,t,i
+	.word	0x20020000, 0x2a3e96e1	# xori d,t,i
+	.word	0x00001c0c, 0x0a3c9c0c	# sll d,s,t
+	.word	0x00001c0d, 0x0a3c9c0d	# srl d,s,t
+	.word	0x00001c0e, 0x0a3c9c0e	# sra d,s,t
+	.word	0x00001a0f, 0x0a3c9a0f	# slli d,t,5
+	.word	0x00001a10, 0x0a3c9a10	# srli d,t,5
+	.word	0x00001a11, 0x0a3c9a11	# srai d,t,5
+	.word	0x00001c12, 0x0a3c9c12	# ceq d,s,t
+	.word	0x00001c13, 0x0a3c9c13	# clt d,s,t
+	.word	0x00001c14, 0x0a3c9c14	# cle d,s,t
+	.word	0x00001c15, 0x0a3c9c15	# cltu d,s,t
+	.word	0x00001c16, 0x0a3c9c16	# cleu d,s,t
+	.word	0x00001c17, 0x0a3c9c17	# ceqf d,s,t
+	.word	0x00001c18, 0x0a3c9c18	# cltf d,s,t
+	.word	0x00001c19, 0x0a3c9c19	# cltef d,s,t
+	.word	0x00001c1a, 0x0a3c9c1a	# cmov.eq d,s,t
+	.word	0x00001c1b, 0x0a3c9c1b	# cmov.neq d,s,t
+	.word	0x0000181c, 0x0a3c181c	# mfsr d,t
+	.word	0x0000181d, 0x0a3c181d	# mtsr d,t
+	.word	0x30000000, 0x3a0096e1	# mvui d,i
+	.word	0x20030000, 0x2a3f96e1	# beq d,t,p
+	.word	0x40000000, 0x4a3c96e1	# bne d,t,p
+	.word	0x50000000, 0x503c96e1	# be t,p
+	.word	0x50010000, 0x503d96e1	# bnz t,p
+	.word	0x50020000, 0x503e96e1	# blt t,p
+	.word	0x50030000, 0x503f96e1	# bgt t,p
+	.word	0x60000000, 0x603c96e1	# ble t,p
+	.word	0x60010000, 0x603d96e1	# bge t,p
+	.word	0x70000000, 0x723c96e1	# lj a
+	.word	0x74000000, 0x763c96e1	# ljl a
+	.word	0x60020000, 0x600296e1	# jmp p
+	.word	0x3f810000, 0x3f8196e1	# jal p
+	.word	0x0000081e, 0x003c081e	# jmpr t
+	.word	0x0f80181f, 0x0fbc181f	# jalr t
+	.word	0x00001820, 0x0a3c1820	# ldl d,t
+	.word	0x00001c21, 0x0a3c9c21	# stc d,s,t
+	.word	0x30020000, 0x3a0296e1	# pref.l d,i
+	.word	0x40010000, 0x4a3d96e1	# pref.b.gc d,t,j
+	.word	0x40020000, 0x4a3e96e1	# pref.b.cc d,t,j
+	.word	0x30030000, 0x3a0396e1	# pref.nga d,i
+	.word	0x40030000, 0x4a3f96e1	# pldw d,t,j
+	.word	0x80000000, 0x8a0096e1	# bcast.i d,i
+	.word	0x90000000, 0x9a3c96e1	# bcast.u d,t,j
+	.word	0x90010000, 0x9a3d96e1	# ldw d,t,j
+	.word	0x90020000, 0x9a3e96e1	# stw d,t,j
+	.word	0x90030000, 0x9a3f96e1	# g.ldw d,t,j
+	.word	0xa0000000, 0xaa3c96e1	# g.stw d,t,j
+	.word	0xa0010000, 0xaa3d96e1	# atom.dec d,t,j
+	.word	0xa0020000, 0xaa3e96e1	# atom.inc d,t,j
+	.word	0xa0030000, 0xaa3f96e1	# atom.xchg d,t,j
+	.word	0x00001c22, 0x0a3c9c22	# atom.cas d,s,t
+	.word	0x00001c23, 0x0a3c9c23	# atom.addu d,s,t
+	.word	0x00001c24, 0x0a3c9c24	# atom.xor d,s,t
+	.word	0x00001c25, 0x0a3c9c25	# atom.or d,s,t
+	.word	0x00001c26, 0x0a3c9c26	# atom.and d,s,t
+	.word	0x00001c27, 0x0a3c9c27	# atom.max d,s,t
+	.word	0x00001c28, 0x0a3c9c28	# atom.min d,s,t
+	.word	0x00001829, 0x0a3c1829	# tbloffset d,t
+	.word	0x0000002a	# nop
+	.word	0x0000002b	# brk
+	.word	0x0000002c	# hlt
+	.word	0x0000002d	# sync
+	.word	0x0000002e	# undef
+	.word	0x0000002f	# cc.wb
+	.word	0x00000030	# cc.inv
+	.word	0x00000031	# cc.flush
+	.word	0x00000032	# ic.inv
+	.word	0x00000033	# mb
+	.word	0x00000034	# rfe
+	.word	0x00000035	# abort
+	.word	0x00001036, 0x0a001036	# syscall d
+	.word	0x00001037, 0x0a001037	# printreg d
+	.word	0x00001038, 0x0a001038	# timer.start d
+	.word	0x00001039, 0x0a001039	# timer.stop d
+	.word	0x80010000, 0x8a0196e1	# strtof d,i
+	.word	0x0000083a, 0x003c083a	# flush.bcast t
+	.word	0x0000083b, 0x003c083b	# line.wb t
+	.word	0x0000083c, 0x003c083c	# line.inv t
+	.word	0x0000083d, 0x003c083d	# line.flush t
+	.word	0x0000003e	# tq.enq
+	.word	0x0000003f	# tq.deq
+	.word	0x00000040	# tq.loop
+	.word	0x00000041	# tq.init
+	.word	0x00000042	# tq.end
+	.word	0x00001c43, 0x0a3c9c43	# fadd d,s,t
+	.word	0x00001c44, 0x0a3c9c44	# fsub d,s,t
+	.word	0x00001c45, 0x0a3c9c45	# fmul d,s,t
+	.word	0xb0000000, 0xba3c9600	# fmadd d,s,t,A
+	.word	0xb0000001, 0xba3c9601	# fmsub d,s,t,A
+	.word	0x00001846, 0x0a3c1846	# frcp d,t
+	.word	0x00001847, 0x0a3c1847	# frsq d,t
+	.word	0x00001848, 0x0a3c1848	# fabs d,t
+	.word	0x00001849, 0x0a3c1849	# fmrs d,t
+	.word	0x0000184a, 0x0a3c184a	# fmov d,t
+	.word	0xb0000002, 0xba001602	# fa2r d,A
+	.word	0x0000184b, 0x0a3c184b	# fr2a d,t
+	.word	0x0000184c, 0x0a3c184c	# f2i d,t
+	.word	0x0000184d, 0x0a3c184d	# i2f d,t
+	.word	0x00001c4e, 0x0a3c9c4e	# mul d,s,t
+	.word	0x00001c4f, 0x0a3c9c4f	# mul32 d,s,t
+	.word	0x00001c50, 0x0a3c9c50	# mul16 d,s,t
+	.word	0x00001c51, 0x0a3c9c51	# mul16.c d,s,t
+	.word	0x00001c52, 0x0a3c9c52	# mul16.g d,s,t
+	.word	0x00001853, 0x0a3c1853	# clz d,t
+	.word	0x00001854, 0x0a3c1854	# zext8 d,t
+	.word	0x00001855, 0x0a3c1855	# sext8 d,t
+	.word	0x00001856, 0x0a3c1856	# zext16 d,t
+	.word	0x00001857, 0x0a3c1857	# sext16 d,t
+	.word	0x00001c58, 0x0a3c9c58	# vadd d,s,t
+	.word	0x00001c59, 0x0a3c9c59	# vsub d,s,t
+	.word	0xc0000000, 0xca3c96e1	# vaddi d,t,j
+	.word	0xc0010000, 0xca3d96e1	# vsubi d,t,j
+	.word	0x00001c5a, 0x0a3c9c5a	# vfadd d,s,t
+	.word	0x00001c5b, 0x0a3c9c5b	# vfsub d,s,t
+	.word	0x00001c5c, 0x0a3c9c5c	# vfmul d,s,t
+	.word	0xc0020000, 0xca3e96e1	# vldw d,t,j
+	.word	0xc0030000, 0xca3f96e1	# vstw d,t,j
+	.word	0x80020000, 0x8a0296e1	# event d,i
+	.word	0x80030000, 0x8a0396e1	# prio d,i
+	.word	0x00001a5d, 0x0a3c9a5d	# sleep d,t,5
+
+# No opcode.
+	.word	0xffffffff
+	.word	0xc0000000
+	.word	0x000000ff
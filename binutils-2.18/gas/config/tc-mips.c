@@ -535,6 +535,30 @@ static struct hash_control *op_hash = NULL;
 /* The opcode hash table we use for the mips16.  */
 static struct hash_control *mips16_op_hash = NULL;
 
+/* A precompiled form of the operand string of a mips_opcodes entry,
+   used by rigel_assemble.  */
+struct rigel_insn_form
+{
+  /* True if rigel_assemble can handle the instruction.  */
+  unsigned char fast_p;
+
+  /* The number of operands.  */
+  unsigned char nops;
+
+  /* The opcode table character for each operand: 'd', 's', 't' or 'A'
+     for a register, 'i', 'j' or '5' for an immediate, 'p' for a branch
+     target and 'a' for a jump target.  Only the last operand can be
+     an expression.  */
+  char kind[4];
+
+  /* Where each register operand goes in the opcode.  */
+  unsigned char shift[4];
+  unsigned char mask[4];
+};
+
+/* The precompiled forms, indexed in parallel with mips_opcodes.  */
+static struct rigel_insn_form *rigel_insn_forms;
+
 /* This array holds the chars that always start a comment.  If the
     pre-processor is disabled, these aren't very useful */
 const char comment_chars[] = "#";
@@ -723,6 +747,12 @@ static int mips_fix_vr4130;
    efficient expansion.  */
 
 static int mips_relax_branch;
+
+/* True if md_assemble may assemble Rigel instructions without going
+   through mips_ip and the hazard and delay-slot handling in append_insn.
+   See rigel_assemble.  -mno-rigel-fast turns this off.  */
+
+static int mips_rigel_fast = 1;
 
 /* The expansion of many macros depends on the type of symbol that
    they refer to.  For example, when generating position-dependent code,
@@ -1003,6 +1033,7 @@ static void mips16_macro (struct mips_cl_insn * ip);
 static void macro2 (struct mips_cl_insn * ip);
 #endif
 static void mips_ip (char *str, struct mips_cl_insn * ip);
+static bfd_boolean rigel_assemble (char *str);
 static void mips16_ip (char *str, struct mips_cl_insn * ip);
 static void mips16_immed
   (char *, unsigned int, int, offsetT, bfd_boolean, bfd_boolean, bfd_boolean,
@@ -1771,6 +1802,69 @@ reg_lookup (char **s, unsigned int types, unsigned int *regnop)
   return reg >= 0;
 }
 
+/* Fill in rigel_insn_forms[INDEX] for mips_opcodes[INDEX], if
+   rigel_assemble can handle that instruction.  It must be a Rigel
+   instruction without a delay slot, and all its operands must be
+   simple registers except perhaps for a final immediate or address.  */
+
+static void
+rigel_compile_insn (int index)
+{
+  const struct mips_opcode *mo = &mips_opcodes[index];
+  struct rigel_insn_form *form = &rigel_insn_forms[index];
+  const char *args;
+  unsigned int n;
+
+  if (mo->pinfo == INSN_MACRO
+      || (mo->membership & INSN_RIGEL32) == 0
+      || (mo->pinfo & (INSN_UNCOND_BRANCH_DELAY | INSN_COND_BRANCH_DELAY
+		       | INSN_COND_BRANCH_LIKELY)) != 0)
+    return;
+
+  n = 0;
+  for (args = mo->args; *args != '\0'; args++)
+    {
+      if (n == ARRAY_SIZE (form->kind))
+	return;
+      switch (*args)
+	{
+	case 'd':
+	  form->shift[n] = OP_SH_RD;
+	  form->mask[n] = OP_MASK_RD;
+	  break;
+	case 's':
+	  form->shift[n] = OP_SH_RS;
+	  form->mask[n] = OP_MASK_RS;
+	  break;
+	case 't':
+	  form->shift[n] = OP_SH_RT;
+	  form->mask[n] = OP_MASK_RT;
+	  break;
+	case 'A':
+	  form->shift[n] = OP_SH_RA;
+	  form->mask[n] = OP_MASK_RA;
+	  break;
+	case 'i':
+	case 'j':
+	case '5':
+	case 'p':
+	case 'a':
+	  if (args[1] != '\0')
+	    return;
+	  break;
+	default:
+	  return;
+	}
+      form->kind[n++] = *args;
+      if (args[1] == ',')
+	args++;
+      else if (args[1] != '\0')
+	return;
+    }
+  form->nops = n;
+  form->fast_p = 1;
+}
+
 /* This function is called once, at assembler startup time.  It should set up
    all the tables, etc. that the MD part of the assembler will need.  */
 
@@ -1794,10 +1888,12 @@ md_begin (void)
 	//printf("[%s] %s: PONG\n", __FILE__, __FUNCTION__);
 
   op_hash = hash_new ();
+  rigel_insn_forms = xcalloc (NUMOPCODES, sizeof (*rigel_insn_forms));
 
   for (i = 0; i < NUMOPCODES;)
     {
       const char *name = mips_opcodes[i].name;
+      int first = i;
 
       retval = hash_insert (op_hash, name, (void *) &mips_opcodes[i]);
       if (retval != NULL)
@@ -1822,6 +1918,10 @@ md_begin (void)
 	  ++i;
 	}
       while ((i < NUMOPCODES) && !strcmp (mips_opcodes[i].name, name));
+
+      /* rigel_assemble does not try alternative forms.  */
+      if (i == first + 1)
+	rigel_compile_insn (first);
     }
 
   mips16_op_hash = hash_new ();
@@ -1998,6 +2098,14 @@ md_assemble (char *str)
   bfd_reloc_code_real_type unused_reloc[3]
     = {BFD_RELOC_UNUSED, BFD_RELOC_UNUSED, BFD_RELOC_UNUSED};
 
+  if (mips_rigel_fast
+      && mips_opts.isa == ISA_RIGEL32
+      && !mips_opts.mips16
+      && mips_opts.noreorder
+      && prev_nop_frag == NULL
+      && rigel_assemble (str))
+    return;
+
   imm_expr.X_op = O_absent;
   imm2_expr.X_op = O_absent;
   offset_expr.X_op = O_absent;
@@ -2562,193 +2670,14 @@ nops_for_insn_or_target (const struct mips_cl_insn *history,
   return nops;
 }
 
-/* Output an instruction.  IP is the instruction information.
-   ADDRESS_EXPR is an operand of the instruction to be used with
-   RELOC_TYPE.  */
+/* Attach ADDRESS_EXPR to instruction IP using relocation RELOC_TYPE.
+   Constant expressions are folded into the opcode; anything else gets
+   a fixup.  */
 
 static void
-append_insn (struct mips_cl_insn *ip, expressionS *address_expr,
-	     bfd_reloc_code_real_type *reloc_type)
+append_insn_reloc (struct mips_cl_insn *ip, expressionS *address_expr,
+		   bfd_reloc_code_real_type *reloc_type)
 {
-  unsigned long prev_pinfo, pinfo;
-  relax_stateT prev_insn_frag_type = 0;
-  bfd_boolean relaxed_branch = FALSE;
-  segment_info_type *si = seg_info (now_seg);
-
-  /* Mark instruction labels in mips16 mode.  */
-  mips16_mark_labels ();
-
-//printf("%s [%s]: INFO\n", __FUNCTION__, __FILE__);
-
-  prev_pinfo = history[0].insn_mo->pinfo;
-  pinfo = ip->insn_mo->pinfo;
-
-  if (mips_relax.sequence != 2 && !mips_opts.noreorder)
-    {
-      /* There are a lot of optimizations we could do that we don't.
-	 In particular, we do not, in general, reorder instructions.
-	 If you use gcc with optimization, it will reorder
-	 instructions and generally do much more optimization then we
-	 do here; repeating all that work in the assembler would only
-	 benefit hand written assembly code, and does not seem worth
-	 it.  */
-      int nops = (mips_optimize == 0
-		  ? nops_for_insn (history, NULL)
-		  : nops_for_insn_or_target (history, ip));
-      if (nops > 0)
-	{
-	  fragS *old_frag;
-	  unsigned long old_frag_offset;
-	  int i;
-
-	  old_frag = frag_now;
-	  old_frag_offset = frag_now_fix ();
-
-	  for (i = 0; i < nops; i++)
-	    emit_nop ();
-
-	  if (listing)
-	    {
-	      listing_prev_line ();
-	      /* We may be at the start of a variant frag.  In case we
-                 are, make sure there is enough space for the frag
-                 after the frags created by listing_prev_line.  The
-                 argument to frag_grow here must be at least as large
-                 as the argument to all other calls to frag_grow in
-                 this file.  We don't have to worry about being in the
-                 middle of a variant frag, because the variants insert
-                 all needed nop instructions themselves.  */
-	      frag_grow (40);
-	    }
-
-	  mips_move_labels ();
-
-#ifndef NO_ECOFF_DEBUGGING
-	  if (ECOFF_DEBUGGING)
-	    ecoff_fix_loc (old_frag, old_frag_offset);
-#endif
-	}
-    }
-  else if (mips_relax.sequence != 2 && prev_nop_frag != NULL)
-    {
-      /* Work out how many nops in prev_nop_frag are needed by IP.  */
-      int nops = nops_for_insn_or_target (history, ip);
-      assert (nops <= prev_nop_frag_holds);
-
-      /* Enforce NOPS as a minimum.  */
-      if (nops > prev_nop_frag_required)
-	prev_nop_frag_required = nops;
-
-      if (prev_nop_frag_holds == prev_nop_frag_required)
-	{
-	  /* Settle for the current number of nops.  Update the history
-	     accordingly (for the benefit of any future .set reorder code).  */
-	  prev_nop_frag = NULL;
-	  insert_into_history (prev_nop_frag_since,
-			       prev_nop_frag_holds, NOP_INSN);
-	}
-      else
-	{
-	  /* Allow this instruction to replace one of the nops that was
-	     tentatively added to prev_nop_frag.  */
-	  prev_nop_frag->fr_fix -= mips_opts.mips16 ? 2 : 4;
-	  prev_nop_frag_holds--;
-	  prev_nop_frag_since++;
-	}
-    }
-
-#ifdef OBJ_ELF
-  /* The value passed to dwarf2_emit_insn is the distance between
-     the beginning of the current instruction and the address that
-     should be recorded in the debug tables.  For MIPS16 debug info
-     we want to use ISA-encoded addresses, so we pass -1 for an
-     address higher by one than the current.  */
-  dwarf2_emit_insn (mips_opts.mips16 ? -1 : 0);
-#endif
-
-  /* Record the frag type before frag_var.  */
-  if (history[0].frag)
-    prev_insn_frag_type = history[0].frag->fr_type;
-
-  if (address_expr
-      && *reloc_type == BFD_RELOC_16_PCREL_S2
-      && (pinfo & INSN_UNCOND_BRANCH_DELAY || pinfo & INSN_COND_BRANCH_DELAY
-	  || pinfo & INSN_COND_BRANCH_LIKELY)
-      && mips_relax_branch
-      /* Don't try branch relaxation within .set nomacro, or within
-	 .set noat if we use $at for PIC computations.  If it turns
-	 out that the branch was out-of-range, we'll get an error.  */
-      && !mips_opts.warn_about_macros
-      && !(mips_opts.noat && mips_pic != NO_PIC)
-      && !mips_opts.mips16)
-    {
-      relaxed_branch = TRUE;
-      add_relaxed_insn (ip, (relaxed_branch_length
-			     (NULL, NULL,
-			      (pinfo & INSN_UNCOND_BRANCH_DELAY) ? -1
-			      : (pinfo & INSN_COND_BRANCH_LIKELY) ? 1
-			      : 0)), 4,
-			RELAX_BRANCH_ENCODE
-			(pinfo & INSN_UNCOND_BRANCH_DELAY,
-			 pinfo & INSN_COND_BRANCH_LIKELY,
-			 pinfo & INSN_WRITE_GPR_31,
-			 0),
-			address_expr->X_add_symbol,
-			address_expr->X_add_number);
-      *reloc_type = BFD_RELOC_UNUSED;
-    }
-  else if (*reloc_type > BFD_RELOC_UNUSED)
-    {
-      /* We need to set up a variant frag.  */
-      assert (mips_opts.mips16 && address_expr != NULL);
-      add_relaxed_insn (ip, 4, 0,
-			RELAX_MIPS16_ENCODE
-			(*reloc_type - BFD_RELOC_UNUSED,
-			 mips16_small, mips16_ext,
-			 prev_pinfo & INSN_UNCOND_BRANCH_DELAY,
-			 history[0].mips16_absolute_jump_p),
-			make_expr_symbol (address_expr), 0);
-    }
-  else if (mips_opts.mips16
-	   && ! ip->use_extend
-	   && *reloc_type != BFD_RELOC_MIPS16_JMP)
-    {
-      if ((pinfo & INSN_UNCOND_BRANCH_DELAY) == 0)
-	/* Make sure there is enough room to swap this instruction with
-	   a following jump instruction.  */
-	frag_grow (6);
-      add_fixed_insn (ip);
-    }
-  else
-    {
-      if (mips_opts.mips16
-	  && mips_opts.noreorder
-	  && (prev_pinfo & INSN_UNCOND_BRANCH_DELAY) != 0)
-	as_warn (_("extended instruction in delay slot"));
-
-      if (mips_relax.sequence)
-	{
-	  /* If we've reached the end of this frag, turn it into a variant
-	     frag and record the information for the instructions we've
-	     written so far.  */
-	  if (frag_room () < 4)
-	    relax_close_frag ();
-	  mips_relax.sizes[mips_relax.sequence - 1] += 4;
-	}
-
-      if (mips_relax.sequence != 2)
-	mips_macro_warning.sizes[0] += 4;
-      if (mips_relax.sequence != 1)
-	mips_macro_warning.sizes[1] += 4;
-
-      if (mips_opts.mips16)
-	{
-	  ip->fixed_p = 1;
-	  ip->mips16_absolute_jump_p = (*reloc_type == BFD_RELOC_MIPS16_JMP);
-	}
-      add_fixed_insn (ip);
-    }
-
   if (address_expr != NULL && *reloc_type <= BFD_RELOC_UNUSED)
     {
       if (address_expr->X_op == O_constant)
@@ -2909,9 +2838,15 @@ append_insn (struct mips_cl_insn *ip, expressionS *address_expr,
 	      }
 	}
     }
-  install_insn (ip);
+}
+
+/* Update the register mask information for instruction IP.  */
+
+static void
+mips_record_insn_regs (const struct mips_cl_insn *ip)
+{
+  unsigned long pinfo = ip->insn_mo->pinfo;
 
-  /* Update the register mask information.  */
   if (! mips_opts.mips16)
     {
       if (pinfo & INSN_WRITE_GPR_D)
@@ -2961,6 +2896,198 @@ append_insn (struct mips_cl_insn *ip, expressionS *address_expr,
       if (pinfo & MIPS16_INSN_READ_GPR_X)
 	mips_gprmask |= 1 << MIPS16_EXTRACT_OPERAND (REGR32, *ip);
     }
+}
+
+/* Output an instruction.  IP is the instruction information.
+   ADDRESS_EXPR is an operand of the instruction to be used with
+   RELOC_TYPE.  */
+
+static void
+append_insn (struct mips_cl_insn *ip, expressionS *address_expr,
+	     bfd_reloc_code_real_type *reloc_type)
+{
+  unsigned long prev_pinfo, pinfo;
+  relax_stateT prev_insn_frag_type = 0;
+  bfd_boolean relaxed_branch = FALSE;
+  segment_info_type *si = seg_info (now_seg);
+
+  /* Mark instruction labels in mips16 mode.  */
+  mips16_mark_labels ();
+
+//printf("%s [%s]: INFO\n", __FUNCTION__, __FILE__);
+
+  prev_pinfo = history[0].insn_mo->pinfo;
+  pinfo = ip->insn_mo->pinfo;
+
+  if (mips_relax.sequence != 2 && !mips_opts.noreorder)
+    {
+      /* There are a lot of optimizations we could do that we don't.
+	 In particular, we do not, in general, reorder instructions.
+	 If you use gcc with optimization, it will reorder
+	 instructions and generally do much more optimization then we
+	 do here; repeating all that work in the assembler would only
+	 benefit hand written assembly code, and does not seem worth
+	 it.  */
+      int nops = (mips_optimize == 0
+		  ? nops_for_insn (history, NULL)
+		  : nops_for_insn_or_target (history, ip));
+      if (nops > 0)
+	{
+	  fragS *old_frag;
+	  unsigned long old_frag_offset;
+	  int i;
+
+	  old_frag = frag_now;
+	  old_frag_offset = frag_now_fix ();
+
+	  for (i = 0; i < nops; i++)
+	    emit_nop ();
+
+	  if (listing)
+	    {
+	      listing_prev_line ();
+	      /* We may be at the start of a variant frag.  In case we
+                 are, make sure there is enough space for the frag
+                 after the frags created by listing_prev_line.  The
+                 argument to frag_grow here must be at least as large
+                 as the argument to all other calls to frag_grow in
+                 this file.  We don't have to worry about being in the
+                 middle of a variant frag, because the variants insert
+                 all needed nop instructions themselves.  */
+	      frag_grow (40);
+	    }
+
+	  mips_move_labels ();
+
+#ifndef NO_ECOFF_DEBUGGING
+	  if (ECOFF_DEBUGGING)
+	    ecoff_fix_loc (old_frag, old_frag_offset);
+#endif
+	}
+    }
+  else if (mips_relax.sequence != 2 && prev_nop_frag != NULL)
+    {
+      /* Work out how many nops in prev_nop_frag are needed by IP.  */
+      int nops = nops_for_insn_or_target (history, ip);
+      assert (nops <= prev_nop_frag_holds);
+
+      /* Enforce NOPS as a minimum.  */
+      if (nops > prev_nop_frag_required)
+	prev_nop_frag_required = nops;
+
+      if (prev_nop_frag_holds == prev_nop_frag_required)
+	{
+	  /* Settle for the current number of nops.  Update the history
+	     accordingly (for the benefit of any future .set reorder code).  */
+	  prev_nop_frag = NULL;
+	  insert_into_history (prev_nop_frag_since,
+			       prev_nop_frag_holds, NOP_INSN);
+	}
+      else
+	{
+	  /* Allow this instruction to replace one of the nops that was
+	     tentatively added to prev_nop_frag.  */
+	  prev_nop_frag->fr_fix -= mips_opts.mips16 ? 2 : 4;
+	  prev_nop_frag_holds--;
+	  prev_nop_frag_since++;
+	}
+    }
+
+#ifdef OBJ_ELF
+  /* The value passed to dwarf2_emit_insn is the distance between
+     the beginning of the current instruction and the address that
+     should be recorded in the debug tables.  For MIPS16 debug info
+     we want to use ISA-encoded addresses, so we pass -1 for an
+     address higher by one than the current.  */
+  dwarf2_emit_insn (mips_opts.mips16 ? -1 : 0);
+#endif
+
+  /* Record the frag type before frag_var.  */
+  if (history[0].frag)
+    prev_insn_frag_type = history[0].frag->fr_type;
+
+  if (address_expr
+      && *reloc_type == BFD_RELOC_16_PCREL_S2
+      && (pinfo & INSN_UNCOND_BRANCH_DELAY || pinfo & INSN_COND_BRANCH_DELAY
+	  || pinfo & INSN_COND_BRANCH_LIKELY)
+      && mips_relax_branch
+      /* Don't try branch relaxation within .set nomacro, or within
+	 .set noat if we use $at for PIC computations.  If it turns
+	 out that the branch was out-of-range, we'll get an error.  */
+      && !mips_opts.warn_about_macros
+      && !(mips_opts.noat && mips_pic != NO_PIC)
+      && !mips_opts.mips16)
+    {
+      relaxed_branch = TRUE;
+      add_relaxed_insn (ip, (relaxed_branch_length
+			     (NULL, NULL,
+			      (pinfo & INSN_UNCOND_BRANCH_DELAY) ? -1
+			      : (pinfo & INSN_COND_BRANCH_LIKELY) ? 1
+			      : 0)), 4,
+			RELAX_BRANCH_ENCODE
+			(pinfo & INSN_UNCOND_BRANCH_DELAY,
+			 pinfo & INSN_COND_BRANCH_LIKELY,
+			 pinfo & INSN_WRITE_GPR_31,
+			 0),
+			address_expr->X_add_symbol,
+			address_expr->X_add_number);
+      *reloc_type = BFD_RELOC_UNUSED;
+    }
+  else if (*reloc_type > BFD_RELOC_UNUSED)
+    {
+      /* We need to set up a variant frag.  */
+      assert (mips_opts.mips16 && address_expr != NULL);
+      add_relaxed_insn (ip, 4, 0,
+			RELAX_MIPS16_ENCODE
+			(*reloc_type - BFD_RELOC_UNUSED,
+			 mips16_small, mips16_ext,
+			 prev_pinfo & INSN_UNCOND_BRANCH_DELAY,
+			 history[0].mips16_absolute_jump_p),
+			make_expr_symbol (address_expr), 0);
+    }
+  else if (mips_opts.mips16
+	   && ! ip->use_extend
+	   && *reloc_type != BFD_RELOC_MIPS16_JMP)
+    {
+      if ((pinfo & INSN_UNCOND_BRANCH_DELAY) == 0)
+	/* Make sure there is enough room to swap this instruction with
+	   a following jump instruction.  */
+	frag_grow (6);
+      add_fixed_insn (ip);
+    }
+  else
+    {
+      if (mips_opts.mips16
+	  && mips_opts.noreorder
+	  && (prev_pinfo & INSN_UNCOND_BRANCH_DELAY) != 0)
+	as_warn (_("extended instruction in delay slot"));
+
+      if (mips_relax.sequence)
+	{
+	  /* If we've reached the end of this frag, turn it into a variant
+	     frag and record the information for the instructions we've
+	     written so far.  */
+	  if (frag_room () < 4)
+	    relax_close_frag ();
+	  mips_relax.sizes[mips_relax.sequence - 1] += 4;
+	}
+
+      if (mips_relax.sequence != 2)
+	mips_macro_warning.sizes[0] += 4;
+      if (mips_relax.sequence != 1)
+	mips_macro_warning.sizes[1] += 4;
+
+      if (mips_opts.mips16)
+	{
+	  ip->fixed_p = 1;
+	  ip->mips16_absolute_jump_p = (*reloc_type == BFD_RELOC_MIPS16_JMP);
+	}
+      add_fixed_insn (ip);
+    }
+
+  append_insn_reloc (ip, address_expr, reloc_type);
+  install_insn (ip);
+  mips_record_insn_regs (ip);
 
   if (mips_relax.sequence != 2 && !mips_opts.noreorder)
     {
@@ -3179,6 +3306,203 @@ append_insn (struct mips_cl_insn *ip, expressionS *address_expr,
   mips_clear_insn_labels ();
 }
 
+/* If S is a plain decimal or hexadecimal integer, possibly negated and
+   followed only by whitespace, store it in *EP, set expr_end to the end
+   of the number and return TRUE.  This gives the same result as
+   my_getSmallExpression for the immediates that the compiler writes,
+   without going through expression ().  */
+
+static bfd_boolean
+rigel_constant (expressionS *ep, char *s)
+{
+  bfd_boolean negative = FALSE;
+  offsetT value = 0;
+  unsigned int ndigits = 0;
+  char *end;
+
+  if (*s == '-')
+    {
+      negative = TRUE;
+      ++s;
+    }
+  if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    for (s += 2; ISXDIGIT (*s); ++s, ++ndigits)
+      value = value * 16 + hex_value (*s);
+  else if (s[0] == '0')
+    {
+      /* Leave octal numbers to expression ().  */
+      ++s;
+      ndigits = 1;
+    }
+  else
+    for (; ISDIGIT (*s); ++s, ++ndigits)
+      value = value * 10 + (*s - '0');
+
+  end = s;
+  s += strspn (s, " \t");
+  if (ndigits == 0 || ndigits > 8 || *s != '\0')
+    return FALSE;
+
+  memset (ep, 0, sizeof (*ep));
+  ep->X_op = O_constant;
+  ep->X_add_number = negative ? -value : value;
+  ep->X_unsigned = !negative;
+  expr_end = end;
+  return TRUE;
+}
+
+/* Parse a general register at *S for rigel_assemble.  Numbered registers
+   are decoded directly; anything else goes through reg_lookup.  */
+
+static bfd_boolean
+rigel_reg (char **s, unsigned int *regnop)
+{
+  char *p = *s;
+  unsigned int regno;
+
+  if (p[0] == '$' && ISDIGIT (p[1]))
+    {
+      regno = p[1] - '0';
+      p += 2;
+      if (ISDIGIT (*p) && regno != 0)
+	regno = regno * 10 + (*p++ - '0');
+      if (regno <= 31 && !is_part_of_name (*p))
+	{
+	  *s = p;
+	  *regnop = regno;
+	  return TRUE;
+	}
+    }
+  return reg_lookup (s, RTYPE_NUM | RTYPE_GP, regnop);
+}
+
+/* Try to assemble STR, a Rigel instruction in .set noreorder code, using
+   the operand forms that md_begin precompiled in rigel_insn_forms.  The
+   result is the same as for mips_ip and append_insn, but it skips the
+   opcode table search, the general operand matching and the nop and
+   delay-slot handling, none of which can apply.  Return FALSE without
+   having changed anything if STR needs the general path.  */
+
+static bfd_boolean
+rigel_assemble (char *str)
+{
+  const struct rigel_insn_form *form;
+  struct mips_opcode *mo;
+  struct mips_cl_insn insn;
+  expressionS ep;
+  bfd_reloc_code_real_type reloc[3];
+  offsetT minval, maxval;
+  unsigned int i, regno;
+  size_t name_len;
+  char *s, save_c;
+
+  for (s = str; *s != '\0' && !ISSPACE (*s); ++s)
+    continue;
+  name_len = s - str;
+  save_c = *s;
+  *s = '\0';
+  mo = (struct mips_opcode *) hash_find (op_hash, str);
+  *s = save_c;
+  if (mo == NULL)
+    return FALSE;
+  form = &rigel_insn_forms[mo - mips_opcodes];
+  if (!form->fast_p)
+    return FALSE;
+
+  create_insn (&insn, mo);
+  ep.X_op = O_absent;
+  reloc[0] = reloc[1] = reloc[2] = BFD_RELOC_UNUSED;
+  for (i = 0; i < form->nops; i++)
+    {
+      s += strspn (s, " \t");
+      if (i > 0)
+	{
+	  if (*s != ',')
+	    return FALSE;
+	  ++s;
+	  s += strspn (s, " \t");
+	}
+
+      switch (form->kind[i])
+	{
+	case 'd':
+	case 's':
+	case 't':
+	case 'A':
+	  if (!rigel_reg (&s, &regno))
+	    return FALSE;
+	  INSERT_BITS (insn.insn_opcode, regno, form->mask[i], form->shift[i]);
+	  continue;
+
+	case 'i':
+	case 'j':
+	case '5':
+	  if (form->kind[i] == 'i')
+	    minval = 0, maxval = 0xffff;
+	  else if (form->kind[i] == '5')
+	    minval = 0, maxval = 0x1f;
+	  else
+	    minval = -0x8000, maxval = 0x7fff;
+	  reloc[0] = BFD_RELOC_LO16;
+	  if ((rigel_constant (&ep, s)
+	       || my_getSmallExpression (&ep, reloc, s) == 0)
+	      && (ep.X_op == O_big
+		  || (ep.X_op == O_constant
+		      && (ep.X_add_number < minval
+			  || ep.X_add_number > maxval))))
+	    as_bad (_("expression out of range"));
+#ifdef RIGEL_32REG_CHANGES
+	  if (form->kind[i] == '5')
+	    {
+	      INSERT_OPERAND (IMM5, insn, ep.X_add_number);
+	      ep.X_add_number = 0;
+	    }
+#endif
+	  break;
+
+	case 'p':
+	  reloc[0] = BFD_RELOC_16_PCREL_S2;
+	  my_getExpression (&ep, s);
+	  break;
+
+	case 'a':
+	  reloc[0] = BFD_RELOC_MIPS_JMP;
+	  my_getExpression (&ep, s);
+	  break;
+
+	default:
+	  internalError ();
+	}
+      s = expr_end;
+    }
+
+  s += strspn (s, " \t");
+  if (*s != '\0')
+    {
+      /* Once an expression has been parsed, falling back on mips_ip
+	 would report any problems with it twice.  */
+      if (reloc[0] == BFD_RELOC_UNUSED)
+	return FALSE;
+      /* mips_ip names only the mnemonic in this error.  */
+      as_bad ("%s `%.*s'", _("illegal operands"), (int) name_len, str);
+      return TRUE;
+    }
+
+  /* This is all that append_insn does for a .set noreorder instruction
+     outside a macro.  */
+#ifdef OBJ_ELF
+  dwarf2_emit_insn (0);
+#endif
+  add_fixed_insn (&insn);
+  if (ep.X_op != O_absent)
+    append_insn_reloc (&insn, &ep, reloc);
+  install_insn (&insn);
+  mips_record_insn_regs (&insn);
+  insert_into_history (0, 1, &insn);
+  mips_clear_insn_labels ();
+  return TRUE;
+}
+
 /* Forget that there was any previous instruction or label.  */
 
 static void
@@ -10250,10 +10574,14 @@ struct option md_longopts[] =
 #define OPTION_MNO_SYM32 (OPTION_MISC_BASE + 15)
   {"msym32", no_argument, NULL, OPTION_MSYM32},
   {"mno-sym32", no_argument, NULL, OPTION_MNO_SYM32},
+#define OPTION_RIGEL_FAST (OPTION_MISC_BASE + 16)
+#define OPTION_NO_RIGEL_FAST (OPTION_MISC_BASE + 17)
+  {"mrigel-fast", no_argument, NULL, OPTION_RIGEL_FAST},
+  {"mno-rigel-fast", no_argument, NULL, OPTION_NO_RIGEL_FAST},
 
   /* ELF-specific options.  */
 #ifdef OBJ_ELF
-#define OPTION_ELF_BASE    (OPTION_MISC_BASE + 16)
+#define OPTION_ELF_BASE    (OPTION_MISC_BASE + 18)
 #define OPTION_CALL_SHARED (OPTION_ELF_BASE + 0)
   {"KPIC",        no_argument, NULL, OPTION_CALL_SHARED},
   {"call_shared", no_argument, NULL, OPTION_CALL_SHARED},
@@ -10527,6 +10855,14 @@ md_parse_option (int c, char *arg)
       mips_opts.sym32 = FALSE;
       break;
 
+    case OPTION_RIGEL_FAST:
+      mips_rigel_fast = 1;
+      break;
+
+    case OPTION_NO_RIGEL_FAST:
+      mips_rigel_fast = 0;
+      break;
+
 #ifdef OBJ_ELF
       /* When generating ELF code, we permit -KPIC and -call_shared to
 	 select SVR4_PIC, and -non_shared to select no PIC.  This is
@@ -14365,6 +14701,7 @@ MIPS options:\n\
 -mgp32			use 32-bit GPRs, regardless of the chosen ISA\n\
 -mfp32			use 32-bit FPRs, regardless of the chosen ISA\n\
 -msym32			assume all symbols have 32-bit values\n\
+-mno-rigel-fast		assemble Rigel .set noreorder code the general way\n\
 -O0			remove unneeded NOPs, do not swap branches\n\
 -O			remove unneeded NOPs and swap branches\n\
 --[no-]construct-floats [dis]allow floating point values to be constructed\n\
@@ -0,0 +1,14 @@
+# Errors in Rigel .set noreorder code are reported the same way with and
+# without -mno-rigel-fast.
+
+	.set	noreorder
+	.text
+	addi	$1, $2, 32768
+	addi	$1, $2, -32769
+	andi	$1, $2, -1
+	andi	$1, $2, 0x10000
+	slli	$1, $2, 32
+	add	$1, $2, $3, $4
+	ldw	$1, $2, %lo(v) junk
+	mvui	$1, %hi(v), 1
+	nosuchinsn	$1
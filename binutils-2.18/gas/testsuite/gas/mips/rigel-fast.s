@@ -0,0 +1,51 @@
+# Rigel .set noreorder code, assembled the same way with and without
+# -mno-rigel-fast.
+
+	.set	noreorder
+	.text
+	.globl	f
+	.ent	f
+f:
+	add	$1, $2, $3
+	sub	$4, $5, $6
+	and	$7, $8, $9
+	or	$10, $11, $12
+	xor	$13, $14, $15
+	nor	$16, $17, $18
+	mul	$19, $20, $21
+	addi	$1, $2, -32768
+	addi	$1, $2, 32767
+	subi	$3, $4, 1
+	andi	$5, $6, 0xffff
+	ori	$7, $8, 0
+	xori	$9, $10, 0x1234
+	slli	$11, $12, 31
+	srai	$13, $14, 0
+	srli	$15, $16, 7
+	clz	$17, $18
+	fadd	$1, $2, $3
+	i2f	$7, $8
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)
+	stw	$2, $1, %lo(v+4)
+	ldw	$3, $sp, 16
+	stw	$3, $sp, -4
+.Lloop:
+	beq	$1, $2, .Lout
+	nop
+	bne	$1, $zero, .Lloop
+	blt	$3, .Lloop
+	bge	$3, .Lout
+	jal	g
+	ljl	g
+	lj	.Lout
+	jmp	.Lloop
+	jalr	$4
+.Lout:
+	mfsr	$1, $2
+	mb
+	jmpr	$ra
+	.end	f
+
+	.data
+v:	.word	1, 2
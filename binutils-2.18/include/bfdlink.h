@@ -43,6 +43,15 @@ enum bfd_link_discard
   discard_all		/* Discard all locals.  */
 };
 
+/* Which code sections identical code folding may merge.  */
+enum bfd_link_icf
+{
+  icf_none,		/* Don't fold any sections.  */
+  icf_safe,		/* Fold only sections whose address is not
+			   taken.  */
+  icf_all		/* Fold every identical code section.  */
+};
+
 /* Describes the type of hash table entry structure being used.
    Different hash table structure have different fields and so
    support different linking features.  */
@@ -330,6 +339,9 @@ struct bfd_link_info
   /* TRUE if user shoudl be informed of removed unreferenced sections.  */
   unsigned int print_gc_sections: 1;
 
+  /* TRUE if user should be informed of folded identical sections.  */
+  unsigned int print_icf_sections: 1;
+
   /* TRUE if .hash section should be created.  */
   unsigned int emit_hash: 1;
 
@@ -368,6 +380,9 @@ struct bfd_link_info
   /* Which local symbols to discard.  */
   enum bfd_link_discard discard;
 
+  /* Which identical code sections to fold.  */
+  enum bfd_link_icf icf;
+
   /* Criteria for skipping symbols when detemining
      whether to include an object from an archive. */
   enum bfd_link_common_skip_ar_aymbols common_skip_ar_aymbols;
@@ -447,6 +462,10 @@ struct bfd_link_info
   /* How many spare .dynamic DT_NULL entries should be added?  */
   unsigned int spare_dynamic_tags;
 
+  /* How many worker processes the final link may use to relocate
+     input sections.  Zero or one means the link is done serially.  */
+  unsigned int jobs;
+
   /* May be used to set DT_FLAGS for ELF. */
   bfd_vma flags;
 
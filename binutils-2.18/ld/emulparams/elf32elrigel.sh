@@ -0,0 +1,7 @@
+# Rigel: little-endian embedded MIPS ELF.  Functions a profile showed to be
+# hot, or never run, are gathered at the start of .text, each group kept
+# together and apart from the other.
+. ${srcdir}/emulparams/elf32elmip.sh
+TEXT_START_SYMBOLS='_ftext = . ;
+    *(.text.hot .text.hot.*)
+    *(.text.unlikely .text.*_unlikely .text.unlikely.*)'
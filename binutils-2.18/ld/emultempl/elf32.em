@@ -1390,6 +1390,12 @@ gld${EMULATION_NAME}_before_allocation (void)
   if (link_info.hash->type == bfd_link_elf_hash_table)
     _bfd_elf_tls_setup (output_bfd, &link_info);
 
+  /* Fold identical code sections now that input sections have been
+     mapped, so that nothing is sized for the ones that go.  */
+  if (link_info.icf != icf_none
+      && !bfd_elf_fold_identical_sections (output_bfd, &link_info))
+    einfo ("%P%F: identical code folding failed: %E\n");
+
   /* If we are going to make any variable assignments, we need to let
      the ELF backend know about them in case the variables are
      referred to by dynamic objects.  */
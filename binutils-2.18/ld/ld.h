@@ -223,6 +223,10 @@ typedef struct {
 
   /* Default linker script.  */
   char *default_script;
+
+  /* File naming symbols whose sections go first in their output
+     sections, in order, from the --symbol-ordering-file option.  */
+  char *symbol_ordering_file;
 } args_type;
 
 extern args_type command_line;
@@ -5660,6 +5660,377 @@ lang_gc_sections (void)
     bfd_gc_sections (output_bfd, &link_info);
 }
 
+/* --symbol-ordering-file support.  Each symbol named in the file ranks
+   the input section defining it by the symbol's position in the file,
+   and ranked sections go first in their place in the script, in rank
+   order.  */
+
+struct symbol_order_entry
+{
+  struct bfd_hash_entry root;
+  /* Position of the name in the ordering file, counting from 1.  */
+  unsigned long rank;
+};
+
+struct section_rank
+{
+  asection *section;
+  unsigned long rank;
+};
+
+/* An input section statement being moved, and where it was.  */
+
+struct ranked_statement
+{
+  lang_statement_union_type *s;
+  unsigned long rank;
+  size_t index;
+};
+
+static struct bfd_hash_table symbol_order_table;
+static htab_t section_rank_table;
+
+static struct bfd_hash_entry *
+symbol_order_newfunc (struct bfd_hash_entry *entry,
+		      struct bfd_hash_table *table,
+		      const char *string)
+{
+  if (entry == NULL)
+    {
+      entry = bfd_hash_allocate (table, sizeof (struct symbol_order_entry));
+      if (entry == NULL)
+	return NULL;
+    }
+
+  entry = bfd_hash_newfunc (entry, table, string);
+  if (entry != NULL)
+    ((struct symbol_order_entry *) entry)->rank = 0;
+  return entry;
+}
+
+static hashval_t
+section_rank_hash (const void *p)
+{
+  return htab_hash_pointer (((const struct section_rank *) p)->section);
+}
+
+static int
+section_rank_eq (const void *p1, const void *p2)
+{
+  return (((const struct section_rank *) p1)->section
+	  == ((const struct section_rank *) p2)->section);
+}
+
+/* Give SEC rank RANK, unless a name earlier in the ordering file
+   already ranked it.  */
+
+static void
+rank_section (asection *sec, unsigned long rank)
+{
+  struct section_rank key, **slot;
+
+  if (sec == NULL
+      || bfd_is_abs_section (sec)
+      || bfd_is_und_section (sec)
+      || bfd_is_com_section (sec))
+    return;
+
+  key.section = sec;
+  slot = (struct section_rank **) htab_find_slot (section_rank_table, &key,
+						  INSERT);
+  if (*slot == NULL)
+    {
+      *slot = xmalloc (sizeof (**slot));
+      (*slot)->section = sec;
+      (*slot)->rank = rank;
+    }
+  else if ((*slot)->rank > rank)
+    (*slot)->rank = rank;
+}
+
+static unsigned long
+section_rank (asection *sec)
+{
+  struct section_rank key, *found;
+
+  key.section = sec;
+  found = htab_find (section_rank_table, &key);
+  return found != NULL ? found->rank : 0;
+}
+
+/* Read the ordering file and rank the sections defining the symbols
+   it names, global ones through the link hash table and, if some
+   names were not found there, local ones from the input files' symbol
+   tables.  */
+
+static void
+read_symbol_ordering_file (const char *filename)
+{
+  FILE *file;
+  char *buf;
+  size_t bufsize;
+  unsigned long count, unresolved;
+  int c;
+
+  file = fopen (filename, "r");
+  if (file == NULL)
+    {
+      bfd_set_error (bfd_error_system_call);
+      einfo ("%P%F: %s: %E\n", filename);
+    }
+
+  if (!bfd_hash_table_init (&symbol_order_table, symbol_order_newfunc,
+			    sizeof (struct symbol_order_entry)))
+    einfo (_("%P%F: bfd_hash_table_init failed: %E\n"));
+  section_rank_table = htab_create (1021, section_rank_hash,
+				    section_rank_eq, free);
+
+  bufsize = 100;
+  buf = xmalloc (bufsize);
+  count = 0;
+  unresolved = 0;
+
+  c = getc (file);
+  while (c != EOF)
+    {
+      while (ISSPACE (c))
+	c = getc (file);
+
+      /* Skip comments.  */
+      if (c == '#')
+	{
+	  while (c != '\n' && c != EOF)
+	    c = getc (file);
+	  continue;
+	}
+
+      if (c != EOF)
+	{
+	  struct symbol_order_entry *entry;
+	  struct bfd_link_hash_entry *h;
+	  size_t len = 0;
+
+	  while (! ISSPACE (c) && c != EOF)
+	    {
+	      buf[len] = c;
+	      ++len;
+	      if (len >= bufsize)
+		{
+		  bufsize *= 2;
+		  buf = xrealloc (buf, bufsize);
+		}
+	      c = getc (file);
+	    }
+
+	  buf[len] = '\0';
+
+	  entry = ((struct symbol_order_entry *)
+		   bfd_hash_lookup (&symbol_order_table, buf, TRUE, TRUE));
+	  if (entry == NULL)
+	    einfo (_("%P%F: bfd_hash_lookup for insertion failed: %E\n"));
+	  if (entry->rank != 0)
+	    continue;
+	  entry->rank = ++count;
+
+	  h = bfd_link_hash_lookup (link_info.hash, buf, FALSE, FALSE, TRUE);
+	  if (h != NULL
+	      && (h->type == bfd_link_hash_defined
+		  || h->type == bfd_link_hash_defweak))
+	    rank_section (h->u.def.section, entry->rank);
+	  else
+	    ++unresolved;
+	}
+    }
+
+  free (buf);
+  fclose (file);
+
+  if (unresolved == 0)
+    return;
+
+  LANG_FOR_EACH_INPUT_STATEMENT (f)
+    {
+      asymbol **asymbols, **syms;
+      long symsize, symbol_count;
+
+      if (f->just_syms_flag
+	  || (bfd_get_file_flags (f->the_bfd) & HAS_SYMS) == 0)
+	continue;
+
+      asymbols = f->asymbols;
+      if (asymbols == NULL)
+	{
+	  symsize = bfd_get_symtab_upper_bound (f->the_bfd);
+	  if (symsize < 0)
+	    einfo (_("%B%F: could not read symbols; %E\n"), f->the_bfd);
+	  asymbols = xmalloc (symsize);
+	  symbol_count = bfd_canonicalize_symtab (f->the_bfd, asymbols);
+	  if (symbol_count < 0)
+	    einfo (_("%B%F: could not read symbols: %E\n"), f->the_bfd);
+	  if (link_info.keep_memory)
+	    {
+	      f->asymbols = asymbols;
+	      f->symbol_count = symbol_count;
+	    }
+	}
+
+      for (syms = asymbols; *syms != NULL; ++syms)
+	{
+	  asymbol *sym = *syms;
+	  struct symbol_order_entry *entry;
+
+	  if ((sym->flags & BSF_LOCAL) == 0
+	      || (sym->flags & (BSF_SECTION_SYM | BSF_FILE)) != 0)
+	    continue;
+
+	  entry = ((struct symbol_order_entry *)
+		   bfd_hash_lookup (&symbol_order_table, sym->name,
+				    FALSE, FALSE));
+	  if (entry != NULL)
+	    rank_section (sym->section, entry->rank);
+	}
+
+      if (asymbols != f->asymbols)
+	free (asymbols);
+    }
+}
+
+static int
+compare_ranked_statements (const void *p1, const void *p2)
+{
+  const struct ranked_statement *r1 = p1;
+  const struct ranked_statement *r2 = p2;
+
+  if (r1->rank != r2->rank)
+    return r1->rank < r2->rank ? -1 : 1;
+  return r1->index < r2->index ? -1 : r1->index > r2->index;
+}
+
+/* Move the ranked input sections of each run of input section
+   statements in LIST to the front of the run, in rank order.  Other
+   statements, such as assignments between the runs, stay put.  */
+
+static void
+order_input_sections (lang_statement_list_type *list)
+{
+  lang_statement_union_type **pp = &list->head;
+  struct ranked_statement *run = NULL;
+  size_t alloc = 0;
+
+  while (*pp != NULL)
+    {
+      lang_statement_union_type **start = pp;
+      size_t n = 0, ranked = 0, i;
+
+      while (*pp != NULL && (*pp)->header.type == lang_input_section_enum)
+	{
+	  unsigned long rank = section_rank ((*pp)->input_section.section);
+
+	  if (n == alloc)
+	    {
+	      alloc = alloc ? 2 * alloc : 64;
+	      run = xrealloc (run, alloc * sizeof (*run));
+	    }
+	  run[n].s = *pp;
+	  run[n].rank = rank != 0 ? rank : (unsigned long) -1;
+	  run[n].index = n;
+	  if (rank != 0)
+	    ++ranked;
+	  ++n;
+	  pp = &(*pp)->header.next;
+	}
+
+      if (ranked != 0 && n > 1)
+	{
+	  lang_statement_union_type *rest = *pp;
+
+	  qsort (run, n, sizeof (*run), compare_ranked_statements);
+	  *start = run[0].s;
+	  for (i = 1; i < n; i++)
+	    run[i - 1].s->header.next = run[i].s;
+	  run[n - 1].s->header.next = rest;
+	  pp = &run[n - 1].s->header.next;
+	}
+
+      if (n == 0)
+	pp = &(*pp)->header.next;
+    }
+
+  list->tail = pp;
+  if (run != NULL)
+    free (run);
+}
+
+/* Rebuild the map_head/map_tail list of input sections of output
+   section OS to follow the statements under S.  */
+
+static void
+relink_input_sections (lang_statement_union_type *s, asection *os)
+{
+  for (; s != NULL; s = s->header.next)
+    {
+      if (s->header.type == lang_wild_statement_enum)
+	relink_input_sections (s->wild_statement.children.head, os);
+      else if (s->header.type == lang_input_section_enum)
+	{
+	  asection *section = s->input_section.section;
+	  asection *prev = os->map_tail.s;
+
+	  if (section->output_section != os)
+	    continue;
+	  os->map_tail.s = section;
+	  section->map_head.s = NULL;
+	  section->map_tail.s = prev;
+	  if (prev != NULL)
+	    prev->map_head.s = section;
+	  else
+	    os->map_head.s = section;
+	}
+    }
+}
+
+static void
+order_statement_input_sections (lang_statement_union_type *s)
+{
+  switch (s->header.type)
+    {
+    case lang_wild_statement_enum:
+      order_input_sections (&s->wild_statement.children);
+      break;
+    case lang_output_section_statement_enum:
+      order_input_sections (&s->output_section_statement.children);
+      break;
+    default:
+      break;
+    }
+}
+
+/* Apply --symbol-ordering-file to the input sections just mapped to
+   output sections.  */
+
+static void
+lang_order_sections_by_symbols (void)
+{
+  lang_output_section_statement_type *os;
+
+  read_symbol_ordering_file (command_line.symbol_ordering_file);
+  lang_for_each_statement (order_statement_input_sections);
+
+  if (!link_info.relocatable)
+    for (os = &lang_output_section_statement.head->output_section_statement;
+	 os != NULL;
+	 os = os->next)
+      if (os->constraint != -1 && os->bfd_section != NULL)
+	{
+	  os->bfd_section->map_head.s = NULL;
+	  os->bfd_section->map_tail.s = NULL;
+	  relink_input_sections (os->children.head, os->bfd_section);
+	}
+
+  htab_delete (section_rank_table);
+  bfd_hash_table_free (&symbol_order_table);
+}
+
 /* Relax all sections until bfd_relax_section gives up.  */
 
 static void
@@ -5757,6 +6128,11 @@ lang_process (void)
   /* Find any sections not attached explicitly and handle them.  */
   lang_place_orphans ();
 
+  /* Put the sections defining the symbols in --symbol-ordering-file
+     first, in the order the file gives.  */
+  if (command_line.symbol_ordering_file != NULL)
+    lang_order_sections_by_symbols ();
+
   if (! link_info.relocatable)
     {
       asection *found;
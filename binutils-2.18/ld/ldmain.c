@@ -294,6 +294,8 @@ main (int argc, char **argv)
     {
       if (link_info.gc_sections)
 	einfo ("%P%F: --gc-sections and -r may not be used together\n");
+      else if (link_info.icf != icf_none)
+	einfo (_("%P%F: --icf and -r may not be used together\n"));
       else if (command_line.relax)
 	einfo (_("%P%F: --relax and -r may not be used together\n"));
       if (link_info.shared)
@@ -90,6 +90,7 @@ enum option_values
   OPTION_OFORMAT,
   OPTION_RELAX,
   OPTION_RETAIN_SYMBOLS_FILE,
+  OPTION_SYMBOL_ORDERING_FILE,
   OPTION_RPATH,
   OPTION_RPATH_LINK,
   OPTION_SHARED,
@@ -132,7 +133,11 @@ enum option_values
   OPTION_NO_GC_SECTIONS,
   OPTION_PRINT_GC_SECTIONS,
   OPTION_NO_PRINT_GC_SECTIONS,
+  OPTION_ICF,
+  OPTION_PRINT_ICF_SECTIONS,
+  OPTION_NO_PRINT_ICF_SECTIONS,
   OPTION_HASH_SIZE,
+  OPTION_JOBS,
   OPTION_CHECK_SECTIONS,
   OPTION_NO_CHECK_SECTIONS,
   OPTION_NO_UNDEFINED,
@@ -396,8 +401,21 @@ static const struct ld_option ld_options[] =
     TWO_DASHES },
   { {"help", no_argument, NULL, OPTION_HELP},
     '\0', NULL, N_("Print option help"), TWO_DASHES },
+  { {"icf", required_argument, NULL, OPTION_ICF},
+    '\0', N_("[none|safe|all]"),
+    N_("Fold identical code sections (on some targets)"), TWO_DASHES },
+  { {"print-icf-sections", no_argument, NULL, OPTION_PRINT_ICF_SECTIONS},
+    '\0', NULL, N_("List folded identical sections on stderr"),
+    TWO_DASHES },
+  { {"no-print-icf-sections", no_argument, NULL,
+     OPTION_NO_PRINT_ICF_SECTIONS},
+    '\0', NULL, N_("Do not list folded identical sections"),
+    TWO_DASHES },
   { {"init", required_argument, NULL, OPTION_INIT},
     '\0', N_("SYMBOL"), N_("Call SYMBOL at load-time"), ONE_DASH },
+  { {"jobs", required_argument, NULL, OPTION_JOBS},
+    '\0', N_("N"), N_("Relocate input sections in N processes"),
+    TWO_DASHES },
   { {"Map", required_argument, NULL, OPTION_MAP},
     '\0', N_("FILE"), N_("Write a map file"), ONE_DASH },
   { {"no-define-common", no_argument, NULL, OPTION_NO_DEFINE_COMMON},
@@ -488,6 +506,10 @@ static const struct ld_option ld_options[] =
     TWO_DASHES },
   { {"stats", no_argument, NULL, OPTION_STATS},
     '\0', NULL, N_("Print memory usage statistics"), TWO_DASHES },
+  { {"symbol-ordering-file", required_argument, NULL,
+     OPTION_SYMBOL_ORDERING_FILE},
+    '\0', N_("FILE"), N_("Place sections defining symbols in FILE first"),
+    TWO_DASHES },
   { {"target-help", no_argument, NULL, OPTION_TARGET_HELP},
     '\0', NULL, N_("Display target specific options"), TWO_DASHES },
   { {"task-link", required_argument, NULL, OPTION_TASK_LINK},
@@ -850,6 +872,19 @@ parse_args (unsigned argc, char **argv)
 	case OPTION_PRINT_GC_SECTIONS:
 	  link_info.print_gc_sections = TRUE;
 	  break;
+	case OPTION_ICF:
+	  if (strcmp (optarg, "none") == 0)
+	    link_info.icf = icf_none;
+	  else if (strcmp (optarg, "safe") == 0)
+	    link_info.icf = icf_safe;
+	  else if (strcmp (optarg, "all") == 0)
+	    link_info.icf = icf_all;
+	  else
+	    einfo (_("%P%F: bad --icf option: %s\n"), optarg);
+	  break;
+	case OPTION_PRINT_ICF_SECTIONS:
+	  link_info.print_icf_sections = TRUE;
+	  break;
 	case OPTION_HELP:
 	  help ();
 	  xexit (0);
@@ -896,6 +931,9 @@ parse_args (unsigned argc, char **argv)
 	case OPTION_NO_PRINT_GC_SECTIONS:
 	  link_info.print_gc_sections = FALSE;
 	  break;
+	case OPTION_NO_PRINT_ICF_SECTIONS:
+	  link_info.print_icf_sections = FALSE;
+	  break;
 	case OPTION_NO_KEEP_MEMORY:
 	  link_info.keep_memory = FALSE;
 	  break;
@@ -1097,6 +1135,9 @@ parse_args (unsigned argc, char **argv)
 	case OPTION_RETAIN_SYMBOLS_FILE:
 	  add_keepsyms_file (optarg);
 	  break;
+	case OPTION_SYMBOL_ORDERING_FILE:
+	  command_line.symbol_ordering_file = optarg;
+	  break;
 	case 'S':
 	  link_info.strip = strip_debugger;
 	  break;
@@ -1433,6 +1474,18 @@ parse_args (unsigned argc, char **argv)
               einfo (_("%P%X: --hash-size needs a numeric argument\n"));
           }
           break;
+
+	case OPTION_JOBS:
+	  {
+	    char *end;
+	    unsigned long jobs;
+
+	    jobs = strtoul (optarg, &end, 0);
+	    if (*optarg == '\0' || *end != '\0')
+	      einfo (_("%P%F: invalid number `%s'\n"), optarg);
+	    link_info.jobs = jobs;
+	  }
+	  break;
 	}
     }
 
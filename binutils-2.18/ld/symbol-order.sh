@@ -0,0 +1,101 @@
+#!/bin/sh
+# symbol-order.sh - make an ld --symbol-ordering-file from a profile
+# Copyright 2026 Free Software Foundation, Inc.
+#
+# This file is part of the Gnu Linker.
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3, or (at your option)
+# any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with GLD; see the file COPYING.  If not, write to the Free
+# Software Foundation, 51 Franklin Street - Fifth Floor, Boston, MA
+# 02110-1301, USA.
+#
+# Usage:
+#   symbol-order.sh [--nm=NM] EXECUTABLE HISTOGRAM
+#	HISTOGRAM has one "PC COUNT" pair per line, PC in hex, as the
+#	Rigel simulator's PC histogram dump writes it.  The samples are
+#	added up per function of EXECUTABLE, using NM to find where
+#	functions start.  NM defaults to nm, or in the installed copy to
+#	the nm installed with it.
+#   symbol-order.sh --gprof FLAT-PROFILE
+#	FLAT-PROFILE is the output of `gprof -b -p'.
+#
+# Either way the functions that were seen are written to standard
+# output, hottest first, one per line.  Functions with the same count
+# keep their address (or gprof) order.
+
+NM=nm
+
+case "$1" in
+  --nm=*)
+    NM=`echo "$1" | sed -e 's/^--nm=//'`
+    shift
+    ;;
+esac
+
+case "$1" in
+  --gprof)
+    if test $# -ne 2; then
+      echo "usage: $0 --gprof FLAT-PROFILE" 1>&2
+      exit 1
+    fi
+    # Rows of the flat profile start with the percentage of time; the
+    # name is the last field.  Keep the functions that took time or
+    # were called.
+    awk '
+      $1 ~ /^[0-9.]+$/ && NF >= 4 {
+	calls = (NF >= 7) ? $4 : 0
+	if ($3 + 0 > 0 || calls + 0 > 0)
+	  print $NF
+      }' "$2"
+    exit $?
+    ;;
+esac
+
+if test $# -ne 2; then
+  echo "usage: $0 [--nm=NM] EXECUTABLE HISTOGRAM" 1>&2
+  echo "       $0 --gprof FLAT-PROFILE" 1>&2
+  exit 1
+fi
+
+exe=$1
+hist=$2
+
+syms=`mktemp ${TMPDIR-/tmp}/symorderXXXXXX` || exit 1
+trap 'rm -f "$syms"' 0 1 2 15
+
+"$NM" -n --defined-only "$exe" | awk '$2 ~ /^[Tt]$/ { print $1, "F", $3 }' \
+  > "$syms" || exit 1
+
+# nm pads addresses to the target's width with zeros, so padding the
+# PCs the same way lets sort order both by address as plain strings.
+width=`awk 'NR == 1 { print length ($1) }' "$syms"`
+test -n "$width" || exit 0
+
+{
+  cat "$syms"
+  awk -v width="$width" '
+    NF >= 2 && $1 !~ /^#/ {
+      pc = tolower ($1)
+      sub (/^0x/, "", pc)
+      while (length (pc) < width)
+	pc = "0" pc
+      print pc, "P", $2
+    }' "$hist"
+} | LC_ALL=C sort -k1,1 -k2,2 | awk '
+  $2 == "F" { fn = $3; if (!(fn in order)) order[fn] = ++n; next }
+  fn != "" { count[fn] += $3 }
+  END {
+    for (fn in count)
+      if (count[fn] > 0)
+	printf "%.0f %d %s\n", count[fn], order[fn], fn
+  }' | LC_ALL=C sort -k1,1nr -k2,2n | awk '{ print $3 }'
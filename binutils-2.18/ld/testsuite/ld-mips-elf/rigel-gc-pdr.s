@@ -0,0 +1,30 @@
+# With --gc-sections, the .pdr record of a removed function goes too, and
+# the records of the others are kept.  The records don't keep the functions
+# they describe.
+
+	.section .text.used,"ax",@progbits
+	.globl	used
+	.type	used, @function
+	.ent	used
+used:
+	jmpr	$ra
+	.end	used
+	.size	used, .-used
+
+	.section .text.unused,"ax",@progbits
+	.globl	unused
+	.type	unused, @function
+	.ent	unused
+unused:
+	jmpr	$ra
+	.end	unused
+	.size	unused, .-unused
+
+	.section .text.also,"ax",@progbits
+	.globl	also
+	.type	also, @function
+	.ent	also
+also:
+	jmpr	$ra
+	.end	also
+	.size	also, .-also
@@ -0,0 +1,52 @@
+# f and g have the same code and relocations, so --icf=all folds g into f
+# and the call to g goes to f.  h differs in one word and is kept.
+
+	.section .text.main,"ax",@progbits
+	.globl	main
+	.type	main, @function
+	.ent	main
+main:
+	ljl	f
+	ljl	g
+	ljl	h
+	jmpr	$ra
+	.end	main
+	.size	main, .-main
+
+	.section .text.f,"ax",@progbits
+	.globl	f
+	.type	f, @function
+	.ent	f
+f:
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)
+	jmpr	$ra
+	.end	f
+	.size	f, .-f
+
+	.section .text.g,"ax",@progbits
+	.globl	g
+	.type	g, @function
+	.ent	g
+g:
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)
+	jmpr	$ra
+	.end	g
+	.size	g, .-g
+
+	.section .text.h,"ax",@progbits
+	.globl	h
+	.type	h, @function
+	.ent	h
+h:
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)+4
+	jmpr	$ra
+	.end	h
+	.size	h, .-h
+
+	.data
+	.globl	v
+v:
+	.word	0, 0
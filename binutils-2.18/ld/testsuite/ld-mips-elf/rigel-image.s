@@ -0,0 +1,24 @@
+# A program with code, data and zero-initialized data for conversion to a
+# Rigel memory image.  The .bss shares a page with .data, so they make one
+# segment.
+
+	.text
+	.globl	_start
+	.type	_start, @function
+	.ent	_start
+_start:
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)
+	jmpr	$ra
+	.end	_start
+	.size	_start, .-_start
+
+	.data
+	.globl	v
+v:
+	.word	0x11223344, 0x55667788
+
+	.bss
+	.globl	b
+b:
+	.space	16
@@ -0,0 +1,66 @@
+# Links of this and rigel-jobs-2.s with --jobs=4 must give the same output
+# as serial ones.  There are enough sections for several workers, with
+# calls and %hi/%lo pairs that cross between them, functions and data for
+# --gc-sections to drop and long jumps for --relax to shorten.
+
+	.section .text.main,"ax",@progbits
+	.globl	main
+	.type	main, @function
+	.ent	main
+main:
+	ljl	f1
+	ljl	f2
+	ljl	f3
+	ljl	f4
+	mvui	$1, %hi(v1)
+	ldw	$2, $1, %lo(v1)
+	mvui	$3, %hi(v2)
+	ldw	$2, $3, %lo(v2)
+	jmpr	$ra
+	.end	main
+	.size	main, .-main
+
+	.section .text.f1,"ax",@progbits
+	.globl	f1
+	.type	f1, @function
+	.ent	f1
+f1:
+	mvui	$1, %hi(v1)
+	ldw	$2, $1, %lo(v1)
+	ljl	f3
+	jmpr	$ra
+	.end	f1
+	.size	f1, .-f1
+
+	.section .text.f2,"ax",@progbits
+	.globl	f2
+	.type	f2, @function
+	.ent	f2
+f2:
+	mvui	$1, %hi(v2)
+	ldw	$2, $1, %lo(v2)
+	lj	f4
+	.end	f2
+	.size	f2, .-f2
+
+	.section .text.unused1,"ax",@progbits
+	.globl	unused1
+	.type	unused1, @function
+	.ent	unused1
+unused1:
+	mvui	$1, %hi(u1)
+	ldw	$2, $1, %lo(u1)
+	ljl	f1
+	jmpr	$ra
+	.end	unused1
+	.size	unused1, .-unused1
+
+	.section .data.v1,"aw",@progbits
+	.globl	v1
+v1:
+	.word	0, 1, 2, 3
+
+	.section .data.u1,"aw",@progbits
+	.globl	u1
+u1:
+	.word	0, 1, 2, 3, 4, 5, 6, 7
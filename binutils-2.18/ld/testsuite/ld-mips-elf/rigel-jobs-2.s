@@ -0,0 +1,47 @@
+# See rigel-jobs-1.s.
+
+	.section .text.f3,"ax",@progbits
+	.globl	f3
+	.type	f3, @function
+	.ent	f3
+f3:
+	mvui	$1, %hi(v2)
+	ldw	$2, $1, %lo(v2)
+	ljl	f4
+	jmpr	$ra
+	.end	f3
+	.size	f3, .-f3
+
+	.section .text.f4,"ax",@progbits
+	.globl	f4
+	.type	f4, @function
+	.ent	f4
+f4:
+	mvui	$1, %hi(v1)
+	ldw	$2, $1, %lo(v1)
+	mvui	$3, %hi(v2)
+	ldw	$2, $3, %lo(v2)
+	jmpr	$ra
+	.end	f4
+	.size	f4, .-f4
+
+	.section .text.unused2,"ax",@progbits
+	.globl	unused2
+	.type	unused2, @function
+	.ent	unused2
+unused2:
+	mvui	$1, %hi(u2)
+	ldw	$2, $1, %lo(u2)
+	lj	f2
+	.end	unused2
+	.size	unused2, .-unused2
+
+	.section .data.v2,"aw",@progbits
+	.globl	v2
+v2:
+	.word	0, 1, 2, 3
+
+	.section .data.u2,"aw",@progbits
+	.globl	u2
+u2:
+	.word	0, 1, 2, 3, 4, 5, 6, 7
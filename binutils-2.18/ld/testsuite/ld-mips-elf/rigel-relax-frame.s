@@ -0,0 +1,42 @@
+# .debug_frame uses DW_CFA_set_loc, which relaxation cannot update, so the
+# mvui stays and the linker says why.
+
+	.text
+	.globl	f
+	.type	f, @function
+	.ent	f
+f:
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)
+	addi	$1, $zero, 0
+	jmpr	$ra
+	.end	f
+.Lf_end:
+	.size	f, .-f
+
+	.data
+	.globl	v
+v:	.word	1
+
+	.section .debug_frame,"",@progbits
+.Lcie:
+	.4byte	.Lcie_end - .Lcie_start
+.Lcie_start:
+	.4byte	0xffffffff
+	.byte	1
+	.asciz	""
+	.uleb128 1
+	.sleb128 -4
+	.byte	31
+	.align	2
+.Lcie_end:
+	.4byte	.Lfde_end - .Lfde_start
+.Lfde_start:
+	.4byte	.Lcie
+	.4byte	f
+	.4byte	.Lf_end - f
+	.byte	0x01
+	.4byte	f + 8
+	.byte	0x0e, 16
+	.align	2
+.Lfde_end:
@@ -0,0 +1,68 @@
+# An mvui whose %hi is zero goes, and the %lo users are rebased on $zero.
+# The line, frame and arange info for the function shrinks with it.
+
+	.text
+	.globl	f
+	.type	f, @function
+	.ent	f
+f:
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)
+	addi	$1, $zero, 0
+.Lf_cfa:
+	jmpr	$ra
+	.end	f
+.Lf_end:
+	.size	f, .-f
+
+# $1 is read after the ldw, so this mvui has to stay.
+	.globl	h
+	.type	h, @function
+	.ent	h
+h:
+	mvui	$1, %hi(v)
+	ldw	$2, $1, %lo(v)
+	add	$2, $2, $1
+	jmpr	$ra
+	.end	h
+.Lh_end:
+	.size	h, .-h
+
+	.data
+	.globl	v
+v:	.word	1
+
+	.section .debug_frame,"",@progbits
+.Lcie:
+	.4byte	.Lcie_end - .Lcie_start
+.Lcie_start:
+	.4byte	0xffffffff
+	.byte	1
+	.asciz	""
+	.uleb128 1
+	.sleb128 -4
+	.byte	31
+	.byte	0x0c, 29, 0
+	.align	2
+.Lcie_end:
+	.4byte	.Lfde_end - .Lfde_start
+.Lfde_start:
+	.4byte	.Lcie
+	.4byte	f
+	.4byte	.Lf_end - f
+	.byte	0x40 + (.Lf_cfa - f)
+	.byte	0x0e, 16
+	.align	2
+.Lfde_end:
+
+	.section .debug_aranges,"",@progbits
+	.4byte	.Lar_end - .Lar_start
+.Lar_start:
+	.2byte	2
+	.4byte	0
+	.byte	4, 0
+	.4byte	0
+	.4byte	f
+	.4byte	.Lh_end - f
+	.4byte	0, 0
+.Lar_end:
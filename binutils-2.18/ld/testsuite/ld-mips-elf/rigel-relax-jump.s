@@ -0,0 +1,30 @@
+# lj and ljl to a target in branch range become jmp and jal, and an ljl to
+# a target out of range is left alone.
+
+	.text
+	.globl	f
+	.type	f, @function
+	.ent	f
+f:
+	jmpr	$ra
+	.end	f
+	.size	f, .-f
+
+	.globl	g
+	.type	g, @function
+	.ent	g
+g:
+	ljl	f
+	lj	f
+	ljl	far
+	.end	g
+	.size	g, .-g
+
+	.section .far,"ax",@progbits
+	.globl	far
+	.type	far, @function
+	.ent	far
+far:
+	jmpr	$ra
+	.end	far
+	.size	far, .-far
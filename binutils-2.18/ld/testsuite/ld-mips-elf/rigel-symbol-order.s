@@ -0,0 +1,46 @@
+# Each function has a section of its own, for --symbol-ordering-file to
+# move around.  e is local.
+
+	.section .text.a,"ax",@progbits
+	.globl	a
+	.type	a, @function
+	.ent	a
+a:
+	jmpr	$ra
+	.end	a
+	.size	a, .-a
+
+	.section .text.b,"ax",@progbits
+	.globl	b
+	.type	b, @function
+	.ent	b
+b:
+	jmpr	$ra
+	.end	b
+	.size	b, .-b
+
+	.section .text.c,"ax",@progbits
+	.globl	c
+	.type	c, @function
+	.ent	c
+c:
+	jmpr	$ra
+	.end	c
+	.size	c, .-c
+
+	.section .text.d,"ax",@progbits
+	.globl	d
+	.type	d, @function
+	.ent	d
+d:
+	jmpr	$ra
+	.end	d
+	.size	d, .-d
+
+	.section .text.e,"ax",@progbits
+	.type	e, @function
+	.ent	e
+e:
+	jmpr	$ra
+	.end	e
+	.size	e, .-e
@@ -1273,6 +1273,117 @@ print_insn_args (const char *d,
     }
 }
 
+/* The opcode table is searched with a decode tree.  Most Rigel
+   instructions share major opcode 0 and differ only in the function bits,
+   so bucketing on the major opcode alone leaves a long linear scan.
+
+   An inner node of the tree switches on a field of up to
+   MIPS_DECODE_FIELD_BITS bits that every opcode below it fixes in its
+   mask.  A leaf lists the opcodes that are left, in table order, so the
+   first one that matches is the one a scan of the whole table would have
+   found.  */
+
+#define MIPS_DECODE_FIELD_BITS	8
+#define MIPS_DECODE_LEAF_SIZE	2
+
+struct mips_decode_node
+{
+  /* The field this node switches on, or 0 for a leaf.  */
+  unsigned long mask;
+  unsigned int shift;
+  union
+  {
+    struct mips_decode_node *children;
+    /* NULL-terminated.  */
+    const struct mips_opcode **ops;
+  } u;
+};
+
+static const struct mips_opcode *mips_decode_empty[1];
+
+/* Fill in NODE for the NOPS opcodes in OPS, none of which can be told apart
+   by the bits in TESTED any more.  */
+
+static void
+mips_build_decode_node (struct mips_decode_node *node,
+			const struct mips_opcode **ops, unsigned int nops,
+			unsigned long tested)
+{
+  const struct mips_opcode **sub;
+  unsigned long common = 0xffffffff & ~tested;
+  unsigned int i, n, hi, width, value;
+
+  for (i = 0; i < nops; i++)
+    common &= ops[i]->mask;
+
+  node->mask = 0;
+  if (nops == 0)
+    {
+      node->u.ops = mips_decode_empty;
+      return;
+    }
+  if (nops <= MIPS_DECODE_LEAF_SIZE || common == 0)
+    {
+      node->u.ops = xmalloc ((nops + 1) * sizeof (*ops));
+      memcpy (node->u.ops, ops, nops * sizeof (*ops));
+      node->u.ops[nops] = NULL;
+      return;
+    }
+
+  /* Switch on the highest run of bits that all the opcodes fix.  */
+  for (hi = 31; (common & (1ul << hi)) == 0; hi--)
+    ;
+  for (width = 1;
+       width < MIPS_DECODE_FIELD_BITS && width <= hi
+	 && (common & (1ul << (hi - width))) != 0;
+       width++)
+    ;
+  node->shift = hi - width + 1;
+  node->mask = ((1ul << width) - 1) << node->shift;
+  node->u.children = xmalloc ((1 << width) * sizeof (*node->u.children));
+
+  sub = xmalloc (nops * sizeof (*ops));
+  for (value = 0; value < (1u << width); value++)
+    {
+      for (i = n = 0; i < nops; i++)
+	if (((ops[i]->match & node->mask) >> node->shift) == value)
+	  sub[n++] = ops[i];
+      mips_build_decode_node (&node->u.children[value], sub, n,
+			      tested | node->mask);
+    }
+  free (sub);
+}
+
+/* Return the NULL-terminated list of opcodes WORD may be, in table
+   order.  */
+
+static const struct mips_opcode **
+mips_decode_candidates (unsigned long word)
+{
+  static struct mips_decode_node root;
+  static bfd_boolean init = 0;
+  const struct mips_decode_node *node;
+
+  if (! init)
+    {
+      const struct mips_opcode **ops;
+      const struct mips_opcode *op;
+      unsigned int n = 0;
+
+      ops = xmalloc (NUMOPCODES * sizeof (*ops));
+      for (op = mips_opcodes; op < &mips_opcodes[NUMOPCODES]; op++)
+	if (op->pinfo != INSN_MACRO)
+	  ops[n++] = op;
+      mips_build_decode_node (&root, ops, n, 0);
+      free (ops);
+      init = 1;
+    }
+
+  for (node = &root; node->mask != 0; )
+    node = &node->u.children[(word & node->mask) >> node->shift];
+  return node->u.ops;
+}
+
 /* Print the mips instruction at address MEMADDR in debugged memory,
    on using INFO.  Returns length of the instruction, in bytes, which is
    always INSNLEN.  BIGENDIAN must be 1 if this is big-endian code, 0 if
@@ -1283,32 +1394,8 @@ print_insn_mips (bfd_vma memaddr,
 		 unsigned long int word,
 		 struct disassemble_info *info)
 {
+  const struct mips_opcode **ops;
   const struct mips_opcode *op;
-  static bfd_boolean init = 0;
-  static const struct mips_opcode *mips_hash[OP_MASK_OP + 1];
-
-  /* Build a hash table to shorten the search time.  */
-  if (! init)
-    {
-      unsigned int i;
-
-      for (i = 0; i <= OP_MASK_OP; i++)
-	{
-	  for (op = mips_opcodes; op < &mips_opcodes[NUMOPCODES]; op++)
-	    {
-	      if (op->pinfo == INSN_MACRO
-		  || (no_aliases && (op->pinfo2 & INSN2_ALIAS)))
-		continue;
-	      if (i == ((op->match >> OP_SH_OP) & OP_MASK_OP))
-		{
-		  mips_hash[i] = op;
-		  break;
-		}
-	    }
-	}
-
-      init = 1;
-    }
 
   info->bytes_per_chunk = INSNLEN;
   info->display_endian = info->endian;
@@ -1319,55 +1406,50 @@ print_insn_mips (bfd_vma memaddr,
   info->target = 0;
   info->target2 = 0;
 
-  op = mips_hash[(word >> OP_SH_OP) & OP_MASK_OP];
-  if (op != NULL)
+  for (ops = mips_decode_candidates (word); (op = *ops) != NULL; ops++)
     {
-      for (; op < &mips_opcodes[NUMOPCODES]; op++)
+      if (!(no_aliases && (op->pinfo2 & INSN2_ALIAS))
+	  && (word & op->mask) == op->match)
 	{
-	  if (op->pinfo != INSN_MACRO 
-	      && !(no_aliases && (op->pinfo2 & INSN2_ALIAS))
-	      && (word & op->mask) == op->match)
-	    {
-	      const char *d;
-
-	      /* We always allow to disassemble the jalx instruction.  */
-	      if (! OPCODE_IS_MEMBER (op, mips_isa, mips_processor)
-		  && strcmp (op->name, "jalx"))
-		continue;
-
-	      /* Figure out instruction type and branch delay information.  */
-	      if ((op->pinfo & INSN_UNCOND_BRANCH_DELAY) != 0)
-	        {
-		  if ((info->insn_type & INSN_WRITE_GPR_31) != 0)
-		    info->insn_type = dis_jsr;
-		  else
-		    info->insn_type = dis_branch;
-		  info->branch_delay_insns = 1;
-		}
-	      else if ((op->pinfo & (INSN_COND_BRANCH_DELAY
-				     | INSN_COND_BRANCH_LIKELY)) != 0)
-		{
-		  if ((info->insn_type & INSN_WRITE_GPR_31) != 0)
-		    info->insn_type = dis_condjsr;
-		  else
-		    info->insn_type = dis_condbranch;
-		  info->branch_delay_insns = 1;
-		}
-	      else if ((op->pinfo & (INSN_STORE_MEMORY
-				     | INSN_LOAD_MEMORY_DELAY)) != 0)
-		info->insn_type = dis_dref;
+	  const char *d;
 
-	      (*info->fprintf_func) (info->stream, "%s", op->name);
+	  /* We always allow to disassemble the jalx instruction.  */
+	  if (! OPCODE_IS_MEMBER (op, mips_isa, mips_processor)
+	      && strcmp (op->name, "jalx"))
+	    continue;
 
-	      d = op->args;
-	      if (d != NULL && *d != '\0')
-		{
-		  (*info->fprintf_func) (info->stream, " "); // DRJ: space was \t, changed
-		  print_insn_args (d, word, memaddr, info, op);
-		}
+	  /* Figure out instruction type and branch delay information.  */
+	  if ((op->pinfo & INSN_UNCOND_BRANCH_DELAY) != 0)
+	    {
+	      if ((info->insn_type & INSN_WRITE_GPR_31) != 0)
+		info->insn_type = dis_jsr;
+	      else
+		info->insn_type = dis_branch;
+	      info->branch_delay_insns = 1;
+	    }
+	  else if ((op->pinfo & (INSN_COND_BRANCH_DELAY
+				 | INSN_COND_BRANCH_LIKELY)) != 0)
+	    {
+	      if ((info->insn_type & INSN_WRITE_GPR_31) != 0)
+		info->insn_type = dis_condjsr;
+	      else
+		info->insn_type = dis_condbranch;
+	      info->branch_delay_insns = 1;
+	    }
+	  else if ((op->pinfo & (INSN_STORE_MEMORY
+				 | INSN_LOAD_MEMORY_DELAY)) != 0)
+	    info->insn_type = dis_dref;
 
-	      return INSNLEN;
+	  (*info->fprintf_func) (info->stream, "%s", op->name);
+
+	  d = op->args;
+	  if (d != NULL && *d != '\0')
+	    {
+	      (*info->fprintf_func) (info->stream, " "); // DRJ: space was \t, changed
+	      print_insn_args (d, word, memaddr, info, op);
 	    }
+
+	  return INSNLEN;
 	}
     }
 
@@ -0,0 +1,48 @@
+//===-- llvm/IntrinsicsRigel.h - Rigel special registers --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the Rigel special register numbers taken by the
+// llvm.rigel.read.sr, llvm.rigel.read.sr.volatile and llvm.rigel.write.sr
+// intrinsics.  It is shared by the Rigel backend and the clang builtins.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_INTRINSICS_RIGEL_H
+#define LLVM_INTRINSICS_RIGEL_H
+
+namespace llvm {
+
+namespace RigelSR {
+  /// SpecialReg - Special register numbers.  These must match the
+  /// simulator's special register file layout.
+  enum SpecialReg {
+    CoreID     = 0,
+    ClusterID  = 1,
+    CycleCount = 5,
+    NumThreads = 6
+  };
+
+  /// isImmutable - Return true if the special register's value is fixed for
+  /// the life of a thread, so that reads of it may use the readnone
+  /// llvm.rigel.read.sr and be CSE'd and hoisted.
+  inline bool isImmutable(unsigned SR) {
+    switch (SR) {
+    case CoreID:
+    case ClusterID:
+    case NumThreads:
+      return true;
+    default:
+      return false;
+    }
+  }
+} // End RigelSR namespace
+
+} // End llvm namespace
+
+#endif
@@ -14,6 +14,8 @@
 #ifndef LLVM_TRANSFORMS_INSTRUMENTATION_H
 #define LLVM_TRANSFORMS_INSTRUMENTATION_H
 
+#include <string>
+
 namespace llvm {
 
 class ModulePass;
@@ -25,6 +27,10 @@ ModulePass *createEdgeProfilerPass();
 // Insert optimal edge profiling instrumentation
 ModulePass *createOptimalEdgeProfilerPass();
 
+// Attach an edge profile to the terminators as !prof metadata.  An empty
+// filename means the one given with -profile-metadata-file.
+ModulePass *createProfileMetadataLoaderPass(const std::string &Filename = "");
+
 } // End llvm namespace
 
 #endif
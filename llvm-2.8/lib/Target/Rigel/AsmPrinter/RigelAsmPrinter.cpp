@@ -63,6 +63,7 @@ namespace {
     void printOperand(const MachineInstr *MI, int opNum, raw_ostream &O);
     void printOperand(const MachineInstr *MI, int opNum, raw_ostream &O, const char *Modifier);
     void printUnsignedImm(const MachineInstr *MI, int opNum, raw_ostream &O);
+    void printSPRFOperand(const MachineInstr *MI, int opNum, raw_ostream &O);
     void printMemOperand(const MachineInstr *MI, int opNum, raw_ostream &O, 
                          const char *Modifier = 0);
     //void printModuleLevelGV(const GlobalVariable* GVar);
@@ -241,8 +242,12 @@ void RigelAsmPrinter:: printOperand(const MachineInstr *MI, int opNum,
       break;
 
     case MachineOperand::MO_Immediate:
+      // Inline asm constants were range-checked against their constraint
+      // (I/K/L) already; print them as written.
+      if (MI->isInlineAsm()) {
+        O << MO.getImm();
       // We may need to add more here
-      if ((MI->getOpcode() == Rigel::ORi)  || (MI->getOpcode() == Rigel::ANDi)
+      } else if ((MI->getOpcode() == Rigel::ORi)  || (MI->getOpcode() == Rigel::ANDi)
        || (MI->getOpcode() == Rigel::XORi) || (MI->getOpcode() == Rigel::MVUi)) {
         O << (unsigned short int)MO.getImm();
       } else {
@@ -268,6 +273,11 @@ void RigelAsmPrinter:: printOperand(const MachineInstr *MI, int opNum,
       O << *GetExternalSymbolSymbol(MO.getSymbolName());
       break;
 
+    // Code shared by the outliner.
+    case MachineOperand::MO_MCSymbol:
+      O << *MO.getMCSymbol();
+      break;
+
     case MachineOperand::MO_JumpTableIndex:
 			if (MI->getOpcode() == Rigel::MVUi)
 				O << "%hi(";
@@ -312,6 +322,14 @@ void RigelAsmPrinter:: printUnsignedImm(const MachineInstr *MI, int opNum,
     printOperand(MI, opNum, O);
 }
 
+// Special register numbers go in the rt field, so the assembler wants them
+// spelled like a register.
+void RigelAsmPrinter:: printSPRFOperand(const MachineInstr *MI, int opNum,
+			raw_ostream &O) 
+{
+  O << '$' << MI->getOperand(opNum).getImm();
+}
+
 void RigelAsmPrinter::
 printMemOperand(const MachineInstr *MI, int opNum, raw_ostream &O, 
 		const char *Modifier) 
@@ -15,11 +15,14 @@
 #ifndef TARGET_RIGEL_H
 #define TARGET_RIGEL_H
 
+#include "llvm/System/DataTypes.h"
 #include "llvm/Target/TargetMachine.h"
 
 namespace llvm {
   class RigelTargetMachine;
+  class BasicBlock;
   class FunctionPass;
+  class ModulePass;
   class MachineCodeEmitter;
   class formatted_raw_ostream;
 
@@ -28,6 +31,17 @@ namespace llvm {
   //FunctionPass *createRigelCodePrinterPass(raw_ostream &OS, 
                                           //RigelTargetMachine &TM);
 	FunctionPass *createRigelExpandPseudoPass();
+  FunctionPass *createRigelAlignmentInferencePass(RigelTargetMachine &TM);
+  FunctionPass *createRigelSpinWaitPass();
+  ModulePass *createRigelLoopParallelizePass(RigelTargetMachine &TM);
+  FunctionPass *createRigelModuloSchedulePass();
+  ModulePass *createRigelHotColdSplitPass();
+  FunctionPass *createRigelBlockPlacementPass();
+  FunctionPass *createRigelOutlinerPass();
+
+  /// getRigelProfileCount - Read the execution count that
+  /// -profile-metadata-loader recorded for BB.  Returns false if BB has none.
+  bool getRigelProfileCount(const BasicBlock *BB, uint64_t &Count);
   extern Target TheRigelTarget;
   //extern Target TheRigelelTarget;
 } // end namespace llvm;
@@ -0,0 +1,220 @@
+//===-- RigelAlignmentInference.cpp - Raise load/store alignment -----*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Rigel has no unaligned or subword memory operations, so RigelISelLowering
+// turns any i32/i16 access it can't prove word-aligned into a call to
+// __unalignedldi32/__unalignedldi16/__unalignedsti32.  The frontend is
+// conservative about the alignment it puts on loads and stores (packed
+// structs, casts through char *, etc.), so this pass runs right before
+// instruction selection and raises the alignment of each load and store to
+// the largest alignment that can be proven for its address.
+//
+// Alignment is derived from allocas, globals and GEPs (through known bits and
+// the preferred alignment of defined globals), and from pointer arguments
+// carrying an align or byval attribute.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "rigel-align"
+#include "Rigel.h"
+#include "RigelTargetMachine.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/GlobalVariable.h"
+#include "llvm/Instructions.h"
+#include "llvm/Operator.h"
+#include "llvm/Pass.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Support/GetElementPtrTypeIterator.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Target/TargetData.h"
+#include <algorithm>
+using namespace llvm;
+
+STATISTIC(NumLoadsRaised,  "Number of loads with raised alignment");
+STATISTIC(NumStoresRaised, "Number of stores with raised alignment");
+
+namespace {
+  class RigelAlignmentInference : public FunctionPass {
+    const TargetData *TD;
+
+  public:
+    static char ID;
+    explicit RigelAlignmentInference(const TargetData *td)
+      : FunctionPass(ID), TD(td) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    virtual const char *getPassName() const {
+      return "Rigel load/store alignment inference";
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesCFG();
+    }
+
+  private:
+    unsigned getKnownAlignment(Value *V, unsigned Depth);
+    unsigned getKnownBitsAlignment(Value *V);
+    unsigned getArgumentAlignment(Argument *A);
+    unsigned getGEPAlignment(GEPOperator *GEP, unsigned Depth);
+  };
+  char RigelAlignmentInference::ID = 0;
+}
+
+// Don't chase pointers through long chains of PHIs and selects.
+static const unsigned MaxDepth = 6;
+// Anything beyond this is as good as aligned for Rigel's 32-bit accesses, and
+// keeping it bounded keeps MinAlign() well-behaved for null-ish constants.
+static const unsigned MaxAlignment = 1 << 16;
+
+/// getKnownBitsAlignment - Alignment implied by the known-zero low bits of V.
+/// ValueTracking already understands allocas, globals and GEPs off of them.
+unsigned RigelAlignmentInference::getKnownBitsAlignment(Value *V) {
+  unsigned BitWidth = TD->getPointerSizeInBits();
+  APInt Mask = APInt::getAllOnesValue(BitWidth);
+  APInt KnownZero(BitWidth, 0), KnownOne(BitWidth, 0);
+  ComputeMaskedBits(V, Mask, KnownZero, KnownOne, TD);
+  unsigned TrailZ = KnownZero.countTrailingOnes();
+  if (TrailZ >= 16)
+    return MaxAlignment;
+  return 1u << TrailZ;
+}
+
+/// getArgumentAlignment - Pointer arguments are only known to be aligned if
+/// the caller promised it, either with an explicit align attribute or by
+/// passing the pointee byval (in which case the callee owns the copy).
+unsigned RigelAlignmentInference::getArgumentAlignment(Argument *A) {
+  if (!A->getType()->isPointerTy())
+    return 1;
+  const Function *F = A->getParent();
+  unsigned Align = F->getParamAlignment(A->getArgNo() + 1);
+  if (Align == 0 && A->hasByValAttr()) {
+    const Type *ElTy = cast<PointerType>(A->getType())->getElementType();
+    Align = TD->getABITypeAlignment(ElTy);
+  }
+  return Align ? Align : 1;
+}
+
+/// getGEPAlignment - The alignment of a GEP is the alignment of its base,
+/// limited by the constant part of the offset and by the element size of
+/// every variable index.
+unsigned RigelAlignmentInference::getGEPAlignment(GEPOperator *GEP,
+                                                  unsigned Depth) {
+  unsigned Align = getKnownAlignment(GEP->getPointerOperand(), Depth + 1);
+  uint64_t Offset = 0;
+  gep_type_iterator GTI = gep_type_begin(GEP);
+  for (User::op_iterator I = GEP->idx_begin(), E = GEP->idx_end();
+       I != E; ++I, ++GTI) {
+    Value *Idx = *I;
+    if (const StructType *STy = dyn_cast<StructType>(*GTI)) {
+      unsigned Field = cast<ConstantInt>(Idx)->getZExtValue();
+      Offset += TD->getStructLayout(STy)->getElementOffset(Field);
+      continue;
+    }
+    uint64_t Size = TD->getTypeAllocSize(GTI.getIndexedType());
+    if (ConstantInt *CI = dyn_cast<ConstantInt>(Idx))
+      Offset += CI->getSExtValue() * Size;
+    else
+      Align = MinAlign(Align, Size);
+  }
+  return MinAlign(Align, Offset);
+}
+
+/// getKnownAlignment - Largest power of two that V is known to be a multiple
+/// of.  Always returns at least 1.
+unsigned RigelAlignmentInference::getKnownAlignment(Value *V, unsigned Depth) {
+  unsigned Align = getKnownBitsAlignment(V);
+  if (Depth >= MaxDepth || Align >= MaxAlignment)
+    return Align;
+
+  if (Argument *A = dyn_cast<Argument>(V))
+    return std::max(Align, getArgumentAlignment(A));
+
+  // Globals we define are emitted with their preferred alignment, which can
+  // be larger than what the frontend recorded (e.g. packed structs).  This
+  // matches SelectionDAG::InferPtrAlignment().  A weak definition may be
+  // replaced by a less aligned one at link time.
+  if (GlobalVariable *GV = dyn_cast<GlobalVariable>(V))
+    if (GV->hasInitializer() && !GV->mayBeOverridden())
+      return std::max(Align, TD->getPreferredAlignment(GV));
+
+  if (BitCastInst *BC = dyn_cast<BitCastInst>(V))
+    return std::max(Align, getKnownAlignment(BC->getOperand(0), Depth + 1));
+  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(V))
+    if (CE->getOpcode() == Instruction::BitCast)
+      return std::max(Align, getKnownAlignment(CE->getOperand(0), Depth + 1));
+
+  if (GEPOperator *GEP = dyn_cast<GEPOperator>(V))
+    return std::max(Align, getGEPAlignment(GEP, Depth));
+
+  if (SelectInst *SI = dyn_cast<SelectInst>(V)) {
+    unsigned T = getKnownAlignment(SI->getTrueValue(), Depth + 1);
+    unsigned F = getKnownAlignment(SI->getFalseValue(), Depth + 1);
+    return std::max(Align, std::min(T, F));
+  }
+
+  if (PHINode *PN = dyn_cast<PHINode>(V)) {
+    // Give up on self-referencing PHIs rather than reasoning about the cycle;
+    // the depth limit catches longer ones.
+    unsigned Min = MaxAlignment;
+    for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e && Min > 1; ++i) {
+      Value *In = PN->getIncomingValue(i);
+      if (In == PN)
+        return Align;
+      Min = std::min(Min, getKnownAlignment(In, Depth + 1));
+    }
+    return std::max(Align, Min);
+  }
+
+  return Align;
+}
+
+bool RigelAlignmentInference::runOnFunction(Function &F) {
+  bool Changed = false;
+  for (Function::iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB) {
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+      if (LoadInst *LI = dyn_cast<LoadInst>(I)) {
+        unsigned Cur = LI->getAlignment();
+        if (Cur == 0)
+          Cur = TD->getABITypeAlignment(LI->getType());
+        //Only word alignment matters to Rigel; don't bother past that.
+        if (Cur >= 4)
+          continue;
+        unsigned Known = getKnownAlignment(LI->getPointerOperand(), 0);
+        if (Known > Cur) {
+          LI->setAlignment(std::min(Known, MaxAlignment));
+          ++NumLoadsRaised;
+          Changed = true;
+        }
+      } else if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+        unsigned Cur = SI->getAlignment();
+        if (Cur == 0)
+          Cur = TD->getABITypeAlignment(SI->getOperand(0)->getType());
+        if (Cur >= 4)
+          continue;
+        unsigned Known = getKnownAlignment(SI->getPointerOperand(), 0);
+        if (Known > Cur) {
+          SI->setAlignment(std::min(Known, MaxAlignment));
+          ++NumStoresRaised;
+          Changed = true;
+        }
+      }
+    }
+  }
+  return Changed;
+}
+
+/// createRigelAlignmentInferencePass - Returns a pass that raises the
+/// alignment of loads and stores to what can be proven about their addresses.
+FunctionPass *llvm::createRigelAlignmentInferencePass(RigelTargetMachine &TM) {
+  return new RigelAlignmentInference(TM.getTargetData());
+}
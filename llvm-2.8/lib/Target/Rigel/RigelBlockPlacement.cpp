@@ -0,0 +1,318 @@
+//===-- RigelBlockPlacement.cpp - Profile-guided block layout ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Lays out the blocks of a function from the edge profile that
+// -profile-metadata-loader attached to the IR, so the hot path through the
+// function falls through and blocks the training run never reached end up
+// behind everything else.  With the small per-core instruction caches, code
+// that is never fetched should not share lines with code that is.
+//
+// Chains are built bottom-up in the manner of Pettis and Hansen: edges are
+// visited from the hottest down and an edge joins two chains when its source
+// ends one and its destination starts the other.  The chain holding the entry
+// block goes first, the remaining chains follow from the hottest down, and
+// chains made only of cold blocks go last in their original order.  Blocks
+// whose branches AnalyzeBranch cannot rewrite stay glued to the block they
+// fall into.
+//
+// Functions without profile data, and functions with landing pads, keep the
+// layout they have.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "rigel-block-placement"
+#include "Rigel.h"
+#include "llvm/Constants.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Metadata.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include <algorithm>
+using namespace llvm;
+
+STATISTIC(NumMoved, "Number of blocks moved by profile-guided placement");
+STATISTIC(NumCold,  "Number of cold blocks moved to the end of a function");
+
+static cl::opt<bool>
+DisableBlockPlacement("disable-rigel-block-placement", cl::Hidden,
+                      cl::desc("Disable profile-guided block placement"));
+
+/// getRigelProfileCount - Read the execution count of BB from the !prof
+/// metadata on its terminator.
+bool llvm::getRigelProfileCount(const BasicBlock *BB, uint64_t &Count) {
+  const TerminatorInst *TI = BB->getTerminator();
+  if (!TI)
+    return false;
+  const MDNode *MD = TI->getMetadata("prof");
+  if (!MD || MD->getNumOperands() == 0)
+    return false;
+  const ConstantInt *CI = dyn_cast_or_null<ConstantInt>(MD->getOperand(0));
+  if (!CI)
+    return false;
+  Count = CI->getZExtValue();
+  return true;
+}
+
+/// getEdgeCount - Read the count of the IR edge BB->Succ, summing duplicate
+/// edges out of switches.
+static bool getEdgeCount(const BasicBlock *BB, const BasicBlock *Succ,
+                         uint64_t &Count) {
+  const TerminatorInst *TI = BB->getTerminator();
+  const MDNode *MD = TI->getMetadata("prof");
+  if (!MD || MD->getNumOperands() != TI->getNumSuccessors() + 1)
+    return false;
+  bool Found = false;
+  Count = 0;
+  for (unsigned s = 0, e = TI->getNumSuccessors(); s != e; ++s) {
+    if (TI->getSuccessor(s) != Succ)
+      continue;
+    const ConstantInt *CI = dyn_cast_or_null<ConstantInt>(MD->getOperand(s+1));
+    if (!CI)
+      return false;
+    Count += CI->getZExtValue();
+    Found = true;
+  }
+  return Found;
+}
+
+namespace {
+  struct PlacementEdge {
+    MachineBasicBlock *From, *To;
+    uint64_t Weight;
+    unsigned Order;   // position of From in the original layout
+  };
+
+  struct HotterEdge {
+    bool operator()(const PlacementEdge &A, const PlacementEdge &B) const {
+      if (A.Weight != B.Weight)
+        return A.Weight > B.Weight;
+      return A.Order < B.Order;
+    }
+  };
+
+  class RigelBlockPlacement : public MachineFunctionPass {
+    const TargetInstrInfo *TII;
+
+    // Chains[i] is the i'th chain of blocks; ChainOf maps a block to the
+    // chain it currently belongs to.  Merged chains are left empty.
+    std::vector<std::vector<MachineBasicBlock*> > Chains;
+    DenseMap<MachineBasicBlock*, unsigned> ChainOf;
+
+    DenseMap<MachineBasicBlock*, uint64_t> Counts;
+    DenseMap<MachineBasicBlock*, bool> Cold;
+
+  public:
+    static char ID;
+    RigelBlockPlacement() : MachineFunctionPass(ID) {}
+
+    virtual bool runOnMachineFunction(MachineFunction &MF);
+
+    virtual const char *getPassName() const {
+      return "Rigel profile-guided block placement";
+    }
+
+  private:
+    bool isRewritable(MachineBasicBlock *MBB) const;
+    uint64_t getEdgeWeight(MachineBasicBlock *From, MachineBasicBlock *To);
+    bool canChain(MachineBasicBlock *From, MachineBasicBlock *To) const;
+    void mergeChains(unsigned Into, unsigned From);
+    uint64_t getChainHeat(unsigned C) const;
+    bool isColdChain(unsigned C) const;
+  };
+  char RigelBlockPlacement::ID = 0;
+}
+
+/// isRewritable - Return true if the branches at the end of MBB can be
+/// rewritten by updateTerminator once its layout successor changes.
+bool RigelBlockPlacement::isRewritable(MachineBasicBlock *MBB) const {
+  MachineBasicBlock *TBB = 0, *FBB = 0;
+  SmallVector<MachineOperand, 4> Cond;
+  if (TII->AnalyzeBranch(*MBB, TBB, FBB, Cond))
+    return false;
+  // updateTerminator expects a conditional branch to have two distinct
+  // successors.
+  return Cond.empty() || MBB->succ_size() == 2;
+}
+
+/// getEdgeWeight - Estimate how often the edge From->To was taken.  Edges
+/// that line up with an IR edge use its count; edges inside a block that
+/// instruction selection split use the block's count.
+uint64_t RigelBlockPlacement::getEdgeWeight(MachineBasicBlock *From,
+                                            MachineBasicBlock *To) {
+  const BasicBlock *FromBB = From->getBasicBlock();
+  const BasicBlock *ToBB = To->getBasicBlock();
+  uint64_t Count;
+  if (FromBB && ToBB && FromBB != ToBB && getEdgeCount(FromBB, ToBB, Count))
+    return Count;
+  if (From->succ_size() == 1 && Counts.count(From))
+    return Counts[From];
+  if (To->pred_size() == 1 && Counts.count(To))
+    return Counts[To];
+  if (FromBB && FromBB == ToBB && Counts.count(From))
+    return Counts[From];
+  return 0;
+}
+
+/// canChain - Return true if From may be laid out directly before To.
+bool RigelBlockPlacement::canChain(MachineBasicBlock *From,
+                                   MachineBasicBlock *To) const {
+  if (From == To || To == &To->getParent()->front())
+    return false;
+  unsigned FromChain = ChainOf.lookup(From), ToChain = ChainOf.lookup(To);
+  if (FromChain == ToChain)
+    return false;
+  return Chains[FromChain].back() == From && Chains[ToChain].front() == To &&
+         isRewritable(From);
+}
+
+void RigelBlockPlacement::mergeChains(unsigned Into, unsigned From) {
+  std::vector<MachineBasicBlock*> &Src = Chains[From];
+  for (unsigned i = 0, e = Src.size(); i != e; ++i) {
+    ChainOf[Src[i]] = Into;
+    Chains[Into].push_back(Src[i]);
+  }
+  Src.clear();
+}
+
+uint64_t RigelBlockPlacement::getChainHeat(unsigned C) const {
+  uint64_t Heat = 0;
+  for (unsigned i = 0, e = Chains[C].size(); i != e; ++i)
+    Heat = std::max(Heat, Counts.lookup(Chains[C][i]));
+  return Heat;
+}
+
+bool RigelBlockPlacement::isColdChain(unsigned C) const {
+  for (unsigned i = 0, e = Chains[C].size(); i != e; ++i)
+    if (!Cold.lookup(Chains[C][i]))
+      return false;
+  return true;
+}
+
+bool RigelBlockPlacement::runOnMachineFunction(MachineFunction &MF) {
+  if (DisableBlockPlacement || MF.size() < 3)
+    return false;
+
+  // Gather the block counts.  Blocks created during code generation have no
+  // IR block of their own and stay uncounted.
+  Counts.clear();
+  Cold.clear();
+  std::vector<MachineBasicBlock*> Layout;
+  for (MachineFunction::iterator I = MF.begin(), E = MF.end(); I != E; ++I) {
+    MachineBasicBlock *MBB = I;
+    if (MBB->isLandingPad())
+      return false;
+    Layout.push_back(MBB);
+    uint64_t Count;
+    if (MBB->getBasicBlock() &&
+        getRigelProfileCount(MBB->getBasicBlock(), Count))
+      Counts[MBB] = Count;
+  }
+  MachineBasicBlock *Entry = Layout.front();
+  if (!Counts.count(Entry) || Counts[Entry] == 0)
+    return false;
+
+  TII = MF.getTarget().getInstrInfo();
+  Chains.clear();
+  ChainOf.clear();
+  for (unsigned i = 0, e = Layout.size(); i != e; ++i) {
+    MachineBasicBlock *MBB = Layout[i];
+    Cold[MBB] = Counts.count(MBB) && Counts[MBB] == 0;
+    ChainOf[MBB] = i;
+    Chains.push_back(std::vector<MachineBasicBlock*>(1, MBB));
+  }
+
+  // Blocks that fall through with a branch we cannot rewrite have to stay
+  // in front of their layout successor.
+  for (unsigned i = 0, e = Layout.size(); i + 1 < e; ++i)
+    if (!isRewritable(Layout[i]) && Layout[i]->canFallThrough())
+      mergeChains(ChainOf[Layout[i]], ChainOf[Layout[i+1]]);
+
+  // Join chains along the hottest edges first.
+  std::vector<PlacementEdge> Edges;
+  for (unsigned i = 0, e = Layout.size(); i != e; ++i) {
+    MachineBasicBlock *MBB = Layout[i];
+    for (MachineBasicBlock::succ_iterator SI = MBB->succ_begin(),
+           SE = MBB->succ_end(); SI != SE; ++SI) {
+      PlacementEdge Edge = { MBB, *SI, getEdgeWeight(MBB, *SI), i };
+      if (Edge.Weight)
+        Edges.push_back(Edge);
+    }
+  }
+  std::stable_sort(Edges.begin(), Edges.end(), HotterEdge());
+  for (unsigned i = 0, e = Edges.size(); i != e; ++i)
+    if (canChain(Edges[i].From, Edges[i].To))
+      mergeChains(ChainOf[Edges[i].From], ChainOf[Edges[i].To]);
+
+  // Whatever was never executed keeps the fall-throughs it had, as long as
+  // that does not pull cold code into a hot chain.
+  for (unsigned i = 0, e = Layout.size(); i + 1 < e; ++i) {
+    MachineBasicBlock *MBB = Layout[i], *Next = Layout[i+1];
+    if (MBB->isSuccessor(Next) && Cold[MBB] == Cold[Next] &&
+        canChain(MBB, Next))
+      mergeChains(ChainOf[MBB], ChainOf[Next]);
+  }
+
+  // Entry chain first, then the other warm chains from the hottest down,
+  // then the cold chains.
+  std::vector<std::pair<uint64_t, unsigned> > Warm;
+  std::vector<unsigned> ColdChains;
+  unsigned EntryChain = ChainOf[Entry];
+  for (unsigned C = 0, e = Chains.size(); C != e; ++C) {
+    if (Chains[C].empty() || C == EntryChain)
+      continue;
+    if (isColdChain(C))
+      ColdChains.push_back(C);
+    else
+      Warm.push_back(std::make_pair(~getChainHeat(C), C));
+  }
+  std::stable_sort(Warm.begin(), Warm.end());
+
+  std::vector<MachineBasicBlock*> Order(Chains[EntryChain]);
+  for (unsigned i = 0, e = Warm.size(); i != e; ++i)
+    Order.insert(Order.end(), Chains[Warm[i].second].begin(),
+                 Chains[Warm[i].second].end());
+  for (unsigned i = 0, e = ColdChains.size(); i != e; ++i) {
+    NumCold += Chains[ColdChains[i]].size();
+    Order.insert(Order.end(), Chains[ColdChains[i]].begin(),
+                 Chains[ColdChains[i]].end());
+  }
+  assert(Order.size() == Layout.size() && "Lost a block while placing!");
+
+  if (Order == Layout)
+    return false;
+
+  DEBUG(dbgs() << "Rigel: new block order for " << MF.getFunction()->getName()
+               << ":");
+  for (unsigned i = 1, e = Order.size(); i != e; ++i) {
+    DEBUG(dbgs() << " BB#" << Order[i]->getNumber());
+    if (Order[i] != Layout[i])
+      ++NumMoved;
+    Order[i]->moveAfter(Order[i-1]);
+  }
+  DEBUG(dbgs() << "\n");
+
+  // Fix up the branches for the new fall-throughs.
+  for (unsigned i = 0, e = Order.size(); i != e; ++i)
+    if (isRewritable(Order[i]))
+      Order[i]->updateTerminator();
+  return true;
+}
+
+/// createRigelBlockPlacementPass - Returns a pass that lays out blocks from
+/// the edge profile attached to the IR.
+FunctionPass *llvm::createRigelBlockPlacementPass() {
+  return new RigelBlockPlacement();
+}
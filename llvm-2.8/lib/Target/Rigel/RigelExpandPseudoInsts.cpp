@@ -17,6 +17,7 @@
 #define DEBUG_TYPE "rigel-pseudo"
 #include "Rigel.h"
 #include "RigelInstrInfo.h"
+#include "llvm/Constants.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/Target/TargetRegisterInfo.h"
@@ -112,6 +113,36 @@ bool RigelExpandPseudo::ExpandMBB(MachineBasicBlock &MBB) {
       MI.eraseFromParent();
       break;
     }
+    case Rigel::MOVf32imm: {
+      unsigned DstReg = MI.getOperand(0).getReg();
+      bool DstIsDead = MI.getOperand(0).isDead();
+      unsigned Imm = (unsigned)MI.getOperand(1).getFPImm()->getValueAPF()
+                                 .bitcastToAPInt().getZExtValue();
+      unsigned Lo16 = Imm & 0xffff;
+      unsigned Hi16 = (Imm >> 16) & 0xffff;
+
+      //FP and integer values share registers, so this is the same mvui/ori
+      //pair as MOVi32imm, except that a zero half is simply left out.
+      if (Hi16 == 0) {
+        BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Rigel::ORi))
+          .addReg(DstReg, getDefRegState(true) | getDeadRegState(DstIsDead))
+          .addReg(Rigel::ZERO)
+          .addImm(Lo16);
+      } else if (Lo16 == 0) {
+        BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Rigel::MVUi))
+          .addReg(DstReg, getDefRegState(true) | getDeadRegState(DstIsDead))
+          .addImm(Hi16);
+      } else {
+        BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Rigel::MVUi), DstReg)
+          .addImm(Hi16);
+        BuildMI(MBB, MBBI, MI.getDebugLoc(), TII->get(Rigel::ORi))
+          .addReg(DstReg, getDefRegState(true) | getDeadRegState(DstIsDead))
+          .addReg(DstReg)
+          .addImm(Lo16);
+      }
+      MI.eraseFromParent();
+      break;
+    }
     }
 
     if (ModifiedOp)
@@ -0,0 +1,210 @@
+//===-- RigelHotColdSplit.cpp - Outline cold code ---------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Moves code that the edge profile says was never executed out of functions
+// that were, so the hot part of each function is packed into as few
+// instruction cache lines as possible.
+//
+// A cold region is a block with a zero count together with the zero-count
+// blocks it dominates that are entered only from inside the region.  Regions
+// of at least -rigel-cold-split-min-size instructions are outlined with the
+// code extractor.  The outlined functions carry a zero entry count, which
+// RigelTargetObjectFile places in .text.unlikely along with the functions the
+// training run never called.
+//
+// Only functions with profile data (see -profile-metadata-loader) and without
+// invokes are split.  Outlining adds functions to the module, so this is a
+// module pass; the outlined functions themselves are not visited.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "rigel-hot-cold-split"
+#include "Rigel.h"
+#include "llvm/Constants.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/IntrinsicInst.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Metadata.h"
+#include "llvm/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/FunctionUtils.h"
+using namespace llvm;
+
+STATISTIC(NumColdRegions, "Number of cold regions outlined");
+
+static cl::opt<unsigned>
+ColdSplitMinSize("rigel-cold-split-min-size", cl::Hidden,
+                 cl::desc("Smallest cold region to outline, in instructions "
+                          "(default=16)"),
+                 cl::init(16));
+
+namespace {
+  class RigelHotColdSplit : public ModulePass {
+    DominatorTree *DT;
+
+  public:
+    static char ID;
+    RigelHotColdSplit() : ModulePass(ID) {}
+
+    virtual bool runOnModule(Module &M);
+
+    virtual const char *getPassName() const {
+      return "Rigel hot/cold function splitting";
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<DominatorTree>();
+    }
+
+  private:
+    bool runOnFunction(Function &F);
+    bool findColdRegion(BasicBlock *Header, std::vector<BasicBlock*> &Region);
+    void markCold(TerminatorInst *TI);
+  };
+  char RigelHotColdSplit::ID = 0;
+}
+
+static bool isCold(BasicBlock *BB) {
+  uint64_t Count;
+  return getRigelProfileCount(BB, Count) && Count == 0;
+}
+
+/// findColdRegion - Collect the cold region headed by Header into Region,
+/// header first.  Returns false if it is too small to be worth a call.
+bool RigelHotColdSplit::findColdRegion(BasicBlock *Header,
+                                       std::vector<BasicBlock*> &Region) {
+  SmallPtrSet<BasicBlock*, 16> InRegion;
+  SmallVector<DomTreeNode*, 16> Worklist;
+  Worklist.push_back(DT->getNode(Header));
+  while (!Worklist.empty()) {
+    DomTreeNode *N = Worklist.pop_back_val();
+    BasicBlock *BB = N->getBlock();
+    if (!isCold(BB) || BB->hasAddressTaken())
+      continue;
+    InRegion.insert(BB);
+    Worklist.append(N->begin(), N->end());
+  }
+
+  // Everything is dominated by the header, but a block with a warm
+  // predecessor would give the region a second entry.  Dropping a block can
+  // expose another, so go until nothing changes.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (SmallPtrSet<BasicBlock*, 16>::iterator I = InRegion.begin(),
+           E = InRegion.end(); I != E; ++I) {
+      BasicBlock *BB = *I;
+      if (BB == Header)
+        continue;
+      for (pred_iterator PI = pred_begin(BB), PE = pred_end(BB); PI != PE; ++PI)
+        if (!InRegion.count(*PI)) {
+          InRegion.erase(BB);
+          Changed = true;
+          break;
+        }
+      if (Changed)
+        break;
+    }
+  }
+
+  // Keep the blocks in function order, header first, and size it up.
+  unsigned Size = 0;
+  Region.clear();
+  Region.push_back(Header);
+  Function *F = Header->getParent();
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+    if (!InRegion.count(BB))
+      continue;
+    if (&*BB != Header)
+      Region.push_back(BB);
+    for (BasicBlock::iterator I = BB->getFirstNonPHI(), IE = BB->end();
+         I != IE; ++I)
+      if (!isa<DbgInfoIntrinsic>(I))
+        ++Size;
+  }
+  return Size >= ColdSplitMinSize;
+}
+
+/// markCold - Give TI a zero profile so later passes see it as cold too.
+void RigelHotColdSplit::markCold(TerminatorInst *TI) {
+  LLVMContext &Ctx = TI->getContext();
+  const Type *Int64Ty = Type::getInt64Ty(Ctx);
+  SmallVector<Value*, 4> Ops(TI->getNumSuccessors() + 1,
+                             ConstantInt::get(Int64Ty, 0));
+  TI->setMetadata("prof", MDNode::get(Ctx, Ops.data(), Ops.size()));
+}
+
+bool RigelHotColdSplit::runOnModule(Module &M) {
+  SmallVector<Function*, 16> Worklist;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
+    if (!F->isDeclaration())
+      Worklist.push_back(F);
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Worklist.size(); i != e; ++i)
+    Changed |= runOnFunction(*Worklist[i]);
+  return Changed;
+}
+
+bool RigelHotColdSplit::runOnFunction(Function &F) {
+  uint64_t EntryCount;
+  if (!getRigelProfileCount(&F.getEntryBlock(), EntryCount) || EntryCount == 0)
+    return false;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    if (isa<InvokeInst>(BB->getTerminator()) ||
+        isa<UnwindInst>(BB->getTerminator()))
+      return false;
+
+  DT = &getAnalysis<DominatorTree>(F);
+  SmallPtrSet<BasicBlock*, 8> Tried;
+  bool Changed = false;
+  for (Function::iterator BB = ++F.begin(); BB != F.end(); ) {
+    BasicBlock *Header = BB++;
+    if (!isCold(Header) || Header->hasAddressTaken() || Tried.count(Header) ||
+        !DT->getNode(Header))
+      continue;
+
+    Tried.insert(Header);
+    std::vector<BasicBlock*> Region;
+    if (!findColdRegion(Header, Region))
+      continue;
+
+    Function *Cold = ExtractCodeRegion(*DT, Region);
+    if (!Cold)
+      continue;
+    DEBUG(dbgs() << "Rigel: outlined cold region " << Cold->getName()
+                 << " (" << Region.size() << " blocks)\n");
+    markCold(Cold->getEntryBlock().getTerminator());
+    if (CallInst *CI = dyn_cast<CallInst>(Cold->use_back()))
+      markCold(CI->getParent()->getTerminator());
+    ++NumColdRegions;
+    Changed = true;
+
+    // The extractor only patches the dominator tree up partially; start
+    // over on a fresh one.
+    DT->DT->recalculate(F);
+    BB = ++F.begin();
+  }
+  return Changed;
+}
+
+/// createRigelHotColdSplitPass - Returns a pass that outlines the parts of
+/// profiled functions that were never executed.
+ModulePass *llvm::createRigelHotColdSplitPass() {
+  return new RigelHotColdSplit();
+}
@@ -16,7 +16,7 @@
 #include "RigelISelLowering.h"
 #include "RigelMachineFunction.h"
 #include "RigelTargetMachine.h"
-//#include "RigelTargetObjectFile.h"
+#include "RigelTargetObjectFile.h"
 #include "RigelSubtarget.h"
 #include "llvm/DerivedTypes.h"
 #include "llvm/Function.h"
@@ -33,6 +33,7 @@
 #include "llvm/CodeGen/ValueTypes.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include <iostream>
 using namespace llvm;
@@ -40,7 +41,7 @@ using namespace llvm;
 
 RigelTargetLowering::
 RigelTargetLowering(RigelTargetMachine &TM)
-  : TargetLowering(TM, new TargetLoweringObjectFileELF()) {
+  : TargetLowering(TM, new RigelTargetObjectFile()) {
 
   Subtarget = TM.getSubtargetImpl() ;
 
@@ -103,17 +104,22 @@ RigelTargetLowering(RigelTargetMachine &TM)
   //Expand indirect branches
   //setOperationAction(ISD::BRIND, MVT::Other, Expand);
 
+  //The high half of a 32x32 product is built from mul16 partial products in
+  //LowerMULH().  Having MULHU/MULHS available also lets the DAG combiner turn
+  //divides by constants into multiplies and keeps i64 multiplies inline.
+  setOperationAction(ISD::MULHS, MVT::i32, Custom);
+  setOperationAction(ISD::MULHU, MVT::i32, Custom);
+  setOperationAction(ISD::SMUL_LOHI, MVT::i32, Custom);
+  setOperationAction(ISD::UMUL_LOHI, MVT::i32, Custom);
+  setTargetDAGCombine(ISD::MUL);
+
   //FIXME Can we make any of these Legal?
-  setOperationAction(ISD::MULHS, MVT::i32, Expand);
-  setOperationAction(ISD::MULHU, MVT::i32, Expand);
   setOperationAction(ISD::UDIV, MVT::i32, Expand);
   setOperationAction(ISD::SDIV, MVT::i32, Expand);
   setOperationAction(ISD::SREM, MVT::i32, Expand);
   setOperationAction(ISD::UREM, MVT::i32, Expand);
   setOperationAction(ISD::SDIVREM, MVT::i32, Expand);
   setOperationAction(ISD::UDIVREM, MVT::i32, Expand);
-  setOperationAction(ISD::SMUL_LOHI, MVT::i32, Expand);
-  setOperationAction(ISD::UMUL_LOHI, MVT::i32, Expand);
 
   setOperationAction(ISD::CTPOP, MVT::i32, Expand);
   setOperationAction(ISD::CTTZ , MVT::i32, Expand);
@@ -188,25 +194,34 @@ RigelTargetLowering(RigelTargetMachine &TM)
     setOperationAction(ISD::ATOMIC_CMP_SWAP,  MVT::i32, Legal);
     // setOperationAction(ISD::ATOMIC_SWAP,      MVT::i8,  Promote);
     // setOperationAction(ISD::ATOMIC_SWAP,      MVT::i16, Promote);
-    // setOperationAction(ISD::ATOMIC_SWAP,      MVT::i32, Custom);
+    setOperationAction(ISD::ATOMIC_SWAP,      MVT::i32, Legal);
     // setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i8,  Promote);
     // setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i16, Promote);
-    // setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i32, Custom);
+    setOperationAction(ISD::ATOMIC_LOAD_ADD,  MVT::i32, Legal);
     // setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i8,  Promote);
     // setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i16, Promote);
-    // setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Custom);
+    setOperationAction(ISD::ATOMIC_LOAD_SUB,  MVT::i32, Custom);
     // setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i8,  Promote);
     // setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i16, Promote);
-    // setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i32, Custom);
+    setOperationAction(ISD::ATOMIC_LOAD_AND,  MVT::i32, Legal);
     // setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i8,  Promote);
     // setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i16, Promote);
-    // setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i32, Custom);
+    setOperationAction(ISD::ATOMIC_LOAD_OR,   MVT::i32, Legal);
     // setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i8,  Promote);
     // setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i16, Promote);
-    // setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i32, Custom);
+    setOperationAction(ISD::ATOMIC_LOAD_XOR,  MVT::i32, Legal);
     // setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i8,  Promote);
     // setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i16, Promote);
     // setOperationAction(ISD::ATOMIC_LOAD_NAND, MVT::i32, Custom);
+    setOperationAction(ISD::ATOMIC_LOAD_MIN,  MVT::i32, Legal);
+    setOperationAction(ISD::ATOMIC_LOAD_MAX,  MVT::i32, Legal);
+
+  // The task queue intrinsics pass values in fixed registers; everything
+  // else is matched directly (see LowerINTRINSIC_W_CHAIN).
+  setOperationAction(ISD::INTRINSIC_W_CHAIN, MVT::Other, Custom);
+
+  // llvm.prefetch maps onto pref.l.
+  setOperationAction(ISD::PREFETCH, MVT::Other, Legal);
 
   //For now, assume that all our hardware atomics implicitly form a full
   //memory barrier for a single thread, and we don't need calls to
@@ -232,6 +247,7 @@ const char *RigelTargetLowering::getTargetNodeName(unsigned Opcode) const {
     case RigelISD::JmpLink    : return "RigelISD::JmpLink";
     case RigelISD::Hi         : return "RigelISD::Hi";
     case RigelISD::Lo         : return "RigelISD::Lo";
+    case RigelISD::Mul16      : return "RigelISD::Mul16";
     case RigelISD::GPRel      : return "RigelISD::GPRel";
     case RigelISD::Ret        : return "RigelISD::Ret";
     case RigelISD::CMov       : return "RigelISD::CMov";
@@ -239,6 +255,11 @@ const char *RigelTargetLowering::getTargetNodeName(unsigned Opcode) const {
     case RigelISD::FPSelectCC : return "RigelISD::FPSelectCC";
     case RigelISD::FPBrcond   : return "RigelISD::FPBrcond";
     case RigelISD::FPCmp      : return "RigelISD::FPCmp";
+    case RigelISD::TQInit     : return "RigelISD::TQInit";
+    case RigelISD::TQEnd      : return "RigelISD::TQEnd";
+    case RigelISD::TQEnqueue  : return "RigelISD::TQEnqueue";
+    case RigelISD::TQLoop     : return "RigelISD::TQLoop";
+    case RigelISD::TQDequeue  : return "RigelISD::TQDequeue";
     default                  : return NULL;
   }
 }
@@ -248,8 +269,14 @@ MVT::SimpleValueType RigelTargetLowering::getSetCCResultType(EVT VT) const {
   return MVT::i32;
 }
 
-//log2 of the byte alignment of functions
+//log2 of the byte alignment of functions.  Functions the edge profile says
+//were called start on a 32-byte instruction cache line, so a hot function
+//never drags the tail of its neighbour into the cache with it.
 unsigned RigelTargetLowering::getFunctionAlignment(const Function *F) const {
+  uint64_t EntryCount;
+  if (!F->isDeclaration() &&
+      getRigelProfileCount(&F->getEntryBlock(), EntryCount) && EntryCount)
+    return 5;
   return 2;
 }
 
@@ -346,10 +373,97 @@ LowerOperation(SDValue Op, SelectionDAG &DAG) const
     case ISD::SEXTLOAD:
     case ISD::ZEXTLOAD:           return LowerLOAD(Op, DAG);
     case ISD::STORE:              return LowerSTORE(Op, DAG);
+    case ISD::MULHS:
+    case ISD::MULHU:              return LowerMULH(Op, DAG);
+    case ISD::SMUL_LOHI:
+    case ISD::UMUL_LOHI:          return LowerMUL_LOHI(Op, DAG);
+    case ISD::ATOMIC_LOAD_SUB:    return LowerATOMIC_LOAD_SUB(Op, DAG);
+    case ISD::INTRINSIC_W_CHAIN:  return LowerINTRINSIC_W_CHAIN(Op, DAG);
   }
   return SDValue();
 }
 
+/// LowerATOMIC_LOAD_SUB - There is no atom.sub; add the negated value.
+SDValue RigelTargetLowering::
+LowerATOMIC_LOAD_SUB(SDValue Op, SelectionDAG &DAG) const
+{
+  AtomicSDNode *Node = cast<AtomicSDNode>(Op.getNode());
+  DebugLoc dl = Op.getDebugLoc();
+  EVT VT = Node->getMemoryVT();
+  SDValue NegVal = DAG.getNode(ISD::SUB, dl, VT, DAG.getConstant(0, VT),
+                               Node->getOperand(2));
+  return DAG.getAtomic(ISD::ATOMIC_LOAD_ADD, dl, VT, Node->getChain(),
+                       Node->getBasePtr(), NegVal, Node->getSrcValue(),
+                       Node->getAlignment());
+}
+
+/// LowerINTRINSIC_W_CHAIN - Only the task queue intrinsics need help; the
+/// rest are matched by the patterns in RigelInstrInfo.td.
+SDValue RigelTargetLowering::
+LowerINTRINSIC_W_CHAIN(SDValue Op, SelectionDAG &DAG) const
+{
+  unsigned IntNo = cast<ConstantSDNode>(Op.getOperand(1))->getZExtValue();
+  switch (IntNo) {
+    default: return SDValue();
+    case Intrinsic::rigel_tq_init:
+      return LowerTaskQueue(Op, RigelISD::TQInit, DAG);
+    case Intrinsic::rigel_tq_end:
+      return LowerTaskQueue(Op, RigelISD::TQEnd, DAG);
+    case Intrinsic::rigel_tq_enqueue:
+      return LowerTaskQueue(Op, RigelISD::TQEnqueue, DAG);
+    case Intrinsic::rigel_tq_loop:
+      return LowerTaskQueue(Op, RigelISD::TQLoop, DAG);
+    case Intrinsic::rigel_tq_dequeue:
+      return LowerTaskQueue(Op, RigelISD::TQDequeue, DAG);
+  }
+}
+
+/// LowerTaskQueue - The tq.* instructions read their operands from A0-A3 and
+/// leave a status word in V0; tq.deq also leaves the task it handed out
+/// in A0-A3.  Copy the intrinsic's operands in and its results out, glued to
+/// the instruction so nothing else gets scheduled in between.
+SDValue RigelTargetLowering::
+LowerTaskQueue(SDValue Op, unsigned Opc, SelectionDAG &DAG) const
+{
+  static const unsigned TQRegs[] = {
+    Rigel::A0, Rigel::A1, Rigel::A2, Rigel::A3
+  };
+  DebugLoc dl = Op.getDebugLoc();
+  SDValue Chain = Op.getOperand(0);
+  SDValue InFlag;
+
+  // Operand 1 is the intrinsic ID.
+  for (unsigned i = 2, e = Op.getNumOperands(); i != e; ++i) {
+    assert(i - 2 < array_lengthof(TQRegs) && "Too many task queue operands!");
+    Chain = DAG.getCopyToReg(Chain, dl, TQRegs[i - 2], Op.getOperand(i),
+                             InFlag);
+    InFlag = Chain.getValue(1);
+  }
+
+  SDVTList VTs = DAG.getVTList(MVT::Other, MVT::Flag);
+  if (InFlag.getNode())
+    Chain = DAG.getNode(Opc, dl, VTs, Chain, InFlag);
+  else
+    Chain = DAG.getNode(Opc, dl, VTs, Chain);
+  InFlag = Chain.getValue(1);
+
+  SmallVector<SDValue, 6> Results;
+  SDValue Val = DAG.getCopyFromReg(Chain, dl, Rigel::V0, MVT::i32, InFlag);
+  Results.push_back(Val);
+  Chain = Val.getValue(1);
+  InFlag = Val.getValue(2);
+  if (Opc == RigelISD::TQDequeue) {
+    for (unsigned i = 0; i != array_lengthof(TQRegs); ++i) {
+      Val = DAG.getCopyFromReg(Chain, dl, TQRegs[i], MVT::i32, InFlag);
+      Results.push_back(Val);
+      Chain = Val.getValue(1);
+      InFlag = Val.getValue(2);
+    }
+  }
+  Results.push_back(Chain);
+  return DAG.getMergeValues(&Results[0], Results.size(), dl);
+}
+
 /// ReplaceNodeResults - Replace the results of node with an illegal result
 /// type with new values built out of custom code.
 void RigelTargetLowering::ReplaceNodeResults(SDNode *N,
@@ -632,6 +746,59 @@ SDValue RigelTargetLowering::LowerVASTART(SDValue Op, SelectionDAG &DAG) const {
                       false, false, 0);
 }
 
+/// GetMaxKnownAlignment - Best alignment we can prove for Ptr, given that the
+/// memory operation using it already claims Align.  RigelAlignmentInference
+/// does most of the work at the IR level; this catches what only becomes
+/// visible in the DAG (frame indices, %hi/%lo pairs, shifted indices).
+static unsigned
+GetMaxKnownAlignment(SelectionDAG &DAG, SDValue Ptr, unsigned Align,
+                     unsigned Depth = 0)
+{
+  Align = std::max(Align, DAG.InferPtrAlignment(Ptr));
+
+  APInt KnownZero, KnownOne;
+  DAG.ComputeMaskedBits(Ptr, APInt::getAllOnesValue(32), KnownZero, KnownOne);
+  unsigned TrailZ = std::min(KnownZero.countTrailingOnes(), 16U);
+  Align = std::max(Align, 1U << TrailZ);
+
+  if (Depth >= 4 || Align >= 4)
+    return Align;
+
+  // A global, either still whole or as %hi(sym) + %lo(sym) from
+  // LowerGlobalAddress().  Globals we define are emitted with their preferred
+  // alignment, which may exceed the alignment recorded on them (packed structs).
+  // A declaration with no recorded alignment is defined elsewhere with at
+  // least its ABI alignment.  Nothing is known about a global that another
+  // definition can replace at link time.
+  const GlobalAddressSDNode *GA = dyn_cast<GlobalAddressSDNode>(Ptr);
+  if (!GA && Ptr.getOpcode() == ISD::ADD &&
+      Ptr.getOperand(0).getOpcode() == RigelISD::Hi &&
+      Ptr.getOperand(1).getOpcode() == RigelISD::Lo)
+    GA = dyn_cast<GlobalAddressSDNode>(Ptr.getOperand(1).getOperand(0));
+  if (GA) {
+    const GlobalValue *GV = GA->getGlobal();
+    const GlobalVariable *GVar = dyn_cast<GlobalVariable>(GV);
+    if (!GVar || GV->mayBeOverridden())
+      return Align;
+    const TargetData *TD = DAG.getTarget().getTargetData();
+    unsigned GVAlign = GV->getAlignment();
+    if (GVar->hasInitializer())
+      GVAlign = TD->getPreferredAlignment(GVar);
+    else if (GVAlign == 0 && GVar->getType()->getElementType()->isSized())
+      GVAlign = TD->getABITypeAlignment(GVar->getType()->getElementType());
+    return std::max(Align, (unsigned)MinAlign(GVAlign, GA->getOffset()));
+  }
+
+  // base + index: aligned if both halves are.
+  if (Ptr.getOpcode() == ISD::ADD) {
+    unsigned LHS = GetMaxKnownAlignment(DAG, Ptr.getOperand(0), 1, Depth + 1);
+    unsigned RHS = GetMaxKnownAlignment(DAG, Ptr.getOperand(1), 1, Depth + 1);
+    Align = std::max(Align, std::min(LHS, RHS));
+  }
+
+  return Align;
+}
+
 static bool
 IsWordAlignedBasePlusConstantOffset(SelectionDAG &DAG, SDValue Addr, SDValue &AlignedBase,
                                     int64_t &Offset)
@@ -666,7 +833,11 @@ IsWordAlignedBasePlusConstantOffset(SelectionDAG &DAG, SDValue Addr, SDValue &Al
     Offset = off;
     return true;
   }
-  //TODO Other idioms on Rigel that are definitely word-aligned that LLVM doesn't already know about?
+  if (GetMaxKnownAlignment(DAG, Base, 1) >= 4) {
+    AlignedBase = Base;
+    Offset = off;
+    return true;
+  }
   return false;
 }
 
@@ -682,7 +853,8 @@ SDValue RigelTargetLowering::LowerLOAD(SDValue Op, SelectionDAG &DAG) const {
   SDValue the_chain = LN->getChain();
   EVT PtrVT = DAG.getTargetLoweringInfo().getPointerTy();
   ISD::LoadExtType ExtType = LN->getExtensionType();
-  unsigned alignment = LN->getAlignment();
+  unsigned alignment = GetMaxKnownAlignment(DAG, LN->getBasePtr(),
+                                            LN->getAlignment());
   DebugLoc dl = Op.getDebugLoc();
   SDValue result;
   SDValue basePtr = LN->getBasePtr();
@@ -698,7 +870,12 @@ SDValue RigelTargetLowering::LowerLOAD(SDValue Op, SelectionDAG &DAG) const {
 
   if(InVT == MVT::i32) {
     if(alignment >= 4) {
-      return SDValue();
+      if(alignment == LN->getAlignment())
+        return SDValue();
+      //Rebuild the load so later combines see the alignment we proved.
+      return DAG.getLoad(MVT::i32, dl, the_chain, basePtr,
+                         LN->getSrcValue(), LN->getSrcValueOffset(),
+                         LN->isVolatile(), LN->isNonTemporal(), alignment);
     }
     //Let's statically lower to ld/ld/shr/shl/or if the address is base+offset
     //and it's not a RigelHi/RigelLo pair.  This way, we can elide the offset-
@@ -708,12 +885,10 @@ SDValue RigelTargetLowering::LowerLOAD(SDValue Op, SelectionDAG &DAG) const {
     //and only do this optimization when we know the base pointer itself is aligned.
     else if (IsWordAlignedBasePlusConstantOffset(DAG, basePtr, base, offset)) {
       if(offset % 4 == 0) { //Turns out to be word-aligned
+        unsigned wordAlign = (unsigned)MinAlign(GetMaxKnownAlignment(DAG, base, 4), offset);
         result = DAG.getLoad(MVT::i32, dl, the_chain, basePtr,
                        LN->getSrcValue(), (LN->getSrcValueOffset() & ~(0x3)),
-                       LN->isVolatile(), LN->isNonTemporal(), 4);
-        //TODO The offset may be 8-, 16-, etc. byte aligned.
-        // We should provide that maximum known alignment to getLoad(), in case
-        // we ever have wider loads in the future.
+                       LN->isVolatile(), LN->isNonTemporal(), wordAlign);
 
         // Update the chain
         the_chain = result.getValue(1);
@@ -779,12 +954,10 @@ SDValue RigelTargetLowering::LowerLOAD(SDValue Op, SelectionDAG &DAG) const {
     // that could work.
     else if (IsWordAlignedBasePlusConstantOffset(DAG, basePtr, base, offset)) {
       if(offset % 4 == 0) { //Turns out to be word-aligned
+        unsigned wordAlign = (unsigned)MinAlign(GetMaxKnownAlignment(DAG, base, 4), offset);
         result = DAG.getLoad(MVT::i32, dl, the_chain, basePtr,
                        LN->getSrcValue(), (LN->getSrcValueOffset() & ~(0x3)),
-                       LN->isVolatile(), LN->isNonTemporal(), 4);
-        //TODO The offset may be 8-, 16-, etc. byte aligned.
-        // We should provide that maximum known alignment to getLoad(), in case
-        // we ever have wider loads in the future.
+                       LN->isVolatile(), LN->isNonTemporal(), wordAlign);
 
         // Update the chain
         the_chain = result.getValue(1);
@@ -917,7 +1090,8 @@ SDValue RigelTargetLowering::LowerSTORE(SDValue Op, SelectionDAG &DAG) const
   EVT StVT = (!SN->isTruncatingStore() ? VT : SN->getMemoryVT());
   EVT PtrVT = DAG.getTargetLoweringInfo().getPointerTy();
   DebugLoc dl = Op.getDebugLoc();
-  unsigned alignment = SN->getAlignment();
+  unsigned alignment = GetMaxKnownAlignment(DAG, SN->getBasePtr(),
+                                            SN->getAlignment());
   int src_value_offset = SN->getSrcValueOffset();
   //FIXME Re-enable this once we are sure this function call will always
   //return false (since Rigel does not support any unaligned loads).
@@ -936,7 +1110,11 @@ SDValue RigelTargetLowering::LowerSTORE(SDValue Op, SelectionDAG &DAG) const
 
   if(StVT == MVT::i32) {
     if(alignment >= 4) {
-      return SDValue();
+      if(alignment == SN->getAlignment())
+        return SDValue();
+      return DAG.getStore(SN->getChain(), dl, Value, SN->getBasePtr(),
+                          SN->getSrcValue(), src_value_offset,
+                          SN->isVolatile(), SN->isNonTemporal(), alignment);
     }
     else {
       // Lower to a call to __unalignedsti32(basePtr, theValue).
@@ -1030,6 +1208,147 @@ SDValue RigelTargetLowering::LowerSTORE(SDValue Op, SelectionDAG &DAG) const
   return SDValue();
 }
 
+/// LowerMULH - Rigel has no instruction producing the high word of a 32x32
+/// product, so build it from four mul16 partial products of the halfwords:
+///   a*b = (ah*bh << 32) + ((ah*bl + al*bh) << 16) + al*bl
+/// The middle sums are accumulated 16 bits at a time so that no carry is lost.
+/// The signed high word is derived from the unsigned one.
+SDValue RigelTargetLowering::LowerMULH(SDValue Op, SelectionDAG &DAG) const {
+  DebugLoc dl = Op.getDebugLoc();
+  SDValue A = Op.getOperand(0);
+  SDValue B = Op.getOperand(1);
+  SDValue Sixteen = DAG.getConstant(16, MVT::i32);
+  SDValue LoMask = DAG.getConstant(0xFFFF, MVT::i32);
+
+  // mul16 only looks at the low halfword of each operand, so the low halves
+  // can be fed in directly and the high halves only need to be shifted down.
+  SDValue AHi = DAG.getNode(ISD::SRL, dl, MVT::i32, A, Sixteen);
+  SDValue BHi = DAG.getNode(ISD::SRL, dl, MVT::i32, B, Sixteen);
+
+  SDValue LL = DAG.getNode(RigelISD::Mul16, dl, MVT::i32, A, B);
+  SDValue HL = DAG.getNode(RigelISD::Mul16, dl, MVT::i32, AHi, B);
+  SDValue LH = DAG.getNode(RigelISD::Mul16, dl, MVT::i32, A, BHi);
+  SDValue HH = DAG.getNode(RigelISD::Mul16, dl, MVT::i32, AHi, BHi);
+
+  // (2^16-1)^2 + (2^16-1) < 2^32, so neither middle sum can overflow.
+  SDValue Mid1 = DAG.getNode(ISD::ADD, dl, MVT::i32, HL,
+                             DAG.getNode(ISD::SRL, dl, MVT::i32, LL, Sixteen));
+  SDValue Mid2 = DAG.getNode(ISD::ADD, dl, MVT::i32, LH,
+                             DAG.getNode(ISD::AND, dl, MVT::i32, Mid1, LoMask));
+  SDValue Hi = DAG.getNode(ISD::ADD, dl, MVT::i32, HH,
+                           DAG.getNode(ISD::SRL, dl, MVT::i32, Mid1, Sixteen));
+  Hi = DAG.getNode(ISD::ADD, dl, MVT::i32, Hi,
+                   DAG.getNode(ISD::SRL, dl, MVT::i32, Mid2, Sixteen));
+
+  if (Op.getOpcode() == ISD::MULHU)
+    return Hi;
+
+  // mulhs(a, b) = mulhu(a, b) - (a < 0 ? b : 0) - (b < 0 ? a : 0)
+  SDValue ThirtyOne = DAG.getConstant(31, MVT::i32);
+  SDValue ASign = DAG.getNode(ISD::SRA, dl, MVT::i32, A, ThirtyOne);
+  SDValue BSign = DAG.getNode(ISD::SRA, dl, MVT::i32, B, ThirtyOne);
+  Hi = DAG.getNode(ISD::SUB, dl, MVT::i32, Hi,
+                   DAG.getNode(ISD::AND, dl, MVT::i32, ASign, B));
+  return DAG.getNode(ISD::SUB, dl, MVT::i32, Hi,
+                     DAG.getNode(ISD::AND, dl, MVT::i32, BSign, A));
+}
+
+/// LowerMUL_LOHI - Split a two-result multiply into mul for the low word and
+/// the MULHU/MULHS expansion above for the high word.
+SDValue RigelTargetLowering::LowerMUL_LOHI(SDValue Op,
+                                           SelectionDAG &DAG) const {
+  DebugLoc dl = Op.getDebugLoc();
+  unsigned HiOpc = Op.getOpcode() == ISD::UMUL_LOHI ? ISD::MULHU : ISD::MULHS;
+  SDValue Lo = DAG.getNode(ISD::MUL, dl, MVT::i32,
+                           Op.getOperand(0), Op.getOperand(1));
+  SDValue Hi = LowerMULH(DAG.getNode(HiOpc, dl, MVT::i32,
+                                     Op.getOperand(0), Op.getOperand(1)), DAG);
+  SDValue Ops[2] = { Lo, Hi };
+  return DAG.getMergeValues(Ops, 2, dl);
+}
+
+//===----------------------------------------------------------------------===//
+//                          Target DAG Combines
+//===----------------------------------------------------------------------===//
+
+/// getInstrLatency - Latency of a Rigel instruction according to the
+/// itineraries, so multiply costs track RigelSchedule.td.
+unsigned RigelTargetLowering::getInstrLatency(unsigned Opcode) const {
+  const TargetMachine &TM = getTargetMachine();
+  unsigned SchedClass = TM.getInstrInfo()->get(Opcode).getSchedClass();
+  return TM.getInstrItineraryData().getStageLatency(SchedClass);
+}
+
+SDValue RigelTargetLowering::PerformDAGCombine(SDNode *N,
+                                               DAGCombinerInfo &DCI) const {
+  switch (N->getOpcode()) {
+  default: break;
+  case ISD::MUL: return PerformMULCombine(N, DCI);
+  }
+  return SDValue();
+}
+
+/// PerformMULCombine - Pick the cheapest way to do an i32 multiply:
+///  - mul16 when both operands are known to fit in 16 unsigned bits.
+///  - Shifts and adds/subs for constants of the form +-2^n+-2^m when the
+///    critical path is no longer than the multiply it replaces.  Ties go to
+///    the ALU sequence because there are two ALUs and only one multiplier.
+/// Multiplies by powers of two are already turned into shifts generically.
+SDValue RigelTargetLowering::PerformMULCombine(SDNode *N,
+                                               DAGCombinerInfo &DCI) const {
+  if (N->getValueType(0) != MVT::i32)
+    return SDValue();
+
+  SelectionDAG &DAG = DCI.DAG;
+  DebugLoc dl = N->getDebugLoc();
+  SDValue N0 = N->getOperand(0);
+  SDValue N1 = N->getOperand(1);
+  APInt HighHalf = APInt::getHighBitsSet(32, 16);
+  bool Fits16 = DAG.MaskedValueIsZero(N0, HighHalf) &&
+                DAG.MaskedValueIsZero(N1, HighHalf);
+  unsigned MulLatency = getInstrLatency(Fits16 ? Rigel::MUL16 : Rigel::MUL);
+
+  if (ConstantSDNode *C = dyn_cast<ConstantSDNode>(N1)) {
+    int64_t Val = C->getSExtValue();
+    bool Negate = Val < 0;
+    uint64_t Abs = Negate ? -(uint64_t)Val : (uint64_t)Val;
+    // Abs = 2^Hi +- 2^Lo, with Hi > Lo.
+    unsigned ShHi = 0, ShLo = 0;
+    bool IsSub = false, Found = false;
+    if (Abs > 2 && isPowerOf2_64(Abs - 1)) {
+      ShHi = Log2_64(Abs - 1); ShLo = 0; Found = true;
+    } else if (Abs > 2 && isPowerOf2_64(Abs + 1)) {
+      ShHi = Log2_64(Abs + 1); ShLo = 0; IsSub = true; Found = true;
+    } else if (Abs > 2 && CountPopulation_64(Abs) == 2) {
+      ShLo = CountTrailingZeros_64(Abs);
+      ShHi = Log2_64(Abs);
+      Found = true;
+    }
+    // Shifts and the add/sub each take one ALU cycle; the two shifts of a
+    // 2^n+2^m constant can issue together, and negation adds one more op.
+    unsigned AluLatency = getInstrLatency(Rigel::ADDu);
+    unsigned SeqLatency = 2 * AluLatency + (Negate ? AluLatency : 0);
+    if (Found && ShHi < 32 && SeqLatency <= MulLatency) {
+      SDValue Hi = DAG.getNode(ISD::SHL, dl, MVT::i32, N0,
+                               DAG.getConstant(ShHi, getShiftAmountTy()));
+      SDValue Lo = ShLo == 0 ? N0
+                 : DAG.getNode(ISD::SHL, dl, MVT::i32, N0,
+                               DAG.getConstant(ShLo, getShiftAmountTy()));
+      SDValue Res = DAG.getNode(IsSub ? ISD::SUB : ISD::ADD, dl, MVT::i32,
+                                Hi, Lo);
+      if (Negate)
+        Res = DAG.getNode(ISD::SUB, dl, MVT::i32,
+                          DAG.getConstant(0, MVT::i32), Res);
+      return Res;
+    }
+  }
+
+  if (Fits16)
+    return DAG.getNode(RigelISD::Mul16, dl, MVT::i32, N0, N1);
+
+  return SDValue();
+}
+
 //===----------------------------------------------------------------------===//
 //                  CALL Calling Convention Implementation
 //===----------------------------------------------------------------------===//
@@ -1491,6 +1810,16 @@ LowerReturn(SDValue Chain,
 //                           Rigel Inline Assembly Support
 //===----------------------------------------------------------------------===//
 
+/// getConstraintType - 'f' is a register class on Rigel; everything else is
+/// handled generically.  I/K/L are immediates (C_Other) by default.
+RigelTargetLowering::ConstraintType RigelTargetLowering::
+getConstraintType(const std::string &Constraint) const
+{
+  if (Constraint.size() == 1 && Constraint[0] == 'f')
+    return C_RegisterClass;
+  return TargetLowering::getConstraintType(Constraint);
+}
+
 /// getRegClassForInlineAsmConstraint - Given a constraint letter (e.g. "r"),
 /// return a list of registers that can be used to satisfy the constraint.
 /// This should only be used for C_RegisterClass constraints.
@@ -1500,6 +1829,13 @@ getRegForInlineAsmConstraint(const std::string &Constraint, EVT VT) const
   if (Constraint.size() == 1) {
     switch (Constraint[0]) {
     case 'r':
+    case 'f':
+      //FP values live in the integer registers, but they have to come from
+      //the f32 class or the copies in and out of the asm won't type-check.
+      if (VT == MVT::f32)
+        return std::make_pair(0U, Rigel::FPRegsRegisterClass);
+      if (Constraint[0] == 'f')
+        break;
       return std::make_pair(0U, Rigel::CPURegsRegisterClass);
     }
   }
@@ -1519,6 +1855,7 @@ getRegClassForInlineAsmConstraint(const std::string &Constraint,
   switch (Constraint[0]) {         
     default : break;
     case 'r':
+    case 'f':
       return make_vector<unsigned>(Rigel::T0, Rigel::T1, Rigel::T2, Rigel::T3, 
              Rigel::T4, Rigel::T5, Rigel::S0, Rigel::S1, 
              Rigel::S2, Rigel::S3, Rigel::S4, Rigel::S5, Rigel::S6, Rigel::S7,
@@ -1528,6 +1865,42 @@ getRegClassForInlineAsmConstraint(const std::string &Constraint,
   return std::vector<unsigned>();
 }
 
+/// LowerAsmOperandForConstraint - Turn constants for the immediate
+/// constraints into target constants so they print straight into the asm:
+///   I - signed 16-bit (addi, ldw/stw offsets)
+///   K - unsigned 16-bit (ori, andi, mvui)
+///   L - unsigned 5-bit (shift amounts, special register numbers)
+/// A constant that doesn't fit adds nothing, which gets reported as an
+/// invalid operand for the constraint.
+void RigelTargetLowering::
+LowerAsmOperandForConstraint(SDValue Op, char ConstraintLetter,
+                             std::vector<SDValue> &Ops,
+                             SelectionDAG &DAG) const
+{
+  switch (ConstraintLetter) {
+  default: break;
+  case 'I':
+  case 'K':
+  case 'L': {
+    ConstantSDNode *C = dyn_cast<ConstantSDNode>(Op);
+    if (!C)
+      return;
+    int64_t Val = C->getSExtValue();
+    bool Fits;
+    switch (ConstraintLetter) {
+    default: llvm_unreachable("Unknown constraint letter!");
+    case 'I': Fits = isInt<16>(Val); break;
+    case 'K': Fits = isUInt<16>(Val); break;
+    case 'L': Fits = isUInt<5>(Val); break;
+    }
+    if (Fits)
+      Ops.push_back(DAG.getTargetConstant(Val, Op.getValueType()));
+    return;
+  }
+  }
+  TargetLowering::LowerAsmOperandForConstraint(Op, ConstraintLetter, Ops, DAG);
+}
+
 //NOTE: If your target doesn't define this function, LLVM will fall back on the default
 //one, which always allows offset folding under static relocation, never under PIC,
 //and sometimes under dynamic-no-PIC.
@@ -1544,16 +1917,14 @@ bool RigelTargetLowering::isOffsetFoldingLegal(const GlobalAddressSDNode *GA) co
   return false;
 }
 
-//FIXME I tried defining this function and got a:
-//fatal error: error in backend: Cannot yet select: 0x52a0c50: f32 = ConstantFP<0.000000e+00> [ORD=439] [ID=3]
-//That doesn't seem right, since 0.000000e+00 should satisfy isZero(), but I'm taking this out for now because not having
-//it never caused us problems.  I just added it at the same time as isOffsetFoldingLegal() because that was right next to it
-//in MIPS and we didn't have it either.
-//bool RigelTargetLowering::isFPImmLegal(const APFloat &Imm, EVT VT) const {
-//  if (VT != MVT::f32 && VT != MVT::f64)
-//    return false;
-//  return Imm.isZero();
-//}
+//Every f32 immediate is legal: MOVf32imm builds the bit pattern in place with
+//mvui/ori (or just one of them), which beats an address computation plus a load
+//from the constant pool and can be rematerialized instead of spilled.
+//(An earlier attempt at this failed with "Cannot yet select: ConstantFP" because
+//there was no pattern for fpimm; MOVf32imm provides it.)
+bool RigelTargetLowering::isFPImmLegal(const APFloat &Imm, EVT VT) const {
+  return VT == MVT::f32;
+}
 
 bool RigelTargetLowering::allowsUnalignedMemoryAccesses(EVT VT) const {
   //No unaligned accesses yet
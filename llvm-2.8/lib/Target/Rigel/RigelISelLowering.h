@@ -40,6 +40,9 @@ namespace llvm {
       // Handle gp_rel (small data/bss sections) relocation.
       GPRel,
 
+      // 32-bit product of the unsigned low halfwords of both operands
+      Mul16,
+
       // Conditional Move
       CMov,
 
@@ -58,6 +61,13 @@ namespace llvm {
       // Return 
       Ret,
       RetNull,
+
+      // Task queue operations; operands and results are in fixed registers
+      TQInit,
+      TQEnd,
+      TQEnqueue,
+      TQLoop,
+      TQDequeue,
       
       START_SPECIAL_OPS,
       // FP Ops
@@ -94,6 +104,10 @@ namespace llvm {
 
     /// getFunctionAlignment - Return the Log2 alignment of this function.
     virtual unsigned getFunctionAlignment(const Function *F) const;
+
+    /// PerformDAGCombine - Narrow multiplies to mul16 and strength-reduce
+    /// multiplies by constants when the itineraries say it pays off.
+    virtual SDValue PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const;
   private:
     // Subtarget Info
     const RigelSubtarget *Subtarget;
@@ -122,6 +136,15 @@ namespace llvm {
     SDValue LowerVASTART(SDValue Op, SelectionDAG &DAG) const;
     SDValue LowerLOAD(SDValue Op, SelectionDAG &DAG) const;
     SDValue LowerSTORE(SDValue Op, SelectionDAG &DAG) const;
+    SDValue LowerMULH(SDValue Op, SelectionDAG &DAG) const;
+    SDValue LowerMUL_LOHI(SDValue Op, SelectionDAG &DAG) const;
+    SDValue LowerATOMIC_LOAD_SUB(SDValue Op, SelectionDAG &DAG) const;
+    SDValue LowerINTRINSIC_W_CHAIN(SDValue Op, SelectionDAG &DAG) const;
+    SDValue LowerTaskQueue(SDValue Op, unsigned Opc, SelectionDAG &DAG) const;
+
+    // DAG combine helpers
+    SDValue PerformMULCombine(SDNode *N, DAGCombinerInfo &DCI) const;
+    unsigned getInstrLatency(unsigned Opcode) const;
 
     virtual SDValue LowerFormalArguments(SDValue Chain, 
 			CallingConv::ID CallConv, bool isVarArg,
@@ -147,6 +170,8 @@ namespace llvm {
     virtual MachineBasicBlock *EmitInstrWithCustomInserter(MachineInstr *MI,
                                                         MachineBasicBlock *MBB) const;
 
+    ConstraintType getConstraintType(const std::string &Constraint) const;
+
     std::pair<unsigned, const TargetRegisterClass*> 
               getRegForInlineAsmConstraint(const std::string &Constraint,
               EVT VT) const;
@@ -154,6 +179,11 @@ namespace llvm {
     std::vector<unsigned>
     getRegClassForInlineAsmConstraint(const std::string &Constraint,
               EVT VT) const;
+
+    virtual void LowerAsmOperandForConstraint(SDValue Op,
+                                              char ConstraintLetter,
+                                              std::vector<SDValue> &Ops,
+                                              SelectionDAG &DAG) const;
     
     /// isOffsetFoldingLegal - Returns true if the target supports
     /// folding of struct/union member offsets.  See big long note in
@@ -161,11 +191,10 @@ namespace llvm {
     /// function specifically for Rigel (since our backend is *not* offset-folding aware.
     virtual bool isOffsetFoldingLegal(const GlobalAddressSDNode *GA) const;
 
-    /// NOTE: Commented this function out due to error explained in this function's definition.
     /// isFPImmLegal - Returns true if the target can instruction select the
     /// specified FP immediate natively. If false, the legalizer will
     /// materialize the FP immediate as a load from a constant pool.
-    //virtual bool isFPImmLegal(const APFloat &Imm, EVT VT) const;
+    virtual bool isFPImmLegal(const APFloat &Imm, EVT VT) const;
 
     virtual bool allowsUnalignedMemoryAccesses(EVT VT) const;
   };
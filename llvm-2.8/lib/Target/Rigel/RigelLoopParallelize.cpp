@@ -0,0 +1,549 @@
+//===-- RigelLoopParallelize.cpp - Run marked loops on the task queue -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Spreads the iterations of loops marked with '#pragma rigel parallel for'
+// (which clang turns into !rigel.parallel on the loop's branches) across the
+// chip with the hardware task queue.
+//
+//   for (i = 0; i < n; ++i) body(i);
+//
+// becomes
+//
+//   static void loop_body(env..., begin, end)
+//     { for (i = begin; i != end; ++i) body(i); }
+//   static void loop_body.task(unsigned env, unsigned begin, unsigned end)
+//     { loop_body(g.ldw of each word of env..., begin, end); }
+//
+//   g.stw the values the loop needs into env (on the stack);
+//   tq.loop(loop_body.task, &env, n, chunk);
+//   while (tq.deq(&t) == 0)          // also runs other cores' tasks
+//     ((void (*)(unsigned, unsigned, unsigned))t.v1)(t.v2, t.v3, t.v4);
+//   tq.end();
+//
+// That is, the core that reaches the loop enqueues it and then works on the
+// queue alongside everyone else until the queue reports that all of the work
+// is done, then ends the queue.  This relies on the runtime's conventions:
+//
+//   - every other core is sitting in the runtime's dispatch loop, which
+//     calls v1(v2, v3, v4) for every task it dequeues;
+//   - tq.loop hands out tasks with v3 = first iteration and v4 = one past the
+//     last, and tq.deq returns 0 with a task and non-zero once the queue
+//     has drained (the runtime writes back task results at that point);
+//   - tq.end releases the queue, sending the other cores back to waiting
+//     for the next tq.loop.
+//
+// The loop environment is written and read with g.stw/g.ldw so the other
+// clusters never see a stale copy of it.  chunk is picked to give every core
+// a few tasks.
+//
+// Only loops whose trip count is computable, with no values live out of the
+// loop, a single exit out of the latch and only affine induction variables
+// are handled; anything else is left alone.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "rigel-parallel"
+#include "Rigel.h"
+#include "RigelTargetMachine.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Intrinsics.h"
+#include "llvm/IntrinsicsRigel.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetData.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/FunctionUtils.h"
+#include "llvm/Transforms/Utils/Local.h"
+using namespace llvm;
+
+STATISTIC(NumParallelLoops, "Number of loops handed to the task queue");
+
+static cl::opt<unsigned>
+TasksPerCore("rigel-parallel-tasks-per-core", cl::Hidden,
+             cl::desc("Task queue chunks to create per core for a parallel "
+                      "loop (default=4)"),
+             cl::init(4));
+
+namespace {
+  class RigelLoopParallelize : public ModulePass {
+    const TargetData *TD;
+    LoopInfo *LI;
+    DominatorTree *DT;
+    ScalarEvolution *SE;
+    unsigned ParallelKind;
+
+  public:
+    static char ID;
+    explicit RigelLoopParallelize(const TargetData *td)
+      : ModulePass(ID), TD(td) {}
+
+    virtual bool runOnModule(Module &M);
+
+    virtual const char *getPassName() const {
+      return "Rigel task queue loop parallelization";
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<DominatorTree>();
+      AU.addRequired<LoopInfo>();
+      AU.addRequired<ScalarEvolution>();
+    }
+
+  private:
+    bool runOnFunction(Function &F);
+    bool isParallelLoop(Loop *L);
+    void collectParallelLoops(Loop *L, SmallVectorImpl<Loop*> &Loops);
+    bool parallelizeLoop(Loop *L);
+    void forgetLoop(Loop *L, BasicBlock *Entry);
+    bool emitDispatch(CallInst *CI, Value *Begin, Value *End,
+                      Value *TripCount);
+    unsigned getNumWords(const Type *Ty);
+  };
+  char RigelLoopParallelize::ID = 0;
+}
+
+/// isParallelLoop - The pragma tags the loop's own branches (not those of
+/// loops nested in it).
+bool RigelLoopParallelize::isParallelLoop(Loop *L) {
+  for (Loop::block_iterator I = L->block_begin(), E = L->block_end();
+       I != E; ++I)
+    if (LI->getLoopFor(*I) == L &&
+        (*I)->getTerminator()->getMetadata(ParallelKind))
+      return true;
+  return false;
+}
+
+/// collectParallelLoops - Find the outermost marked loops.  Marks on loops
+/// nested in those are dropped; the inner loops run serially in the task.
+void RigelLoopParallelize::collectParallelLoops(Loop *L,
+                                                SmallVectorImpl<Loop*> &Loops) {
+  if (!isParallelLoop(L)) {
+    for (Loop::iterator I = L->begin(), E = L->end(); I != E; ++I)
+      collectParallelLoops(*I, Loops);
+    return;
+  }
+  for (Loop::block_iterator I = L->block_begin(), E = L->block_end();
+       I != E; ++I)
+    (*I)->getTerminator()->setMetadata(ParallelKind, 0);
+  Loops.push_back(L);
+}
+
+/// getNumWords - How many 32-bit words a value of type Ty takes in the loop
+/// environment, or 0 if it can't be passed that way.
+unsigned RigelLoopParallelize::getNumWords(const Type *Ty) {
+  if (!Ty->isIntegerTy() && !Ty->isFloatingPointTy() && !Ty->isPointerTy())
+    return 0;
+  uint64_t Bits = TD->getTypeSizeInBits(Ty);
+  if (Bits == 0 || Bits > 64)
+    return 0;
+  return (Bits + 31) / 32;
+}
+
+/// forgetLoop - L and the region's entry block have been moved into another
+/// function; drop them from LoopInfo so the remaining loops can still be
+/// processed.
+void RigelLoopParallelize::forgetLoop(Loop *L, BasicBlock *Entry) {
+  std::vector<BasicBlock*> Blocks(L->block_begin(), L->block_end());
+  Loop *Parent = L->getParentLoop();
+  if (Parent) {
+    for (Loop::iterator I = Parent->begin(); ; ++I)
+      if (*I == L) {
+        Parent->removeChildLoop(I);
+        break;
+      }
+  } else {
+    for (LoopInfo::iterator I = LI->begin(); ; ++I)
+      if (*I == L) {
+        LI->removeLoop(I);
+        break;
+      }
+  }
+  for (unsigned i = 0, e = Blocks.size(); i != e; ++i)
+    LI->removeBlock(Blocks[i]);
+  LI->removeBlock(Entry);
+  delete L;
+}
+
+bool RigelLoopParallelize::parallelizeLoop(Loop *L) {
+  BasicBlock *Header = L->getHeader();
+  BasicBlock *Latch = L->getLoopLatch();
+  BasicBlock *Pred = L->getLoopPredecessor();
+  if (!Pred || !Latch || !L->getExitBlock() ||
+      L->getExitingBlock() != Latch)
+    return false;
+  BranchInst *LatchBr = dyn_cast<BranchInst>(Latch->getTerminator());
+  if (!LatchBr || !LatchBr->isConditional())
+    return false;
+
+  // Nothing computed in the loop may be used after it.
+  for (Loop::block_iterator BI = L->block_begin(), BE = L->block_end();
+       BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end();
+         I != E; ++I)
+      for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+           UI != UE; ++UI)
+        if (!L->contains(cast<Instruction>(*UI)->getParent()))
+          return false;
+
+  LLVMContext &Ctx = Header->getContext();
+  const IntegerType *Int32Ty = Type::getInt32Ty(Ctx);
+  const SCEV *BTC = SE->getBackedgeTakenCount(L);
+  if (isa<SCEVCouldNotCompute>(BTC) ||
+      SE->getTypeSizeInBits(BTC->getType()) > 32)
+    return false;
+
+  // Every value carried around the loop has to be computable from the
+  // iteration number, so a task can start in the middle.
+  SmallVector<std::pair<PHINode*, const SCEVAddRecExpr*>, 4> IVs;
+  for (BasicBlock::iterator I = Header->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    if (!SE->isSCEVable(PN->getType()))
+      return false;
+    const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(PN));
+    if (!AR || AR->getLoop() != L || !AR->isAffine())
+      return false;
+    IVs.push_back(std::make_pair(PN, AR));
+  }
+
+  DEBUG(dbgs() << "Rigel: parallelizing loop at " << Header->getName()
+               << " in " << Header->getParent()->getName() << "\n");
+
+  // CodeGenPrepare will usually have folded the preheader into the loop
+  // guard; put it back.
+  BasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader) {
+    Preheader = SplitEdge(Pred, Header, this);
+    Preheader->setName(Header->getName() + ".preheader");
+  }
+
+  // The task's range.  Outside of the region that gets outlined these are
+  // opaque loads of [0, trip count), so they become arguments of the outlined
+  // function, and until the call is rewritten the code still runs the whole
+  // loop serially.
+  Function *F = Header->getParent();
+  SCEVExpander Expander(*SE);
+  Instruction *PHTerm = Preheader->getTerminator();
+  const SCEV *TripCountS =
+    SE->getAddExpr(SE->getTruncateOrZeroExtend(BTC, Int32Ty),
+                   SE->getConstant(Int32Ty, 1));
+  Value *TripCount = Expander.expandCodeFor(TripCountS, Int32Ty, PHTerm);
+  Instruction *AllocaPt = F->getEntryBlock().begin();
+  AllocaInst *BeginSlot = new AllocaInst(Int32Ty, "par.begin.addr", AllocaPt);
+  AllocaInst *EndSlot = new AllocaInst(Int32Ty, "par.end.addr", AllocaPt);
+  new StoreInst(ConstantInt::get(Int32Ty, 0), BeginSlot, PHTerm);
+  new StoreInst(TripCount, EndSlot, PHTerm);
+  LoadInst *Begin = new LoadInst(BeginSlot, "par.begin", PHTerm);
+  LoadInst *End = new LoadInst(EndSlot, "par.end", PHTerm);
+
+  // Start every induction variable at iteration Begin.  This is computed in
+  // a new block that is outlined along with the loop.
+  BasicBlock *Entry = SplitBlock(Preheader, PHTerm, this);
+  Entry->setName("par.entry");
+  Instruction *EntryTerm = Entry->getTerminator();
+  const SCEV *BeginS = SE->getSCEV(Begin);
+  for (unsigned i = 0, e = IVs.size(); i != e; ++i) {
+    PHINode *PN = IVs[i].first;
+    const SCEVAddRecExpr *AR = IVs[i].second;
+    const SCEV *Step = AR->getStepRecurrence(*SE);
+    const SCEV *Start =
+      SE->getAddExpr(AR->getStart(),
+                     SE->getMulExpr(Step,
+                        SE->getTruncateOrZeroExtend(BeginS, Step->getType())));
+    Value *V = Expander.expandCodeFor(Start, PN->getType(), EntryTerm);
+    PN->setIncomingValue(PN->getBasicBlockIndex(Entry), V);
+  }
+
+  // Run until End, whatever the original exit test was.
+  PHINode *IV = PHINode::Create(Int32Ty, "par.iv", Header->begin());
+  IV->addIncoming(Begin, Entry);
+  Value *Next = BinaryOperator::CreateAdd(IV, ConstantInt::get(Int32Ty, 1),
+                                          "par.iv.next", LatchBr);
+  IV->addIncoming(Next, Latch);
+  bool ContinueOnTrue = L->contains(LatchBr->getSuccessor(0));
+  Value *Cond = new ICmpInst(LatchBr, ContinueOnTrue ? ICmpInst::ICMP_NE
+                                                     : ICmpInst::ICMP_EQ,
+                             Next, End, "par.cond");
+  Value *OldCond = LatchBr->getCondition();
+  LatchBr->setCondition(Cond);
+  RecursivelyDeleteTriviallyDeadInstructions(OldCond);
+
+  // Outline the loop.
+  std::vector<BasicBlock*> Region;
+  Region.push_back(Entry);
+  Region.insert(Region.end(), L->block_begin(), L->block_end());
+  SE->forgetLoop(L);
+  Function *Body = ExtractCodeRegion(*DT, Region);
+  if (!Body) {
+    DEBUG(dbgs() << "Rigel: could not outline loop\n");
+    return true;
+  }
+  forgetLoop(L, Entry);
+  DT->DT->recalculate(*F);
+
+  // The call replacing the loop stays in whatever loop the preheader is in,
+  // whether or not it is turned into a dispatch.
+  assert(Body->hasOneUse() && "Outlined loop should have one call");
+  CallInst *CI = cast<CallInst>(*Body->use_begin());
+  if (Loop *Outer = LI->getLoopFor(Preheader))
+    Outer->addBasicBlockToLoop(CI->getParent(), LI->getBase());
+  if (emitDispatch(CI, Begin, End, TripCount))
+    ++NumParallelLoops;
+  DT->DT->recalculate(*F);
+  return true;
+}
+
+/// emitDispatch - Replace the call to the outlined loop with a tq.loop of
+/// its iterations and a dispatch loop.  Returns false (leaving the serial
+/// call in place) if some argument can't be passed through the environment.
+bool RigelLoopParallelize::emitDispatch(CallInst *CI, Value *Begin,
+                                        Value *End, Value *TripCount) {
+  Function *Body = CI->getCalledFunction();
+  Function *F = CI->getParent()->getParent();
+  Module *M = F->getParent();
+  LLVMContext &Ctx = F->getContext();
+  const IntegerType *Int32Ty = Type::getInt32Ty(Ctx);
+  const IntegerType *Int64Ty = Type::getInt64Ty(Ctx);
+  const Type *Int8PtrTy = Type::getInt8PtrTy(Ctx);
+
+  // Lay out the environment: everything but the range, one or two words
+  // per value.
+  unsigned NumArgs = CI->getNumOperands() - 1;
+  std::vector<unsigned> FirstWord(NumArgs);
+  unsigned NumWords = 0;
+  for (unsigned i = 0; i != NumArgs; ++i) {
+    Value *Arg = CI->getArgOperand(i);
+    if (Arg == Begin || Arg == End)
+      continue;
+    unsigned Words = getNumWords(Arg->getType());
+    if (!Words)
+      return false;
+    FirstWord[i] = NumWords;
+    NumWords += Words;
+  }
+  const Type *EnvTy = ArrayType::get(Int32Ty, NumWords ? NumWords : 1);
+  Function *GStW = Intrinsic::getDeclaration(M, Intrinsic::rigel_gstw);
+  Function *GLdW = Intrinsic::getDeclaration(M, Intrinsic::rigel_gldw);
+
+  // The task entry point: void (unsigned env, unsigned begin, unsigned end).
+  std::vector<const Type*> TaskArgTys(3, Int32Ty);
+  const FunctionType *TaskTy =
+    FunctionType::get(Type::getVoidTy(Ctx), TaskArgTys, false);
+  Function *Task = Function::Create(TaskTy, GlobalValue::InternalLinkage,
+                                    Body->getName() + ".task", M);
+  Function::arg_iterator TA = Task->arg_begin();
+  Argument *TaskEnv = TA++, *TaskBegin = TA++, *TaskEnd = TA++;
+  TaskEnv->setName("env");
+  TaskBegin->setName("begin");
+  TaskEnd->setName("end");
+  BasicBlock *TaskBB = BasicBlock::Create(Ctx, "entry", Task);
+  Value *TaskEnvPtr = new IntToPtrInst(TaskEnv, PointerType::getUnqual(EnvTy),
+                                       "env.ptr", TaskBB);
+
+  // Store the environment at the call site and load it back in the task.
+  AllocaInst *Env = new AllocaInst(EnvTy, "par.env",
+                                   F->getEntryBlock().begin());
+  std::vector<Value*> TaskCallArgs;
+  for (unsigned i = 0; i != NumArgs; ++i) {
+    Value *Arg = CI->getArgOperand(i);
+    if (Arg == Begin) {
+      TaskCallArgs.push_back(TaskBegin);
+      continue;
+    }
+    if (Arg == End) {
+      TaskCallArgs.push_back(TaskEnd);
+      continue;
+    }
+
+    const Type *Ty = Arg->getType();
+    unsigned Words = getNumWords(Ty);
+    const IntegerType *IntTy = Words == 1 ? Int32Ty : Int64Ty;
+
+    // Caller: value -> integer -> words.
+    Value *Int = Arg;
+    if (Ty->isPointerTy())
+      Int = new PtrToIntInst(Int, IntTy, "", CI);
+    else if (Ty->isFloatingPointTy())
+      Int = new BitCastInst(Int, IntegerType::get(Ctx, TD->getTypeSizeInBits(Ty)),
+                            "", CI);
+    if (Int->getType() != IntTy)
+      Int = new ZExtInst(Int, IntTy, "", CI);
+    for (unsigned w = 0; w != Words; ++w) {
+      Value *Word = Int;
+      if (w)
+        Word = BinaryOperator::CreateLShr(Word,
+                                          ConstantInt::get(IntTy, 32 * w),
+                                          "", CI);
+      if (IntTy != Int32Ty)
+        Word = new TruncInst(Word, Int32Ty, "", CI);
+      Value *Idx[] = { ConstantInt::get(Int32Ty, 0),
+                       ConstantInt::get(Int32Ty, FirstWord[i] + w) };
+      Value *Addr = GetElementPtrInst::Create(Env, Idx, Idx + 2, "", CI);
+      Addr = new BitCastInst(Addr, Int8PtrTy, "", CI);
+      Value *StArgs[] = { Word, Addr };
+      CallInst::Create(GStW, StArgs, StArgs + 2, "", CI);
+    }
+
+    // Task: words -> integer -> value.
+    Value *Loaded = 0;
+    for (unsigned w = 0; w != Words; ++w) {
+      Value *Idx[] = { ConstantInt::get(Int32Ty, 0),
+                       ConstantInt::get(Int32Ty, FirstWord[i] + w) };
+      Value *Addr = GetElementPtrInst::Create(TaskEnvPtr, Idx, Idx + 2, "",
+                                              TaskBB);
+      Addr = new BitCastInst(Addr, Int8PtrTy, "", TaskBB);
+      Value *Word = CallInst::Create(GLdW, Addr, "", TaskBB);
+      if (IntTy != Int32Ty) {
+        Word = new ZExtInst(Word, IntTy, "", TaskBB);
+        if (w)
+          Word = BinaryOperator::CreateShl(Word,
+                                           ConstantInt::get(IntTy, 32 * w),
+                                           "", TaskBB);
+      }
+      Loaded = Loaded ? BinaryOperator::CreateOr(Loaded, Word, "", TaskBB)
+                      : Word;
+    }
+    if (Ty->isPointerTy())
+      Loaded = new IntToPtrInst(Loaded, Ty, Arg->getName(), TaskBB);
+    else if (Ty->isFloatingPointTy()) {
+      const Type *BitsTy = IntegerType::get(Ctx, TD->getTypeSizeInBits(Ty));
+      if (Loaded->getType() != BitsTy)
+        Loaded = new TruncInst(Loaded, BitsTy, "", TaskBB);
+      Loaded = new BitCastInst(Loaded, Ty, Arg->getName(), TaskBB);
+    } else if (Loaded->getType() != Ty)
+      Loaded = new TruncInst(Loaded, Ty, Arg->getName(), TaskBB);
+    TaskCallArgs.push_back(Loaded);
+  }
+  CallInst::Create(Body, TaskCallArgs.begin(), TaskCallArgs.end(), "", TaskBB);
+  ReturnInst::Create(Ctx, TaskBB);
+
+  // Enqueue the loop, a few chunks per core.
+  Function *ReadSR = Intrinsic::getDeclaration(M, Intrinsic::rigel_read_sr);
+  Value *NumThreads =
+    CallInst::Create(ReadSR, ConstantInt::get(Int32Ty, RigelSR::NumThreads),
+                     "par.nthreads", CI);
+  Value *NumTasks =
+    BinaryOperator::CreateMul(NumThreads,
+                              ConstantInt::get(Int32Ty, TasksPerCore),
+                              "par.ntasks", CI);
+  Value *Chunk = BinaryOperator::CreateUDiv(TripCount, NumTasks, "", CI);
+  Value *IsZero = new ICmpInst(CI, ICmpInst::ICMP_EQ, Chunk,
+                               ConstantInt::get(Int32Ty, 0), "");
+  Chunk = SelectInst::Create(IsZero, ConstantInt::get(Int32Ty, 1), Chunk,
+                             "par.chunk", CI);
+  Value *LoopArgs[] = {
+    new PtrToIntInst(Task, Int32Ty, "", CI),
+    new PtrToIntInst(Env, Int32Ty, "", CI),
+    TripCount,
+    Chunk
+  };
+  Function *TQLoop = Intrinsic::getDeclaration(M, Intrinsic::rigel_tq_loop);
+  CallInst::Create(TQLoop, LoopArgs, LoopArgs + 4, "", CI);
+
+  // Work on the queue until it drains, then release it.
+  BasicBlock *CallBB = CI->getParent();
+  BasicBlock *Done = CallBB->splitBasicBlock(CI, "par.done");
+  Function *TQEnd = Intrinsic::getDeclaration(M, Intrinsic::rigel_tq_end);
+  CallInst::Create(TQEnd, "", CI);
+  BasicBlock *Dispatch = BasicBlock::Create(Ctx, "par.dispatch", F, Done);
+  BasicBlock *Run = BasicBlock::Create(Ctx, "par.run", F, Done);
+  CallBB->getTerminator()->setSuccessor(0, Dispatch);
+
+  Function *TQDequeue =
+    Intrinsic::getDeclaration(M, Intrinsic::rigel_tq_dequeue);
+  Value *T = CallInst::Create(TQDequeue, "par.task", Dispatch);
+  Value *Status = ExtractValueInst::Create(T, 0, "par.status", Dispatch);
+  Value *Got = new ICmpInst(*Dispatch, ICmpInst::ICMP_EQ, Status,
+                            ConstantInt::get(Int32Ty, 0), "par.got");
+  BranchInst::Create(Run, Done, Got, Dispatch);
+
+  Value *Fn = ExtractValueInst::Create(T, 1, "", Run);
+  Fn = new IntToPtrInst(Fn, PointerType::getUnqual(TaskTy), "par.fn", Run);
+  Value *RunArgs[] = {
+    ExtractValueInst::Create(T, 2, "", Run),
+    ExtractValueInst::Create(T, 3, "", Run),
+    ExtractValueInst::Create(T, 4, "", Run)
+  };
+  CallInst::Create(Fn, RunArgs, RunArgs + 3, "", Run);
+  BranchInst::Create(Dispatch, Run);
+
+  CI->eraseFromParent();
+
+  // Keep LoopInfo up to date for any loops still to be processed.
+  if (Loop *Outer = LI->getLoopFor(CallBB)) {
+    Outer->addBasicBlockToLoop(Dispatch, LI->getBase());
+    Outer->addBasicBlockToLoop(Run, LI->getBase());
+    Outer->addBasicBlockToLoop(Done, LI->getBase());
+  }
+  return true;
+}
+
+/// runOnModule - Parallelizing a loop outlines its body into new functions,
+/// which is why this is a module pass.  Only the functions that were there
+/// to begin with are visited.
+bool RigelLoopParallelize::runOnModule(Module &M) {
+  ParallelKind = M.getContext().getMDKindID("rigel.parallel");
+
+  SmallVector<Function*, 16> Worklist;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
+    if (!F->isDeclaration())
+      Worklist.push_back(F);
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Worklist.size(); i != e; ++i)
+    Changed |= runOnFunction(*Worklist[i]);
+  return Changed;
+}
+
+bool RigelLoopParallelize::runOnFunction(Function &F) {
+  // Don't compute the loop analyses for functions without any marked loops.
+  bool HasMarks = false;
+  for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    if (BB->getTerminator()->getMetadata(ParallelKind)) {
+      HasMarks = true;
+      break;
+    }
+  if (!HasMarks)
+    return false;
+
+  LI = &getAnalysis<LoopInfo>(F);
+  DT = &getAnalysis<DominatorTree>(F);
+  SE = &getAnalysis<ScalarEvolution>(F);
+
+  SmallVector<Loop*, 4> Loops;
+  for (LoopInfo::iterator I = LI->begin(), E = LI->end(); I != E; ++I)
+    collectParallelLoops(*I, Loops);
+
+  bool Changed = !Loops.empty();
+  for (unsigned i = 0, e = Loops.size(); i != e; ++i)
+    if (!parallelizeLoop(Loops[i]))
+      DEBUG(dbgs() << "Rigel: can't parallelize loop at "
+                   << Loops[i]->getHeader()->getName() << " in "
+                   << F.getName() << "\n");
+  return Changed;
+}
+
+/// createRigelLoopParallelizePass - Returns a pass that runs loops marked
+/// with '#pragma rigel parallel for' on the hardware task queue.
+ModulePass *llvm::createRigelLoopParallelizePass(RigelTargetMachine &TM) {
+  return new RigelLoopParallelize(TM.getTargetData());
+}
@@ -0,0 +1,874 @@
+//===-- RigelModuloSchedule.cpp - Software pipelining for Rigel --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Modulo schedules single-block innermost loops before register allocation,
+// so that loads and FPU operations of later iterations overlap the latency of
+// earlier ones instead of the in-order core stalling on each dependency
+// chain.
+//
+// The loop body is scheduled with the Rigel itineraries at the smallest
+// initiation interval (II) that fits its resources and recurrences.  With S
+// stages, the loop is then rewritten as
+//
+//   preheader: k = n - (S - 1); if (k <= 0) goto original loop
+//   prolog:    the first S - 1 stages of the first S - 1 iterations
+//   kernel:    one instance of every stage, k times
+//   epilog:    the last S - 1 stages of the last S - 1 iterations
+//
+// where n is the loop's trip count.  Short loops keep running the original
+// body.  The code is still in SSA form, so values that live longer than II
+// cycles are carried around the kernel by chains of PHIs rather than by
+// modulo variable expansion.
+//
+// Only loops counted down by LSR's "addi c, c, -1; bnz c" idiom, free of
+// calls and volatile accesses, are handled.  A schedule is rejected if it
+// does not beat the length of one iteration, needs more than
+// -rigel-pipeline-max-stages stages, or keeps more values live than there
+// are registers.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "rigel-pipeliner"
+#include "Rigel.h"
+#include "RigelInstrInfo.h"
+#include "RigelTargetMachine.h"
+#include "llvm/Instructions.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineMemOperand.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/PseudoSourceValue.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrItineraries.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include <algorithm>
+#include <climits>
+using namespace llvm;
+
+STATISTIC(NumPipelined, "Number of loops software pipelined");
+
+static cl::opt<bool>
+DisablePipeliner("disable-rigel-pipeliner", cl::Hidden,
+                 cl::desc("Disable software pipelining of Rigel loops"));
+
+static cl::opt<unsigned>
+PipelineMaxOps("rigel-pipeline-max-ops", cl::Hidden,
+               cl::desc("Largest loop body to software pipeline, in "
+                        "instructions (default=48)"),
+               cl::init(48));
+
+static cl::opt<unsigned>
+PipelineMaxStages("rigel-pipeline-max-stages", cl::Hidden,
+                  cl::desc("Most stages in a software pipelined loop "
+                           "(default=4)"),
+                  cl::init(4));
+
+// Rigel cores issue up to two instructions a cycle, in order.
+static const unsigned IssueWidth = 2;
+
+namespace {
+  /// MSDep - An edge of the loop body's dependence graph: the instruction at
+  /// the other end issues at least Latency cycles after the source one from
+  /// Distance iterations earlier.
+  struct MSDep {
+    unsigned Node;
+    unsigned Latency;
+    unsigned Distance;
+    MSDep(unsigned N, unsigned L, unsigned D)
+      : Node(N), Latency(L), Distance(D) {}
+  };
+
+  struct MSNode {
+    MachineInstr *MI;
+    unsigned Latency;
+    int Cycle;
+    SmallVector<MSDep, 4> Preds, Succs;
+    explicit MSNode(MachineInstr *mi) : MI(mi), Latency(1), Cycle(0) {}
+  };
+
+  class RigelModuloSchedule : public MachineFunctionPass {
+    const TargetInstrInfo *TII;
+    InstrItineraryData Itins;
+    MachineRegisterInfo *MRI;
+    AliasAnalysis *AA;
+    unsigned NumRegs;
+
+    // The loop being pipelined.
+    MachineBasicBlock *Preheader, *Body, *Exit;
+    unsigned TripCount;
+    MachineInstr *CounterMI;
+    std::vector<MSNode> Nodes;
+    DenseMap<unsigned, unsigned> DefNode;
+    DenseMap<unsigned, std::pair<unsigned, unsigned> > Phis;
+    DenseMap<unsigned, unsigned> PhiOfValue;
+    SmallVector<unsigned, 8> LiveOuts;
+
+    // The schedule.
+    unsigned II, NumStages;
+
+    // The pipelined code's values, by original register: per prolog and
+    // epilog stage, in the kernel, and the kernel PHIs holding the values
+    // from earlier kernel iterations.
+    std::vector<DenseMap<unsigned, unsigned> > PrologVals, EpilogVals;
+    DenseMap<unsigned, unsigned> KernelVals;
+    DenseMap<unsigned, SmallVector<unsigned, 4> > Chains;
+
+  public:
+    static char ID;
+    RigelModuloSchedule() : MachineFunctionPass(ID) {}
+
+    virtual bool runOnMachineFunction(MachineFunction &MF);
+
+    virtual const char *getPassName() const {
+      return "Rigel software pipeliner";
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<MachineLoopInfo>();
+      AU.addRequired<AliasAnalysis>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+  private:
+    enum Part { Prolog, Kernel, Epilog };
+
+    bool analyzeLoop(MachineLoop *L);
+    bool mayAlias(MachineInstr *A, MachineInstr *B);
+    void buildDeps();
+    unsigned getResMII();
+    unsigned getIterationLength();
+    bool recurrencesFit(unsigned II);
+    bool reserve(unsigned N, int Cycle, std::vector<unsigned> &Busy,
+                 std::vector<unsigned> &Issued);
+    bool scheduleAt(unsigned II);
+    unsigned getMaxLive();
+    bool schedule();
+    void expand();
+
+    unsigned getStage(unsigned N) const { return Nodes[N].Cycle / II; }
+    bool resolveUse(unsigned Reg, unsigned &Src, unsigned &Distance);
+    int getDelta(unsigned User, unsigned Src, unsigned Distance) const {
+      return int(getStage(User)) - int(getStage(DefNode.lookup(Src))) +
+             int(Distance);
+    }
+    unsigned lookupValue(Part P, int Step, unsigned Src, int Delta);
+    unsigned getValueAfterKernel(unsigned Src, int Rel);
+    void emitInstance(Part P, int Step, unsigned N, MachineBasicBlock *MBB,
+                      DenseMap<unsigned, unsigned> &Defs);
+  };
+  char RigelModuloSchedule::ID = 0;
+}
+
+/// analyzeLoop - Check that L is a loop we can pipeline and collect its body.
+bool RigelModuloSchedule::analyzeLoop(MachineLoop *L) {
+  if (L->begin() != L->end() || L->getBlocks().size() != 1)
+    return false;
+  Body = L->getHeader();
+  if (Body->pred_size() != 2 || Body->succ_size() != 2)
+    return false;
+
+  Preheader = Exit = 0;
+  for (MachineBasicBlock::pred_iterator PI = Body->pred_begin(),
+       PE = Body->pred_end(); PI != PE; ++PI)
+    if (*PI != Body)
+      Preheader = *PI;
+  for (MachineBasicBlock::succ_iterator SI = Body->succ_begin(),
+       SE = Body->succ_end(); SI != SE; ++SI)
+    if (*SI != Body)
+      Exit = *SI;
+  if (!Preheader || !Exit || Preheader == Exit ||
+      Preheader->succ_size() != 1)
+    return false;
+
+  MachineBasicBlock *TBB = 0, *FBB = 0;
+  SmallVector<MachineOperand, 4> Cond;
+  if (TII->AnalyzeBranch(*Preheader, TBB, FBB, Cond) || !Cond.empty())
+    return false;
+  TBB = FBB = 0;
+  if (TII->AnalyzeBranch(*Body, TBB, FBB, Cond) || Cond.size() != 2)
+    return false;
+  unsigned BrOpc = Cond[0].getImm();
+  if (!((BrOpc == Rigel::BNZ && TBB == Body) ||
+        (BrOpc == Rigel::BE && TBB == Exit && FBB == Body)))
+    return false;
+
+  // The trip count: the loop runs while c = c - 1 is non-zero.
+  unsigned Count = Cond[1].getReg();
+  if (!TargetRegisterInfo::isVirtualRegister(Count))
+    return false;
+  MachineInstr *Dec = MRI->getVRegDef(Count);
+  if (!Dec || Dec->getParent() != Body || Dec->getOpcode() != Rigel::ADDi ||
+      !Dec->getOperand(1).isReg() || !Dec->getOperand(2).isImm() ||
+      Dec->getOperand(2).getImm() != -1)
+    return false;
+  unsigned CountPhi = Dec->getOperand(1).getReg();
+  MachineInstr *PhiMI = MRI->getVRegDef(CountPhi);
+  if (!PhiMI || !PhiMI->isPHI() || PhiMI->getParent() != Body ||
+      PhiMI->getNumOperands() != 5)
+    return false;
+  TripCount = 0;
+  for (unsigned i = 1; i != 5; i += 2) {
+    if (PhiMI->getOperand(i + 1).getMBB() == Preheader)
+      TripCount = PhiMI->getOperand(i).getReg();
+    else if (PhiMI->getOperand(i).getReg() != Count)
+      return false;
+  }
+  if (!TripCount)
+    return false;
+
+  // If nothing but the branch looks at the counter, the kernel's own counter
+  // replaces it.
+  CounterMI = Dec;
+  for (MachineRegisterInfo::use_iterator UI = MRI->use_begin(CountPhi),
+       UE = MRI->use_end(); UI != UE; ++UI)
+    if (&*UI != Dec)
+      CounterMI = 0;
+  for (MachineRegisterInfo::use_iterator UI = MRI->use_begin(Count),
+       UE = MRI->use_end(); UI != UE; ++UI)
+    if (UI->getParent() != Body ||
+        (&*UI != PhiMI && !UI->getDesc().isBranch()))
+      CounterMI = 0;
+
+  Nodes.clear();
+  DefNode.clear();
+  Phis.clear();
+  PhiOfValue.clear();
+  LiveOuts.clear();
+  for (MachineBasicBlock::iterator I = Body->begin(), E = Body->end();
+       I != E; ++I) {
+    MachineInstr *MI = I;
+    if (MI->isPHI()) {
+      if (CounterMI && MI == PhiMI)
+        continue;
+      if (MI->getNumOperands() != 5)
+        return false;
+      unsigned Init = 0, Next = 0;
+      for (unsigned i = 1; i != 5; i += 2)
+        if (MI->getOperand(i + 1).getMBB() == Preheader)
+          Init = MI->getOperand(i).getReg();
+        else
+          Next = MI->getOperand(i).getReg();
+      Phis[MI->getOperand(0).getReg()] = std::make_pair(Next, Init);
+      continue;
+    }
+    if (MI->isDebugValue() || MI == CounterMI)
+      continue;
+    const TargetInstrDesc &TID = MI->getDesc();
+    if (TID.isTerminator())
+      continue;
+    if (TID.isCall() || TID.isNotDuplicable() ||
+        TID.hasUnmodeledSideEffects() || MI->isInlineAsm() ||
+        MI->isLabel() || MI->hasVolatileMemoryRef())
+      return false;
+    for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (!MO.isReg() || !MO.getReg())
+        continue;
+      if (TargetRegisterInfo::isPhysicalRegister(MO.getReg())) {
+        if (MO.isDef() || MO.getReg() != Rigel::ZERO)
+          return false;
+        continue;
+      }
+      if (MO.isDef())
+        DefNode[MO.getReg()] = Nodes.size();
+    }
+    Nodes.push_back(MSNode(MI));
+  }
+  if (Nodes.empty() || Nodes.size() > PipelineMaxOps)
+    return false;
+
+  // Every value carried around the loop must come from the body.
+  for (DenseMap<unsigned, std::pair<unsigned, unsigned> >::iterator
+       I = Phis.begin(), E = Phis.end(); I != E; ++I) {
+    unsigned Next = I->second.first;
+    if (!DefNode.count(Next) || PhiOfValue.count(Next))
+      return false;
+    PhiOfValue[Next] = I->first;
+  }
+
+  // Values used after the loop.
+  SmallVector<unsigned, 16> Defs;
+  for (DenseMap<unsigned, unsigned>::iterator I = DefNode.begin(),
+       E = DefNode.end(); I != E; ++I)
+    Defs.push_back(I->first);
+  for (DenseMap<unsigned, std::pair<unsigned, unsigned> >::iterator
+       I = Phis.begin(), E = Phis.end(); I != E; ++I)
+    Defs.push_back(I->first);
+  for (unsigned i = 0, e = Defs.size(); i != e; ++i)
+    for (MachineRegisterInfo::use_iterator UI = MRI->use_begin(Defs[i]),
+         UE = MRI->use_end(); UI != UE; ++UI)
+      if (UI->getParent() != Body) {
+        LiveOuts.push_back(Defs[i]);
+        break;
+      }
+  return true;
+}
+
+/// getBaseObject - The object a pointer points into.  Unlike
+/// getUnderlyingObject, this looks through the induction PHIs LSR creates,
+/// which are based on a single object plus an offset.
+static const Value *getBaseObject(const Value *V) {
+  V = V->getUnderlyingObject();
+  for (unsigned Depth = 0; Depth != 6; ++Depth) {
+    const PHINode *PN = dyn_cast<PHINode>(V);
+    if (!PN)
+      break;
+    const Value *Base = 0;
+    for (unsigned i = 0, e = PN->getNumIncomingValues(); i != e; ++i) {
+      const Value *In = PN->getIncomingValue(i)->getUnderlyingObject();
+      if (In == PN)
+        continue;
+      if (Base && In != Base)
+        return V;
+      Base = In;
+    }
+    if (!Base)
+      break;
+    V = Base;
+  }
+  return V;
+}
+
+/// mayAlias - Return true if memory instructions A and B may touch the same
+/// memory in any two iterations.
+bool RigelModuloSchedule::mayAlias(MachineInstr *A, MachineInstr *B) {
+  if ((A->getDesc().mayLoad() && A->isInvariantLoad(AA)) ||
+      (B->getDesc().mayLoad() && B->isInvariantLoad(AA)))
+    return false;
+  if (!A->hasOneMemOperand() || !B->hasOneMemOperand())
+    return true;
+  const Value *VA = (*A->memoperands_begin())->getValue();
+  const Value *VB = (*B->memoperands_begin())->getValue();
+  if (!VA || !VB || isa<PseudoSourceValue>(VA) || isa<PseudoSourceValue>(VB))
+    return true;
+  // Compare whole objects: the accesses move from iteration to iteration.
+  return AA->alias(getBaseObject(VA), AliasAnalysis::UnknownSize,
+                   getBaseObject(VB), AliasAnalysis::UnknownSize) !=
+         AliasAnalysis::NoAlias;
+}
+
+static void addDep(std::vector<MSNode> &Nodes, unsigned From, unsigned To,
+                   unsigned Latency, unsigned Distance) {
+  Nodes[From].Succs.push_back(MSDep(To, Latency, Distance));
+  Nodes[To].Preds.push_back(MSDep(From, Latency, Distance));
+}
+
+/// buildDeps - Build the dependence graph of the loop body.  Register
+/// dependences through the body's PHIs are one iteration apart.  The SSA
+/// body has no anti or output register dependences.
+void RigelModuloSchedule::buildDeps() {
+  for (unsigned u = 0, e = Nodes.size(); u != e; ++u) {
+    MachineInstr *MI = Nodes[u].MI;
+    unsigned Latency =
+      Itins.getStageLatency(MI->getDesc().getSchedClass());
+    Nodes[u].Latency = std::max(Latency, 1U);
+  }
+
+  for (unsigned u = 0, e = Nodes.size(); u != e; ++u) {
+    MachineInstr *MI = Nodes[u].MI;
+    for (unsigned i = 0, ie = MI->getNumOperands(); i != ie; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (!MO.isReg() || !MO.isUse() ||
+          !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        continue;
+      unsigned Src, Distance;
+      if (!resolveUse(MO.getReg(), Src, Distance))
+        continue;
+      unsigned d = DefNode[Src];
+      addDep(Nodes, d, u, Nodes[d].Latency, Distance);
+    }
+  }
+
+  // Keep memory accesses in order unless they provably never overlap.
+  for (unsigned i = 0, e = Nodes.size(); i != e; ++i) {
+    const TargetInstrDesc &TIDi = Nodes[i].MI->getDesc();
+    if (!TIDi.mayLoad() && !TIDi.mayStore())
+      continue;
+    for (unsigned j = i + 1; j != e; ++j) {
+      const TargetInstrDesc &TIDj = Nodes[j].MI->getDesc();
+      if (!(TIDi.mayStore() && (TIDj.mayLoad() || TIDj.mayStore())) &&
+          !(TIDj.mayStore() && TIDi.mayLoad()))
+        continue;
+      if (!mayAlias(Nodes[i].MI, Nodes[j].MI))
+        continue;
+      addDep(Nodes, i, j, 1, 0);
+      addDep(Nodes, j, i, 1, 1);
+    }
+  }
+}
+
+/// getResMII - A lower bound on II from issue width and functional units.
+unsigned RigelModuloSchedule::getResMII() {
+  unsigned ResMII = (Nodes.size() + IssueWidth - 1) / IssueWidth;
+  DenseMap<unsigned, unsigned> UnitCycles;
+  for (unsigned n = 0, e = Nodes.size(); n != e; ++n) {
+    unsigned SchedClass = Nodes[n].MI->getDesc().getSchedClass();
+    if (Itins.isEmpty())
+      break;
+    for (const InstrStage *IS = Itins.beginStage(SchedClass),
+         *E = Itins.endStage(SchedClass); IS != E; ++IS)
+      UnitCycles[IS->getUnits()] += IS->getCycles();
+  }
+  for (DenseMap<unsigned, unsigned>::iterator I = UnitCycles.begin(),
+       E = UnitCycles.end(); I != E; ++I) {
+    unsigned NumUnits = CountPopulation_32(I->first);
+    if (NumUnits)
+      ResMII = std::max(ResMII, (I->second + NumUnits - 1) / NumUnits);
+  }
+  return ResMII;
+}
+
+/// getIterationLength - Cycles one iteration takes by itself: pipelining
+/// only pays if II is shorter.
+unsigned RigelModuloSchedule::getIterationLength() {
+  std::vector<unsigned> Start(Nodes.size(), 0);
+  unsigned Length = (Nodes.size() + IssueWidth - 1) / IssueWidth;
+  for (unsigned u = 0, e = Nodes.size(); u != e; ++u) {
+    for (unsigned i = 0, ie = Nodes[u].Preds.size(); i != ie; ++i) {
+      const MSDep &D = Nodes[u].Preds[i];
+      if (D.Distance == 0)
+        Start[u] = std::max(Start[u], Start[D.Node] + D.Latency);
+    }
+    Length = std::max(Length, Start[u] + Nodes[u].Latency);
+  }
+  return Length;
+}
+
+/// recurrencesFit - Return true if no dependence cycle needs more than II
+/// cycles per iteration.
+bool RigelModuloSchedule::recurrencesFit(unsigned II) {
+  const int None = INT_MIN / 2;
+  unsigned N = Nodes.size();
+  std::vector<int> Path(N * N, None);
+  for (unsigned u = 0; u != N; ++u)
+    for (unsigned i = 0, e = Nodes[u].Succs.size(); i != e; ++i) {
+      const MSDep &D = Nodes[u].Succs[i];
+      int W = int(D.Latency) - int(II * D.Distance);
+      Path[u * N + D.Node] = std::max(Path[u * N + D.Node], W);
+    }
+  for (unsigned k = 0; k != N; ++k)
+    for (unsigned i = 0; i != N; ++i) {
+      if (Path[i * N + k] == None)
+        continue;
+      for (unsigned j = 0; j != N; ++j)
+        if (Path[k * N + j] != None)
+          Path[i * N + j] = std::max(Path[i * N + j],
+                                     Path[i * N + k] + Path[k * N + j]);
+    }
+  for (unsigned i = 0; i != N; ++i)
+    if (Path[i * N + i] > 0)
+      return false;
+  return true;
+}
+
+/// reserve - Claim an issue slot and the functional units node N needs if it
+/// issues at Cycle, in the modulo reservation table.
+bool RigelModuloSchedule::reserve(unsigned N, int Cycle,
+                                  std::vector<unsigned> &Busy,
+                                  std::vector<unsigned> &Issued) {
+  unsigned Slot = Cycle % II;
+  if (Issued[Slot] >= IssueWidth)
+    return false;
+  std::vector<unsigned> NewBusy(Busy);
+  if (!Itins.isEmpty()) {
+    unsigned SchedClass = Nodes[N].MI->getDesc().getSchedClass();
+    unsigned Offset = 0;
+    for (const InstrStage *IS = Itins.beginStage(SchedClass),
+         *E = Itins.endStage(SchedClass); IS != E; ++IS) {
+      // An unpipelined unit busy for II cycles or more would collide with
+      // the next iteration's use of it.
+      if (IS->getCycles() > II)
+        return false;
+      unsigned Found = 0;
+      for (unsigned Units = IS->getUnits(); Units && !Found;
+           Units &= Units - 1) {
+        unsigned Unit = Units & -Units;
+        bool Free = true;
+        for (unsigned c = 0; c != IS->getCycles() && Free; ++c)
+          Free = !(NewBusy[(Cycle + Offset + c) % II] & Unit);
+        if (Free)
+          Found = Unit;
+      }
+      if (!Found)
+        return false;
+      for (unsigned c = 0; c != IS->getCycles(); ++c)
+        NewBusy[(Cycle + Offset + c) % II] |= Found;
+      Offset += IS->getNextCycles();
+    }
+  }
+  Busy.swap(NewBusy);
+  ++Issued[Slot];
+  return true;
+}
+
+/// scheduleAt - Try to schedule the body with the given II, placing each
+/// instruction, in order, at the first cycle its dependences and the
+/// reservation table allow.
+bool RigelModuloSchedule::scheduleAt(unsigned ii) {
+  II = ii;
+  std::vector<unsigned> Busy(II, 0), Issued(II, 0);
+  int MaxCycle = 0;
+  for (unsigned u = 0, e = Nodes.size(); u != e; ++u) {
+    int Early = 0, Late = INT_MAX;
+    for (unsigned i = 0, ie = Nodes[u].Preds.size(); i != ie; ++i) {
+      const MSDep &D = Nodes[u].Preds[i];
+      if (D.Node < u)
+        Early = std::max(Early, Nodes[D.Node].Cycle + int(D.Latency) -
+                                int(II * D.Distance));
+    }
+    for (unsigned i = 0, ie = Nodes[u].Succs.size(); i != ie; ++i) {
+      const MSDep &D = Nodes[u].Succs[i];
+      if (D.Node < u)
+        Late = std::min(Late, Nodes[D.Node].Cycle - int(D.Latency) +
+                              int(II * D.Distance));
+    }
+    bool Placed = false;
+    for (int Cycle = Early; Cycle < Early + int(II) && Cycle <= Late;
+         ++Cycle)
+      if (reserve(u, Cycle, Busy, Issued)) {
+        Nodes[u].Cycle = Cycle;
+        MaxCycle = std::max(MaxCycle, Cycle);
+        Placed = true;
+        break;
+      }
+    if (!Placed)
+      return false;
+  }
+  NumStages = MaxCycle / II + 1;
+  return true;
+}
+
+/// getMaxLive - Estimate the registers the kernel needs: the most values
+/// live in any cycle, plus the loop invariants and the kernel's counter.
+unsigned RigelModuloSchedule::getMaxLive() {
+  DenseMap<unsigned, int> LastUse;
+  DenseMap<unsigned, bool> Invariants;
+  for (unsigned u = 0, e = Nodes.size(); u != e; ++u) {
+    MachineInstr *MI = Nodes[u].MI;
+    for (unsigned i = 0, ie = MI->getNumOperands(); i != ie; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      if (!MO.isReg() || !MO.isUse() ||
+          !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+        continue;
+      unsigned Src, Distance;
+      if (!resolveUse(MO.getReg(), Src, Distance)) {
+        Invariants[MO.getReg()] = true;
+        continue;
+      }
+      int End = Nodes[u].Cycle + int(II * Distance);
+      DenseMap<unsigned, int>::iterator I = LastUse.find(Src);
+      if (I == LastUse.end())
+        LastUse[Src] = End;
+      else
+        I->second = std::max(I->second, End);
+    }
+  }
+
+  std::vector<unsigned> Live(II, 0);
+  for (DenseMap<unsigned, int>::iterator I = LastUse.begin(),
+       E = LastUse.end(); I != E; ++I)
+    for (int c = Nodes[DefNode[I->first]].Cycle; c < I->second; ++c)
+      ++Live[c % II];
+  return *std::max_element(Live.begin(), Live.end()) + Invariants.size() + 1;
+}
+
+/// schedule - Find the smallest II that has a schedule worth using.
+bool RigelModuloSchedule::schedule() {
+  unsigned Length = getIterationLength();
+  for (unsigned ii = std::max(getResMII(), 1U); ii < Length; ++ii) {
+    if (!recurrencesFit(ii) || !scheduleAt(ii))
+      continue;
+    if (NumStages < 2 || NumStages > PipelineMaxStages)
+      continue;
+    unsigned MaxLive = getMaxLive();
+    if (MaxLive > NumRegs) {
+      DEBUG(dbgs() << "Rigel pipeliner: II=" << ii << " needs " << MaxLive
+                   << " registers\n");
+      continue;
+    }
+    DEBUG(dbgs() << "Rigel pipeliner: BB#" << Body->getNumber() << " II="
+                 << II << " stages=" << NumStages << " (iteration length "
+                 << Length << ")\n");
+    return true;
+  }
+  return false;
+}
+
+/// resolveUse - If Reg is computed in the loop, set Src to the register of
+/// the instruction computing it and Distance to how many iterations earlier.
+bool RigelModuloSchedule::resolveUse(unsigned Reg, unsigned &Src,
+                                     unsigned &Distance) {
+  if (DefNode.count(Reg)) {
+    Src = Reg;
+    Distance = 0;
+    return true;
+  }
+  DenseMap<unsigned, std::pair<unsigned, unsigned> >::iterator I =
+    Phis.find(Reg);
+  if (I == Phis.end())
+    return false;
+  Src = I->second.first;
+  Distance = 1;
+  return true;
+}
+
+/// lookupValue - The register holding Src, as defined Delta stages before
+/// the instance being emitted at Step of part P.
+unsigned RigelModuloSchedule::lookupValue(Part P, int Step, unsigned Src,
+                                          int Delta) {
+  switch (P) {
+  case Prolog: {
+    int DefStep = Step - Delta;
+    if (DefStep < int(getStage(DefNode[Src]))) {
+      // Iteration -1: the value the loop starts with.
+      assert(PhiOfValue.count(Src) && "Use before the first iteration");
+      return Phis[PhiOfValue[Src]].second;
+    }
+    return PrologVals[DefStep][Src];
+  }
+  case Kernel:
+    return Delta == 0 ? KernelVals[Src] : Chains[Src][Delta - 1];
+  case Epilog:
+    return getValueAfterKernel(Src, Step - Delta);
+  }
+  return 0;
+}
+
+/// getValueAfterKernel - Src as defined Rel stages after the last kernel
+/// iteration's (or -Rel stages before it).
+unsigned RigelModuloSchedule::getValueAfterKernel(unsigned Src, int Rel) {
+  if (Rel > 0)
+    return EpilogVals[Rel][Src];
+  if (Rel == 0)
+    return KernelVals[Src];
+  return Chains[Src][-Rel - 1];
+}
+
+/// emitInstance - Append a copy of node N for Step of part P to MBB, giving
+/// it new registers.
+void RigelModuloSchedule::emitInstance(Part P, int Step, unsigned N,
+                                       MachineBasicBlock *MBB,
+                                       DenseMap<unsigned, unsigned> &Defs) {
+  MachineFunction &MF = *MBB->getParent();
+  MachineInstr *NewMI = MF.CloneMachineInstr(Nodes[N].MI);
+  for (unsigned i = 0, e = NewMI->getNumOperands(); i != e; ++i) {
+    MachineOperand &MO = NewMI->getOperand(i);
+    if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+      continue;
+    unsigned Reg = MO.getReg();
+    if (MO.isDef()) {
+      unsigned NewReg = MRI->createVirtualRegister(MRI->getRegClass(Reg));
+      Defs[Reg] = NewReg;
+      MO.setReg(NewReg);
+      continue;
+    }
+    MO.setIsKill(false);
+    unsigned Src, Distance;
+    if (resolveUse(Reg, Src, Distance))
+      MO.setReg(lookupValue(P, Step, Src, getDelta(N, Src, Distance)));
+  }
+  MBB->push_back(NewMI);
+}
+
+/// expand - Emit the prolog, kernel and epilog, and route the preheader to
+/// them when the loop runs long enough.
+void RigelModuloSchedule::expand() {
+  MachineFunction &MF = *Body->getParent();
+  DebugLoc DL = Body->getFirstTerminator()->getDebugLoc();
+  unsigned S = NumStages;
+
+  // Issue order within a stage.
+  std::vector<std::pair<unsigned, unsigned> > Order;
+  for (unsigned n = 0, e = Nodes.size(); n != e; ++n)
+    Order.push_back(std::make_pair(Nodes[n].Cycle % II, n));
+  std::sort(Order.begin(), Order.end());
+
+  // How far back the kernel (and the live-outs) look at each value.
+  DenseMap<unsigned, int> MaxDelta;
+  for (unsigned u = 0, e = Nodes.size(); u != e; ++u) {
+    MachineInstr *MI = Nodes[u].MI;
+    for (unsigned i = 0, ie = MI->getNumOperands(); i != ie; ++i) {
+      const MachineOperand &MO = MI->getOperand(i);
+      unsigned Src, Distance;
+      if (MO.isReg() && MO.isUse() &&
+          TargetRegisterInfo::isVirtualRegister(MO.getReg()) &&
+          resolveUse(MO.getReg(), Src, Distance))
+        MaxDelta[Src] = std::max(MaxDelta[Src], getDelta(u, Src, Distance));
+    }
+  }
+  for (unsigned i = 0, e = LiveOuts.size(); i != e; ++i)
+    if (Phis.count(LiveOuts[i])) {
+      unsigned Src = Phis[LiveOuts[i]].first;
+      if (getStage(DefNode[Src]) == 0)
+        MaxDelta[Src] = std::max(MaxDelta[Src], 1);
+    }
+
+  MachineFunction::iterator InsertPt =
+    llvm::next(MachineFunction::iterator(Preheader));
+  MachineBasicBlock *PrologMBB =
+    MF.CreateMachineBasicBlock(Body->getBasicBlock());
+  MachineBasicBlock *KernelMBB =
+    MF.CreateMachineBasicBlock(Body->getBasicBlock());
+  MachineBasicBlock *EpilogMBB =
+    MF.CreateMachineBasicBlock(Body->getBasicBlock());
+  MachineBasicBlock *NewExit =
+    MF.CreateMachineBasicBlock(Body->getBasicBlock());
+  MF.insert(InsertPt, PrologMBB);
+  MF.insert(InsertPt, KernelMBB);
+  MF.insert(InsertPt, EpilogMBB);
+  MF.insert(llvm::next(MachineFunction::iterator(Body)), NewExit);
+
+  // The uses after the loop, before adding any more.
+  SmallVector<std::pair<MachineOperand*, unsigned>, 8> OutsideUses;
+  for (unsigned i = 0, e = LiveOuts.size(); i != e; ++i)
+    for (MachineRegisterInfo::use_iterator UI = MRI->use_begin(LiveOuts[i]),
+         UE = MRI->use_end(); UI != UE; ++UI)
+      if (UI->getParent() != Body)
+        OutsideUses.push_back(std::make_pair(&UI.getOperand(), i));
+
+  // Preheader: run the original loop unless there are at least S iterations.
+  TII->RemoveBranch(*Preheader);
+  unsigned KernelCount =
+    MRI->createVirtualRegister(Rigel::CPURegsRegisterClass);
+  BuildMI(*Preheader, Preheader->end(), DL, TII->get(Rigel::ADDi),
+          KernelCount).addReg(TripCount).addImm(-int(S - 1));
+  BuildMI(*Preheader, Preheader->end(), DL, TII->get(Rigel::BLE))
+    .addReg(KernelCount).addMBB(Body);
+  Preheader->addSuccessor(PrologMBB);
+
+  // Prolog: stages 0..k of the iteration that started k stages ago.
+  PrologVals.assign(S - 1, DenseMap<unsigned, unsigned>());
+  for (unsigned k = 0; k != S - 1; ++k)
+    for (unsigned i = 0, e = Order.size(); i != e; ++i)
+      if (getStage(Order[i].second) <= k)
+        emitInstance(Prolog, k, Order[i].second, PrologMBB, PrologVals[k]);
+  PrologMBB->addSuccessor(KernelMBB);
+
+  // Kernel.
+  KernelVals.clear();
+  Chains.clear();
+  for (DenseMap<unsigned, int>::iterator I = MaxDelta.begin(),
+       E = MaxDelta.end(); I != E; ++I)
+    for (int m = 0; m != I->second; ++m)
+      Chains[I->first].push_back(
+        MRI->createVirtualRegister(MRI->getRegClass(I->first)));
+  for (unsigned i = 0, e = Order.size(); i != e; ++i)
+    emitInstance(Kernel, 0, Order[i].second, KernelMBB, KernelVals);
+  for (DenseMap<unsigned, SmallVector<unsigned, 4> >::iterator
+       I = Chains.begin(), E = Chains.end(); I != E; ++I)
+    for (unsigned m = 1, me = I->second.size(); m <= me; ++m) {
+      unsigned Back = m == 1 ? KernelVals[I->first] : I->second[m - 2];
+      BuildMI(*KernelMBB, KernelMBB->begin(), DL, TII->get(TargetOpcode::PHI),
+              I->second[m - 1])
+        .addReg(lookupValue(Prolog, S - 1, I->first, m)).addMBB(PrologMBB)
+        .addReg(Back).addMBB(KernelMBB);
+    }
+  unsigned KC = MRI->createVirtualRegister(Rigel::CPURegsRegisterClass);
+  unsigned KCNext = MRI->createVirtualRegister(Rigel::CPURegsRegisterClass);
+  BuildMI(*KernelMBB, KernelMBB->begin(), DL, TII->get(TargetOpcode::PHI), KC)
+    .addReg(KernelCount).addMBB(PrologMBB)
+    .addReg(KCNext).addMBB(KernelMBB);
+  BuildMI(*KernelMBB, KernelMBB->end(), DL, TII->get(Rigel::ADDi), KCNext)
+    .addReg(KC).addImm(-1);
+  BuildMI(*KernelMBB, KernelMBB->end(), DL, TII->get(Rigel::BNZ))
+    .addReg(KCNext).addMBB(KernelMBB);
+  KernelMBB->addSuccessor(KernelMBB);
+  KernelMBB->addSuccessor(EpilogMBB);
+
+  // Epilog: stages e.. of the iterations still in flight.
+  EpilogVals.assign(S, DenseMap<unsigned, unsigned>());
+  for (unsigned e = 1; e != S; ++e)
+    for (unsigned i = 0, ie = Order.size(); i != ie; ++i)
+      if (getStage(Order[i].second) >= e)
+        emitInstance(Epilog, e, Order[i].second, EpilogMBB, EpilogVals[e]);
+  BuildMI(*EpilogMBB, EpilogMBB->end(), DL, TII->get(Rigel::JMP))
+    .addMBB(NewExit);
+  EpilogMBB->addSuccessor(NewExit);
+
+  // Join the two versions of the loop and use the joined values after it.
+  SmallVector<unsigned, 8> Joined;
+  for (unsigned i = 0, e = LiveOuts.size(); i != e; ++i) {
+    unsigned Reg = LiveOuts[i];
+    unsigned Val;
+    if (Phis.count(Reg)) {
+      unsigned Src = Phis[Reg].first;
+      Val = getValueAfterKernel(Src, int(getStage(DefNode[Src])) - 1);
+    } else {
+      Val = getValueAfterKernel(Reg, getStage(DefNode[Reg]));
+    }
+    unsigned NewReg = MRI->createVirtualRegister(MRI->getRegClass(Reg));
+    BuildMI(*NewExit, NewExit->end(), DL, TII->get(TargetOpcode::PHI), NewReg)
+      .addReg(Reg).addMBB(Body).addReg(Val).addMBB(EpilogMBB);
+    Joined.push_back(NewReg);
+  }
+  for (unsigned i = 0, e = OutsideUses.size(); i != e; ++i) {
+    OutsideUses[i].first->setReg(Joined[OutsideUses[i].second]);
+    OutsideUses[i].first->setIsKill(false);
+  }
+
+  Body->ReplaceUsesOfBlockWith(Exit, NewExit);
+  for (MachineBasicBlock::iterator I = Exit->begin(), E = Exit->end();
+       I != E && I->isPHI(); ++I)
+    for (unsigned i = 2, e = I->getNumOperands(); i < e; i += 2)
+      if (I->getOperand(i).getMBB() == Body)
+        I->getOperand(i).setMBB(NewExit);
+  if (!NewExit->isLayoutSuccessor(Exit))
+    BuildMI(*NewExit, NewExit->end(), DL, TII->get(Rigel::JMP)).addMBB(Exit);
+  NewExit->addSuccessor(Exit);
+}
+
+bool RigelModuloSchedule::runOnMachineFunction(MachineFunction &MF) {
+  if (DisablePipeliner)
+    return false;
+  TII = MF.getTarget().getInstrInfo();
+  Itins = MF.getTarget().getInstrItineraryData();
+  MRI = &MF.getRegInfo();
+  AA = &getAnalysis<AliasAnalysis>();
+  const TargetRegisterClass *RC = Rigel::CPURegsRegisterClass;
+  NumRegs = RC->allocation_order_end(MF) - RC->allocation_order_begin(MF);
+
+  // Collect the innermost loops up front; pipelining adds blocks.
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+  SmallVector<MachineLoop*, 8> Worklist(MLI.begin(), MLI.end());
+  SmallVector<MachineLoop*, 8> Innermost;
+  while (!Worklist.empty()) {
+    MachineLoop *L = Worklist.pop_back_val();
+    if (L->begin() == L->end())
+      Innermost.push_back(L);
+    else
+      Worklist.append(L->begin(), L->end());
+  }
+
+  bool Changed = false;
+  for (unsigned i = 0, e = Innermost.size(); i != e; ++i) {
+    if (!analyzeLoop(Innermost[i]))
+      continue;
+    buildDeps();
+    if (!schedule())
+      continue;
+    expand();
+    ++NumPipelined;
+    Changed = true;
+  }
+  return Changed;
+}
+
+/// createRigelModuloSchedulePass - Returns a pass that software pipelines
+/// single-block innermost loops.
+FunctionPass *llvm::createRigelModuloSchedulePass() {
+  return new RigelModuloSchedule();
+}
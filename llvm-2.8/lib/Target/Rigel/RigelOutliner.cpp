@@ -0,0 +1,413 @@
+//===-- RigelOutliner.cpp - Share repeated instruction sequences -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Replaces runs of identical instructions with calls to a single shared copy,
+// trading a call and return for the static code the copies took up.  Rigel
+// code repeats itself a lot after register allocation: frame offsets too big
+// for an immediate turn into mvui/ori/add, epilogues differ only in the
+// frame size, and unaligned accesses expand into shift/or chains.  On the
+// small instruction caches every line saved is a line that is not missed.
+//
+// Two kinds of sequence are outlined:
+//
+//  - Runs ending in the function return.  The copy is reached with a plain
+//    jump and returns on the caller's behalf, so RA need not be free.
+//  - Other runs, reached with "ljl".  This overwrites RA, so these are only
+//    taken from functions that make calls, between the point where the
+//    prologue saved RA and the point where the epilogue reloads it.
+//
+// The code generator finishes each function before starting the next, so the
+// pass cannot see the whole module up front.  It keeps a table of the runs it
+// has seen so far instead; the first function that outlines a run gets the
+// shared copy appended to it, and later functions call that copy.  A run
+// outlined for the first time must pay for its copy from the sites in the
+// current function, plus half of what the times it was left in place earlier
+// would have saved; those are taken as a sign that it will keep turning up.
+//
+// The pass runs on functions optimized for size (-Os), or on everything with
+// -rigel-outline.  Blocks inside loops are left alone unless
+// -rigel-outline-loops is given, since the call and return are paid on every
+// iteration.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "rigel-outliner"
+#include "Rigel.h"
+#include "RigelInstrInfo.h"
+#include "llvm/Function.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCSymbol.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include <algorithm>
+using namespace llvm;
+
+STATISTIC(NumOutlined,  "Number of shared sequences created");
+STATISTIC(NumCallSites, "Number of sequences replaced by a call or jump");
+STATISTIC(NumInstrsSaved, "Net number of instructions saved by outlining");
+
+static cl::opt<bool>
+OutlineAll("rigel-outline", cl::Hidden,
+           cl::desc("Outline repeated sequences in every function, not just "
+                    "those optimized for size"));
+
+static cl::opt<bool>
+OutlineLoops("rigel-outline-loops", cl::Hidden,
+             cl::desc("Outline sequences inside loops too"));
+
+static cl::opt<unsigned>
+MinLength("rigel-outline-min-length", cl::Hidden,
+          cl::desc("Shortest sequence to outline (default=3)"),
+          cl::init(3));
+
+static cl::opt<unsigned>
+MaxLength("rigel-outline-max-length", cl::Hidden,
+          cl::desc("Longest sequence to outline (default=16)"),
+          cl::init(16));
+
+namespace {
+  /// Sequence - What the pass knows about a run of instructions across the
+  /// functions it has seen.
+  struct Sequence {
+    MCSymbol *Body;     // The shared copy, once there is one.
+    unsigned Seen;      // Times it was left in place in earlier functions.
+    Sequence() : Body(0), Seen(0) {}
+  };
+
+  /// Candidate - The occurrences of one run in the current function.
+  struct Candidate {
+    StringMapEntry<Sequence> *Seq;
+    unsigned Length;
+    bool IsTail;
+    std::vector<MachineBasicBlock::iterator> Starts;
+    int Gain;
+
+    bool operator<(const Candidate &RHS) const {
+      if (Gain != RHS.Gain)
+        return Gain > RHS.Gain;
+      return Length > RHS.Length;
+    }
+  };
+
+  class RigelOutliner : public MachineFunctionPass {
+    const TargetInstrInfo *TII;
+    StringMap<Sequence> Sequences;
+    unsigned NextBody;
+
+  public:
+    static char ID;
+    RigelOutliner() : MachineFunctionPass(ID), NextBody(0) {}
+
+    virtual bool doInitialization(Module &M) {
+      Sequences.clear();
+      return false;
+    }
+
+    virtual bool runOnMachineFunction(MachineFunction &MF);
+
+    virtual const char *getPassName() const {
+      return "Rigel machine code outliner";
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<MachineLoopInfo>();
+      AU.addRequired<MachineModuleInfo>();
+      MachineFunctionPass::getAnalysisUsage(AU);
+    }
+
+  private:
+    bool isOutlinable(const MachineInstr *MI) const;
+    void collect(MachineBasicBlock &MBB, bool RASaved,
+                 StringMap<Candidate> &Found);
+    MCSymbol *createBody(MachineFunction &MF, const Candidate &C);
+    void replace(MachineBasicBlock::iterator Start, const Candidate &C);
+  };
+  char RigelOutliner::ID = 0;
+}
+
+/// usesRA - Return true if MI reads or writes the return address register.
+static bool usesRA(const MachineInstr *MI) {
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (MO.isReg() && MO.getReg() == Rigel::RA)
+      return true;
+  }
+  return false;
+}
+
+/// isOutlinable - Return true if MI can be moved into another function
+/// unchanged.  Anything that refers to the function it is in (blocks,
+/// constant pools, jump tables) or changes control flow stays put.
+bool RigelOutliner::isOutlinable(const MachineInstr *MI) const {
+  const TargetInstrDesc &TID = MI->getDesc();
+  if (MI->getOpcode() <= TargetOpcode::COPY || MI->isDebugValue() ||
+      MI->getOpcode() == Rigel::NOREORDER)
+    return false;
+  if (TID.isCall() || TID.isBranch() || TID.isReturn() || TID.isBarrier())
+    return false;
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    if (!MO.isReg() && !MO.isImm() && !MO.isFPImm() && !MO.isGlobal() &&
+        !MO.isSymbol())
+      return false;
+  }
+  return true;
+}
+
+/// appendKey - Add a description of MI to Key that is equal for two
+/// instructions exactly when they do the same thing.
+static void appendKey(const MachineInstr *MI, std::string &Key) {
+  raw_string_ostream OS(Key);
+  OS << MI->getOpcode();
+  for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
+    const MachineOperand &MO = MI->getOperand(i);
+    switch (MO.getType()) {
+    case MachineOperand::MO_Register:
+      OS << (MO.isDef() ? " d" : " u") << MO.getReg();
+      break;
+    case MachineOperand::MO_Immediate:
+      OS << " i" << MO.getImm();
+      break;
+    case MachineOperand::MO_FPImmediate:
+      OS << " f" << (const void*)MO.getFPImm();
+      break;
+    case MachineOperand::MO_GlobalAddress:
+      OS << " g" << (const void*)MO.getGlobal() << '+' << MO.getOffset();
+      break;
+    case MachineOperand::MO_ExternalSymbol:
+      OS << " s" << MO.getSymbolName() << '+' << MO.getOffset();
+      break;
+    default:
+      llvm_unreachable("Operand kind rejected by isOutlinable");
+    }
+    OS << '/' << MO.getTargetFlags();
+  }
+  OS << ';';
+}
+
+/// collect - Record every run of MBB that could be outlined in Found.
+/// RASaved says whether RA is free to clobber on entry to MBB.
+void RigelOutliner::collect(MachineBasicBlock &MBB, bool RASaved,
+                            StringMap<Candidate> &Found) {
+  // Work out once which instructions can start or continue a run:
+  // CallOK[i] if instruction i may go in a called copy, TailOK[i] if it may
+  // go in a copy that ends in the return.
+  std::vector<MachineBasicBlock::iterator> Instrs;
+  std::vector<bool> CallOK, TailOK;
+  for (MachineBasicBlock::iterator I = MBB.begin(), E = MBB.end(); I != E;
+       ++I) {
+    bool OK = isOutlinable(I);
+    bool RA = usesRA(I);
+    Instrs.push_back(I);
+    CallOK.push_back(OK && RASaved && !RA);
+    TailOK.push_back(OK);
+    // The prologue stores RA and the epilogue reloads it.
+    if (RA)
+      RASaved = !I->getDesc().mayLoad() && !I->definesRegister(Rigel::RA);
+  }
+
+  // A tail run must end in the block's return with nothing after it.
+  bool EndsInReturn = !Instrs.empty() && Instrs.back()->getDesc().isReturn();
+
+  unsigned N = Instrs.size();
+  for (unsigned Start = 0; Start != N; ++Start) {
+    std::string Key;
+    bool AllCall = true, AllTail = true;
+    for (unsigned End = Start; End != N && End - Start < MaxLength; ++End) {
+      unsigned Length = End - Start + 1;
+      bool IsTail = EndsInReturn && End == N - 1;
+      if (!IsTail) {
+        AllCall &= CallOK[End];
+        AllTail &= TailOK[End];
+      }
+      if (!AllCall && !AllTail)
+        break;
+
+      appendKey(Instrs[End], Key);
+      if (Length < MinLength || !(IsTail ? AllTail : AllCall))
+        continue;
+
+      Candidate &C = Found[Key];
+      if (C.Starts.empty()) {
+        C.Seq = &Sequences.GetOrCreateValue(Key);
+        C.Length = Length;
+        C.IsTail = IsTail;
+      }
+      C.Starts.push_back(Instrs[Start]);
+    }
+  }
+}
+
+/// getGain - Return the number of instructions that outlining Sites copies
+/// of C would save in the module.  A call costs one instruction at each site;
+/// a new copy costs the run plus its return.
+static int getGain(const Candidate &C, unsigned Sites) {
+  const Sequence &S = C.Seq->getValue();
+  int PerSite = C.Length - 1;
+  if (S.Body)
+    return Sites * PerSite;
+  return Sites * PerSite + S.Seen * PerSite / 2 - (C.Length + !C.IsTail);
+}
+
+/// isFree - Return true if none of the Length instructions from Start has
+/// gone to another run.
+static bool isFree(MachineBasicBlock::iterator Start, unsigned Length,
+                   const SmallPtrSet<MachineInstr*, 64> &Taken) {
+  for (unsigned n = 0; n != Length; ++n, ++Start)
+    if (Taken.count(Start))
+      return false;
+  return true;
+}
+
+/// createBody - Append the shared copy of C to MF and return its label.
+MCSymbol *RigelOutliner::createBody(MachineFunction &MF, const Candidate &C) {
+  MCContext &Ctx = getAnalysis<MachineModuleInfo>().getContext();
+  const MCAsmInfo *MAI = MF.getTarget().getMCAsmInfo();
+  MCSymbol *Sym = Ctx.GetOrCreateSymbol(Twine(MAI->getPrivateGlobalPrefix()) +
+                                        "outlined" + Twine(NextBody++));
+
+  MachineBasicBlock *Body = MF.CreateMachineBasicBlock();
+  MF.push_back(Body);
+  MachineBasicBlock::iterator I = C.Starts.front();
+  DebugLoc DL = I->getDebugLoc();
+  BuildMI(Body, DL, TII->get(TargetOpcode::GC_LABEL)).addSym(Sym);
+  for (unsigned i = 0; i != C.Length; ++i, ++I)
+    Body->push_back(MF.CloneMachineInstr(I));
+  if (!C.IsTail)
+    BuildMI(Body, DL, TII->get(Rigel::RET)).addReg(Rigel::RA);
+  ++NumOutlined;
+  NumInstrsSaved -= C.Length + !C.IsTail;
+  return Sym;
+}
+
+/// replace - Swap the run of C at Start for a transfer to its shared copy.
+void RigelOutliner::replace(MachineBasicBlock::iterator Start,
+                            const Candidate &C) {
+  MachineBasicBlock *MBB = Start->getParent();
+  MCSymbol *Body = C.Seq->getValue().Body;
+
+  // A tail run in the block just before its copy can fall into it.
+  MachineFunction::iterator Next = llvm::next(MachineFunction::iterator(MBB));
+  bool FallsIn = C.IsTail && Next != MBB->getParent()->end() &&
+                 !Next->empty() && Next->front().isLabel() &&
+                 Next->front().getOperand(0).getMCSymbol() == Body;
+  if (!FallsIn)
+    BuildMI(*MBB, Start, Start->getDebugLoc(),
+            TII->get(C.IsTail ? Rigel::JMP : Rigel::JAL)).addSym(Body);
+  for (unsigned i = 0; i != C.Length; ++i)
+    (Start++)->eraseFromParent();
+  ++NumCallSites;
+  NumInstrsSaved += C.Length - !FallsIn;
+}
+
+bool RigelOutliner::runOnMachineFunction(MachineFunction &MF) {
+  const Function *F = MF.getFunction();
+  if (!OutlineAll && !F->hasFnAttr(Attribute::OptimizeForSize))
+    return false;
+
+  TII = MF.getTarget().getInstrInfo();
+  MachineLoopInfo &MLI = getAnalysis<MachineLoopInfo>();
+
+  // A shared copy goes after the last block, which must not fall into it.
+  // Later functions reach it through a local label, so it cannot go in a
+  // function the linker may throw away in favour of another definition.
+  bool CanAppend = !F->isWeakForLinker() && !MF.back().empty() &&
+                   MF.back().back().getDesc().isBarrier();
+
+  StringMap<Candidate> Found;
+  bool HasCalls = MF.getFrameInfo()->hasCalls();
+  for (MachineFunction::iterator MBB = MF.begin(), E = MF.end(); MBB != E;
+       ++MBB) {
+    if (!OutlineLoops && MLI.getLoopFor(MBB))
+      continue;
+    collect(*MBB, HasCalls && MBB != MF.begin(), Found);
+  }
+
+  // Rank the runs by what outlining them would save.
+  std::vector<Candidate> Ranked;
+  for (StringMap<Candidate>::iterator I = Found.begin(), E = Found.end();
+       I != E; ++I) {
+    Candidate &C = I->getValue();
+    if (!C.Seq->getValue().Body && !CanAppend)
+      continue;
+    C.Gain = getGain(C, C.Starts.size());
+    if (C.Gain > 0)
+      Ranked.push_back(C);
+  }
+  std::sort(Ranked.begin(), Ranked.end());
+
+  // Take the best runs first; an instruction goes to one run only.  Nothing
+  // is rewritten until all the runs are picked, so the iterators stay good.
+  SmallPtrSet<MachineInstr*, 64> Taken;
+  std::vector<Candidate*> Chosen;
+  for (unsigned i = 0, e = Ranked.size(); i != e; ++i) {
+    Candidate &C = Ranked[i];
+    std::vector<MachineBasicBlock::iterator> Sites;
+    for (unsigned s = 0, se = C.Starts.size(); s != se; ++s)
+      if (isFree(C.Starts[s], C.Length, Taken))
+        Sites.push_back(C.Starts[s]);
+
+    // Overlaps may have cost this run the sites that made it worthwhile.
+    if (Sites.empty() || getGain(C, Sites.size()) <= 0)
+      continue;
+
+    for (unsigned s = 0, se = Sites.size(); s != se; ++s) {
+      MachineBasicBlock::iterator I = Sites[s];
+      for (unsigned n = 0; n != C.Length; ++n, ++I)
+        Taken.insert(I);
+    }
+    C.Starts.swap(Sites);
+    Chosen.push_back(&C);
+  }
+
+  // Runs left in place count towards outlining them later; the parts of runs
+  // that were outlined do not.
+  for (StringMap<Candidate>::iterator I = Found.begin(), E = Found.end();
+       I != E; ++I) {
+    Candidate &C = I->getValue();
+    Sequence &S = C.Seq->getValue();
+    if (S.Body)
+      continue;
+    for (unsigned s = 0, se = C.Starts.size(); s != se; ++s)
+      if (isFree(C.Starts[s], C.Length, Taken))
+        ++S.Seen;
+  }
+
+  for (unsigned i = 0, e = Chosen.size(); i != e; ++i) {
+    Candidate &C = *Chosen[i];
+    Sequence &S = C.Seq->getValue();
+    if (!S.Body) {
+      S.Body = createBody(MF, C);
+      DEBUG(dbgs() << "Rigel: outlined " << C.Length << " instructions as "
+                   << *S.Body << " from " << F->getName() << "\n");
+    }
+    for (unsigned s = 0, se = C.Starts.size(); s != se; ++s)
+      replace(C.Starts[s], C);
+  }
+  return !Chosen.empty();
+}
+
+/// createRigelOutlinerPass - Returns a pass that replaces repeated
+/// instruction sequences with calls to a shared copy.
+FunctionPass *llvm::createRigelOutlinerPass() {
+  return new RigelOutliner();
+}
@@ -0,0 +1,194 @@
+//===-- RigelSpinWait.cpp - Back off in spin-wait loops ---------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Recognizes loops that do nothing but poll a word of memory,
+//
+//   while (*(volatile int *)flag == x) ;
+//
+// and rewrites them to poll with g.ldw and sleep between polls, doubling the
+// sleep each time up to a cap.  With hundreds of cores spinning on one line
+// of the global cache, the polling traffic otherwise slows down the very core
+// that is going to release them.
+//
+// Only single-block loops made of a volatile i32 load from a loop-invariant
+// address, a compare against a loop-invariant value and the back-branch are
+// touched, so there is no other work in the loop for the sleep to delay.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "rigel-spinwait"
+#include "Rigel.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Intrinsics.h"
+#include "llvm/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+STATISTIC(NumSpinLoops, "Number of spin-wait loops given backoff");
+
+static cl::opt<unsigned>
+SpinMinBackoff("rigel-spin-min-backoff", cl::Hidden,
+               cl::desc("Initial sleep between spin-wait polls, in cycles "
+                        "(default=16)"),
+               cl::init(16));
+
+static cl::opt<unsigned>
+SpinMaxBackoff("rigel-spin-max-backoff", cl::Hidden,
+               cl::desc("Largest sleep between spin-wait polls, in cycles "
+                        "(default=1024)"),
+               cl::init(1024));
+
+namespace {
+  class RigelSpinWait : public FunctionPass {
+  public:
+    static char ID;
+    RigelSpinWait() : FunctionPass(ID) {}
+
+    virtual bool runOnFunction(Function &F);
+
+    virtual const char *getPassName() const {
+      return "Rigel spin-wait backoff";
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<LoopInfo>();
+    }
+
+  private:
+    LoadInst *matchSpinLoop(Loop *L);
+    void rewriteSpinLoop(Loop *L, LoadInst *Poll);
+  };
+  char RigelSpinWait::ID = 0;
+}
+
+static bool isLoopInvariant(Loop *L, Value *V) {
+  Instruction *I = dyn_cast<Instruction>(V);
+  return !I || !L->contains(I->getParent());
+}
+
+/// matchSpinLoop - If L is a pure polling loop, return its load.
+LoadInst *RigelSpinWait::matchSpinLoop(Loop *L) {
+  if (L->getBlocks().size() != 1)
+    return 0;
+  BasicBlock *BB = L->getHeader();
+
+  BranchInst *Br = dyn_cast<BranchInst>(BB->getTerminator());
+  if (!Br || !Br->isConditional())
+    return 0;
+  ICmpInst *Cmp = dyn_cast<ICmpInst>(Br->getCondition());
+  if (!Cmp || !Cmp->isEquality() || !Cmp->hasOneUse())
+    return 0;
+
+  LoadInst *Poll = dyn_cast<LoadInst>(Cmp->getOperand(0));
+  Value *Other = Cmp->getOperand(1);
+  if (!Poll) {
+    Poll = dyn_cast<LoadInst>(Cmp->getOperand(1));
+    Other = Cmp->getOperand(0);
+  }
+  if (!Poll || !Poll->isVolatile() || !Poll->hasOneUse() ||
+      !Poll->getType()->isIntegerTy(32) ||
+      !isLoopInvariant(L, Poll->getPointerOperand()) ||
+      !isLoopInvariant(L, Other))
+    return 0;
+
+  // Nothing else may happen in the loop.
+  if (BB->size() != 3)
+    return 0;
+  return Poll;
+}
+
+/// rewriteSpinLoop - Turn
+///   spin:    %v = volatile load %p ; cmp ; br %c, spin, exit
+/// into
+///   spin:    %delay = phi [min, preds], [%next, backoff]
+///            %v = g.ldw %p ; cmp ; br %c, backoff, exit
+///   backoff: sleep %delay ; %next = min(%delay * 2, max) ; br spin
+void RigelSpinWait::rewriteSpinLoop(Loop *L, LoadInst *Poll) {
+  BasicBlock *BB = L->getHeader();
+  Function *F = BB->getParent();
+  Module *M = F->getParent();
+  LLVMContext &Ctx = F->getContext();
+  const Type *Int32Ty = Type::getInt32Ty(Ctx);
+
+  // Poll with g.ldw.
+  Value *Ptr = new BitCastInst(Poll->getPointerOperand(),
+                               Type::getInt8PtrTy(Ctx), "spin.ptr", Poll);
+  Function *GLdW = Intrinsic::getDeclaration(M, Intrinsic::rigel_gldw);
+  CallInst *NewPoll = CallInst::Create(GLdW, Ptr, Poll->getName(), Poll);
+  Poll->replaceAllUsesWith(NewPoll);
+  Poll->eraseFromParent();
+
+  // Sleep on the way around the back edge.
+  SmallVector<BasicBlock*, 4> Preds;
+  for (pred_iterator PI = pred_begin(BB), E = pred_end(BB); PI != E; ++PI)
+    if (*PI != BB)
+      Preds.push_back(*PI);
+
+  BasicBlock *Backoff = BasicBlock::Create(Ctx, "spin.backoff", F,
+                                           llvm::next(Function::iterator(BB)));
+  PHINode *Delay = PHINode::Create(Int32Ty, "spin.delay", BB->begin());
+  for (unsigned i = 0, e = Preds.size(); i != e; ++i)
+    Delay->addIncoming(ConstantInt::get(Int32Ty, SpinMinBackoff), Preds[i]);
+
+  Function *Sleep = Intrinsic::getDeclaration(M, Intrinsic::rigel_sleep);
+  Value *SleepArgs[] = { Delay, ConstantInt::get(Int32Ty, 0) };
+  CallInst::Create(Sleep, SleepArgs, SleepArgs + 2, "", Backoff);
+  Value *Max = ConstantInt::get(Int32Ty, SpinMaxBackoff);
+  Value *Dbl = BinaryOperator::CreateShl(Delay, ConstantInt::get(Int32Ty, 1),
+                                         "spin.dbl", Backoff);
+  Value *TooBig = new ICmpInst(*Backoff, ICmpInst::ICMP_UGT, Dbl, Max,
+                               "spin.cap");
+  Value *Next = SelectInst::Create(TooBig, Max, Dbl, "spin.next", Backoff);
+  BranchInst::Create(BB, Backoff);
+  Delay->addIncoming(Next, Backoff);
+
+  BranchInst *Br = cast<BranchInst>(BB->getTerminator());
+  for (unsigned i = 0, e = Br->getNumSuccessors(); i != e; ++i)
+    if (Br->getSuccessor(i) == BB)
+      Br->setSuccessor(i, Backoff);
+
+  DEBUG(dbgs() << "Rigel spin-wait backoff in " << F->getName() << ": "
+               << BB->getName() << "\n");
+}
+
+bool RigelSpinWait::runOnFunction(Function &F) {
+  LoopInfo &LI = getAnalysis<LoopInfo>();
+
+  // Spin loops are innermost; collect them all before changing the CFG.
+  SmallVector<Loop*, 8> Worklist(LI.begin(), LI.end());
+  SmallVector<std::pair<Loop*, LoadInst*>, 4> SpinLoops;
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.pop_back_val();
+    Worklist.append(L->begin(), L->end());
+    if (LoadInst *Poll = matchSpinLoop(L))
+      SpinLoops.push_back(std::make_pair(L, Poll));
+  }
+
+  for (unsigned i = 0, e = SpinLoops.size(); i != e; ++i) {
+    rewriteSpinLoop(SpinLoops[i].first, SpinLoops[i].second);
+    ++NumSpinLoops;
+  }
+  return !SpinLoops.empty();
+}
+
+/// createRigelSpinWaitPass - Returns a pass that adds g.ldw polling and
+/// sleep-based backoff to spin-wait loops.
+FunctionPass *llvm::createRigelSpinWaitPass() {
+  return new RigelSpinWait();
+}
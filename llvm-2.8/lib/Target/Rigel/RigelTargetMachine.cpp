@@ -47,6 +47,22 @@ RigelTargetMachine(const Target &T, const std::string &TT, const std::string &FS
   }
 }
 
+// Farm '#pragma rigel parallel for' loops out to the task queue, outline
+// code the edge profile says never runs, give spin-wait loops g.ldw polling
+// and sleep backoff, then raise load/store alignments where the address is
+// provably aligned, so RigelISelLowering can avoid the __unaligned* libcalls.
+bool RigelTargetMachine::
+addPreISel(PassManagerBase &PM, CodeGenOpt::Level OptLevel)
+{
+  if (OptLevel != CodeGenOpt::None) {
+    PM.add(createRigelLoopParallelizePass(*this));
+    PM.add(createRigelHotColdSplitPass());
+    PM.add(createRigelSpinWaitPass());
+    PM.add(createRigelAlignmentInferencePass(*this));
+  }
+  return false;
+}
+
 // Install an instruction selector pass using 
 // the ISelDag to gen Rigel code.
 bool RigelTargetMachine::
@@ -56,12 +72,27 @@ addInstSelector(PassManagerBase &PM, CodeGenOpt::Level OptLevel)
   return false;
 }
 
+// Software pipeline inner loops while the code is still in SSA form.
+bool RigelTargetMachine::
+addPreRegAlloc(PassManagerBase &PM, CodeGenOpt::Level OptLevel)
+{
+  if (OptLevel != CodeGenOpt::None)
+    PM.add(createRigelModuloSchedulePass());
+  return false;
+}
+
 // Implemented by targets that want to run passes immediately before 
 // machine code is emitted. return true if -print-machineinstrs should 
 // print out the code after the passes.
 bool RigelTargetMachine::
 addPreEmitPass(PassManagerBase &PM, CodeGenOpt::Level OptLevel) 
 {
+  // Lay blocks out from the edge profile, if there is one, then share
+  // repeated code once the layout is final.
+  if (OptLevel != CodeGenOpt::None) {
+    PM.add(createRigelBlockPlacementPass());
+    PM.add(createRigelOutlinerPass());
+  }
   return true;
 }
 
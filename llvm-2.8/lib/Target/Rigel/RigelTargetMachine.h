@@ -54,7 +54,9 @@ namespace llvm {
     virtual const InstrItineraryData getInstrItineraryData() const {  return InstrItins; }
     static unsigned getModuleMatchQuality(const Module &M);
     // Pass Pipeline Configuration
+    virtual bool addPreISel(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
     virtual bool addInstSelector(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
+    virtual bool addPreRegAlloc(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
     virtual bool addPreEmitPass(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
 		virtual bool addPreSched2(PassManagerBase &PM, CodeGenOpt::Level OptLevel);
   };
@@ -8,11 +8,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "RigelTargetObjectFile.h"
+#include "Rigel.h"
 #include "RigelSubtarget.h"
 #include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
 #include "llvm/GlobalVariable.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCSectionELF.h"
+#include "llvm/MC/MCSymbol.h"
+#include "llvm/Target/Mangler.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Support/CommandLine.h"
@@ -35,7 +40,20 @@ void RigelTargetObjectFile::Initialize(MCContext &Ctx, const TargetMachine &TM){
     getContext().getELFSection(".sbss", MCSectionELF::SHT_NOBITS,
                                MCSectionELF::SHF_WRITE |MCSectionELF::SHF_ALLOC,
                                SectionKind::getBSS());
-  
+
+  // rigelld's elf32elrigel emulation gathers these ahead of the rest of
+  // .text.
+  TextHotSection =
+    getContext().getELFSection(".text.hot", MCSectionELF::SHT_PROGBITS,
+                               MCSectionELF::SHF_EXECINSTR |
+                               MCSectionELF::SHF_ALLOC,
+                               SectionKind::getText());
+
+  TextUnlikelySection =
+    getContext().getELFSection(".text.unlikely", MCSectionELF::SHT_PROGBITS,
+                               MCSectionELF::SHF_EXECINSTR |
+                               MCSectionELF::SHF_ALLOC,
+                               SectionKind::getText());
 }
 
 // A address must be loaded from a small section if its size is less than the 
@@ -77,18 +95,72 @@ IsGlobalInSmallSection(const GlobalValue *GV, const TargetMachine &TM,
   return IsInSmallSection(TM.getTargetData()->getTypeAllocSize(Ty));
 }
 
+/// SelectSectionForFunction - Return .text.hot or .text.unlikely for a
+/// function the edge profile says was or was not called, or null if it has no
+/// profile data.  With -ffunction-sections each function still gets a section
+/// of its own, named .text.hot.<name> or .text.unlikely.<name>.
+const MCSection *RigelTargetObjectFile::
+SelectSectionForFunction(const Function *F, Mangler *Mang,
+                         const TargetMachine &TM) const {
+  uint64_t EntryCount;
+  if (F->isDeclaration() || F->isWeakForLinker() ||
+      !getRigelProfileCount(&F->getEntryBlock(), EntryCount))
+    return 0;
+
+  if (!TM.getFunctionSections())
+    return EntryCount ? TextHotSection : TextUnlikelySection;
+
+  StringRef Prefix = EntryCount ? ".text.hot." : ".text.unlikely.";
+  SmallString<128> Name(Prefix.begin(), Prefix.end());
+  MCSymbol *Sym = Mang->getSymbol(F);
+  Name.append(Sym->getName().begin(), Sym->getName().end());
+  return getContext().getELFSection(Name.str(), MCSectionELF::SHT_PROGBITS,
+                                    MCSectionELF::SHF_EXECINSTR |
+                                    MCSectionELF::SHF_ALLOC,
+                                    SectionKind::getText());
+}
+
+const MCSection *RigelTargetObjectFile::
+getDataSectionFor(const GlobalValue *GV, StringRef Prefix,
+                  const MCSection *Section, Mangler *Mang,
+                  const TargetMachine &TM) const {
+  if (!TM.getDataSections())
+    return Section;
+
+  const MCSectionELF *ELFSection = cast<MCSectionELF>(Section);
+  SmallString<128> Name(Prefix.begin(), Prefix.end());
+  MCSymbol *Sym = Mang->getSymbol(GV);
+  Name.append(Sym->getName().begin(), Sym->getName().end());
+  return getContext().getELFSection(Name.str(), ELFSection->getType(),
+                                    ELFSection->getFlags(),
+                                    ELFSection->getKind());
+}
+
 const MCSection *RigelTargetObjectFile::
 SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
                        Mangler *Mang, const TargetMachine &TM) const {
   // TODO: Could also support "weak" symbols as well with ".gnu.linkonce.s.*"
   // sections?
+
+  // Profiled functions go to the hot or the unlikely text section.
+  if (const Function *F = dyn_cast<Function>(GV))
+    if (const MCSection *S = SelectSectionForFunction(F, Mang, TM))
+      return S;
   
-  // Handle Small Section classification here.
+  // Handle Small Section classification here.  With -fdata-sections these
+  // become .sbss.<name> and .sdata.<name>, which rigelld's linker script
+  // still gathers into .sbss and .sdata.
   if (Kind.isBSS() && IsGlobalInSmallSection(GV, TM, Kind))
-    return SmallBSSSection;
+    return getDataSectionFor(GV, ".sbss.", SmallBSSSection, Mang, TM);
   if (Kind.isDataNoRel() && IsGlobalInSmallSection(GV, TM, Kind))
-    return SmallDataSection;
-  
+    return getDataSectionFor(GV, ".sdata.", SmallDataSection, Mang, TM);
+
+  // TargetLoweringObjectFileELF keeps zero-initialized globals in .bss even
+  // with -fdata-sections.  Static ones never get here; they are emitted with
+  // .local/.comm.
+  if (Kind.isBSS() && !GV->isWeakForLinker())
+    return getDataSectionFor(GV, ".bss.", BSSSection, Mang, TM);
+
   // Otherwise, we work the same as ELF.
   return TargetLoweringObjectFileELF::SelectSectionForGlobal(GV, Kind, Mang,TM);
 }
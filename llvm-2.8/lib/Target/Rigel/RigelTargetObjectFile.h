@@ -13,10 +13,23 @@
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 
 namespace llvm {
+  class Function;
 
   class RigelTargetObjectFile : public TargetLoweringObjectFileELF {
     const MCSection *SmallDataSection;
     const MCSection *SmallBSSSection;
+    const MCSection *TextHotSection;
+    const MCSection *TextUnlikelySection;
+
+    /// getDataSectionFor - With -fdata-sections, return a section of the
+    /// same type as Section named Prefix followed by GV's symbol, so that
+    /// rigelld --gc-sections can drop GV on its own.  Otherwise return
+    /// Section.
+    const MCSection *getDataSectionFor(const GlobalValue *GV,
+                                       StringRef Prefix,
+                                       const MCSection *Section,
+                                       Mangler *Mang,
+                                       const TargetMachine &TM) const;
   public:
     
     void Initialize(MCContext &Ctx, const TargetMachine &TM);
@@ -28,6 +41,13 @@ namespace llvm {
                                 const TargetMachine &TM, SectionKind Kind)const;
     bool IsGlobalInSmallSection(const GlobalValue *GV,
                                 const TargetMachine &TM) const;  
+
+    /// SelectSectionForFunction - Return .text.hot or .text.unlikely for a
+    /// function the edge profile says was or was not called, or null if it
+    /// has no profile data.
+    const MCSection *SelectSectionForFunction(const Function *F,
+                                              Mangler *Mang,
+                                              const TargetMachine &TM) const;
     
     const MCSection *SelectSectionForGlobal(const GlobalValue *GV,
                                             SectionKind Kind,
@@ -0,0 +1,149 @@
+//===- ProfileMetadataLoader.cpp - Attach edge profile counts to the IR ---===//
+//
+//                      The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass reads an edge profile written by a program that was instrumented
+// with -insert-edge-profiling and records the counts on the terminators of the
+// module as !prof metadata:
+//
+//   !{i64 <block count>, i64 <count of edge to successor 0>, ...}
+//
+// Unlike the ProfileInfo analysis, metadata survives being handed from the
+// optimizer to a separate code generator pass manager (as clang and llc do) and
+// being written out as bitcode, so targets can consume it for block layout and
+// section placement.  The module must have the same CFG that was instrumented,
+// i.e. it must come out of the same pipeline the instrumented build ran up to
+// the point where the edge profiler was inserted.
+//
+//===----------------------------------------------------------------------===//
+#define DEBUG_TYPE "profile-metadata-loader"
+#include "llvm/Constants.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Metadata.h"
+#include "llvm/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Analysis/ProfileInfoLoader.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Instrumentation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include <cstdio>
+using namespace llvm;
+
+STATISTIC(NumAnnotated, "The # of terminators annotated with profile counts");
+
+static cl::opt<std::string>
+ProfileMetadataFile("profile-metadata-file", cl::init("llvmprof.out"),
+                    cl::value_desc("filename"),
+                    cl::desc("Edge profile file read by "
+                             "-profile-metadata-loader"));
+
+namespace {
+  class ProfileMetadataLoader : public ModulePass {
+    std::string Filename;
+    bool runOnModule(Module &M);
+  public:
+    static char ID; // Pass identification, replacement for typeid
+    explicit ProfileMetadataLoader(const std::string &File = "")
+      : ModulePass(ID), Filename(File) {
+      if (Filename.empty())
+        Filename = ProfileMetadataFile;
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesCFG();
+    }
+
+    virtual const char *getPassName() const {
+      return "Profile Metadata Loader";
+    }
+  };
+}
+
+char ProfileMetadataLoader::ID = 0;
+INITIALIZE_PASS(ProfileMetadataLoader, "profile-metadata-loader",
+                "Attach an edge profile to the IR as !prof metadata",
+                false, false);
+
+ModulePass *llvm::createProfileMetadataLoaderPass(const std::string &File) {
+  return new ProfileMetadataLoader(File);
+}
+
+/// getCount - Return the next raw counter, treating counters the runtime never
+/// wrote as zero.
+static uint64_t getCount(const std::vector<unsigned> &Counts, unsigned &Idx) {
+  unsigned C = Counts[Idx++];
+  return C == ProfileInfoLoader::Uncounted ? 0 : C;
+}
+
+bool ProfileMetadataLoader::runOnModule(Module &M) {
+  // ProfileInfoLoader exits on a missing file; a build without a profile
+  // should just go ahead without one.
+  if (FILE *F = fopen(Filename.c_str(), "rb")) {
+    fclose(F);
+  } else {
+    errs() << "WARNING: profile file '" << Filename
+           << "' not found, no profile data attached\n";
+    return false;
+  }
+
+  ProfileInfoLoader PIL("profile-metadata-loader", Filename, M);
+  const std::vector<unsigned> &Counts = PIL.getRawEdgeCounts();
+
+  // The counters are laid out the way EdgeProfiler numbers the edges: the
+  // (0,entry) edge of each defined function followed by every successor edge
+  // of each of its blocks.
+  unsigned NumEdges = 0;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration()) continue;
+    ++NumEdges;
+    for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+      NumEdges += BB->getTerminator()->getNumSuccessors();
+  }
+  if (Counts.size() != NumEdges) {
+    errs() << "WARNING: profile file '" << Filename << "' has "
+           << Counts.size() << " edge counts but the module has " << NumEdges
+           << " edges, ignoring it\n";
+    return false;
+  }
+
+  LLVMContext &Ctx = M.getContext();
+  unsigned ProfKind = Ctx.getMDKindID("prof");
+  const Type *Int64Ty = Type::getInt64Ty(Ctx);
+
+  unsigned Idx = 0;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration()) continue;
+
+    // A block runs as often as its incoming edges do, so collect those first;
+    // blocks without successors (returns) have nothing else to go on.
+    DenseMap<BasicBlock*, uint64_t> InCounts;
+    InCounts[&F->getEntryBlock()] = getCount(Counts, Idx);
+    unsigned First = Idx;
+    for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+      TerminatorInst *TI = BB->getTerminator();
+      for (unsigned s = 0, e = TI->getNumSuccessors(); s != e; ++s)
+        InCounts[TI->getSuccessor(s)] += getCount(Counts, Idx);
+    }
+
+    Idx = First;
+    for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+      TerminatorInst *TI = BB->getTerminator();
+      SmallVector<Value*, 4> Ops;
+      Ops.push_back(ConstantInt::get(Int64Ty, InCounts[BB]));
+      for (unsigned s = 0, e = TI->getNumSuccessors(); s != e; ++s)
+        Ops.push_back(ConstantInt::get(Int64Ty, getCount(Counts, Idx)));
+      TI->setMetadata(ProfKind, MDNode::get(Ctx, Ops.data(), Ops.size()));
+      ++NumAnnotated;
+    }
+  }
+  return true;
+}
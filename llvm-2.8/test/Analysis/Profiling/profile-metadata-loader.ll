@@ -0,0 +1,33 @@
+; Test attaching an edge profile to the IR as !prof metadata.
+; The profile is an EdgeInfo packet (4) with the five edge counts of @f:
+; (0,entry) 10, entry->a 3, entry->b 7, a->exit 3 and b->exit 7.
+; RUN: printf {\004\000\000\000\005\000\000\000\012\000\000\000\003\000\000\000\007\000\000\000\003\000\000\000\007\000\000\000} > %t.prof
+; RUN: opt < %s -profile-metadata-loader -profile-metadata-file=%t.prof -S | FileCheck %s
+
+; A missing profile is not an error.
+; RUN: opt < %s -profile-metadata-loader -profile-metadata-file=%t.missing -S 2>&1 | FileCheck %s -check-prefix=MISSING
+; MISSING: WARNING: profile file '{{.*}}.missing' not found
+; MISSING: define void @f
+
+define void @f(i1 %c) {
+entry:
+; CHECK: br i1 %c, label %a, label %b, !prof [[ENTRY:![0-9]+]]
+  br i1 %c, label %a, label %b
+
+a:
+; CHECK: br label %exit, !prof [[A:![0-9]+]]
+  br label %exit
+
+b:
+; CHECK: br label %exit, !prof [[B:![0-9]+]]
+  br label %exit
+
+exit:
+; CHECK: ret void, !prof [[EXIT:![0-9]+]]
+  ret void
+}
+
+; CHECK: [[ENTRY]] = metadata !{i64 10, i64 3, i64 7}
+; CHECK: [[A]] = metadata !{i64 3, i64 3}
+; CHECK: [[B]] = metadata !{i64 7, i64 7}
+; CHECK: [[EXIT]] = metadata !{i64 10}
@@ -0,0 +1,73 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; Loads and stores whose address is provably word aligned use ldw/stw even
+; when the frontend only promised byte alignment, instead of going through
+; the __unaligned* libcalls.
+
+%struct.P = type <{ i8, i32, i16 }>
+
+@g = global %struct.P zeroinitializer, align 4
+@w = weak global %struct.P zeroinitializer, align 4
+
+; The field straddles two words of an aligned global, so it is put together
+; from two ldws.
+define i32 @field() nounwind {
+entry:
+; CHECK: field:
+; CHECK-NOT: __unaligned
+; CHECK: ldw
+; CHECK: ldw
+; CHECK: jmpr $ra
+  %p = getelementptr %struct.P* @g, i32 0, i32 1
+  %v = load i32* %p, align 1
+  ret i32 %v
+}
+
+; A weak definition may be replaced by a less aligned one.
+define i32 @weakfield() nounwind {
+entry:
+; CHECK: weakfield:
+; CHECK: __unalignedldi32
+  %p = getelementptr %struct.P* @w, i32 0, i32 1
+  %v = load i32* %p, align 1
+  ret i32 %v
+}
+
+define i32 @arg(i32* align 4 %q) nounwind {
+entry:
+; CHECK: arg:
+; CHECK-NOT: __unaligned
+; CHECK: ldw $2, $4, 0
+  %v = load i32* %q, align 1
+  ret i32 %v
+}
+
+define i32 @unknown(i32* %q) nounwind {
+entry:
+; CHECK: unknown:
+; CHECK: __unalignedldi32
+  %v = load i32* %q, align 1
+  ret i32 %v
+}
+
+define void @stack(i32 %x) nounwind {
+entry:
+; CHECK: stack:
+; CHECK-NOT: __unaligned
+; CHECK: stw $4, $sp,
+; CHECK: jmpr $ra
+  %s = alloca [4 x i16], align 4
+  %p = getelementptr [4 x i16]* %s, i32 0, i32 2
+  %q = bitcast i16* %p to i32*
+  volatile store i32 %x, i32* %q, align 1
+  ret void
+}
+
+define i16 @half() nounwind {
+entry:
+; CHECK: half:
+; CHECK-NOT: __unalignedldi16
+; CHECK: jmpr $ra
+  %p = getelementptr %struct.P* @g, i32 0, i32 2
+  %v = load i16* %p, align 1
+  ret i16 %v
+}
@@ -0,0 +1,17 @@
+; Immediates that don't fit their constraint are rejected.
+; RUN: sed -e s/CONSTRAINT/I/ -e s/VALUE/32768/ %s | not llc -march=rigel 2>&1 | FileCheck %s -check-prefix=I
+; RUN: sed -e s/CONSTRAINT/I/ -e s/VALUE/-32769/ %s | not llc -march=rigel 2>&1 | FileCheck %s -check-prefix=I
+; RUN: sed -e s/CONSTRAINT/K/ -e s/VALUE/65536/ %s | not llc -march=rigel 2>&1 | FileCheck %s -check-prefix=K
+; RUN: sed -e s/CONSTRAINT/K/ -e s/VALUE/-1/ %s | not llc -march=rigel 2>&1 | FileCheck %s -check-prefix=K
+; RUN: sed -e s/CONSTRAINT/L/ -e s/VALUE/32/ %s | not llc -march=rigel 2>&1 | FileCheck %s -check-prefix=L
+; RUN: sed -e s/CONSTRAINT/L/ -e s/VALUE/-1/ %s | not llc -march=rigel 2>&1 | FileCheck %s -check-prefix=L
+
+; I: Invalid operand for inline asm constraint 'I'
+; K: Invalid operand for inline asm constraint 'K'
+; L: Invalid operand for inline asm constraint 'L'
+
+define i32 @f(i32 %a) nounwind {
+entry:
+  %0 = tail call i32 asm "op $0, $1, $2", "=r,r,CONSTRAINT"(i32 %a, i32 VALUE) nounwind
+  ret i32 %0
+}
@@ -0,0 +1,41 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; Inline asm constraints: 'f' is a register, I/K/L are immediates that
+; print straight into the instruction.
+
+; CHECK: fadd:
+; CHECK: fadd ${{[0-9]+}}, ${{[0-9]+}}, ${{[0-9]+}}
+define float @fadd(float %a, float %b) nounwind {
+entry:
+  %0 = tail call float asm "fadd $0, $1, $2", "=f,f,f"(float %a, float %b) nounwind
+  ret float %0
+}
+
+; CHECK: imm_I:
+; CHECK: addi ${{[0-9]+}}, ${{[0-9]+}}, 32767
+; CHECK: addi ${{[0-9]+}}, ${{[0-9]+}}, -32768
+define i32 @imm_I(i32 %a) nounwind {
+entry:
+  %0 = tail call i32 asm "addi $0, $1, $2", "=r,r,I"(i32 %a, i32 32767) nounwind
+  %1 = tail call i32 asm "addi $0, $1, $2", "=r,r,I"(i32 %0, i32 -32768) nounwind
+  ret i32 %1
+}
+
+; CHECK: imm_K:
+; CHECK: ori ${{[0-9]+}}, ${{[0-9]+}}, 0
+; CHECK: ori ${{[0-9]+}}, ${{[0-9]+}}, 65535
+define i32 @imm_K(i32 %a) nounwind {
+entry:
+  %0 = tail call i32 asm "ori $0, $1, $2", "=r,r,K"(i32 %a, i32 0) nounwind
+  %1 = tail call i32 asm "ori $0, $1, $2", "=r,r,K"(i32 %0, i32 65535) nounwind
+  ret i32 %1
+}
+
+; CHECK: imm_L:
+; CHECK: slli ${{[0-9]+}}, ${{[0-9]+}}, 0
+; CHECK: slli ${{[0-9]+}}, ${{[0-9]+}}, 31
+define i32 @imm_L(i32 %a) nounwind {
+entry:
+  %0 = tail call i32 asm "slli $0, $1, $2", "=r,r,L"(i32 %a, i32 0) nounwind
+  %1 = tail call i32 asm "slli $0, $1, $2", "=r,r,L"(i32 %0, i32 31) nounwind
+  ret i32 %1
+}
@@ -0,0 +1,30 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; The fetch-and-op atomics are three-register instructions: old value,
+; address, operand.
+
+define i32 @add(i32* %p, i32 %v) nounwind {
+entry:
+; CHECK: add:
+; CHECK: atom.addu	${{[0-9]+}}, $4, $5
+  %r = tail call i32 @llvm.atomic.load.add.i32.p0i32(i32* %p, i32 %v)
+  ret i32 %r
+}
+
+define i32 @max(i32* %p, i32 %v) nounwind {
+entry:
+; CHECK: max:
+; CHECK: atom.max	${{[0-9]+}}, $4, $5
+  %r = tail call i32 @llvm.atomic.load.max.i32.p0i32(i32* %p, i32 %v)
+  ret i32 %r
+}
+
+define i32 @inc(i32* %p) nounwind {
+entry:
+; CHECK: inc:
+; CHECK: atom.inc	${{[0-9]+}}, $4, 0
+  %r = tail call i32 @llvm.atomic.load.add.i32.p0i32(i32* %p, i32 1)
+  ret i32 %r
+}
+
+declare i32 @llvm.atomic.load.add.i32.p0i32(i32* nocapture, i32) nounwind
+declare i32 @llvm.atomic.load.max.i32.p0i32(i32* nocapture, i32) nounwind
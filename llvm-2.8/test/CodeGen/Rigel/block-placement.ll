@@ -0,0 +1,32 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+
+; The training run took the branch to %rare once in a hundred times, so the
+; placement puts %common straight after the entry block, where it is reached
+; by falling through, and moves %rare out of the way.
+
+declare void @g(i32)
+
+; CHECK: f:
+; CHECK: %common
+; CHECK: %rare
+; CHECK: .end f
+define void @f(i1 %c) {
+entry:
+  br i1 %c, label %rare, label %common, !prof !0
+
+rare:
+  call void @g(i32 1)
+  br label %exit, !prof !1
+
+common:
+  call void @g(i32 2)
+  br label %exit, !prof !2
+
+exit:
+  ret void, !prof !3
+}
+
+!0 = metadata !{i64 100, i64 1, i64 99}
+!1 = metadata !{i64 1, i64 1}
+!2 = metadata !{i64 99, i64 99}
+!3 = metadata !{i64 100}
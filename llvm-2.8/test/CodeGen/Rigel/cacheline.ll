@@ -0,0 +1,38 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; line.wb/inv/flush take a single address register, so offsets are added
+; beforehand.
+
+define void @inv(i32* %p) nounwind {
+entry:
+; CHECK: inv:
+; CHECK: line.inv $4{{$}}
+  %p0 = bitcast i32* %p to i8*
+  tail call void @llvm.rigel.line.inv(i8* %p0)
+  ret void
+}
+
+define void @wb(i32* %p) nounwind {
+entry:
+; CHECK: wb:
+; CHECK: addi [[R:\$[0-9]+]], $4, 12
+; CHECK: line.wb [[R]]{{$}}
+  %q = getelementptr inbounds i32* %p, i32 3
+  %q0 = bitcast i32* %q to i8*
+  tail call void @llvm.rigel.line.wb(i8* %q0)
+  ret void
+}
+
+define void @flush(i32* %p) nounwind {
+entry:
+; CHECK: flush:
+; CHECK: add [[R:\$[0-9]+]], $4,
+; CHECK: line.flush [[R]]{{$}}
+  %r = getelementptr inbounds i32* %p, i32 100000
+  %r0 = bitcast i32* %r to i8*
+  tail call void @llvm.rigel.line.flush(i8* %r0)
+  ret void
+}
+
+declare void @llvm.rigel.line.wb(i8*) nounwind
+declare void @llvm.rigel.line.inv(i8*) nounwind
+declare void @llvm.rigel.line.flush(i8*) nounwind
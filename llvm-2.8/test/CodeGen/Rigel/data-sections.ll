@@ -0,0 +1,29 @@
+; RUN: llc < %s -march=rigel -fdata-sections | FileCheck %s
+; RUN: llc < %s -march=rigel | FileCheck %s -check-prefix=NOSEC
+; With -fdata-sections each global gets a section of its own, so that
+; ld --gc-sections can drop the unused ones.  Small objects keep to the
+; small data sections.
+
+; CHECK: .section .sdata.small,"aw",@progbits
+; CHECK: small:
+; NOSEC-NOT: .sdata.small
+; NOSEC: small:
+@small = global i32 3
+
+; CHECK: .section .sbss.zero,"aw",@nobits
+; CHECK: zero:
+; NOSEC-NOT: .sbss.zero
+; NOSEC: zero:
+@zero = global i32 0
+
+; CHECK: .section .bss.big,"aw",@nobits
+; CHECK: big:
+; NOSEC-NOT: .bss.big
+; NOSEC: big:
+@big = global [100 x i32] zeroinitializer
+
+; CHECK-NOT: .sdata.w
+; CHECK-NOT: .sbss.w
+; CHECK-NOT: .bss.w
+; CHECK: w:
+@w = weak global [100 x i32] zeroinitializer
@@ -0,0 +1,38 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; f32 constants are built in a register with mvui/ori rather than loaded
+; from the constant pool.
+
+; CHECK-NOT: .rodata.cst4
+
+define float @pi() nounwind {
+entry:
+; CHECK: pi:
+; CHECK: mvui $2, 16457
+; CHECK-NEXT: ori $2, $2, 4059
+  ret float 0x400921FB60000000
+}
+
+; The low half of 1.0 is zero, so no ori is needed.
+define float @one() nounwind {
+entry:
+; CHECK: one:
+; CHECK: mvui $2, 16256
+; CHECK-NEXT: jmpr $ra
+  ret float 1.0
+}
+
+define float @zero() nounwind {
+entry:
+; CHECK: zero:
+; CHECK: addi $2, $zero, 0
+  ret float 0.0
+}
+
+define float @scale(float %x) nounwind {
+entry:
+; CHECK: scale:
+; CHECK: mvui [[C:\$[0-9]+]], 16416
+; CHECK: fmul ${{[0-9]+}}, ${{[0-9]+}}, [[C]]
+  %r = fmul float %x, 2.5
+  ret float %r
+}
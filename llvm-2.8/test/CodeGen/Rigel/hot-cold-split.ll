@@ -0,0 +1,36 @@
+; RUN: llc < %s -march=rigel -rigel-cold-split-min-size=4 | FileCheck %s
+; RUN: llc < %s -march=rigel | FileCheck %s -check-prefix=SMALL
+
+; The training run never took the branch to %cold, so the block is outlined
+; into f_cold, which goes to .text.unlikely while f stays in .text.hot.
+
+; CHECK: .section .text.hot
+; CHECK: f:
+; CHECK: f_cold
+; CHECK: .end f
+; CHECK: .section .text.unlikely
+; CHECK: f_cold:
+
+; Regions smaller than -rigel-cold-split-min-size are left alone.
+; SMALL: f:
+; SMALL-NOT: f_cold
+; SMALL: .end f
+define void @f(i32 %x, i32* %p) {
+entry:
+  %c = icmp eq i32 %x, 0
+  br i1 %c, label %cold, label %exit, !prof !0
+
+cold:
+  volatile store i32 1, i32* %p
+  volatile store i32 2, i32* %p
+  volatile store i32 3, i32* %p
+  volatile store i32 4, i32* %p
+  br label %exit, !prof !1
+
+exit:
+  ret void, !prof !2
+}
+
+!0 = metadata !{i64 100, i64 0, i64 100}
+!1 = metadata !{i64 0, i64 0}
+!2 = metadata !{i64 100}
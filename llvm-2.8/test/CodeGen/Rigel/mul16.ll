@@ -0,0 +1,89 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; Multiplies whose operands fit in 16 bits use mul16, the high word of a
+; 32x32 product is built from mul16 partial products, and cheap constant
+; multiplies become shifts and adds.
+
+define i32 @narrow(i16 %a, i16 %b) nounwind {
+entry:
+; CHECK: narrow:
+; CHECK: mul16 $2,
+; CHECK-NOT: mul $
+; CHECK: jmpr $ra
+  %x = zext i16 %a to i32
+  %y = zext i16 %b to i32
+  %m = mul i32 %x, %y
+  ret i32 %m
+}
+
+define i32 @wide(i32 %a, i32 %b) nounwind {
+entry:
+; CHECK: wide:
+; CHECK: mul $2, $4, $5
+  %m = mul i32 %a, %b
+  ret i32 %m
+}
+
+define i32 @mulhu(i32 %a, i32 %b) nounwind {
+entry:
+; CHECK: mulhu:
+; CHECK: mul16
+; CHECK: mul16
+; CHECK: mul16
+; CHECK: mul16
+; CHECK-NOT: jal
+; CHECK: jmpr $ra
+  %x = zext i32 %a to i64
+  %y = zext i32 %b to i64
+  %m = mul i64 %x, %y
+  %h = lshr i64 %m, 32
+  %r = trunc i64 %h to i32
+  ret i32 %r
+}
+
+; Division by a constant goes through MULHU instead of a libcall.
+define i32 @div10(i32 %a) nounwind {
+entry:
+; CHECK: div10:
+; CHECK-NOT: __udivsi3
+; CHECK: mul16
+; CHECK: srli $2, ${{[0-9]+}}, 3
+  %r = udiv i32 %a, 10
+  ret i32 %r
+}
+
+define i32 @by9(i32 %a) nounwind {
+entry:
+; CHECK: by9:
+; CHECK: slli [[T:\$[0-9]+]], $4, 3
+; CHECK-NEXT: add $2, [[T]], $4
+  %r = mul i32 %a, 9
+  ret i32 %r
+}
+
+define i32 @by7(i32 %a) nounwind {
+entry:
+; CHECK: by7:
+; CHECK: slli [[T:\$[0-9]+]], $4, 3
+; CHECK-NEXT: sub $2, $4, [[T]]
+  %r = mul i32 %a, 7
+  ret i32 %r
+}
+
+define i32 @by12(i32 %a) nounwind {
+entry:
+; CHECK: by12:
+; CHECK: slli
+; CHECK: slli
+; CHECK: add $2,
+  %r = mul i32 %a, 12
+  ret i32 %r
+}
+
+; 11 is neither 2^n+-1 nor 2^n+2^m, so it stays a multiply.
+define i32 @by11(i32 %a) nounwind {
+entry:
+; CHECK: by11:
+; CHECK: mul $2, $4,
+  %r = mul i32 %a, 11
+  ret i32 %r
+}
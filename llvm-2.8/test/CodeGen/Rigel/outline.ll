@@ -0,0 +1,62 @@
+; RUN: llc < %s -march=rigel -relocation-model=static | FileCheck %s
+
+; The first function only counts the run.  The second pays for the shared
+; copy and falls into it; later ones jump to it.
+
+@a = global i32 0
+@b = global i32 0
+@c = global i32 0
+
+; CHECK: f1:
+; CHECK-NOT: lj
+; CHECK: jmpr $ra
+define void @f1(i32 %x) optsize {
+  store i32 %x, i32* @a
+  store i32 %x, i32* @b
+  store i32 %x, i32* @c
+  ret void
+}
+
+; A function the linker may replace cannot hold the copy.
+; CHECK: w:
+; CHECK-NOT: outlined
+; CHECK: jmpr $ra
+define weak void @w(i32 %x) optsize {
+  store i32 %x, i32* @a
+  store i32 %x, i32* @b
+  store i32 %x, i32* @c
+  ret void
+}
+
+; CHECK: f2:
+; CHECK-NOT: lj
+; CHECK: [[BODY:\.outlined[0-9]+]]:
+; CHECK: stw
+; CHECK: jmpr $ra
+define void @f2(i32 %x) optsize {
+  store i32 %x, i32* @a
+  store i32 %x, i32* @b
+  store i32 %x, i32* @c
+  ret void
+}
+
+; CHECK: f3:
+; CHECK: # BB#0:
+; CHECK-NEXT: lj [[BODY]]
+define void @f3(i32 %x) optsize {
+  store i32 %x, i32* @a
+  store i32 %x, i32* @b
+  store i32 %x, i32* @c
+  ret void
+}
+
+; Only functions optimized for size are outlined by default.
+; CHECK: f4:
+; CHECK-NOT: lj
+; CHECK: jmpr $ra
+define void @f4(i32 %x) {
+  store i32 %x, i32* @a
+  store i32 %x, i32* @b
+  store i32 %x, i32* @c
+  ret void
+}
@@ -0,0 +1,48 @@
+; RUN: llc %s -march=rigel -codegen-partitions=2 -o %t.s
+; RUN: FileCheck -check-prefix=P0 %s < %t.s.0
+; RUN: FileCheck -check-prefix=P1 %s < %t.s.1
+; RUN: not grep {^g:} %t.s.1
+; RUN: not grep {^s\.part\..*:} %t.s.1
+; -codegen-partitions splits the functions between the partitions, largest
+; first.  Module asm, globals, and locals used from both halves are handled
+; so that the two objects link together.
+
+module asm "\09.globl foo_asm"
+module asm "foo_asm:"
+module asm "\09jmpr $ra"
+
+@g = global i32 7
+@s = internal global i32 1
+
+; Module-level asm is only emitted in partition 0.
+; P0: foo_asm:
+; P1-NOT: foo_asm:
+
+define i32 @big(i32 %a, i32 %b) nounwind {
+entry:
+; P0: big:
+; P1-NOT: big:
+  %x = mul i32 %a, %b
+  %y = add i32 %x, %a
+  %z = sub i32 %y, %b
+  %w = xor i32 %z, %x
+  %v = load i32* @s
+  %r = add i32 %w, %v
+  ret i32 %r
+}
+
+define i32 @small() nounwind {
+entry:
+; P0-NOT: small:
+; P1: small:
+; P1: s.part.{{[0-9A-F]+}}
+; P1: .size small
+  %v = load i32* @s
+  ret i32 %v
+}
+
+; Only partition 0 defines the globals.  @s is used from both partitions, so
+; it is promoted to a hidden global.
+; P0: {{^}}g:
+; P0: .hidden s.part.[[SALT:[0-9A-F]+]]
+; P0: s.part.[[SALT]]:
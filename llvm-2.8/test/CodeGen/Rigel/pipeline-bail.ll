@@ -0,0 +1,145 @@
+; RUN: llc < %s -march=rigel -relocation-model=static | FileCheck %s
+; RUN: llc < %s -march=rigel -relocation-model=static -rigel-pipeline-max-stages=1 | FileCheck -check-prefix=STAGES %s
+; RUN: llc < %s -march=rigel -relocation-model=static -disable-rigel-pipeliner | FileCheck -check-prefix=STAGES %s
+
+; Loops the pipeliner has to leave alone: each function keeps its single
+; loop.
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:32-i16:16:32-i32:32:32-i64:32:64-f32:32:32-f64:32:64-a0:0:32-s0:32:32-n32"
+target triple = "rigel-unknown-unknown"
+
+; Pipelined normally, but needs two stages.
+; STAGES: chain:
+; STAGES: Inner Loop Header
+; STAGES-NOT: Inner Loop Header
+; STAGES: .end chain
+
+define void @chain(float* noalias nocapture %a, float* noalias nocapture %b, float %s, float %t, i32 %n) nounwind {
+entry:
+  %cmp12 = icmp sgt i32 %n, 0
+  br i1 %cmp12, label %for.body, label %for.end
+
+for.body:
+  %i.013 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr float* %b, i32 %i.013
+  %arrayidx10 = getelementptr float* %a, i32 %i.013
+  %tmp4 = load float* %arrayidx, align 4
+  %mul = fmul float %tmp4, %s
+  %mul7 = fmul float %mul, %t
+  store float %mul7, float* %arrayidx10, align 4
+  %inc = add nsw i32 %i.013, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; The recurrence through both multiplies takes as long as an iteration.
+; CHECK: longrec:
+; CHECK: Inner Loop Header
+; CHECK-NOT: Inner Loop Header
+; CHECK: .end longrec
+
+define float @longrec(float* noalias nocapture %b, float %s, i32 %n) nounwind readonly {
+entry:
+  %cmp10 = icmp sgt i32 %n, 0
+  br i1 %cmp10, label %for.body, label %for.end
+
+for.body:
+  %i.012 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %x.011 = phi float [ %mul7, %for.body ], [ 1.000000e+00, %entry ]
+  %arrayidx = getelementptr float* %b, i32 %i.012
+  %mul = fmul float %x.011, %s
+  %tmp6 = load float* %arrayidx, align 4
+  %mul7 = fmul float %mul, %tmp6
+  %inc = add nsw i32 %i.012, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  %x.0.lcssa = phi float [ 1.000000e+00, %entry ], [ %mul7, %for.body ]
+  ret float %x.0.lcssa
+}
+
+; a and b may overlap, so each load waits for the previous store.
+; CHECK: alias:
+; CHECK: Inner Loop Header
+; CHECK-NOT: Inner Loop Header
+; CHECK: .end alias
+
+define void @alias(float* nocapture %a, float* nocapture %b, float %s, float %t, i32 %n) nounwind {
+entry:
+  %cmp12 = icmp sgt i32 %n, 0
+  br i1 %cmp12, label %for.body, label %for.end
+
+for.body:
+  %i.013 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr float* %b, i32 %i.013
+  %arrayidx10 = getelementptr float* %a, i32 %i.013
+  %tmp4 = load float* %arrayidx, align 4
+  %mul = fmul float %tmp4, %s
+  %mul7 = fmul float %mul, %t
+  store float %mul7, float* %arrayidx10, align 4
+  %inc = add nsw i32 %i.013, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; CHECK: vol:
+; CHECK: Inner Loop Header
+; CHECK-NOT: Inner Loop Header
+; CHECK: .end vol
+
+define void @vol(float* noalias nocapture %a, float* noalias nocapture %b, float %s, float %t, i32 %n) nounwind {
+entry:
+  %cmp12 = icmp sgt i32 %n, 0
+  br i1 %cmp12, label %for.body, label %for.end
+
+for.body:
+  %i.013 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr float* %b, i32 %i.013
+  %arrayidx10 = getelementptr float* %a, i32 %i.013
+  %tmp4 = volatile load float* %arrayidx, align 4
+  %mul = fmul float %tmp4, %s
+  %mul7 = fmul float %mul, %t
+  store float %mul7, float* %arrayidx10, align 4
+  %inc = add nsw i32 %i.013, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; CHECK: call:
+; CHECK: Inner Loop Header
+; CHECK-NOT: Inner Loop Header
+; CHECK: .end call
+
+define void @call(float* noalias nocapture %a, float* noalias nocapture %b, float %s, i32 %n) nounwind {
+entry:
+  %cmp12 = icmp sgt i32 %n, 0
+  br i1 %cmp12, label %for.body, label %for.end
+
+for.body:
+  %i.013 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr float* %b, i32 %i.013
+  %arrayidx10 = getelementptr float* %a, i32 %i.013
+  %tmp4 = load float* %arrayidx, align 4
+  %mul = fmul float %tmp4, %s
+  %call = tail call float @g(float %mul) nounwind
+  %mul7 = fmul float %call, %s
+  store float %mul7, float* %arrayidx10, align 4
+  %inc = add nsw i32 %i.013, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+declare float @g(float)
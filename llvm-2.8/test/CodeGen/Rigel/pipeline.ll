@@ -0,0 +1,84 @@
+; RUN: llc < %s -march=rigel -relocation-model=static | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:32-i16:16:32-i32:32:32-i64:32:64-f32:32:32-f64:32:64-a0:0:32-s0:32:32-n32"
+target triple = "rigel-unknown-unknown"
+
+; A chain of FPU operations longer than the FPU's issue interval: the next
+; iteration's load and multiplies start while this one's result is stored.
+; CHECK: chain:
+; Loops of one iteration run the original body.
+; CHECK: addi [[K:\$[0-9]+]], {{\$[0-9]+}}, -1
+; CHECK-NEXT: ble [[K]], [[ORIG:\.BB[0-9_]+]]
+; CHECK: ldw
+; CHECK: fmul
+; CHECK: fmul
+; CHECK: [[KERNEL:\.BB[0-9_]+]]:
+; CHECK: ldw
+; CHECK: fmul
+; CHECK: stw
+; CHECK: fmul
+; CHECK: bnz [[K]], [[KERNEL]]
+; CHECK: stw
+; CHECK-NEXT: addi $sp, $sp, 8
+; CHECK-NEXT: jmpr $ra
+; CHECK-NEXT: [[ORIG]]:
+; CHECK: .end chain
+
+define void @chain(float* noalias nocapture %a, float* noalias nocapture %b, float %s, float %t, i32 %n) nounwind {
+entry:
+  %cmp12 = icmp sgt i32 %n, 0
+  br i1 %cmp12, label %for.body, label %for.end
+
+for.body:
+  %i.013 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr float* %b, i32 %i.013
+  %arrayidx10 = getelementptr float* %a, i32 %i.013
+  %tmp4 = load float* %arrayidx, align 4
+  %mul = fmul float %tmp4, %s
+  %mul7 = fmul float %mul, %t
+  store float %mul7, float* %arrayidx10, align 4
+  %inc = add nsw i32 %i.013, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; x is carried around the loop through the fmul; the kernel stores the
+; previous iteration's x while computing the next one.
+; CHECK: prefix:
+; CHECK: addi [[K:\$[0-9]+]], {{\$[0-9]+}}, -1
+; CHECK-NEXT: ble [[K]], [[ORIG:\.BB[0-9_]+]]
+; CHECK: fmul [[X:\$[0-9]+]],
+; CHECK: [[KERNEL:\.BB[0-9_]+]]:
+; CHECK: ldw [[B:\$[0-9]+]],
+; CHECK: fmul [[NEXT:\$[0-9]+]], [[X]], [[B]]
+; CHECK: stw [[X]],
+; CHECK: or [[X]], $zero, [[NEXT]]
+; CHECK-NEXT: bnz [[K]], [[KERNEL]]
+; CHECK: stw [[NEXT]],
+; CHECK-NEXT: jmpr $ra
+; CHECK-NEXT: [[ORIG]]:
+; CHECK: .end prefix
+
+define void @prefix(float* noalias nocapture %a, float* noalias nocapture %b, i32 %n) nounwind {
+entry:
+  %cmp10 = icmp sgt i32 %n, 0
+  br i1 %cmp10, label %for.body, label %for.end
+
+for.body:
+  %i.012 = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %x.011 = phi float [ %mul, %for.body ], [ 1.000000e+00, %entry ]
+  %arrayidx = getelementptr float* %b, i32 %i.012
+  %arrayidx8 = getelementptr float* %a, i32 %i.012
+  %tmp5 = load float* %arrayidx, align 4
+  %mul = fmul float %x.011, %tmp5
+  store float %mul, float* %arrayidx8, align 4
+  %inc = add nsw i32 %i.012, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
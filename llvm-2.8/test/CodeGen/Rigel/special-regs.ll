@@ -0,0 +1,64 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; Special register reads and writes select to mfsr/mtsr with the register
+; number printed like a register.
+
+declare i32 @llvm.rigel.read.sr(i32) nounwind readnone
+declare i32 @llvm.rigel.read.sr.volatile(i32) nounwind
+declare void @llvm.rigel.write.sr(i32, i32) nounwind
+
+; CHECK: coreid:
+; CHECK: mfsr ${{[0-9]+}}, $0
+define i32 @coreid() nounwind {
+entry:
+  %0 = tail call i32 @llvm.rigel.read.sr(i32 0)
+  ret i32 %0
+}
+
+; CHECK: clusterid:
+; CHECK: mfsr ${{[0-9]+}}, $1
+define i32 @clusterid() nounwind {
+entry:
+  %0 = tail call i32 @llvm.rigel.read.sr(i32 1)
+  ret i32 %0
+}
+
+; CHECK: numthreads:
+; CHECK: mfsr ${{[0-9]+}}, $6
+define i32 @numthreads() nounwind {
+entry:
+  %0 = tail call i32 @llvm.rigel.read.sr(i32 6)
+  ret i32 %0
+}
+
+; The readnone read is CSE'd.
+; CHECK: twice:
+; CHECK: mfsr
+; CHECK-NOT: mfsr
+; CHECK: jmpr $ra
+define i32 @twice() nounwind {
+entry:
+  %0 = tail call i32 @llvm.rigel.read.sr(i32 0)
+  %1 = tail call i32 @llvm.rigel.read.sr(i32 0)
+  %2 = add i32 %0, %1
+  ret i32 %2
+}
+
+; The volatile read is not.
+; CHECK: cycles:
+; CHECK: mfsr ${{[0-9]+}}, $5
+; CHECK: mfsr ${{[0-9]+}}, $5
+define i32 @cycles() nounwind {
+entry:
+  %0 = tail call i32 @llvm.rigel.read.sr.volatile(i32 5)
+  %1 = tail call i32 @llvm.rigel.read.sr.volatile(i32 5)
+  %2 = sub i32 %1, %0
+  ret i32 %2
+}
+
+; CHECK: write:
+; CHECK: mtsr $4, $31
+define void @write(i32 %v) nounwind {
+entry:
+  tail call void @llvm.rigel.write.sr(i32 31, i32 %v)
+  ret void
+}
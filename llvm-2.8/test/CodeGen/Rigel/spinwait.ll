@@ -0,0 +1,65 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; RUN: llc < %s -march=rigel -rigel-spin-min-backoff=4 -rigel-spin-max-backoff=64 | FileCheck %s -check-prefix=OPT
+; The sleep/event/prio/g.ldw intrinsics, and the spin-wait pass that turns a
+; polling loop into a g.ldw poll with exponential backoff.
+
+declare i32 @llvm.rigel.sleep(i32, i32) nounwind
+declare void @llvm.rigel.event(i32, i32) nounwind
+declare void @llvm.rigel.prio(i32, i32) nounwind
+declare i32 @llvm.rigel.gldw(i8*) nounwind
+
+define i32 @ops(i32 %t, i8* %p) nounwind {
+entry:
+; CHECK: ops:
+; CHECK: sleep [[S:\$[0-9]+]], $4, 3
+; CHECK-NEXT: event [[S]], 12
+; CHECK-NEXT: prio [[S]], 2
+; CHECK-NEXT: g.ldw $2, $5, 0
+  %s = call i32 @llvm.rigel.sleep(i32 %t, i32 3)
+  call void @llvm.rigel.event(i32 %s, i32 12)
+  call void @llvm.rigel.prio(i32 %s, i32 2)
+  %g = call i32 @llvm.rigel.gldw(i8* %p)
+  ret i32 %g
+}
+
+define void @spin(i32* %f, i32 %x) nounwind {
+entry:
+; CHECK: spin:
+; CHECK: addi ${{[0-9]+}}, $zero, 16
+; CHECK: %loop
+; CHECK: g.ldw ${{[0-9]+}}, $4, 0
+; CHECK: %spin.backoff
+; CHECK: addi ${{[0-9]+}}, $zero, 1024
+; CHECK: sleep ${{[0-9]+}}, ${{[0-9]+}}, 0
+; CHECK: lj
+; CHECK: %done
+; OPT: spin:
+; OPT: addi ${{[0-9]+}}, $zero, 4
+; OPT: addi ${{[0-9]+}}, $zero, 64
+  br label %loop
+loop:
+  %v = volatile load i32* %f
+  %c = icmp eq i32 %v, %x
+  br i1 %c, label %loop, label %done
+done:
+  ret void
+}
+
+; The loop does other work, so it is left alone.
+define i32 @busy(i32* %f, i32 %x) nounwind {
+entry:
+; CHECK: busy:
+; CHECK-NOT: g.ldw
+; CHECK-NOT: sleep
+; CHECK: ldw ${{[0-9]+}}, $4, 0
+; CHECK: jmpr $ra
+  br label %loop
+loop:
+  %n = phi i32 [ 0, %entry ], [ %n1, %loop ]
+  %n1 = add i32 %n, 1
+  %v = volatile load i32* %f
+  %c = icmp eq i32 %v, %x
+  br i1 %c, label %loop, label %done
+done:
+  ret i32 %n1
+}
@@ -0,0 +1,55 @@
+; RUN: llc < %s -march=rigel | FileCheck %s
+; The task queue instructions take no operands; everything goes through
+; $a0-$a3 and $v0.
+
+%0 = type { i32, i32, i32, i32, i32 }
+
+define i32 @init(i32 %n) nounwind {
+entry:
+; CHECK: init:
+; CHECK: tq.init{{$}}
+  %r = tail call i32 @llvm.rigel.tq.init(i32 %n)
+  ret i32 %r
+}
+
+define i32 @enqueue(i32 %a, i32 %b, i32 %c, i32 %d) nounwind {
+entry:
+; CHECK: enqueue:
+; CHECK: tq.enq{{$}}
+  %r = tail call i32 @llvm.rigel.tq.enqueue(i32 %a, i32 %b, i32 %c, i32 %d)
+  ret i32 %r
+}
+
+define i32 @loop(i32 %a, i32 %b, i32 %c, i32 %d) nounwind {
+entry:
+; CHECK: loop:
+; CHECK: tq.loop{{$}}
+  %r = tail call i32 @llvm.rigel.tq.loop(i32 %a, i32 %b, i32 %c, i32 %d)
+  ret i32 %r
+}
+
+define i32 @dequeue(i32* %t) nounwind {
+entry:
+; CHECK: dequeue:
+; CHECK: tq.deq{{$}}
+; CHECK: stw $4, ${{[0-9]+}}, 0
+  %r = tail call %0 @llvm.rigel.tq.dequeue()
+  %s = extractvalue %0 %r, 0
+  %w = extractvalue %0 %r, 1
+  store i32 %w, i32* %t
+  ret i32 %s
+}
+
+define i32 @end() nounwind {
+entry:
+; CHECK: end:
+; CHECK: tq.end{{$}}
+  %r = tail call i32 @llvm.rigel.tq.end()
+  ret i32 %r
+}
+
+declare i32 @llvm.rigel.tq.init(i32) nounwind
+declare i32 @llvm.rigel.tq.enqueue(i32, i32, i32, i32) nounwind
+declare i32 @llvm.rigel.tq.loop(i32, i32, i32, i32) nounwind
+declare %0 @llvm.rigel.tq.dequeue() nounwind
+declare i32 @llvm.rigel.tq.end() nounwind
@@ -52,6 +52,7 @@ namespace clang {
   class CXXABI;
   // Decls
   class DeclContext;
+  class ForStmt;
   class CXXMethodDecl;
   class CXXRecordDecl;
   class Decl;
@@ -200,6 +201,9 @@ class ASTContext {
   /// wasting space in the Decl class.
   llvm::DenseMap<const Decl*, AttrVec*> DeclAttrs;
 
+  /// \brief For loops marked with '#pragma rigel parallel for'.
+  llvm::SmallPtrSet<const ForStmt*, 4> ParallelForLoops;
+
   /// \brief Keeps track of the static data member templates from which
   /// static data members of class template specializations were instantiated.
   ///
@@ -326,6 +330,14 @@ public:
   /// \brief Erase the attributes corresponding to the given declaration.
   void eraseDeclAttrs(const Decl *D);
 
+  /// \brief Mark a for loop as one whose iterations may run in parallel.
+  void setParallelForLoop(const ForStmt *S) { ParallelForLoops.insert(S); }
+
+  /// \brief Whether the loop was marked with '#pragma rigel parallel for'.
+  bool isParallelForLoop(const ForStmt *S) const {
+    return ParallelForLoops.count(S);
+  }
+
   /// \brief If this variable is an instantiated static data member of a
   /// class template specialization, returns the templated static data member
   /// from which it was instantiated.
@@ -35,6 +35,16 @@ namespace clang {
     };
   }
 
+  /// Rigel builtins
+  namespace Rigel {
+    enum {
+        LastTIBuiltin = clang::Builtin::FirstTSBuiltin-1,
+#define BUILTIN(ID, TYPE, ATTRS) BI##ID,
+#include "clang/Basic/BuiltinsRigel.def"
+        LastTSBuiltin
+    };
+  }
+
   /// X86 builtins
   namespace X86 {
     enum {
@@ -49,6 +49,8 @@ public:
   unsigned EmitDeclMetadata  : 1; /// Emit special metadata indicating what Decl*
                                   /// various IR entities came from.  Only useful
                                   /// when running CodeGen as a subroutine.
+  unsigned EmitEdgeProfile   : 1; /// Instrument for an edge profile
+                                  /// (-fprofile-generate).
   unsigned FunctionSections  : 1; /// Set when -ffunction-sections is enabled
   unsigned HiddenWeakTemplateVTables : 1; /// Emit weak vtables and RTTI for
                                   /// template classes with hidden visibility
@@ -99,6 +101,9 @@ public:
   /// file, for example with -save-temps.
   std::string MainFileName;
 
+  /// The edge profile to attach to the code (-fprofile-use=), if non-empty.
+  std::string ProfileUseFile;
+
   /// The name of the relocation model to use.
   std::string RelocationModel;
 
@@ -113,6 +118,7 @@ public:
     DisableLLVMOpts = 0;
     DisableRedZone = 0;
     EmitDeclMetadata = 0;
+    EmitEdgeProfile = 0;
     FunctionSections = 0;
     HiddenWeakTemplateVTables = 0;
     HiddenWeakVTables = 0;
@@ -251,6 +251,10 @@ public:
   /// VisContext - Manages the stack for #pragma GCC visibility.
   void *VisContext; // Really a "PragmaVisStack*"
 
+  /// PragmaParallelForLoc - Location of a '#pragma rigel parallel for' that
+  /// hasn't been attached to its loop yet.
+  SourceLocation PragmaParallelForLoc;
+
   /// \brief Stack containing information about each of the nested
   /// function, block, and method scopes that are currently active.
   ///
@@ -3816,6 +3820,18 @@ public:
                          SourceLocation LParenLoc,
                          SourceLocation RParenLoc);
 
+  /// ActOnPragmaParallelFor - Called on well formed '#pragma rigel parallel
+  /// for'.  The pragma applies to the statement that follows it.
+  void ActOnPragmaParallelFor(SourceLocation PragmaLoc);
+
+  /// TakePragmaParallelFor - Return the location of a pending '#pragma rigel
+  /// parallel for', if any, and forget about it.
+  SourceLocation TakePragmaParallelFor();
+
+  /// ActOnParallelForStmt - Attach a '#pragma rigel parallel for' to the loop
+  /// that followed it.
+  void ActOnParallelForStmt(SourceLocation PragmaLoc, Stmt *S);
+
   /// ActOnPragmaVisibility - Called on well formed #pragma GCC visibility... .
   void ActOnPragmaVisibility(bool IsPush, const IdentifierInfo* VisType,
                              SourceLocation PragmaLoc);
@@ -4386,6 +4402,7 @@ private:
   ExprResult CheckBuiltinFunctionCall(unsigned BuiltinID, CallExpr *TheCall);
   bool CheckARMBuiltinFunctionCall(unsigned BuiltinID, CallExpr *TheCall);
   bool CheckX86BuiltinFunctionCall(unsigned BuiltinID, CallExpr *TheCall);
+  bool CheckRigelBuiltinFunctionCall(unsigned BuiltinID, CallExpr *TheCall);
 
   bool SemaBuiltinVAStart(CallExpr *TheCall);
   bool SemaBuiltinUnorderedCompare(CallExpr *TheCall);
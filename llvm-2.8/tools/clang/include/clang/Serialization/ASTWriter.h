@@ -67,6 +67,9 @@ private:
   /// \brief The reader of existing AST files, if we're chaining.
   ASTReader *Chain;
 
+  /// \brief The AST being written, while WriteAST() runs.
+  ASTContext *Context;
+
   /// \brief Stores a declaration or a type to be written to the AST file.
   class DeclOrType {
   public:
@@ -311,6 +314,12 @@ public:
   void WriteAST(Sema &SemaRef, MemorizeStatCalls *StatCalls,
                 const char* isysroot);
 
+  /// \brief The AST being written.
+  ASTContext &getASTContext() const {
+    assert(Context && "Not writing an AST");
+    return *Context;
+  }
+
   /// \brief Emit a source location.
   void AddSourceLocation(SourceLocation Loc, RecordData &Record);
 
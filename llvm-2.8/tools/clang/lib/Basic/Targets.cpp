@@ -2493,10 +2493,14 @@ void MipselTargetInfo::getTargetDefines(const LangOptions &Opts,
 namespace {
 class RigelTargetInfo : public TargetInfo {
   std::string ABI, CPU;
+  //Set by -mdouble=32: double and long double are IEEE single.
+  bool Double32;
+  static const Builtin::Info BuiltinInfo[];
   static const TargetInfo::GCCRegAlias GCCRegAliases[];
   static const char * const GCCRegNames[];
 public:
-  RigelTargetInfo(const std::string& triple) : TargetInfo(triple), ABI("o32"), CPU("rigel") {
+  RigelTargetInfo(const std::string& triple)
+    : TargetInfo(triple), ABI("o32"), CPU("rigel"), Double32(false) {
     TLSSupported = false;
     IntWidth = 32;
     IntAlign = 32;
@@ -2532,7 +2536,9 @@ public:
   virtual const char *getABI() const { return ABI.c_str(); }
   virtual bool setABI(const std::string &Name) {
 
-    if ((Name == "o32") || (Name == "eabi")) {
+    // "regstruct" is o32, except that small aggregates are passed and
+    // returned in registers (see RigelABIInfo in CodeGen/TargetInfo.cpp).
+    if ((Name == "o32") || (Name == "eabi") || (Name == "regstruct")) {
       ABI = Name;
       return true;
     } else
@@ -2551,12 +2557,48 @@ public:
     //Features[ABI] = true;
     //Features[CPU] = true;
   }
+  virtual bool setFeatureEnabled(llvm::StringMap<bool> &Features,
+                                 const std::string &Name,
+                                 bool Enabled) const {
+    if (Name != "double32")
+      return false;
+    Features[Name] = Enabled;
+    return true;
+  }
+  virtual void HandleTargetFeatures(std::vector<std::string> &Features) {
+    Double32 = std::find(Features.begin(), Features.end(),
+                         "+double32") != Features.end();
+    if (Double32) {
+      //The backend has no f64 registers, so every double operation becomes
+      //a soft-float libcall.  With -mdouble=32, make double and long double
+      //the same as float so they stay in hardware.
+      DoubleWidth = DoubleAlign = 32;
+      LongDoubleWidth = LongDoubleAlign = 32;
+      DoubleFormat = &llvm::APFloat::IEEEsingle;
+      LongDoubleFormat = &llvm::APFloat::IEEEsingle;
+    }
+
+    // Remove front-end specific options which the backend doesn't know about.
+    std::vector<std::string>::iterator it;
+    it = std::find(Features.begin(), Features.end(), "+double32");
+    if (it != Features.end())
+      Features.erase(it);
+    it = std::find(Features.begin(), Features.end(), "-double32");
+    if (it != Features.end())
+      Features.erase(it);
+  }
   virtual void getArchDefines(const LangOptions &Opts,
                                 MacroBuilder &Builder) const {
     if (ABI == "o32")
       Builder.defineMacro("__rigel_o32");
     else if (ABI == "eabi")
       Builder.defineMacro("__rigel_eabi");
+    else if (ABI == "regstruct")
+      Builder.defineMacro("__rigel_regstruct");
+    //__SIZEOF_DOUBLE__ and the __DBL_*/__LDBL_* macros follow DoubleFormat,
+    //but give code an easy way to tell it's been built with -mdouble=32.
+    if (Double32)
+      Builder.defineMacro("__rigel_double32");
   }
   virtual void getTargetDefines(const LangOptions &Opts,
                                 MacroBuilder &Builder) const {
@@ -2572,7 +2614,8 @@ public:
   }
   virtual void getTargetBuiltins(const Builtin::Info *&Records,
                                  unsigned &NumRecords) const {
-    // FIXME (from copied MIPS code): Implement!
+    Records = BuiltinInfo;
+    NumRecords = clang::Rigel::LastTSBuiltin-Builtin::FirstTSBuiltin;
   }
   //TODO: In libc we use "typedef void *__va_list;"
   virtual const char *getVAListDeclaration() const {
@@ -2582,18 +2625,20 @@ public:
                               unsigned &NumNames) const;
   virtual void getGCCRegAliases(const GCCRegAlias *&Aliases,
                                 unsigned &NumAliases) const;
-  //TODO: Add additional constraints for:
-  //1) Fixed-width constants (to plug into immediate fields) -- x86 has I, J, L, etc.
-  //2) FP regs, if we get some
   virtual bool validateAsmConstraint(const char *&Name,
                                      TargetInfo::ConstraintInfo &Info) const {
     switch (*Name) {
     default:
+      return false;
     case 'r': // CPU registers.
+    case 'f': // Registers holding a float (the same registers on Rigel).
       Info.setAllowsRegister();
       return true;
+    case 'I': // Signed 16-bit constant.
+    case 'K': // Unsigned 16-bit constant.
+    case 'L': // Unsigned 5-bit constant (shift amounts, SR numbers).
+      return true;
     }
-    return false;
   }
 
   virtual const char *getClobbers() const {
@@ -2602,6 +2647,12 @@ public:
   }
 };
 
+const Builtin::Info RigelTargetInfo::BuiltinInfo[] = {
+#define BUILTIN(ID, TYPE, ATTRS) { #ID, TYPE, ATTRS, 0, false },
+#define LIBBUILTIN(ID, TYPE, ATTRS, HEADER) { #ID, TYPE, ATTRS, HEADER, false },
+#include "clang/Basic/BuiltinsRigel.def"
+};
+
 const char * const RigelTargetInfo::GCCRegNames[] = {
   "$0",   "$1",   "$2",   "$3",   "$4",   "$5",   "$6",   "$7",
   "$8",   "$9",   "$10",  "$11",  "$12",  "$13",  "$14",  "$15",
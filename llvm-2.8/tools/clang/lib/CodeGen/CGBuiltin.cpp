@@ -21,6 +21,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/Basic/TargetBuiltins.h"
 #include "llvm/Intrinsics.h"
+#include "llvm/IntrinsicsRigel.h"
 #include "llvm/Target/TargetData.h"
 using namespace clang;
 using namespace CodeGen;
@@ -992,6 +993,8 @@ Value *CodeGenFunction::EmitTargetBuiltinExpr(unsigned BuiltinID,
   case llvm::Triple::ppc:
   case llvm::Triple::ppc64:
     return EmitPPCBuiltinExpr(BuiltinID, E);
+  case llvm::Triple::rigel:
+    return EmitRigelBuiltinExpr(BuiltinID, E);
   default:
     return 0;
   }
@@ -2180,3 +2183,158 @@ Value *CodeGenFunction::EmitPPCBuiltinExpr(unsigned BuiltinID,
   }
   return 0;
 }
+
+Value *CodeGenFunction::EmitRigelBuiltinExpr(unsigned BuiltinID,
+                                             const CallExpr *E) {
+  llvm::SmallVector<Value*, 4> Ops;
+
+  for (unsigned i = 0, e = E->getNumArgs(); i != e; i++)
+    Ops.push_back(EmitScalarExpr(E->getArg(i)));
+
+  const llvm::Type *Int32Ty = llvm::Type::getInt32Ty(VMContext);
+
+  switch (BuiltinID) {
+  default: return 0;
+
+  case Rigel::BI__builtin_rigel_coreid:
+  case Rigel::BI__builtin_rigel_clusterid:
+  case Rigel::BI__builtin_rigel_numthreads: {
+    unsigned SR;
+    switch (BuiltinID) {
+    default: assert(0 && "Unknown special register builtin!");
+    case Rigel::BI__builtin_rigel_coreid:     SR = RigelSR::CoreID;     break;
+    case Rigel::BI__builtin_rigel_clusterid:  SR = RigelSR::ClusterID;  break;
+    case Rigel::BI__builtin_rigel_numthreads: SR = RigelSR::NumThreads; break;
+    }
+    Function *F = CGM.getIntrinsic(Intrinsic::rigel_read_sr);
+    return Builder.CreateCall(F, llvm::ConstantInt::get(Int32Ty, SR));
+  }
+  case Rigel::BI__builtin_rigel_mfsr: {
+    // Sema has already checked that the register number is a constant.
+    uint64_t SR = cast<llvm::ConstantInt>(Ops[0])->getZExtValue();
+    Function *F = CGM.getIntrinsic(RigelSR::isImmutable(SR) ?
+                                   Intrinsic::rigel_read_sr :
+                                   Intrinsic::rigel_read_sr_volatile);
+    return Builder.CreateCall(F, Ops[0]);
+  }
+  case Rigel::BI__builtin_rigel_mtsr: {
+    Function *F = CGM.getIntrinsic(Intrinsic::rigel_write_sr);
+    return Builder.CreateCall2(F, Ops[0], Ops[1]);
+  }
+  case Rigel::BI__builtin_rigel_sleep: {
+    Function *F = CGM.getIntrinsic(Intrinsic::rigel_sleep);
+    return Builder.CreateCall2(F, Ops[0], Ops[1]);
+  }
+  case Rigel::BI__builtin_rigel_event: {
+    Function *F = CGM.getIntrinsic(Intrinsic::rigel_event);
+    return Builder.CreateCall2(F, Ops[0], Ops[1]);
+  }
+  case Rigel::BI__builtin_rigel_prio: {
+    Function *F = CGM.getIntrinsic(Intrinsic::rigel_prio);
+    return Builder.CreateCall2(F, Ops[0], Ops[1]);
+  }
+  case Rigel::BI__builtin_rigel_cycles: {
+    Function *F = CGM.getIntrinsic(Intrinsic::rigel_read_sr_volatile);
+    return Builder.CreateCall(F, llvm::ConstantInt::get(Int32Ty,
+                                                        RigelSR::CycleCount));
+  }
+  case Rigel::BI__builtin_rigel_gldw: {
+    Ops[0] = Builder.CreateBitCast(Ops[0], llvm::Type::getInt8PtrTy(VMContext));
+    Function *F = CGM.getIntrinsic(Intrinsic::rigel_gldw);
+    return Builder.CreateCall(F, Ops[0]);
+  }
+  case Rigel::BI__builtin_rigel_gstw:
+  case Rigel::BI__builtin_rigel_bcast_update: {
+    Intrinsic::ID ID = BuiltinID == Rigel::BI__builtin_rigel_gstw ?
+                       Intrinsic::rigel_gstw : Intrinsic::rigel_bcast_update;
+    Ops[0] = Builder.CreateBitCast(Ops[0], llvm::Type::getInt8PtrTy(VMContext));
+    // The intrinsics take (value, address), like a store.
+    return Builder.CreateCall2(CGM.getIntrinsic(ID), Ops[1], Ops[0]);
+  }
+  case Rigel::BI__builtin_rigel_bcast_inv:
+  case Rigel::BI__builtin_rigel_line_wb:
+  case Rigel::BI__builtin_rigel_line_inv:
+  case Rigel::BI__builtin_rigel_line_flush:
+  case Rigel::BI__builtin_rigel_pref_l:
+  case Rigel::BI__builtin_rigel_pref_nga: {
+    Intrinsic::ID ID;
+    switch (BuiltinID) {
+    default: assert(0 && "Unknown cache control builtin!");
+    case Rigel::BI__builtin_rigel_bcast_inv:  ID = Intrinsic::rigel_bcast_inv;  break;
+    case Rigel::BI__builtin_rigel_line_wb:    ID = Intrinsic::rigel_line_wb;    break;
+    case Rigel::BI__builtin_rigel_line_inv:   ID = Intrinsic::rigel_line_inv;   break;
+    case Rigel::BI__builtin_rigel_line_flush: ID = Intrinsic::rigel_line_flush; break;
+    case Rigel::BI__builtin_rigel_pref_l:     ID = Intrinsic::rigel_pref_l;     break;
+    case Rigel::BI__builtin_rigel_pref_nga:   ID = Intrinsic::rigel_pref_nga;   break;
+    }
+    Ops[0] = Builder.CreateBitCast(Ops[0], llvm::Type::getInt8PtrTy(VMContext));
+    return Builder.CreateCall(CGM.getIntrinsic(ID), Ops[0]);
+  }
+
+  // The atomics use the generic llvm.atomic.* intrinsics, so the optimizer
+  // understands them; the backend selects them to the atom.* instructions.
+  case Rigel::BI__builtin_rigel_atom_add:
+  case Rigel::BI__builtin_rigel_atom_and:
+  case Rigel::BI__builtin_rigel_atom_or:
+  case Rigel::BI__builtin_rigel_atom_xor:
+  case Rigel::BI__builtin_rigel_atom_min:
+  case Rigel::BI__builtin_rigel_atom_max:
+  case Rigel::BI__builtin_rigel_atom_xchg:
+  case Rigel::BI__builtin_rigel_atom_inc:
+  case Rigel::BI__builtin_rigel_atom_dec: {
+    Intrinsic::ID ID;
+    switch (BuiltinID) {
+    default: assert(0 && "Unknown atomic builtin!");
+    case Rigel::BI__builtin_rigel_atom_add:  ID = Intrinsic::atomic_load_add; break;
+    case Rigel::BI__builtin_rigel_atom_and:  ID = Intrinsic::atomic_load_and; break;
+    case Rigel::BI__builtin_rigel_atom_or:   ID = Intrinsic::atomic_load_or;  break;
+    case Rigel::BI__builtin_rigel_atom_xor:  ID = Intrinsic::atomic_load_xor; break;
+    case Rigel::BI__builtin_rigel_atom_min:  ID = Intrinsic::atomic_load_min; break;
+    case Rigel::BI__builtin_rigel_atom_max:  ID = Intrinsic::atomic_load_max; break;
+    case Rigel::BI__builtin_rigel_atom_xchg: ID = Intrinsic::atomic_swap;     break;
+    case Rigel::BI__builtin_rigel_atom_inc:
+      ID = Intrinsic::atomic_load_add;
+      Ops.push_back(llvm::ConstantInt::get(Int32Ty, 1));
+      break;
+    case Rigel::BI__builtin_rigel_atom_dec:
+      ID = Intrinsic::atomic_load_add;
+      Ops.push_back(llvm::ConstantInt::get(Int32Ty, -1, true));
+      break;
+    }
+    const llvm::Type *PtrTy = Int32Ty->getPointerTo();
+    const llvm::Type *Tys[2] = { Int32Ty, PtrTy };
+    Value *F = CGM.getIntrinsic(ID, Tys, 2);
+    Ops[0] = Builder.CreateBitCast(Ops[0], PtrTy);
+    return EmitCallWithBarrier(*this, F, &Ops[0], &Ops[0] + 2);
+  }
+  case Rigel::BI__builtin_rigel_atom_cas: {
+    const llvm::Type *PtrTy = Int32Ty->getPointerTo();
+    const llvm::Type *Tys[2] = { Int32Ty, PtrTy };
+    Value *F = CGM.getIntrinsic(Intrinsic::atomic_cmp_swap, Tys, 2);
+    Ops[0] = Builder.CreateBitCast(Ops[0], PtrTy);
+    return EmitCallWithBarrier(*this, F, &Ops[0], &Ops[0] + 3);
+  }
+
+  case Rigel::BI__builtin_rigel_tq_init:
+    return Builder.CreateCall(CGM.getIntrinsic(Intrinsic::rigel_tq_init),
+                              Ops[0]);
+  case Rigel::BI__builtin_rigel_tq_end:
+    return Builder.CreateCall(CGM.getIntrinsic(Intrinsic::rigel_tq_end));
+  case Rigel::BI__builtin_rigel_tq_enqueue:
+  case Rigel::BI__builtin_rigel_tq_loop: {
+    Function *F = CGM.getIntrinsic(
+      BuiltinID == Rigel::BI__builtin_rigel_tq_enqueue ?
+      Intrinsic::rigel_tq_enqueue : Intrinsic::rigel_tq_loop);
+    return Builder.CreateCall(F, Ops.begin(), Ops.end());
+  }
+  case Rigel::BI__builtin_rigel_tq_dequeue: {
+    // Returns { status, task word 0-3 }; store the task and return status.
+    Value *Res = Builder.CreateCall(CGM.getIntrinsic(Intrinsic::rigel_tq_dequeue));
+    for (unsigned i = 0; i != 4; ++i) {
+      Value *Word = Builder.CreateExtractValue(Res, i + 1);
+      Builder.CreateStore(Word, Builder.CreateConstGEP1_32(Ops[0], i));
+    }
+    return Builder.CreateExtractValue(Res, 0);
+  }
+  }
+}
@@ -496,6 +496,14 @@ void CodeGenFunction::EmitDoStmt(const DoStmt &S) {
     SimplifyForwardingBlocks(LoopCond.getBlock());
 }
 
+/// MarkParallelLoopBranch - Tag a branch of a loop marked with '#pragma rigel
+/// parallel for', which the Rigel backend looks for on the loop's blocks.
+/// Both the condition and back-edge branches are tagged so the mark survives
+/// loop rotation.
+void CodeGenFunction::MarkParallelLoopBranch(llvm::Instruction *Br) {
+  Br->setMetadata("rigel.parallel", llvm::MDNode::get(VMContext, 0, 0));
+}
+
 void CodeGenFunction::EmitForStmt(const ForStmt &S) {
   JumpDest LoopExit = getJumpDestInCurrentScope("for.end");
 
@@ -541,7 +549,10 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S) {
     // C99 6.8.5p2/p4: The first substatement is executed if the expression
     // compares unequal to 0.  The condition must be a scalar type.
     BoolCondVal = EvaluateExprAsBool(S.getCond());
-    Builder.CreateCondBr(BoolCondVal, ForBody, ExitBlock);
+    llvm::BranchInst *CondBr =
+      Builder.CreateCondBr(BoolCondVal, ForBody, ExitBlock);
+    if (getContext().isParallelForLoop(&S))
+      MarkParallelLoopBranch(CondBr);
 
     if (ExitBlock != LoopExit.getBlock()) {
       EmitBlock(ExitBlock);
@@ -580,7 +591,11 @@ void CodeGenFunction::EmitForStmt(const ForStmt &S) {
   BreakContinueStack.pop_back();
 
   ConditionScope.ForceCleanup();
+  llvm::BasicBlock *LatchBlock = Builder.GetInsertBlock();
   EmitBranch(CondBlock);
+  if (getContext().isParallelForLoop(&S) && LatchBlock &&
+      LatchBlock->getTerminator())
+    MarkParallelLoopBranch(LatchBlock->getTerminator());
 
   ForScope.ForceCleanup();
 
@@ -35,10 +35,12 @@
 #include "llvm/Module.h"
 #include "llvm/Intrinsics.h"
 #include "llvm/LLVMContext.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/ErrorHandling.h"
+#include <algorithm>
 using namespace clang;
 using namespace CodeGen;
 
@@ -892,6 +894,17 @@ llvm::Constant *CodeGenModule::GetAddrOfFunction(GlobalDecl GD,
     Ty = getTypes().ConvertType(cast<ValueDecl>(GD.getDecl())->getType());
   
   llvm::StringRef MangledName = getMangledName(GD);
+
+  // Calls to libm functions that weren't recognized as builtins (-fno-builtin,
+  // or functions like exp that have none), and taking their address, need
+  // the same treatment as the builtins in getBuiltinLibFunction.
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(GD.getDecl()))
+    if (FD->isExternC() && !FD->hasBody()) {
+      std::string FloatName = getSingleDoubleLibmName(FD, MangledName);
+      if (!FloatName.empty())
+        return GetOrCreateLLVMFunction(FloatName, Ty, GD);
+    }
+
   return GetOrCreateLLVMFunction(MangledName, Ty, GD);
 }
 
@@ -1428,6 +1441,92 @@ void CodeGenModule::EmitAliasDefinition(GlobalDecl GD) {
   SetCommonAttributes(D, GA);
 }
 
+namespace {
+/// A C99 libm function taking or returning double, with its signature: the
+/// return type, then the parameters; 'd' is a floating type, 'i' an integer
+/// and 'p' a pointer.
+struct DoubleLibmFn {
+  const char *Name;
+  const char *Sig;
+};
+
+struct DoubleLibmFnLess {
+  bool operator()(const DoubleLibmFn &LHS, llvm::StringRef RHS) const {
+    return llvm::StringRef(LHS.Name) < RHS;
+  }
+};
+}
+
+/// Sorted by name.
+static const DoubleLibmFn DoubleLibmFns[] = {
+  { "acos", "dd" }, { "acosh", "dd" }, { "asin", "dd" }, { "asinh", "dd" },
+  { "atan", "dd" }, { "atan2", "ddd" }, { "atanh", "dd" }, { "cbrt", "dd" },
+  { "ceil", "dd" }, { "copysign", "ddd" }, { "cos", "dd" }, { "cosh", "dd" },
+  { "erf", "dd" }, { "erfc", "dd" }, { "exp", "dd" }, { "exp2", "dd" },
+  { "expm1", "dd" }, { "fabs", "dd" }, { "fdim", "ddd" }, { "floor", "dd" },
+  { "fma", "dddd" }, { "fmax", "ddd" }, { "fmin", "ddd" }, { "fmod", "ddd" },
+  { "frexp", "ddp" }, { "hypot", "ddd" }, { "ilogb", "id" },
+  { "ldexp", "ddi" }, { "lgamma", "dd" }, { "llrint", "id" },
+  { "llround", "id" }, { "log", "dd" }, { "log10", "dd" }, { "log1p", "dd" },
+  { "log2", "dd" }, { "logb", "dd" }, { "lrint", "id" }, { "lround", "id" },
+  { "modf", "ddp" }, { "nan", "dp" }, { "nearbyint", "dd" },
+  { "nextafter", "ddd" }, { "pow", "ddd" }, { "remainder", "ddd" },
+  { "remquo", "dddp" }, { "rint", "dd" }, { "round", "dd" },
+  { "scalbln", "ddi" }, { "scalbn", "ddi" }, { "sin", "dd" }, { "sinh", "dd" },
+  { "sqrt", "dd" }, { "tan", "dd" }, { "tanh", "dd" }, { "tgamma", "dd" },
+  { "trunc", "dd" }
+};
+
+/// matchesLibmSig - Whether T has the kind of type Sig names.
+static bool matchesLibmSig(QualType T, char Sig) {
+  switch (Sig) {
+  case 'd': return T->isRealFloatingType();
+  case 'i': return T->isIntegerType();
+  case 'p': return T->isPointerType();
+  }
+  return false;
+}
+
+/// getSingleDoubleLibmName - If the target makes double (and long double)
+/// single precision, the libm functions taking them have to be called through
+/// the float ones: sin/sinl -> sinf.  Return the float name for FD, declared
+/// as Name, or an empty string if doubles are not single precision or FD
+/// isn't a libm function (a user's own "void log(int)", say).
+std::string CodeGenModule::getSingleDoubleLibmName(const FunctionDecl *FD,
+                                                   llvm::StringRef Name) {
+  if (&Context.Target.getDoubleFormat() != &llvm::APFloat::IEEEsingle)
+    return std::string();
+
+  // The long double variants add an 'l'; try the name as it is first, since
+  // "ceil" ends in one too.
+  const DoubleLibmFn *End = llvm::array_endof(DoubleLibmFns);
+  const DoubleLibmFn *Fn = End;
+  llvm::StringRef Base;
+  for (unsigned Strip = 0; Strip != 2 && Fn == End; ++Strip) {
+    if (Strip && !Name.endswith("l"))
+      break;
+    Base = Name.substr(0, Name.size() - Strip);
+    Fn = std::lower_bound(DoubleLibmFns, End, Base, DoubleLibmFnLess());
+    if (Fn != End && Base != Fn->Name)
+      Fn = End;
+  }
+  if (Fn == End)
+    return std::string();
+
+  const FunctionType *FT = FD->getType()->getAs<FunctionType>();
+  if (!FT || !matchesLibmSig(FT->getResultType(), Fn->Sig[0]))
+    return std::string();
+  if (const FunctionProtoType *FPT = dyn_cast<FunctionProtoType>(FT)) {
+    if (FPT->isVariadic() ||
+        FPT->getNumArgs() != llvm::StringRef(Fn->Sig).size() - 1)
+      return std::string();
+    for (unsigned i = 0, e = FPT->getNumArgs(); i != e; ++i)
+      if (!matchesLibmSig(FPT->getArgType(i), Fn->Sig[i + 1]))
+        return std::string();
+  }
+  return Base.str() + "f";
+}
+
 /// getBuiltinLibFunction - Given a builtin id for a function like
 /// "__builtin_fabsf", return a Function* for "fabsf".
 llvm::Value *CodeGenModule::getBuiltinLibFunction(const FunctionDecl *FD,
@@ -1444,6 +1543,10 @@ llvm::Value *CodeGenModule::getBuiltinLibFunction(const FunctionDecl *FD,
   const llvm::FunctionType *Ty =
     cast<llvm::FunctionType>(getTypes().ConvertType(FD->getType()));
 
+  std::string FloatName = getSingleDoubleLibmName(FD, Name);
+  if (!FloatName.empty())
+    return GetOrCreateLLVMFunction(FloatName, Ty, GlobalDecl(FD));
+
   return GetOrCreateLLVMFunction(Name, Ty, GlobalDecl(FD));
 }
 
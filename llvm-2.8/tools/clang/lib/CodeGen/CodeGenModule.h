@@ -519,6 +519,12 @@ private:
                                         const llvm::PointerType *PTy,
                                         const VarDecl *D);
 
+  /// getSingleDoubleLibmName - Under single-precision doubles, the float
+  /// libm function to call instead of FD, declared as Name, or an empty
+  /// string.
+  std::string getSingleDoubleLibmName(const FunctionDecl *FD,
+                                      llvm::StringRef Name);
+
   /// SetCommonAttributes - Set attributes which are common to any
   /// form of a global definition (alias, Objective-C method,
   /// function, global variable).
@@ -2595,14 +2595,48 @@ MIPSTargetCodeGenInfo::initDwarfEHRegSizeTable(CodeGen::CodeGenFunction &CGF,
 }
 
 //===----------------------------------------------------------------------===//
-// Rigel ABI Implementation.  Rigel is big-endian.
+// Rigel ABI Implementation.  Rigel is little-endian.
 //===----------------------------------------------------------------------===//
 
 namespace {
+/// RigelABIInfo - The default ("o32") Rigel ABI passes every aggregate byval
+/// and returns every aggregate through sret, like DefaultABIInfo.  The opt-in
+/// "regstruct" ABI (-mabi=regstruct) instead passes aggregates of up to four
+/// words in A0-A7 and returns aggregates of up to two words in V0/V1.  Since
+/// FP and integer values share registers, all-float aggregates (including
+/// _Complex float) are coerced to floats and everything else to i32s.
+class RigelABIInfo : public ABIInfo {
+  bool IsRegStructABI;
+
+  static const unsigned MaxArgWords = 4;
+  static const unsigned MaxRetWords = 2;
+
+  bool isFloatAggregate(QualType Ty, uint64_t &Members) const;
+  const llvm::Type *getCoerceType(QualType Ty) const;
+
+public:
+  RigelABIInfo(CodeGenTypes &CGT, bool r) : ABIInfo(CGT), IsRegStructABI(r) {}
+
+  ABIArgInfo classifyReturnType(QualType RetTy) const;
+  ABIArgInfo classifyArgumentType(QualType RetTy) const;
+
+  virtual void computeInfo(CGFunctionInfo &FI) const {
+    FI.getReturnInfo() = classifyReturnType(FI.getReturnType());
+    for (CGFunctionInfo::arg_iterator it = FI.arg_begin(), ie = FI.arg_end();
+         it != ie; ++it)
+      it->info = classifyArgumentType(it->type);
+  }
+
+  virtual llvm::Value *EmitVAArg(llvm::Value *VAListAddr, QualType Ty,
+                                 CodeGenFunction &CGF) const {
+    return 0;
+  }
+};
+
 class RigelTargetCodeGenInfo : public TargetCodeGenInfo {
 public:
-  RigelTargetCodeGenInfo(CodeGenTypes &CGT)
-    : TargetCodeGenInfo(new DefaultABIInfo(CGT)) {}
+  RigelTargetCodeGenInfo(CodeGenTypes &CGT, bool IsRegStructABI)
+    : TargetCodeGenInfo(new RigelABIInfo(CGT, IsRegStructABI)) {}
 
   //FIXME will it always be @ r29?
   int getDwarfEHStackPointer(CodeGen::CodeGenModule &CGM) const {
@@ -2614,6 +2648,115 @@ public:
 };
 }
 
+/// isFloatAggregate - Return true if Ty is made up only of floats, counting
+/// them in Members.  Bitfields, C++ bases and anything else disqualify it.
+bool RigelABIInfo::isFloatAggregate(QualType Ty, uint64_t &Members) const {
+  if (const ConstantArrayType *AT = getContext().getAsConstantArrayType(Ty)) {
+    uint64_t EltMembers = 0;
+    if (!isFloatAggregate(AT->getElementType(), EltMembers))
+      return false;
+    Members += EltMembers * AT->getSize().getZExtValue();
+    return true;
+  }
+
+  if (const RecordType *RT = Ty->getAs<RecordType>()) {
+    const RecordDecl *RD = RT->getDecl();
+    if (RD->hasFlexibleArrayMember())
+      return false;
+    if (const CXXRecordDecl *CXXRD = dyn_cast<CXXRecordDecl>(RD))
+      if (CXXRD->getNumBases() || CXXRD->isDynamicClass())
+        return false;
+    for (RecordDecl::field_iterator i = RD->field_begin(), e = RD->field_end();
+         i != e; ++i) {
+      if (i->isBitField() || !isFloatAggregate(i->getType(), Members))
+        return false;
+    }
+    return true;
+  }
+
+  if (const ComplexType *CT = Ty->getAs<ComplexType>()) {
+    if (!CT->getElementType()->isSpecificBuiltinType(BuiltinType::Float))
+      return false;
+    Members += 2;
+    return true;
+  }
+
+  if (Ty->isSpecificBuiltinType(BuiltinType::Float)) {
+    Members += 1;
+    return true;
+  }
+  return false;
+}
+
+/// getCoerceType - The register-sized type(s) an aggregate is passed as.
+const llvm::Type *RigelABIInfo::getCoerceType(QualType Ty) const {
+  llvm::LLVMContext &VMContext = getVMContext();
+  uint64_t Size = getContext().getTypeSize(Ty);
+  uint64_t Words = (Size + 31) / 32;
+
+  const llvm::Type *EltTy = llvm::Type::getInt32Ty(VMContext);
+  uint64_t Members = 0;
+  if (isFloatAggregate(Ty, Members) && Members * 32 == Size)
+    EltTy = llvm::Type::getFloatTy(VMContext);
+
+  if (Words == 1)
+    return EltTy;
+  std::vector<const llvm::Type*> Elts(Words, EltTy);
+  return llvm::StructType::get(VMContext, Elts);
+}
+
+ABIArgInfo RigelABIInfo::classifyArgumentType(QualType Ty) const {
+  if (!isAggregateTypeForABI(Ty)) {
+    // Treat an enum type as its underlying type.
+    if (const EnumType *EnumTy = Ty->getAs<EnumType>())
+      Ty = EnumTy->getDecl()->getIntegerType();
+
+    return (Ty->isPromotableIntegerType() ?
+            ABIArgInfo::getExtend() : ABIArgInfo::getDirect());
+  }
+
+  if (!IsRegStructABI || isRecordWithNonTrivialDestructorOrCopyConstructor(Ty))
+    return ABIArgInfo::getIndirect(0);
+  if (const RecordType *RT = Ty->getAs<RecordType>())
+    if (RT->getDecl()->hasFlexibleArrayMember())
+      return ABIArgInfo::getIndirect(0);
+
+  uint64_t Size = getContext().getTypeSize(Ty);
+  if (Size == 0)
+    return ABIArgInfo::getIgnore();
+  if (Size > MaxArgWords * 32)
+    return ABIArgInfo::getIndirect(0);
+  return ABIArgInfo::getDirect(getCoerceType(Ty));
+}
+
+ABIArgInfo RigelABIInfo::classifyReturnType(QualType RetTy) const {
+  if (RetTy->isVoidType())
+    return ABIArgInfo::getIgnore();
+
+  if (!isAggregateTypeForABI(RetTy)) {
+    // Treat an enum type as its underlying type.
+    if (const EnumType *EnumTy = RetTy->getAs<EnumType>())
+      RetTy = EnumTy->getDecl()->getIntegerType();
+
+    return (RetTy->isPromotableIntegerType() ?
+            ABIArgInfo::getExtend() : ABIArgInfo::getDirect());
+  }
+
+  if (!IsRegStructABI ||
+      isRecordWithNonTrivialDestructorOrCopyConstructor(RetTy))
+    return ABIArgInfo::getIndirect(0);
+  if (const RecordType *RT = RetTy->getAs<RecordType>())
+    if (RT->getDecl()->hasFlexibleArrayMember())
+      return ABIArgInfo::getIndirect(0);
+
+  uint64_t Size = getContext().getTypeSize(RetTy);
+  if (Size == 0)
+    return ABIArgInfo::getIgnore();
+  if (Size > MaxRetWords * 32)
+    return ABIArgInfo::getIndirect(0);
+  return ABIArgInfo::getDirect(getCoerceType(RetTy));
+}
+
 bool
 RigelTargetCodeGenInfo::initDwarfEHRegSizeTable(CodeGen::CodeGenFunction &CGF,
                                                llvm::Value *Address) const {
@@ -2654,7 +2797,8 @@ const TargetCodeGenInfo &CodeGenModule::getTargetCodeGenInfo() {
     return *(TheTargetCodeGenInfo = new MIPSTargetCodeGenInfo(Types));
 
   case llvm::Triple::rigel:
-    return *(TheTargetCodeGenInfo = new RigelTargetCodeGenInfo(Types));
+    return *(TheTargetCodeGenInfo = new RigelTargetCodeGenInfo(Types,
+                  strcmp(getContext().Target.getABI(), "regstruct") == 0));
 
   case llvm::Triple::arm:
   case llvm::Triple::thumb:
@@ -1189,6 +1189,9 @@ RigelToolChain::RigelToolChain(const HostInfo &Host, const llvm::Triple& Triple)
     getProgramPaths().push_back(Path);
   }
 
+  // -flto runs llvm-link, opt and llc; use the ones that came with this clang.
+  getProgramPaths().push_back(getDriver().Dir);
+
   // Target library directory
   Path = RigelInstall + "/target/lib";
   if (llvm::sys::Path(Path).exists()) {
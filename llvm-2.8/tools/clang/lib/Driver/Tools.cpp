@@ -22,12 +22,14 @@
 #include "clang/Driver/ToolChain.h"
 #include "clang/Driver/Util.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/System/Host.h"
+#include "llvm/System/Path.h"
 #include "llvm/System/Process.h"
 
 #include "InputInfo.h"
@@ -557,6 +559,44 @@ void Clang::AddMIPSTargetArgs(const ArgList &Args,
   }
 }
 
+/// getRigelProfileUseFile - Return the edge profile named by -fprofile-use[=],
+/// or null if there is none.  A bare -fprofile-use reads llvmprof.out, where
+/// the profiling runtime writes it.
+static const char *getRigelProfileUseFile(const ArgList &Args) {
+  const Arg *A = Args.getLastArg(options::OPT_fprofile_use,
+                                 options::OPT_fprofile_use_EQ);
+  if (!A)
+    return 0;
+  if (A->getOption().matches(options::OPT_fprofile_use_EQ))
+    return A->getValue(Args);
+  return "llvmprof.out";
+}
+
+void Clang::AddRigelTargetArgs(const ArgList &Args,
+                               ArgStringList &CmdArgs) const {
+  const Driver &D = getToolChain().getDriver();
+
+  // Select the ABI to use.  Only pass it along if asked for, so that the
+  // default stays with RigelTargetInfo.
+  if (Arg *A = Args.getLastArg(options::OPT_mabi_EQ)) {
+    CmdArgs.push_back("-target-abi");
+    CmdArgs.push_back(A->getValue(Args));
+  }
+
+  // Honor -mdouble=.  Rigel only has single-precision hardware, so
+  // -mdouble=32 makes double and long double IEEE single instead of
+  // emulating them in software.
+  if (Arg *A = Args.getLastArg(options::OPT_mdouble_EQ)) {
+    llvm::StringRef Width = A->getValue(Args);
+    if (Width == "32") {
+      CmdArgs.push_back("-target-feature");
+      CmdArgs.push_back("+double32");
+    } else if (Width != "64")
+      D.Diag(clang::diag::err_drv_invalid_value)
+        << A->getAsString(Args) << Width;
+  }
+}
+
 void Clang::AddX86TargetArgs(const ArgList &Args,
                              ArgStringList &CmdArgs) const {
   if (!Args.hasFlag(options::OPT_mred_zone,
@@ -920,6 +960,22 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     AddMIPSTargetArgs(Args, CmdArgs);
     break;
 
+  case llvm::Triple::rigel:
+    AddRigelTargetArgs(Args, CmdArgs);
+    // The edge profile numbers the edges of the whole program, and the
+    // counters are only registered from main's module, so bitcode for -flto
+    // is instrumented, or gets its profile, when it is linked; see
+    // rigel::Link::ConstructLTOJobs.  Code compiled straight to an object
+    // can't take part.
+    if ((isa<CompileJobAction>(JA) || isa<AssembleJobAction>(JA)) &&
+        JA.getType() != types::TY_LTO_BC && JA.getType() != types::TY_LTO_IR)
+      if (const Arg *A = Args.getLastArg(options::OPT_fprofile_generate,
+                                         options::OPT_fprofile_use,
+                                         options::OPT_fprofile_use_EQ))
+        D.Diag(clang::diag::err_drv_argument_only_allowed_with)
+          << A->getAsString(Args) << "-flto";
+    break;
+
   case llvm::Triple::x86:
   case llvm::Triple::x86_64:
     AddX86TargetArgs(Args, CmdArgs);
@@ -3315,6 +3371,9 @@ void rigel::Link::ConstructJob(Compilation &C, const JobAction &JA,
   */
 
   CmdArgs.push_back("-EL");
+  // Gathers .text.hot and .text.unlikely ahead of the rest of .text.
+  CmdArgs.push_back("-m");
+  CmdArgs.push_back("elf32elrigel");
 
   Args.AddAllArgs(CmdArgs, options::OPT_L);
   Args.AddAllArgs(CmdArgs, options::OPT_T_Group);
@@ -3343,30 +3402,71 @@ void rigel::Link::ConstructJob(Compilation &C, const JobAction &JA,
   //6) compiler_rt.a and other sub-libc libraries -- libc may depend on libcompiler_rt for some
   //                                                 things, like 64-bit datatype handling.
 
-  if (!Args.hasArg(options::OPT_nostdlib) &&
-      !Args.hasArg(options::OPT_nostartfiles)) {
+  bool LinkStartFiles = !Args.hasArg(options::OPT_nostdlib) &&
+                        !Args.hasArg(options::OPT_nostartfiles);
+  bool LinkDefaultLibs = !Args.hasArg(options::OPT_nostdlib) &&
+                         !Args.hasArg(options::OPT_nodefaultlibs);
+  if (LinkStartFiles) {
       CmdArgs.push_back(
             Args.MakeArgString(getToolChain().GetFilePath("rigel-crt0-mp.ro")));
   }
 
   getRigelToolChain().AddLinkSearchPathArgs(Args, CmdArgs);
 
+  //rigelld can't read bitcode.  Under -flto (or -O4), bitcode inputs --
+  //including objects built earlier with -flto -c, which have a .o/.ro
+  //extension but bitcode contents -- are pulled out here and turned into a
+  //native object by ConstructLTOJobs() (one per partition with
+  //-flto-partitions=N).  The objects take the place of the first bitcode
+  //input; native objects and archives are linked as usual.
+  bool DoLTO = Args.hasArg(options::OPT_flto);
+  if (const Arg *A = Args.getLastArg(options::OPT_O_Group))
+    DoLTO |= A->getOption().matches(options::OPT_O4);
+
+  ArgStringList BitcodeInputs;
+  unsigned LTOObjectPos = 0;
+  //The runtime linked after the inputs (crt0, libc, libsim, compiler_rt and
+  //the -pthread/-fprofile-generate libraries) always stays native; LTO never
+  //sees or inlines it.  The few symbols it calls back into are known and are
+  //kept public by ConstructLTOJobs, so it doesn't count as a native input.
+  bool HasNativeInputs = false;
   for (InputInfoList::const_iterator
          it = Inputs.begin(), ie = Inputs.end(); it != ie; ++it) {
     const InputInfo &II = *it;
 
-    // Don't try to pass LLVM inputs to a generic gcc.
-    if (II.getType() == types::TY_LLVM_IR || II.getType() == types::TY_LTO_IR ||
-        II.getType() == types::TY_LLVM_BC || II.getType() == types::TY_LTO_BC)
-      D.Diag(clang::diag::err_drv_no_linker_llvm_support)
-        << getToolChain().getTripleString();
+    bool IsBitcode =
+      II.getType() == types::TY_LLVM_IR || II.getType() == types::TY_LTO_IR ||
+      II.getType() == types::TY_LLVM_BC || II.getType() == types::TY_LTO_BC;
+    if (DoLTO && !IsBitcode && II.isFilename() &&
+        II.getType() == types::TY_Object)
+      IsBitcode = llvm::sys::Path(II.getFilename()).isBitcodeFile();
 
+    if (IsBitcode) {
+      if (!DoLTO) {
+        D.Diag(clang::diag::err_drv_no_linker_llvm_support)
+          << getToolChain().getTripleString();
+      } else {
+        if (BitcodeInputs.empty())
+          LTOObjectPos = CmdArgs.size();
+        BitcodeInputs.push_back(II.getFilename());
+        continue;
+      }
+    }
+
+    HasNativeInputs = true;
     if (II.isFilename())
       CmdArgs.push_back(II.getFilename());
     else
       II.getInputArg().renderAsInput(Args, CmdArgs);
   }
 
+  if (!BitcodeInputs.empty()) {
+    ArgStringList LTOObjects;
+    ConstructLTOJobs(C, JA, BitcodeInputs, HasNativeInputs, Args, LTOObjects);
+    CmdArgs.insert(CmdArgs.begin() + LTOObjectPos,
+                   LTOObjects.begin(), LTOObjects.end());
+  }
+
   if (Args.hasArg(options::OPT_pthread))
     CmdArgs.push_back("-lpthread");
 
@@ -3382,22 +3482,29 @@ void rigel::Link::ConstructJob(Compilation &C, const JobAction &JA,
 		CmdArgs.push_back("-lm"); //I think you're always supposed to link libm for C++ programs.
 	}
 
+  //-fprofile-generate code calls into LLVM's profiling runtime, which in turn
+  //needs libc to write llvmprof.out.
+  if (Args.hasArg(options::OPT_fprofile_generate))
+    CmdArgs.push_back("-lprofile_rt");
+
 	//If -pthread was passed and we didn't already pass it as part of C++ support, add
 	//-lpthread
 	if (Args.hasArg(options::OPT_pthread && !getToolChain().getDriver().CCCIsCXX))
 	  CmdArgs.push_back("-lpthread");
-	//libc
-  CmdArgs.push_back(
-          Args.MakeArgString(getToolChain().GetFilePath("libc.a")));
-  //libsim is the output of libgloss, which is a shim layer between libc and the bare metal
-	//(it mostly provides syscall stubs).
-	//We link this unconditionally now, but it would be good to plug different libgloss' in if
-	//we ever get an FPGA, substantially different functional simulator, or ASIC target.
-  CmdArgs.push_back(
-          Args.MakeArgString(getToolChain().GetFilePath("libsim.a")));
-
-	//This should add -lcompiler_rt.
-  getRigelToolChain().AddLinkRuntimeLibArgs(Args, CmdArgs);
+  if (LinkDefaultLibs) {
+    //libc
+    CmdArgs.push_back(
+            Args.MakeArgString(getToolChain().GetFilePath("libc.a")));
+    //libsim is the output of libgloss, which is a shim layer between libc and
+    //the bare metal (it mostly provides syscall stubs).  It would be good to
+    //plug different libgloss' in if we ever get an FPGA, substantially
+    //different functional simulator, or ASIC target.
+    CmdArgs.push_back(
+            Args.MakeArgString(getToolChain().GetFilePath("libsim.a")));
+
+    //This should add -lcompiler_rt.
+    getRigelToolChain().AddLinkRuntimeLibArgs(Args, CmdArgs);
+  }
 
   //TODO no idea how to handle these
   /*
@@ -3467,6 +3574,163 @@ void rigel::Link::ConstructJob(Compilation &C, const JobAction &JA,
   C.addCommand(new Command(JA, *this, Exec, CmdArgs));
 }
 
+/// RigelLibcCallbacks - Functions libc calls that a program may define to
+/// replace libc's own.  When the default libraries are linked, a definition
+/// in the bitcode must stay public so libc's calls still reach it.
+static const char *const RigelLibcCallbacks[] = {
+  "malloc", "free", "calloc", "realloc", "memalign"
+};
+
+/// RigelCXXRTCallbacks - Likewise for the replaceable global operator new
+/// and delete, called from libcxxrt.
+static const char *const RigelCXXRTCallbacks[] = {
+  "_Znwj", "_Znaj", "_ZdlPv", "_ZdaPv"
+};
+
+/// ConstructLTOJobs - Link the bitcode inputs into one module, internalize
+/// everything but main, anything named with -u and the runtime callbacks
+/// above, so the IPO passes can inline and drop it freely, then code
+/// generate and assemble the result.  The driver can't see what native
+/// objects, archives or -l libraries on the command line reference, so when
+/// any are given (HasNativeInputs) nothing is internalized.
+/// With -flto-partitions=N, llc generates code for N pieces of the module in
+/// parallel and each is assembled separately.  The resulting object files are
+/// added to Objects.
+void rigel::Link::ConstructLTOJobs(Compilation &C, const JobAction &JA,
+                                   const ArgStringList &BitcodeInputs,
+                                   bool HasNativeInputs,
+                                   const ArgList &Args,
+                                   ArgStringList &Objects) const {
+  const Driver &D = getToolChain().getDriver();
+  const ToolChain &TC = getToolChain();
+
+  unsigned Partitions = 1;
+  if (const Arg *A = Args.getLastArg(options::OPT_flto_partitions_EQ)) {
+    if (llvm::StringRef(A->getValue(Args)).getAsInteger(10, Partitions) ||
+        Partitions == 0) {
+      D.Diag(clang::diag::err_drv_invalid_value)
+        << A->getAsString(Args) << A->getValue(Args);
+      Partitions = 1;
+    }
+  }
+
+  const char *LinkedBC =
+    C.addTempFile(Args.MakeArgString(D.GetTemporaryPath("bc")));
+  const char *OptBC =
+    C.addTempFile(Args.MakeArgString(D.GetTemporaryPath("bc")));
+  const char *Asm = Args.MakeArgString(D.GetTemporaryPath("s"));
+
+  //1) llvm-link all of the bitcode into one module.
+  ArgStringList LinkArgs;
+  LinkArgs.push_back("-o");
+  LinkArgs.push_back(LinkedBC);
+  LinkArgs.append(BitcodeInputs.begin(), BitcodeInputs.end());
+  C.addCommand(new Command(JA, *this,
+                           Args.MakeArgString(TC.GetProgramPath("llvm-link")),
+                           LinkArgs));
+
+  //2) Internalize and run the standard link-time IPO pipeline.
+  ArgStringList OptArgs;
+  OptArgs.push_back("-std-link-opts");
+  if (HasNativeInputs) {
+    // Anything defined in bitcode may be what a native input links against.
+    OptArgs.push_back("-disable-internalize");
+    Args.ClaimAllArgs(options::OPT_u);
+  } else {
+    // crt0 calls main; with -nostartfiles the program's own startup code
+    // still has to.
+    std::string PublicAPI = "-internalize-public-api-list=main";
+    if (!Args.hasArg(options::OPT_nostdlib) &&
+        !Args.hasArg(options::OPT_nodefaultlibs)) {
+      for (unsigned i = 0, e = llvm::array_lengthof(RigelLibcCallbacks);
+           i != e; ++i) {
+        PublicAPI += ",";
+        PublicAPI += RigelLibcCallbacks[i];
+      }
+      if (D.CCCIsCXX)
+        for (unsigned i = 0, e = llvm::array_lengthof(RigelCXXRTCallbacks);
+             i != e; ++i) {
+          PublicAPI += ",";
+          PublicAPI += RigelCXXRTCallbacks[i];
+        }
+    }
+    for (arg_iterator it = Args.filtered_begin(options::OPT_u),
+           ie = Args.filtered_end(); it != ie; ++it) {
+      (*it)->claim();
+      PublicAPI += ",";
+      PublicAPI += (*it)->getValue(Args);
+    }
+    OptArgs.push_back(Args.MakeArgString(PublicAPI));
+  }
+  // Instrument, or attach the profile, after the IPO passes, so both builds
+  // see the same CFG.
+  if (Args.hasArg(options::OPT_fprofile_generate)) {
+    OptArgs.push_back("-insert-edge-profiling");
+  } else if (const char *Profile = getRigelProfileUseFile(Args)) {
+    OptArgs.push_back("-profile-metadata-loader");
+    OptArgs.push_back(Args.MakeArgString(
+                        llvm::Twine("-profile-metadata-file=") + Profile));
+  }
+  OptArgs.push_back("-o");
+  OptArgs.push_back(OptBC);
+  OptArgs.push_back(LinkedBC);
+  C.addCommand(new Command(JA, *this,
+                           Args.MakeArgString(TC.GetProgramPath("opt")),
+                           OptArgs));
+
+  //3) Code generate the merged module once.  With partitions, llc writes
+  //   <Asm>.0 ... <Asm>.N-1 instead of <Asm>.
+  ArgStringList LLCArgs;
+  LLCArgs.push_back("-march=rigel");
+  LLCArgs.push_back("-relocation-model=static");
+  const char *OptLevel = "-O2";
+  if (const Arg *A = Args.getLastArg(options::OPT_O_Group)) {
+    if (A->getOption().matches(options::OPT_O4))
+      OptLevel = "-O3";
+    else if (A->getOption().matches(options::OPT_O0))
+      OptLevel = "-O0";
+    else if (A->getOption().matches(options::OPT_O)) {
+      llvm::StringRef Level = A->getValue(Args);
+      if (Level == "0" || Level == "1" || Level == "3")
+        OptLevel = Args.MakeArgString("-O" + Level);
+    }
+  }
+  LLCArgs.push_back(OptLevel);
+  // Keep per-function and per-object sections in the LTO object too, so that
+  // -Wl,--gc-sections can still drop whatever the IPO passes left behind.
+  Args.AddAllArgs(LLCArgs, options::OPT_ffunction_sections);
+  Args.AddAllArgs(LLCArgs, options::OPT_fdata_sections);
+  if (Partitions > 1)
+    LLCArgs.push_back(Args.MakeArgString("-codegen-partitions=" +
+                                         llvm::Twine(Partitions)));
+  LLCArgs.push_back("-o");
+  LLCArgs.push_back(Asm);
+  LLCArgs.push_back(OptBC);
+  C.addCommand(new Command(JA, *this,
+                           Args.MakeArgString(TC.GetProgramPath("llc")),
+                           LLCArgs));
+
+  //4) Assemble each piece, the same way rigel::Assemble does.
+  const char *As = Args.MakeArgString(TC.GetProgramPath("rigelas"));
+  for (unsigned i = 0; i != Partitions; ++i) {
+    const char *PartAsm = Asm;
+    if (Partitions > 1)
+      PartAsm = Args.MakeArgString(llvm::Twine(Asm) + "." + llvm::Twine(i));
+    C.addTempFile(PartAsm);
+    const char *Obj =
+      C.addTempFile(Args.MakeArgString(D.GetTemporaryPath("o")));
+
+    ArgStringList AsArgs;
+    AsArgs.push_back("-EL");
+    AsArgs.push_back("-march=mipsrigel32");
+    AsArgs.push_back("-o");
+    AsArgs.push_back(Obj);
+    AsArgs.push_back(PartAsm);
+    C.addCommand(new Command(JA, *this, As, AsArgs));
+    Objects.push_back(Obj);
+  }
+}
+
 void visualstudio::Link::ConstructJob(Compilation &C, const JobAction &JA,
                                       const InputInfo &Output,
                                       const InputInfoList &Inputs,
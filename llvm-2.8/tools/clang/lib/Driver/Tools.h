@@ -37,6 +37,7 @@ namespace tools {
 
     void AddARMTargetArgs(const ArgList &Args, ArgStringList &CmdArgs) const;
     void AddMIPSTargetArgs(const ArgList &Args, ArgStringList &CmdArgs) const;
+    void AddRigelTargetArgs(const ArgList &Args, ArgStringList &CmdArgs) const;
     void AddX86TargetArgs(const ArgList &Args, ArgStringList &CmdArgs) const;
 
   public:
@@ -482,6 +483,14 @@ namespace rigel {
                               const InputInfoList &Inputs,
                               const ArgList &TCArgs,
                               const char *LinkingOutput) const;
+
+  private:
+    void ConstructLTOJobs(Compilation &C, const JobAction &JA,
+                          const ArgStringList &BitcodeInputs,
+                          bool HasNativeInputs,
+                          const ArgList &Args, ArgStringList &Objects) const;
+
+  public:
     //TODO: This code is duplicated in the Assemble and Link classes.
     //Darwin does it by having a single DarwinTool class that the Assemble, Link, ...
     //tools inherit from.  We could do that.
@@ -159,6 +159,10 @@ static void CodeGenOptsToArgs(const CodeGenOptions &Opts,
     Res.push_back("-fdata-sections");
   if (Opts.FunctionSections)
     Res.push_back("-ffunction-sections");
+  if (Opts.EmitEdgeProfile)
+    Res.push_back("-fprofile-generate");
+  if (!Opts.ProfileUseFile.empty())
+    Res.push_back("-fprofile-use=" + Opts.ProfileUseFile);
   if (Opts.AsmVerbose)
     Res.push_back("-masm-verbose");
   if (!Opts.CodeModel.empty()) {
@@ -875,6 +879,9 @@ static void ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args,
   Opts.FunctionSections = Args.hasArg(OPT_ffunction_sections);
   Opts.DataSections = Args.hasArg(OPT_fdata_sections);
 
+  Opts.EmitEdgeProfile = Args.hasArg(OPT_fprofile_generate);
+  Opts.ProfileUseFile = Args.getLastArgValue(OPT_fprofile_use_EQ);
+
   Opts.MainFileName = Args.getLastArgValue(OPT_main_file_name);
   Opts.VerifyModule = !Args.hasArg(OPT_disable_llvm_verifier);
 
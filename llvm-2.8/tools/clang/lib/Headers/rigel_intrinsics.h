@@ -0,0 +1,227 @@
+/*===---- rigel_intrinsics.h - Rigel ISA extensions ------------------------===
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ *===-----------------------------------------------------------------------===
+ */
+
+#ifndef __RIGEL_INTRINSICS_H
+#define __RIGEL_INTRINSICS_H
+
+#ifndef __RIGEL__
+#error "rigel_intrinsics.h is only available when targeting Rigel"
+#else
+
+#define __RIGEL_INLINE \
+  static __inline__ __attribute__((__always_inline__, __nodebug__))
+
+/* Special registers and timers.  The register number passed to rigel_mfsr
+   and rigel_mtsr must be a constant in [0, 31]. */
+__RIGEL_INLINE unsigned
+rigel_coreid(void)
+{
+  return __builtin_rigel_coreid();
+}
+
+__RIGEL_INLINE unsigned
+rigel_clusterid(void)
+{
+  return __builtin_rigel_clusterid();
+}
+
+__RIGEL_INLINE unsigned
+rigel_numthreads(void)
+{
+  return __builtin_rigel_numthreads();
+}
+
+__RIGEL_INLINE unsigned
+rigel_cycles(void)
+{
+  return __builtin_rigel_cycles();
+}
+
+#define rigel_mfsr(sr) __builtin_rigel_mfsr(sr)
+#define rigel_mtsr(sr, val) __builtin_rigel_mtsr((sr), (val))
+
+/* Waiting.  The mode/code operands must be constants. */
+#define rigel_sleep(cycles, mode) __builtin_rigel_sleep((cycles), (mode))
+#define rigel_event(val, code) __builtin_rigel_event((val), (code))
+#define rigel_prio(val, prio) __builtin_rigel_prio((val), (prio))
+
+/* Global memory.  These go straight to the global cache, bypassing the
+   cluster cache. */
+__RIGEL_INLINE unsigned
+rigel_gload(volatile const unsigned *__p)
+{
+  return __builtin_rigel_gldw(__p);
+}
+
+__RIGEL_INLINE void
+rigel_gstore(volatile unsigned *__p, unsigned __v)
+{
+  __builtin_rigel_gstw(__p, __v);
+}
+
+__RIGEL_INLINE void
+rigel_bcast_update(volatile unsigned *__p, unsigned __v)
+{
+  __builtin_rigel_bcast_update(__p, __v);
+}
+
+__RIGEL_INLINE void
+rigel_bcast_inv(volatile void *__p)
+{
+  __builtin_rigel_bcast_inv(__p);
+}
+
+/* Atomics.  All of them return the value that was in memory beforehand. */
+__RIGEL_INLINE int
+rigel_atom_add(volatile int *__p, int __v)
+{
+  return __builtin_rigel_atom_add(__p, __v);
+}
+
+__RIGEL_INLINE int
+rigel_atom_and(volatile int *__p, int __v)
+{
+  return __builtin_rigel_atom_and(__p, __v);
+}
+
+__RIGEL_INLINE int
+rigel_atom_or(volatile int *__p, int __v)
+{
+  return __builtin_rigel_atom_or(__p, __v);
+}
+
+__RIGEL_INLINE int
+rigel_atom_xor(volatile int *__p, int __v)
+{
+  return __builtin_rigel_atom_xor(__p, __v);
+}
+
+__RIGEL_INLINE int
+rigel_atom_min(volatile int *__p, int __v)
+{
+  return __builtin_rigel_atom_min(__p, __v);
+}
+
+__RIGEL_INLINE int
+rigel_atom_max(volatile int *__p, int __v)
+{
+  return __builtin_rigel_atom_max(__p, __v);
+}
+
+__RIGEL_INLINE int
+rigel_atom_xchg(volatile int *__p, int __v)
+{
+  return __builtin_rigel_atom_xchg(__p, __v);
+}
+
+__RIGEL_INLINE int
+rigel_atom_cas(volatile int *__p, int __old, int __new)
+{
+  return __builtin_rigel_atom_cas(__p, __old, __new);
+}
+
+__RIGEL_INLINE int
+rigel_atom_inc(volatile int *__p)
+{
+  return __builtin_rigel_atom_inc(__p);
+}
+
+__RIGEL_INLINE int
+rigel_atom_dec(volatile int *__p)
+{
+  return __builtin_rigel_atom_dec(__p);
+}
+
+/* Cluster cache control and prefetch, on the line holding the address. */
+__RIGEL_INLINE void
+rigel_line_wb(volatile const void *__p)
+{
+  __builtin_rigel_line_wb(__p);
+}
+
+__RIGEL_INLINE void
+rigel_line_inv(volatile const void *__p)
+{
+  __builtin_rigel_line_inv(__p);
+}
+
+__RIGEL_INLINE void
+rigel_line_flush(volatile const void *__p)
+{
+  __builtin_rigel_line_flush(__p);
+}
+
+__RIGEL_INLINE void
+rigel_prefetch(volatile const void *__p)
+{
+  __builtin_rigel_pref_l(__p);
+}
+
+__RIGEL_INLINE void
+rigel_prefetch_noalloc(volatile const void *__p)
+{
+  __builtin_rigel_pref_nga(__p);
+}
+
+/* Hardware task queue.  Every operation returns the queue's status word. */
+typedef struct rigel_task {
+  unsigned v1, v2, v3, v4;
+} rigel_task_t;
+
+__RIGEL_INLINE int
+rigel_tq_init(unsigned __max_tasks)
+{
+  return __builtin_rigel_tq_init(__max_tasks);
+}
+
+__RIGEL_INLINE int
+rigel_tq_end(void)
+{
+  return __builtin_rigel_tq_end();
+}
+
+__RIGEL_INLINE int
+rigel_tq_enqueue(const rigel_task_t *__t)
+{
+  return __builtin_rigel_tq_enqueue(__t->v1, __t->v2, __t->v3, __t->v4);
+}
+
+/* Enqueue __total iterations of the task in chunks of __per_task.  Only the
+   first two words of the task are passed along. */
+__RIGEL_INLINE int
+rigel_tq_loop(const rigel_task_t *__t, unsigned __total, unsigned __per_task)
+{
+  return __builtin_rigel_tq_loop(__t->v1, __t->v2, __total, __per_task);
+}
+
+__RIGEL_INLINE int
+rigel_tq_dequeue(rigel_task_t *__t)
+{
+  return __builtin_rigel_tq_dequeue(&__t->v1);
+}
+
+#undef __RIGEL_INLINE
+
+#endif /* __RIGEL__ */
+
+#endif /* __RIGEL_INTRINSICS_H */
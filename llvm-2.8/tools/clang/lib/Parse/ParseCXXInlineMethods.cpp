@@ -45,6 +45,7 @@ Decl *Parser::ParseCXXInlineMethodDef(AccessSpecifier AS, Declarator &D,
 
   // Consume the tokens and store them for later parsing.
 
+  DiagnoseUnusedPragmaParallelFor();
   getCurrentClass().MethodDefs.push_back(LexedMethod(FnD));
   getCurrentClass().MethodDefs.back().TemplateScope
     = getCurScope()->isTemplateParamScope();
@@ -83,6 +84,17 @@ Decl *Parser::ParseCXXInlineMethodDef(AccessSpecifier AS, Declarator &D,
     }
   }
 
+  // Pragmas are acted on as the body is cached, long before the body is
+  // parsed, so '#pragma rigel parallel for' can't find its loop in here.
+  SourceLocation ParallelForLoc = Actions.TakePragmaParallelFor();
+  if (ParallelForLoc.isValid()) {
+    if (PP.getSourceManager().isBeforeInTranslationUnit(
+          ParallelForLoc, Toks.back().getLocation()))
+      Diag(ParallelForLoc, diag::warn_pragma_parallel_for_inline_method);
+    else
+      Actions.ActOnPragmaParallelFor(ParallelForLoc);
+  }
+
   return FnD;
 }
 
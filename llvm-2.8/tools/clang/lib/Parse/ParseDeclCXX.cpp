@@ -1648,6 +1648,7 @@ void Parser::ParseCXXMemberSpecification(SourceLocation RecordLoc,
       ParseCXXClassMemberDeclaration(CurAS);
     }
 
+    DiagnoseUnusedPragmaParallelFor();
     RBraceLoc = MatchRHSPunctuation(tok::r_brace, LBraceLoc);
   } else {
     SkipUntil(tok::r_brace, false, false);
@@ -296,6 +296,33 @@ void PragmaUnusedHandler::HandlePragma(Preprocessor &PP, Token &UnusedTok) {
                             parser.getCurScope(), UnusedLoc, LParenLoc, RParenLoc);
 }
 
+// #pragma rigel parallel for
+void PragmaRigelParallelHandler::HandlePragma(Preprocessor &PP,
+                                              Token &ParallelTok) {
+  SourceLocation ParallelLoc = ParallelTok.getLocation();
+
+  Token Tok;
+  PP.Lex(Tok);
+  if (Tok.isNot(tok::kw_for)) {
+    PP.Diag(Tok.getLocation(), diag::warn_pragma_parallel_expected_for);
+    return;
+  }
+
+  PP.Lex(Tok);
+  if (Tok.isNot(tok::eom)) {
+    PP.Diag(Tok.getLocation(), diag::warn_pragma_extra_tokens_at_eol)
+      << "rigel parallel for";
+    return;
+  }
+
+  // Two in a row: the first one has no loop.
+  SourceLocation PrevLoc = Actions.TakePragmaParallelFor();
+  if (PrevLoc.isValid())
+    PP.Diag(PrevLoc, diag::warn_pragma_parallel_for_not_loop);
+
+  Actions.ActOnPragmaParallelFor(ParallelLoc);
+}
+
 // #pragma weak identifier
 // #pragma weak identifier '=' identifier
 void PragmaWeakHandler::HandlePragma(Preprocessor &PP, Token &WeakTok) {
@@ -65,6 +65,15 @@ public:
   virtual void HandlePragma(Preprocessor &PP, Token &FirstToken);
 };
 
+class PragmaRigelParallelHandler : public PragmaHandler {
+  Sema &Actions;
+public:
+  explicit PragmaRigelParallelHandler(Sema &A)
+    : PragmaHandler("parallel"), Actions(A) {}
+
+  virtual void HandlePragma(Preprocessor &PP, Token &FirstToken);
+};
+
 class PragmaWeakHandler : public PragmaHandler {
   Sema &Actions;
 public:
@@ -86,6 +86,13 @@ Parser::ParseStatementOrDeclaration(bool OnlyStatement) {
     Attr = ParseCXX0XAttributes();
   llvm::OwningPtr<AttributeList> AttrList(Attr.AttrList);
 
+  // '#pragma rigel parallel for' applies to the statement right after it.
+  SourceLocation ParallelForLoc = Actions.TakePragmaParallelFor();
+  if (ParallelForLoc.isValid() && Tok.isNot(tok::kw_for)) {
+    Diag(ParallelForLoc, diag::warn_pragma_parallel_for_not_loop);
+    ParallelForLoc = SourceLocation();
+  }
+
   // Cases in this switch statement should fall through if the parser expects
   // the token to end in a semicolon (in which case SemiError should be set),
   // or they directly 'return;' if not.
@@ -163,7 +170,10 @@ Parser::ParseStatementOrDeclaration(bool OnlyStatement) {
     SemiError = "do/while";
     break;
   case tok::kw_for:                 // C99 6.8.5.3: for-statement
-    return ParseForStatement(AttrList.take());
+    Res = ParseForStatement(AttrList.take());
+    if (ParallelForLoc.isValid() && !Res.isInvalid())
+      Actions.ActOnParallelForStmt(ParallelForLoc, Res.get());
+    return move(Res);
 
   case tok::kw_goto:                // C99 6.8.6.1: goto-statement
     Res = ParseGotoStatement(AttrList.take());
@@ -516,6 +526,8 @@ StmtResult Parser::ParseCompoundStatementBody(bool isStmtExpr) {
       Stmts.push_back(R.release());
   }
 
+  DiagnoseUnusedPragmaParallelFor();
+
   // We broke out of the while loop because we found a '}' or EOF.
   if (Tok.isNot(tok::r_brace)) {
     Diag(Tok, diag::err_expected_rbrace);
@@ -528,6 +540,15 @@ StmtResult Parser::ParseCompoundStatementBody(bool isStmtExpr) {
                                    isStmtExpr);
 }
 
+/// DiagnoseUnusedPragmaParallelFor - A '#pragma rigel parallel for' that is
+/// still pending at the end of a block, class or file has no loop to apply
+/// to.  Warn and drop it, so that it doesn't attach to some later loop.
+void Parser::DiagnoseUnusedPragmaParallelFor() {
+  SourceLocation ParallelForLoc = Actions.TakePragmaParallelFor();
+  if (ParallelForLoc.isValid())
+    Diag(ParallelForLoc, diag::warn_pragma_parallel_for_not_loop);
+}
+
 /// ParseParenExprOrCondition:
 /// [C  ]     '(' expression ')'
 /// [C++]     '(' condition ')'       [not allowed if OnlyAllowCondition=true]
@@ -16,6 +16,8 @@
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Scope.h"
 #include "clang/Sema/ParsedTemplate.h"
+#include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/Support/raw_ostream.h"
 #include "RAIIObjectsForParser.h"
 #include "ParsePragma.h"
@@ -50,6 +52,11 @@ Parser::Parser(Preprocessor &pp, Sema &actions)
 
   WeakHandler.reset(new PragmaWeakHandler(actions));
   PP.AddPragmaHandler(WeakHandler.get());
+
+  if (PP.getTargetInfo().getTriple().getArch() == llvm::Triple::rigel) {
+    RigelParallelHandler.reset(new PragmaRigelParallelHandler(actions));
+    PP.AddPragmaHandler("rigel", RigelParallelHandler.get());
+  }
       
   PP.setCodeCompletionHandler(*this);
 }
@@ -318,6 +325,10 @@ Parser::~Parser() {
   UnusedHandler.reset();
   PP.RemovePragmaHandler(WeakHandler.get());
   WeakHandler.reset();
+  if (RigelParallelHandler) {
+    PP.RemovePragmaHandler("rigel", RigelParallelHandler.get());
+    RigelParallelHandler.reset();
+  }
   PP.clearCodeCompletionHandler();
 }
 
@@ -360,6 +371,7 @@ void Parser::Initialize() {
 bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
   Result = DeclGroupPtrTy();
   if (Tok.is(tok::eof)) {
+    DiagnoseUnusedPragmaParallelFor();
     Actions.ActOnEndOfTranslationUnit();
     return true;
   }
@@ -411,6 +423,8 @@ void Parser::ParseTranslationUnit() {
 Parser::DeclGroupPtrTy Parser::ParseExternalDeclaration(CXX0XAttributeList Attr,
                                                         ParsingDeclSpec *DS) {
   ParenBraceBracketBalancer BalancerRAIIObj(*this);
+
+  DiagnoseUnusedPragmaParallelFor();
   
   Decl *SingleDecl = 0;
   switch (Tok.getKind()) {
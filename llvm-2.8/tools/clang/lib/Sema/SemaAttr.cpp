@@ -349,6 +349,27 @@ void Sema::ActOnPragmaVisibility(bool IsPush, const IdentifierInfo* VisType,
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Pragma 'rigel parallel for'
+//===----------------------------------------------------------------------===//
+
+void Sema::ActOnPragmaParallelFor(SourceLocation PragmaLoc) {
+  PragmaParallelForLoc = PragmaLoc;
+}
+
+SourceLocation Sema::TakePragmaParallelFor() {
+  SourceLocation Loc = PragmaParallelForLoc;
+  PragmaParallelForLoc = SourceLocation();
+  return Loc;
+}
+
+void Sema::ActOnParallelForStmt(SourceLocation PragmaLoc, Stmt *S) {
+  // The Rigel backend outlines the loop and hands its iterations to the
+  // hardware task queue; it checks whether it actually can.
+  if (ForStmt *FS = dyn_cast_or_null<ForStmt>(S))
+    Context.setParallelForLoop(FS);
+}
+
 void Sema::PushVisibilityAttr(const VisibilityAttr *Attr) {
   PushPragmaVisibility(*this, Attr->getVisibility(), Attr->getLocation());
 }
@@ -222,6 +222,10 @@ Sema::CheckBuiltinFunctionCall(unsigned BuiltinID, CallExpr *TheCall) {
         if (CheckX86BuiltinFunctionCall(BuiltinID, TheCall))
           return ExprError();
         break;
+      case llvm::Triple::rigel:
+        if (CheckRigelBuiltinFunctionCall(BuiltinID, TheCall))
+          return ExprError();
+        break;
       default:
         break;
     }
@@ -243,6 +247,30 @@ bool Sema::CheckX86BuiltinFunctionCall(unsigned BuiltinID, CallExpr *TheCall) {
   return false;
 }
 
+bool Sema::CheckRigelBuiltinFunctionCall(unsigned BuiltinID,
+                                         CallExpr *TheCall) {
+  unsigned i = 0, l = 0, u = 0;
+  switch (BuiltinID) {
+  default: return false;
+  // The special register number is encoded in the instruction.
+  case Rigel::BI__builtin_rigel_mfsr:
+  case Rigel::BI__builtin_rigel_mtsr: i = 0; u = 31; break;
+  case Rigel::BI__builtin_rigel_sleep: i = 1; u = 31; break;
+  case Rigel::BI__builtin_rigel_event:
+  case Rigel::BI__builtin_rigel_prio: i = 1; u = 65535; break;
+  }
+
+  llvm::APSInt Result;
+  if (SemaBuiltinConstantArg(TheCall, i, Result))
+    return true;
+
+  unsigned Val = Result.getZExtValue();
+  if (Val < l || Val > (u + l))
+    return Diag(TheCall->getLocStart(), diag::err_argument_invalid_range)
+      << l << u+l << TheCall->getArg(i)->getSourceRange();
+  return false;
+}
+
 // Get the valid immediate range for the specified NEON type code.
 static unsigned RFT(unsigned t, bool shift = false) {
   bool quad = t & 0x10;
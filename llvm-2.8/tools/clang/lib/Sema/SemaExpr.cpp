@@ -274,6 +274,37 @@ Expr *Sema::UsualUnaryConversions(Expr *&Expr) {
   return Expr;
 }
 
+/// IsSoftDoubleType - Whether arithmetic on Ty is done with soft-float
+/// libcalls.  For now that is any floating type wider than float on Rigel
+/// (see -mdouble=32).
+static bool IsSoftDoubleType(Sema &S, QualType Ty) {
+  if (Ty.isNull() || !Ty->isRealFloatingType())
+    return false;
+  if (S.Context.Target.getTriple().getArch() != llvm::Triple::rigel)
+    return false;
+  return S.Context.getTypeSize(Ty) > S.Context.Target.getFloatWidth();
+}
+
+/// IsFoldedSoftDoubleOperand - Return true if E is a constant the compiler
+/// folds, so that no soft-float code is needed for it.
+static bool IsFoldedSoftDoubleOperand(Sema &S, Expr *E) {
+  return E->isValueDependent() || E->isEvaluatable(S.Context);
+}
+
+/// DiagnoseSoftDoublePromotion - Warn when a call argument is converted from
+/// a floating type the target handles in hardware to one it does not.
+/// Constant arguments are converted at compile time and are left alone.
+static void DiagnoseSoftDoublePromotion(Sema &S, Expr *Arg, QualType ToTy) {
+  QualType FromTy = Arg->getType();
+  if (!FromTy->isRealFloatingType() || IsSoftDoubleType(S, FromTy) ||
+      !IsSoftDoubleType(S, ToTy))
+    return;
+  if (IsFoldedSoftDoubleOperand(S, Arg))
+    return;
+  S.Diag(Arg->getLocStart(), diag::warn_soft_double_promotion)
+    << FromTy << ToTy << Arg->getSourceRange();
+}
+
 /// DefaultArgumentPromotion (C99 6.5.2.2p6). Used for function calls that
 /// do not have a prototype. Arguments that have type float are promoted to
 /// double. All other argument types are converted by UsualUnaryConversions().
@@ -282,9 +313,11 @@ void Sema::DefaultArgumentPromotion(Expr *&Expr) {
   assert(!Ty.isNull() && "DefaultArgumentPromotion - missing type");
 
   // If this is a 'float' (CVR qualified or typedef) promote to double.
-  if (Ty->isSpecificBuiltinType(BuiltinType::Float))
+  if (Ty->isSpecificBuiltinType(BuiltinType::Float)) {
+    DiagnoseSoftDoublePromotion(*this, Expr, Context.DoubleTy);
     return ImpCastExprToType(Expr, Context.DoubleTy,
                              CK_FloatingCast);
+  }
 
   UsualUnaryConversions(Expr);
 }
@@ -3549,6 +3582,8 @@ bool Sema::GatherArgumentsForCall(SourceLocation CallLoc,
         Param = FDecl->getParamDecl(i);
 
 
+      DiagnoseSoftDoublePromotion(*this, Arg, ProtoArgType);
+
       InitializedEntity Entity =
         Param? InitializedEntity::InitializeParameter(Param)
              : InitializedEntity::InitializeParameter(ProtoArgType);
@@ -6456,6 +6491,28 @@ static inline UnaryOperatorKind ConvertTokenKindToUnaryOpcode(
   return Opc;
 }
 
+/// DiagnoseSoftDoubleOperation - Warn about floating-point arithmetic and
+/// comparisons the target can only do with soft-float libcalls.  Operations
+/// on constants are folded at compile time and are left alone.
+static void DiagnoseSoftDoubleOperation(Sema &S, SourceLocation OpLoc,
+                                        BinaryOperatorKind Opc, QualType OpTy,
+                                        Expr *LHS, Expr *RHS) {
+  switch (Opc) {
+  default:
+    return;
+  case BO_Mul: case BO_Div: case BO_Add: case BO_Sub:
+  case BO_LT: case BO_GT: case BO_LE: case BO_GE: case BO_EQ: case BO_NE:
+  case BO_MulAssign: case BO_DivAssign: case BO_AddAssign: case BO_SubAssign:
+    break;
+  }
+  if (!IsSoftDoubleType(S, OpTy))
+    return;
+  if (IsFoldedSoftDoubleOperand(S, LHS) && IsFoldedSoftDoubleOperand(S, RHS))
+    return;
+  S.Diag(OpLoc, diag::warn_soft_double_op)
+    << BinaryOperator::getOpcodeStr(Opc) << OpTy;
+}
+
 /// CreateBuiltinBinOp - Creates a new built-in binary operation with
 /// operator @p Opc at location @c TokLoc. This routine only supports
 /// built-in operations; ActOnBinOp handles overloaded operators.
@@ -6559,6 +6616,10 @@ ExprResult Sema::CreateBuiltinBinOp(SourceLocation OpLoc,
   }
   if (ResultTy.isNull())
     return ExprError();
+  DiagnoseSoftDoubleOperation(*this, OpLoc, Opc,
+                              CompResultTy.isNull() ? lhs->getType()
+                                                    : CompLHSTy,
+                              lhs, rhs);
   if (ResultTy->isObjCObjectType() && LangOpts.ObjCNonFragileABI) {
     if (Opc >= BO_Assign && Opc <= BO_OrAssign) 
           Diag(OpLoc, diag::err_assignment_requires_nonfragile_object)
@@ -6707,6 +6768,24 @@ ExprResult Sema::BuildBinOp(Scope *S, SourceLocation OpLoc,
   return CreateBuiltinBinOp(OpLoc, Opc, lhs, rhs);
 }
 
+/// DiagnoseSoftDoubleOperation - Likewise for increment, decrement and
+/// negation, which are all additions or subtractions.
+static void DiagnoseSoftDoubleOperation(Sema &S, SourceLocation OpLoc,
+                                        UnaryOperatorKind Opc, QualType OpTy,
+                                        Expr *Input) {
+  switch (Opc) {
+  default:
+    return;
+  case UO_PreInc: case UO_PreDec: case UO_PostInc: case UO_PostDec:
+  case UO_Minus:
+    break;
+  }
+  if (!IsSoftDoubleType(S, OpTy) || IsFoldedSoftDoubleOperand(S, Input))
+    return;
+  S.Diag(OpLoc, diag::warn_soft_double_op)
+    << UnaryOperator::getOpcodeStr(Opc) << OpTy;
+}
+
 ExprResult Sema::CreateBuiltinUnaryOp(SourceLocation OpLoc,
                                                     unsigned OpcIn,
                                                     Expr *Input) {
@@ -6787,6 +6866,7 @@ ExprResult Sema::CreateBuiltinUnaryOp(SourceLocation OpLoc,
   }
   if (resultType.isNull())
     return ExprError();
+  DiagnoseSoftDoubleOperation(*this, OpLoc, Opc, resultType, Input);
 
   return Owned(new (Context) UnaryOperator(Input, Opc, resultType, OpLoc));
 }
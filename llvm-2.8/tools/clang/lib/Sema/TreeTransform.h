@@ -3777,9 +3777,15 @@ TreeTransform<Derived>::TransformForStmt(ForStmt *S) {
       Body.get() == S->getBody())
     return SemaRef.Owned(S->Retain());
 
-  return getDerived().RebuildForStmt(S->getForLoc(), S->getLParenLoc(),
-                                     Init.get(), FullCond, ConditionVar,
-                                     FullInc, S->getRParenLoc(), Body.get());
+  StmtResult Result
+    = getDerived().RebuildForStmt(S->getForLoc(), S->getLParenLoc(),
+                                  Init.get(), FullCond, ConditionVar,
+                                  FullInc, S->getRParenLoc(), Body.get());
+
+  // Carry '#pragma rigel parallel for' over to the instantiated loop.
+  if (!Result.isInvalid() && SemaRef.Context.isParallelForLoop(S))
+    SemaRef.Context.setParallelForLoop(cast<ForStmt>(Result.get()));
+  return move(Result);
 }
 
 template<typename Derived>
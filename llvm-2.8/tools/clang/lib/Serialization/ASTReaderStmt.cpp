@@ -282,6 +282,8 @@ void ASTStmtReader::VisitForStmt(ForStmt *S) {
   S->setForLoc(SourceLocation::getFromRawEncoding(Record[Idx++]));
   S->setLParenLoc(SourceLocation::getFromRawEncoding(Record[Idx++]));
   S->setRParenLoc(SourceLocation::getFromRawEncoding(Record[Idx++]));
+  if (Record[Idx++])
+    Reader.getContext()->setParallelForLoop(S);
 }
 
 void ASTStmtReader::VisitGotoStmt(GotoStmt *S) {
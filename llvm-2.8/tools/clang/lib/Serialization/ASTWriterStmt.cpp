@@ -267,6 +267,7 @@ void ASTStmtWriter::VisitForStmt(ForStmt *S) {
   Writer.AddSourceLocation(S->getForLoc(), Record);
   Writer.AddSourceLocation(S->getLParenLoc(), Record);
   Writer.AddSourceLocation(S->getRParenLoc(), Record);
+  Record.push_back(Writer.getASTContext().isParallelForLoop(S));
   Code = serialization::STMT_FOR;
 }
 
@@ -0,0 +1,123 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+
+// CHECK: @coreid
+// CHECK: call i32 @llvm.rigel.read.sr(i32 0)
+// CHECK: declare i32 @llvm.rigel.read.sr(i32) nounwind readnone
+unsigned coreid(void) { return __builtin_rigel_coreid(); }
+
+// CHECK: @clusterid
+// CHECK: call i32 @llvm.rigel.read.sr(i32 1)
+unsigned clusterid(void) { return __builtin_rigel_clusterid(); }
+
+// CHECK: @numthreads
+// CHECK: call i32 @llvm.rigel.read.sr(i32 6)
+unsigned numthreads(void) { return __builtin_rigel_numthreads(); }
+
+// CHECK: @cycles
+// CHECK: call i32 @llvm.rigel.read.sr.volatile(i32 5)
+unsigned cycles(void) { return __builtin_rigel_cycles(); }
+
+// mfsr of an ID register is the readnone read; anything else is re-read.
+// CHECK: @mfsr
+// CHECK: call i32 @llvm.rigel.read.sr(i32 6)
+// CHECK: call i32 @llvm.rigel.read.sr.volatile(i32 5)
+// CHECK: call i32 @llvm.rigel.read.sr.volatile(i32 31)
+unsigned mfsr(void) {
+  return __builtin_rigel_mfsr(6) + __builtin_rigel_mfsr(5) +
+         __builtin_rigel_mfsr(31);
+}
+
+// CHECK: @mtsr
+// CHECK: call void @llvm.rigel.write.sr(i32 31, i32
+void mtsr(unsigned v) { __builtin_rigel_mtsr(31, v); }
+
+// Global memory and broadcasts take the address as an i8*, and the value
+// first, like a store.
+// CHECK: @t_gldw
+// CHECK: call i32 @llvm.rigel.gldw(i8*
+unsigned t_gldw(volatile const unsigned *p) { return __builtin_rigel_gldw(p); }
+
+// CHECK: @t_gstw
+// CHECK: call void @llvm.rigel.gstw(i32 {{.*}}, i8*
+void t_gstw(volatile unsigned *p, unsigned v) { __builtin_rigel_gstw(p, v); }
+
+// CHECK: @t_bcast_update
+// CHECK: call void @llvm.rigel.bcast.update(i32 {{.*}}, i8*
+void t_bcast_update(volatile unsigned *p, unsigned v) {
+  __builtin_rigel_bcast_update(p, v);
+}
+
+// CHECK: @t_bcast_inv
+// CHECK: call void @llvm.rigel.bcast.inv(i8*
+void t_bcast_inv(volatile unsigned *p) { __builtin_rigel_bcast_inv(p); }
+
+// Cache control and prefetch.
+// CHECK: @t_cache
+// CHECK: call void @llvm.rigel.line.wb(i8*
+// CHECK: call void @llvm.rigel.line.inv(i8*
+// CHECK: call void @llvm.rigel.line.flush(i8*
+// CHECK: call void @llvm.rigel.pref.l(i8*
+// CHECK: call void @llvm.rigel.pref.nga(i8*
+void t_cache(const int *p) {
+  __builtin_rigel_line_wb(p);
+  __builtin_rigel_line_inv(p);
+  __builtin_rigel_line_flush(p);
+  __builtin_rigel_pref_l(p);
+  __builtin_rigel_pref_nga(p);
+}
+
+// The atomics are the generic llvm.atomic.* intrinsics, fenced on both sides
+// like the __sync builtins.
+// CHECK: @t_atom_add
+// CHECK: call void @llvm.memory.barrier(i1 true, i1 true, i1 true, i1 true, i1 true)
+// CHECK-NEXT: call i32 @llvm.atomic.load.add.i32.p0i32(i32* {{.*}}, i32 {{.*}})
+// CHECK-NEXT: call void @llvm.memory.barrier(i1 true, i1 true, i1 true, i1 true, i1 true)
+int t_atom_add(volatile int *p, int v) { return __builtin_rigel_atom_add(p, v); }
+
+// CHECK: @t_atom_ops
+// CHECK: call i32 @llvm.atomic.load.and.i32.p0i32(i32* {{.*}}, i32 {{.*}})
+// CHECK: call i32 @llvm.atomic.load.or.i32.p0i32(i32* {{.*}}, i32 {{.*}})
+// CHECK: call i32 @llvm.atomic.load.xor.i32.p0i32(i32* {{.*}}, i32 {{.*}})
+// CHECK: call i32 @llvm.atomic.load.min.i32.p0i32(i32* {{.*}}, i32 {{.*}})
+// CHECK: call i32 @llvm.atomic.load.max.i32.p0i32(i32* {{.*}}, i32 {{.*}})
+// CHECK: call i32 @llvm.atomic.swap.i32.p0i32(i32* {{.*}}, i32 {{.*}})
+// CHECK: call i32 @llvm.atomic.cmp.swap.i32.p0i32(i32* {{.*}}, i32 {{.*}}, i32 {{.*}})
+// CHECK: call i32 @llvm.atomic.load.add.i32.p0i32(i32* {{.*}}, i32 1)
+// CHECK: call i32 @llvm.atomic.load.add.i32.p0i32(i32* {{.*}}, i32 -1)
+int t_atom_ops(volatile int *p, int v) {
+  return __builtin_rigel_atom_and(p, v) + __builtin_rigel_atom_or(p, v) +
+         __builtin_rigel_atom_xor(p, v) + __builtin_rigel_atom_min(p, v) +
+         __builtin_rigel_atom_max(p, v) + __builtin_rigel_atom_xchg(p, v) +
+         __builtin_rigel_atom_cas(p, v, 0) + __builtin_rigel_atom_inc(p) +
+         __builtin_rigel_atom_dec(p);
+}
+
+// Task queue.
+// CHECK: @t_tq
+// CHECK: call i32 @llvm.rigel.tq.init(i32 64)
+// CHECK: call i32 @llvm.rigel.tq.enqueue(i32 1, i32 2, i32 3, i32 4)
+// CHECK: call i32 @llvm.rigel.tq.loop(i32 1, i32 2, i32 100, i32 10)
+// CHECK: call i32 @llvm.rigel.tq.end()
+int t_tq(void) {
+  return __builtin_rigel_tq_init(64) + __builtin_rigel_tq_enqueue(1, 2, 3, 4) +
+         __builtin_rigel_tq_loop(1, 2, 100, 10) + __builtin_rigel_tq_end();
+}
+
+// tq_dequeue stores the four task words through its argument and returns the
+// status.
+// CHECK: @t_tq_dequeue
+// CHECK: [[R:%[a-z0-9.]+]] = call { i32, i32, i32, i32, i32 } @llvm.rigel.tq.dequeue()
+// CHECK-NEXT: [[W0:%[a-z0-9.]+]] = extractvalue { i32, i32, i32, i32, i32 } [[R]], 1
+// CHECK-NEXT: [[P0:%[a-z0-9.]+]] = getelementptr i32* [[T:%[a-z0-9.]+]], i32 0
+// CHECK-NEXT: store i32 [[W0]], i32* [[P0]]
+// CHECK-NEXT: [[W1:%[a-z0-9.]+]] = extractvalue { i32, i32, i32, i32, i32 } [[R]], 2
+// CHECK-NEXT: [[P1:%[a-z0-9.]+]] = getelementptr i32* [[T]], i32 1
+// CHECK-NEXT: store i32 [[W1]], i32* [[P1]]
+// CHECK-NEXT: [[W2:%[a-z0-9.]+]] = extractvalue { i32, i32, i32, i32, i32 } [[R]], 3
+// CHECK-NEXT: [[P2:%[a-z0-9.]+]] = getelementptr i32* [[T]], i32 2
+// CHECK-NEXT: store i32 [[W2]], i32* [[P2]]
+// CHECK-NEXT: [[W3:%[a-z0-9.]+]] = extractvalue { i32, i32, i32, i32, i32 } [[R]], 4
+// CHECK-NEXT: [[P3:%[a-z0-9.]+]] = getelementptr i32* [[T]], i32 3
+// CHECK-NEXT: store i32 [[W3]], i32* [[P3]]
+// CHECK-NEXT: extractvalue { i32, i32, i32, i32, i32 } [[R]], 0
+int t_tq_dequeue(unsigned *t) { return __builtin_rigel_tq_dequeue(t); }
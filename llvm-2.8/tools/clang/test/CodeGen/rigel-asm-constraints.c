@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+
+// CHECK: @f
+// CHECK: call float asm "fadd $0, $1, $1", "=f,f"(float
+float f(float x) {
+  float y;
+  asm ("fadd %0, %1, %1" : "=f" (y) : "f" (x));
+  return y;
+}
+
+// CHECK: @imm
+// CHECK: call i32 asm "addi $0, $1, $2", "=r,r,I"(i32 {{.*}}, i32 -32768)
+// CHECK: call i32 asm "ori $0, $1, $2", "=r,r,K"(i32 {{.*}}, i32 65535)
+// CHECK: call i32 asm "slli $0, $1, $2", "=r,r,L"(i32 {{.*}}, i32 31)
+int imm(int i) {
+  asm ("addi %0, %1, %2" : "=r" (i) : "r" (i), "I" (-32768));
+  asm ("ori %0, %1, %2" : "=r" (i) : "r" (i), "K" (65535));
+  asm ("slli %0, %1, %2" : "=r" (i) : "r" (i), "L" (31));
+  return i;
+}
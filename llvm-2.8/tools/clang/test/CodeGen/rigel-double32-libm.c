@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -target-feature +double32 -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -target-feature +double32 -fno-builtin -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -emit-llvm -o - %s | FileCheck -check-prefix=D64 %s
+
+double exp(double);
+long double floorl(long double);
+double ceil(double);
+
+// CHECK: define float @f(float %x)
+// CHECK: call float @expf(float
+// CHECK: call float @floorf(float
+// CHECK: call float @ceilf(float
+// D64: call double @exp(double
+// D64: call double @floorl(double
+// D64: call double @ceil(double
+double f(double x) { return exp(x) + floorl(x) + ceil(x); }
+
+// Taking the address goes to the float routine too.
+// CHECK: define float (float)* @g()
+// CHECK: ret float (float)* @expf
+// D64: ret double (double)* @exp
+double (*g(void))(double) { return exp; }
+
+// A static function that happens to share a libm name is left alone.
+static double sinh(double x) { return x; }
+// CHECK: define float @h(float %x)
+// CHECK: call float @sinh(float
+double h(double x) { return sinh(x); }
+
+// So is an extern function whose signature isn't the library's.
+void logb(int);
+// CHECK: define void @k()
+// CHECK: call void @logb(i32 1)
+void k(void) { logb(1); }
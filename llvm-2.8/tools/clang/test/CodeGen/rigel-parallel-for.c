@@ -0,0 +1,43 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -emit-llvm -o - %s | FileCheck -check-prefix=IR %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -mrelocation-model static -O2 -S -o - %s | FileCheck -check-prefix=ASM %s
+
+void scale(float *a, float s, int n) {
+#pragma rigel parallel for
+  for (int i = 0; i < n; ++i)
+    a[i] *= s;
+}
+// IR: define void @scale
+// IR: br {{.*}}, !rigel.parallel
+// IR: ret void
+
+// The enqueuing core drains the queue with the other cores, then ends it.
+// ASM: scale:
+// ASM: tq.loop
+// ASM: [[DISPATCH:\.BB[0-9_]+]]:
+// ASM-NEXT: tq.deq
+// ASM-NEXT: bnz $2, [[DONE:\.BB[0-9_]+]]
+// ASM: jalr
+// ASM: lj [[DISPATCH]]
+// ASM-NEXT: [[DONE]]:
+// ASM-NEXT: tq.end
+// ASM: .end scale
+
+// The task reloads the loop's environment with g.ldw and runs its range.
+// ASM: scale_par.entry.task:
+// ASM: g.ldw
+// ASM: ljl scale_par.entry
+
+// A pragma left over at the end of a block doesn't carry over to the next
+// loop.
+void leftover(int *a) {
+  a[0] = 0;
+#pragma rigel parallel for
+}
+
+void serial(int *a, int n) {
+  for (int i = 0; i < n; ++i)
+    a[i] = 0;
+}
+// IR: define void @serial
+// IR-NOT: !rigel.parallel
+// IR: ret void
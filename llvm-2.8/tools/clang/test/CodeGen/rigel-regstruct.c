@@ -0,0 +1,43 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -emit-llvm -o - %s | FileCheck -check-prefix=O32 %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -target-abi regstruct -emit-llvm -o - %s | FileCheck -check-prefix=REG %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -target-abi regstruct -mrelocation-model static -O2 -S -o - %s | FileCheck -check-prefix=ASM %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -target-abi regstruct -E -dM -o - %s | FileCheck -check-prefix=DEF %s
+
+// DEF: #define __rigel_regstruct 1
+
+struct P { int x, y; };
+struct F { float a, b, c; };
+struct Q { int a, b, c; };
+struct Big { int a[5]; };
+
+// Two words come back in V0/V1.
+// O32: define void @mk(%struct.P* sret %agg.result, i32 %a, i32 %b)
+// REG: define %struct.P @mk(i32 %a, i32 %b)
+// ASM: mk:
+// ASM-NOT: stw
+// ASM: or $2, $zero, $4
+// ASM-NEXT: or $3, $zero, $5
+// ASM-NEXT: jmpr $ra
+struct P mk(int a, int b) { struct P p = { a, b }; return p; }
+
+// O32: define i32 @sum(%struct.P* byval %p)
+// REG: define i32 @sum(i32 %p.coerce0, i32 %p.coerce1)
+int sum(struct P p) { return p.x + p.y; }
+
+// All-float aggregates are passed as floats.
+// O32: define float @fs(%struct.F* byval %f)
+// REG: define float @fs(float %f.coerce0, float %f.coerce1, float %f.coerce2)
+float fs(struct F f) { return f.a + f.c; }
+
+// O32: define void @cf(%0* sret %agg.result, %0* byval %z)
+// REG: define %0 @cf(float %z.coerce0, float %z.coerce1)
+_Complex float cf(_Complex float z) { return z; }
+
+// Too big for registers: more than four words as an argument, more than
+// two as a return value.
+// O32: define i32 @big(%struct.Big* byval %b)
+// REG: define i32 @big(%struct.Big* byval %b)
+int big(struct Big b) { return b.a[4]; }
+
+// REG: define void @q(%struct.Q* sret %agg.result, i32 %a)
+struct Q q(int a) { struct Q r = { a, a, a }; return r; }
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+
+// The pragma is carried over to every instantiation of the loop.
+template <typename T> void zero(T *a, int n) {
+#pragma rigel parallel for
+  for (int i = 0; i < n; ++i)
+    a[i] = 0;
+}
+
+void use(int *a, float *b) {
+  zero(a, 10);
+  zero(b, 10);
+}
+
+// CHECK: define linkonce_odr void @_Z4zeroIiEvPT_i
+// CHECK: br {{.*}}, !rigel.parallel
+// CHECK: ret void
+// CHECK: define linkonce_odr void @_Z4zeroIfEvPT_i
+// CHECK: br {{.*}}, !rigel.parallel
+// CHECK: ret void
@@ -0,0 +1,23 @@
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto -flto-partitions=3 %s -### 2> %t.log
+// RUN: FileCheck -input-file %t.log %s
+// CHECK: llc{{.*}}" "-codegen-partitions=3" "-o" "[[ASM:[^"]*]]"
+// CHECK: rigelas{{.*}}" "[[ASM]].0"
+// CHECK: rigelas{{.*}}" "[[ASM]].1"
+// CHECK: rigelas{{.*}}" "[[ASM]].2"
+// CHECK-NOT: rigelas
+// CHECK: rigelld
+
+// One partition is the plain single llc run.
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto -flto-partitions=1 %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=ONE -input-file %t.log %s
+// ONE-NOT: -codegen-partitions
+// ONE: llc{{.*}}" "-o" "[[ASM:[^"]*]]"
+// ONE: rigelas{{.*}}" "[[ASM]]"
+// ONE-NOT: rigelas
+// ONE: rigelld
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto -flto-partitions=0 %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=BAD -input-file %t.log %s
+// BAD: invalid value '0' in '-flto-partitions=0'
+
+int main() { return 0; }
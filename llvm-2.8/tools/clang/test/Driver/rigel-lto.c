@@ -0,0 +1,48 @@
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -nostdlib -### 2> %t.log
+// RUN: FileCheck -check-prefix=BC-ONLY -input-file %t.log %s
+// BC-ONLY: opt{{.*}}" "-std-link-opts" "-internalize-public-api-list=main"
+// BC-ONLY-NOT: libc.a
+// BC-ONLY: rigelld
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -nostdlib -u foo -### 2> %t.log
+// RUN: FileCheck -check-prefix=USYM -input-file %t.log %s
+// USYM: opt{{.*}}" "-std-link-opts" "-internalize-public-api-list=main,foo"
+
+// Native inputs may reference anything the bitcode defines.
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -nostdlib -lfoo -### 2> %t.log
+// RUN: FileCheck -check-prefix=NATIVE -input-file %t.log %s
+// NATIVE: opt{{.*}}" "-std-link-opts" "-disable-internalize"
+// NATIVE: rigelld{{.*}}" "-lfoo"
+
+// The runtime the driver links itself stays native, but only calls back into
+// main and the libc hooks a program may replace, so everything else is still
+// internalized.
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=RUNTIME -input-file %t.log %s
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -nostartfiles -### 2> %t.log
+// RUN: FileCheck -check-prefix=RUNTIME -input-file %t.log %s
+// RUNTIME: opt{{.*}}" "-std-link-opts" "-internalize-public-api-list=main,malloc,free,calloc,realloc,memalign"
+// RUNTIME: rigelld{{.*}}libc.a
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -nodefaultlibs -u foo -### 2> %t.log
+// RUN: FileCheck -check-prefix=CRT0 -input-file %t.log %s
+// CRT0: opt{{.*}}" "-std-link-opts" "-internalize-public-api-list=main,foo"
+// CRT0: rigelld{{.*}}rigel-crt0-mp.ro
+
+// RUN: %clangxx -ccc-host-triple rigel-unknown-unknown -flto %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=CXX -input-file %t.log %s
+// CXX: opt{{.*}}" "-std-link-opts" "-internalize-public-api-list=main,malloc,free,calloc,realloc,memalign,_Znwj,_Znaj,_ZdlPv,_ZdaPv"
+// CXX: rigelld
+
+// The LTO code generator keeps per-function and per-object sections so that
+// --gc-sections still works on the merged object.
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -nostdlib -ffunction-sections -fdata-sections -### 2> %t.log
+// RUN: FileCheck -check-prefix=SECT -input-file %t.log %s
+// SECT: llc{{.*}}" "-ffunction-sections" "-fdata-sections"
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto %s -nostdlib -### 2> %t.log
+// RUN: FileCheck -check-prefix=NOSEC -input-file %t.log %s
+// NOSEC: llc"
+// NOSEC-NOT: -sections"
+// NOSEC: rigelas
+
+int main() { return 0; }
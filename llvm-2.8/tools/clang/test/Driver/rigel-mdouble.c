@@ -0,0 +1,16 @@
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -mdouble=32 -c %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=D32 -input-file %t.log %s
+// D32: "-cc1"
+// D32: "-target-feature" "+double32"
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -mdouble=64 -c %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=D64 -input-file %t.log %s
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -c %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=D64 -input-file %t.log %s
+// D64: "-cc1"
+// D64-NOT: double32
+// D64: "-x" "c"
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -mdouble=16 -c %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=BAD -input-file %t.log %s
+// BAD: invalid value '16' in '-mdouble=16'
@@ -0,0 +1,29 @@
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto -fprofile-generate %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=LTO-GEN -input-file %t.log %s
+// LTO-GEN: clang{{.*}}" "-cc1" {{.*}}"-emit-llvm-bc"
+// LTO-GEN-NOT: "-fprofile-generate"
+// LTO-GEN: opt{{.*}}" "-insert-edge-profiling"
+// LTO-GEN: rigelld{{.*}}" "-EL" "-m" "elf32elrigel"
+// LTO-GEN: "-lprofile_rt"
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -flto -fprofile-use=foo.prof %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=LTO-USE -input-file %t.log %s
+// LTO-USE: opt{{.*}}" "-profile-metadata-loader" "-profile-metadata-file=foo.prof"
+// LTO-USE: rigelld{{.*}}" "-EL" "-m" "elf32elrigel"
+
+// The counters only line up across the whole program when it is linked as
+// bitcode.
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -fprofile-generate -c %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=ERR-GEN -input-file %t.log %s
+// ERR-GEN: invalid argument '-fprofile-generate' only allowed with '-flto'
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -fprofile-use -S %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=ERR-USE -input-file %t.log %s
+// ERR-USE: invalid argument '-fprofile-use' only allowed with '-flto'
+
+// RUN: %clang -ccc-host-triple rigel-unknown-unknown -fprofile-use -E %s -### 2> %t.log
+// RUN: FileCheck -check-prefix=PP -input-file %t.log %s
+// PP-NOT: only allowed with
+// PP: "-cc1" {{.*}}"-E"
+
+int main() { return 0; }
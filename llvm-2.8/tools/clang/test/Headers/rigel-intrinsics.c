@@ -0,0 +1,39 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -ffreestanding -fsyntax-only -verify -DVERIFY %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -ffreestanding -fsyntax-only -x c++ %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -ffreestanding -O2 -emit-llvm -o - %s | FileCheck %s
+
+#include <rigel_intrinsics.h>
+
+// CHECK: @ids
+// CHECK: call i32 @llvm.rigel.read.sr(i32 0)
+// CHECK: call i32 @llvm.rigel.read.sr(i32 6)
+unsigned ids(void) { return rigel_coreid() * rigel_numthreads(); }
+
+// CHECK: @counter
+// CHECK: call i32 @llvm.atomic.load.add.i32.p0i32(i32* %p, i32 1)
+int counter(volatile int *p) { return rigel_atom_inc(p); }
+
+// CHECK: @worker
+// CHECK: call { i32, i32, i32, i32, i32 } @llvm.rigel.tq.dequeue()
+// CHECK: call i32 @llvm.rigel.tq.enqueue(
+int worker(void) {
+  rigel_task_t t;
+  if (rigel_tq_dequeue(&t))
+    return 0;
+  return rigel_tq_enqueue(&t);
+}
+
+// CHECK: @flush
+// CHECK: call void @llvm.rigel.line.flush(i8*
+// CHECK: call void @llvm.rigel.gstw(i32 1, i8*
+void flush(volatile unsigned *p) {
+  rigel_line_flush(p);
+  rigel_gstore(p, 1);
+}
+
+// Misuse is diagnosed through the macros.
+#ifdef VERIFY
+void bad(void) {
+  rigel_mfsr(32); // expected-error {{argument should be a value from 0 to 31}}
+}
+#endif
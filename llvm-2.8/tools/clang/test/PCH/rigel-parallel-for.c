@@ -0,0 +1,16 @@
+// Test this without pch.
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -include %S/rigel-parallel-for.h -emit-llvm -o - %s | FileCheck %s
+
+// Test with pch.
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -emit-pch -o %t %S/rigel-parallel-for.h
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -include-pch %t -emit-llvm -o - %s | FileCheck %s
+
+// The parallel-for flag on a ForStmt survives the round trip, and a plain
+// loop doesn't pick it up.
+void use(int *a) { zero(a, 10); one(a, 10); }
+
+// CHECK: define internal void @zero
+// CHECK: br {{.*}}, !rigel.parallel
+// CHECK: define internal void @one
+// CHECK-NOT: !rigel.parallel
+// CHECK: ret void
@@ -0,0 +1,12 @@
+// Header for PCH test rigel-parallel-for.c
+
+static inline void zero(int *a, int n) {
+#pragma rigel parallel for
+  for (int i = 0; i < n; ++i)
+    a[i] = 0;
+}
+
+static inline void one(int *a, int n) {
+  for (int i = 0; i < n; ++i)
+    a[i] = 1;
+}
@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -fsyntax-only -verify %s
+
+// Note that this puts the expected lines before the directives to work around
+// limitations in the -verify mode.
+
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
+int x;
+
+void f(int *a, int n) {
+  int i;
+/* expected-warning {{expected 'for' following '#pragma rigel parallel'}} */ #pragma rigel parallel while
+/* expected-warning {{extra tokens at end of '#pragma rigel parallel for'}} */ #pragma rigel parallel for i
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
+#pragma rigel parallel for
+  for (i = 0; i < n; ++i)
+    a[i] = 0;
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
+  a[0] = 1;
+  {
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
+  }
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
+}
+
+void g(int *a, int n) {
+  for (int i = 0; i < n; ++i)
+    a[i] = 0;
+}
+
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
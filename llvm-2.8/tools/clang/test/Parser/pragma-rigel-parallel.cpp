@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -fsyntax-only -verify %s
+
+// Note that this puts the expected lines before the directives to work around
+// limitations in the -verify mode.
+
+struct S {
+  void clear(int *a, int n) {
+/* expected-warning {{not supported in a member function defined in its class}} */ #pragma rigel parallel for
+    for (int i = 0; i < n; ++i)
+      a[i] = 0;
+  }
+  int y;
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
+  void set(int *a, int n) {
+    for (int i = 0; i < n; ++i)
+      a[i] = 1;
+  }
+  int x;
+/* expected-warning {{must be followed by a for loop}} */ #pragma rigel parallel for
+};
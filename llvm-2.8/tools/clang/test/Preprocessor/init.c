@@ -808,6 +808,23 @@
 // PPC:#define __WINT_WIDTH__ 32
 // PPC:#define __ppc__ 1
 //
+// RUN: %clang_cc1 -E -dM -ffreestanding -triple=rigel-unknown-unknown < /dev/null | FileCheck -check-prefix RIGEL %s
+//
+// RIGEL:#define __DBL_MANT_DIG__ 53
+// RIGEL:#define __LDBL_MANT_DIG__ 53
+// RIGEL:#define __SIZEOF_DOUBLE__ 8
+// RIGEL:#define __SIZEOF_LONG_DOUBLE__ 8
+// RIGEL-NOT:#define __rigel_double32
+// RIGEL:#define __rigel_o32 1
+//
+// RUN: %clang_cc1 -E -dM -ffreestanding -triple=rigel-unknown-unknown -target-feature +double32 < /dev/null | FileCheck -check-prefix RIGEL-DOUBLE32 %s
+//
+// RIGEL-DOUBLE32:#define __DBL_MANT_DIG__ 24
+// RIGEL-DOUBLE32:#define __LDBL_MANT_DIG__ 24
+// RIGEL-DOUBLE32:#define __SIZEOF_DOUBLE__ 4
+// RIGEL-DOUBLE32:#define __SIZEOF_LONG_DOUBLE__ 4
+// RIGEL-DOUBLE32:#define __rigel_double32 1
+//
 // RUN: %clang_cc1 -E -dM -ffreestanding -triple=s390x-none-none -fno-signed-char < /dev/null | FileCheck -check-prefix S390X %s
 //
 // S390X:#define __CHAR16_TYPE__ unsigned short
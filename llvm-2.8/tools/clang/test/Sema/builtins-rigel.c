@@ -0,0 +1,10 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -fsyntax-only -verify %s
+
+void f(int n, unsigned v) {
+  __builtin_rigel_mfsr(0);
+  __builtin_rigel_mfsr(31);
+  __builtin_rigel_mfsr(32); // expected-error {{argument should be a value from 0 to 31}}
+  __builtin_rigel_mfsr(n); // expected-error {{argument to '__builtin_rigel_mfsr' must be a constant integer}}
+  __builtin_rigel_mtsr(31, v);
+  __builtin_rigel_mtsr(32, v); // expected-error {{argument should be a value from 0 to 31}}
+}
@@ -0,0 +1,13 @@
+// RUN: %clang_cc1 %s -triple rigel-unknown-unknown -verify -fsyntax-only
+
+void f(int i, float x) {
+  float y;
+  asm ("fadd %0, %1, %1" : "=f" (y) : "f" (x));
+  asm ("addi %0, %1, %2" : "=r" (i) : "r" (i), "I" (-32768));
+  asm ("ori %0, %1, %2" : "=r" (i) : "r" (i), "K" (65535));
+  asm ("slli %0, %1, %2" : "=r" (i) : "r" (i), "L" (31));
+
+  asm ("foo %0" : : "q" (i)); // expected-error {{invalid input constraint 'q' in asm}}
+  asm ("foo %0" : "=q" (i)); // expected-error {{invalid output constraint '=q' in asm}}
+  asm ("fadd %0, %1, %1" : "=f" (y + 1) : "f" (x)); // expected-error {{invalid lvalue in asm output}}
+}
@@ -0,0 +1,38 @@
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -fsyntax-only -verify -Wsoft-double %s
+// RUN: %clang_cc1 -triple rigel-unknown-unknown -target-feature +double32 -fsyntax-only -Wsoft-double -Werror %s
+
+// Rigel only has single-precision hardware; double and long double are done
+// with soft-float libcalls unless they are 32 bits wide.
+
+double d;
+long double ld;
+float f;
+
+void proto(double);
+void vararg(int, ...);
+
+void ops(void) {
+  d = d + d; // expected-warning {{'+' on 'double' is emulated in software on this target}}
+  d *= 2; // expected-warning {{'*=' on 'double' is emulated in software on this target}}
+  if (d < f) // expected-warning {{'<' on 'double' is emulated in software on this target}}
+    d = -d; // expected-warning {{'-' on 'double' is emulated in software on this target}}
+  d++; // expected-warning {{'++' on 'double' is emulated in software on this target}}
+  ld = ld / 3; // expected-warning {{'/' on 'long double' is emulated in software on this target}}
+  f = f * f;
+  f += 1.0f;
+}
+
+// Constants are folded at compile time.
+void constants(void) {
+  d = 1.0 + 2.0;
+  d = -1.0;
+  if (1.0 < 2.0)
+    d = 0;
+  proto(1.0f);
+}
+
+void promotions(void) {
+  proto(f); // expected-warning {{converting argument from 'float' to 'double' is emulated in software on this target}}
+  vararg(0, f); // expected-warning {{converting argument from 'float' to 'double' is emulated in software on this target}}
+  proto(d);
+}
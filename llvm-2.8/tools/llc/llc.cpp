@@ -13,10 +13,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/GlobalAlias.h"
+#include "llvm/Instructions.h"
 #include "llvm/LLVMContext.h"
 #include "llvm/Module.h"
 #include "llvm/PassManager.h"
 #include "llvm/Pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Support/IRReader.h"
 #include "llvm/CodeGen/LinkAllAsmWriterComponents.h"
@@ -29,12 +36,14 @@
 #include "llvm/Support/PluginLoader.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/System/Host.h"
+#include "llvm/System/Program.h"
 #include "llvm/System/Signals.h"
 #include "llvm/Target/SubtargetFeature.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetRegistry.h"
 #include "llvm/Target/TargetSelect.h"
+#include <algorithm>
 #include <memory>
 using namespace llvm;
 
@@ -106,6 +115,17 @@ NoImplicitFloats("no-implicit-float",
   cl::desc("Don't generate implicit floating point instructions (x86-only)"),
   cl::init(false));
 
+static cl::opt<unsigned>
+CodeGenPartitions("codegen-partitions",
+  cl::desc("Split the module's functions into N groups and generate code for "
+           "each in its own process, writing <output>.0 ... <output>.N-1"),
+  cl::value_desc("N"), cl::init(1));
+
+// Set on the child processes started for -codegen-partitions.
+static cl::opt<int>
+CodeGenPartition("codegen-partition", cl::Hidden, cl::init(-1),
+  cl::desc("Generate code for only this partition of the module"));
+
 // GetFileNameRoot - Helper function to get the basename of a filename.
 static inline std::string
 GetFileNameRoot(const std::string &InputFilename) {
@@ -159,6 +179,10 @@ static tool_output_file *GetOutputStream(const char *TargetName,
     }
   }
 
+  // Each partition gets its own file next to the requested one.
+  if (CodeGenPartition >= 0)
+    OutputFilename += "." + utostr(CodeGenPartition);
+
   // Decide if we need "binary" output.
   bool Binary = false;
   switch (FileType) {
@@ -186,6 +210,247 @@ static tool_output_file *GetOutputStream(const char *TargetName,
   return FDOut;
 }
 
+//===----------------------------------------------------------------------===//
+// Partitioned code generation
+//
+// With -codegen-partitions=N, llc re-runs itself N times in parallel with
+// -codegen-partition=I.  Every child reads the whole module, splits it the
+// same way, deletes the bodies of the functions that belong to other
+// partitions and generates code for what is left.  Global variables are
+// defined in partition 0 only.  Local symbols that end up referenced from
+// another partition are made hidden externals with a name that is the same in
+// every child, so the partitions link back together.
+//===----------------------------------------------------------------------===//
+
+typedef DenseMap<const Function*, unsigned> PartitionMap;
+
+// getFunctionSize - Rough cost of generating code for F.
+static unsigned getFunctionSize(const Function &F) {
+  unsigned Size = 0;
+  for (Function::const_iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+    Size += BB->size();
+  return Size;
+}
+
+namespace {
+  struct LargerFunction {
+    bool operator()(const std::pair<unsigned, const Function*> &LHS,
+                    const std::pair<unsigned, const Function*> &RHS) const {
+      return LHS.first > RHS.first;
+    }
+  };
+}
+
+// assignPartitions - Deal the defined functions out to N partitions, largest
+// first, each to the partition with the least code so far.  This only
+// depends on the module, so every child process comes up with the same
+// answer.
+static void assignPartitions(Module &M, unsigned N, PartitionMap &Parts) {
+  // Aliases are emitted with the globals in partition 0; keep what they
+  // point to there too so the assembler can resolve them.
+  SmallPtrSet<const GlobalValue*, 8> Aliased;
+  for (Module::alias_iterator I = M.alias_begin(), E = M.alias_end();
+       I != E; ++I)
+    if (const GlobalValue *GV = I->getAliasedGlobal())
+      Aliased.insert(GV);
+
+  std::vector<std::pair<unsigned, const Function*> > Funcs;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    // available_externally bodies are never emitted; leave them everywhere.
+    if (F->isDeclaration() || F->hasAvailableExternallyLinkage())
+      continue;
+    if (Aliased.count(F))
+      Parts[F] = 0;
+    else
+      Funcs.push_back(std::make_pair(getFunctionSize(*F), &*F));
+  }
+  std::stable_sort(Funcs.begin(), Funcs.end(), LargerFunction());
+
+  std::vector<unsigned> Load(N, 0);
+  for (unsigned i = 0, e = Funcs.size(); i != e; ++i) {
+    unsigned Best = std::min_element(Load.begin(), Load.end()) - Load.begin();
+    Load[Best] += Funcs[i].first;
+    Parts[Funcs[i].second] = Best;
+  }
+}
+
+// getPartition - The partition a use by U ends up in, or -1 if it ends up in
+// all of them.
+static int getPartition(const User *U, const PartitionMap &Parts) {
+  if (const Instruction *I = dyn_cast<Instruction>(U)) {
+    PartitionMap::const_iterator It = Parts.find(I->getParent()->getParent());
+    return It == Parts.end() ? -1 : (int)It->second;
+  }
+  // Initializers and aliases live in partition 0.
+  return 0;
+}
+
+// isUsedOutside - Whether V is used anywhere other than partition Home,
+// looking through constant expressions.
+static bool isUsedOutside(const Value *V, int Home, const PartitionMap &Parts,
+                          SmallPtrSet<const Value*, 16> &Visited) {
+  for (Value::const_use_iterator UI = V->use_begin(), E = V->use_end();
+       UI != E; ++UI) {
+    const User *U = *UI;
+    if (isa<Constant>(U) && !isa<GlobalValue>(U)) {
+      if (Visited.insert(U) && isUsedOutside(U, Home, Parts, Visited))
+        return true;
+      continue;
+    }
+    if (getPartition(U, Parts) != Home)
+      return true;
+  }
+  return false;
+}
+
+// promoteLocal - Make GV visible to the other partitions.  The name has to
+// be the same in every child, and shouldn't collide with the same static in
+// a different module, so it is salted with the module's identifier.
+static void promoteLocal(GlobalValue *GV, const std::string &Salt) {
+  std::string Name = GV->hasName() ? GV->getName().str() : "__unnamed";
+  GV->setName(Name + ".part." + Salt);
+  GV->setLinkage(GlobalValue::ExternalLinkage);
+  GV->setVisibility(GlobalValue::HiddenVisibility);
+}
+
+// splitModule - Reduce M to partition Part of N.
+static void splitModule(Module &M, unsigned N, unsigned Part) {
+  PartitionMap Parts;
+  assignPartitions(M, N, Parts);
+
+  // Promote locals that are referenced across partitions.  This has to
+  // happen before any bodies are deleted, and in module order so unnamed
+  // and clashing names come out the same in every child.
+  std::string Salt;
+  {
+    uint32_t Hash = 2166136261u;
+    const std::string &Id = M.getModuleIdentifier();
+    for (unsigned i = 0, e = Id.size(); i != e; ++i)
+      Hash = (Hash ^ (unsigned char)Id[i]) * 16777619u;
+    Salt = utohexstr(Hash);
+  }
+  std::vector<GlobalValue*> Promote;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (!F->hasLocalLinkage())
+      continue;
+    PartitionMap::iterator It = Parts.find(F);
+    int Home = It == Parts.end() ? -1 : (int)It->second;
+    SmallPtrSet<const Value*, 16> Visited;
+    if (isUsedOutside(F, Home, Parts, Visited))
+      Promote.push_back(F);
+  }
+  for (Module::global_iterator G = M.global_begin(), E = M.global_end();
+       G != E; ++G) {
+    SmallPtrSet<const Value*, 16> Visited;
+    if (G->hasLocalLinkage() && isUsedOutside(G, 0, Parts, Visited))
+      Promote.push_back(G);
+  }
+  for (Module::alias_iterator A = M.alias_begin(), E = M.alias_end();
+       A != E; ++A) {
+    SmallPtrSet<const Value*, 16> Visited;
+    if (A->hasLocalLinkage() && isUsedOutside(A, 0, Parts, Visited))
+      Promote.push_back(A);
+  }
+  for (unsigned i = 0, e = Promote.size(); i != e; ++i)
+    promoteLocal(Promote[i], Salt);
+
+  // Drop the function bodies that belong elsewhere.
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    PartitionMap::iterator It = Parts.find(F);
+    if (It != Parts.end() && It->second != Part)
+      F->deleteBody();
+  }
+
+  if (Part == 0)
+    return;
+
+  // Module-level asm defines its symbols wherever it is emitted, so it also
+  // stays in partition 0.
+  M.setModuleInlineAsm("");
+
+  // Everything but functions stays in partition 0.  Aliases become plain
+  // declarations of what they alias.
+  for (Module::alias_iterator A = M.alias_begin(), E = M.alias_end();
+       A != E; ) {
+    GlobalAlias *GA = A++;
+    const PointerType *PTy = cast<PointerType>(GA->getType());
+    GlobalValue *Decl;
+    if (const FunctionType *FTy =
+          dyn_cast<FunctionType>(PTy->getElementType()))
+      Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", &M);
+    else
+      Decl = new GlobalVariable(M, PTy->getElementType(), false,
+                                GlobalValue::ExternalLinkage, 0, "", 0,
+                                false, PTy->getAddressSpace());
+    Decl->takeName(GA);
+    Decl->setVisibility(GA->getVisibility());
+    GA->replaceAllUsesWith(Decl);
+    GA->eraseFromParent();
+  }
+
+  for (Module::global_iterator G = M.global_begin(), E = M.global_end();
+       G != E; ) {
+    GlobalVariable *GV = G++;
+    if (!GV->hasInitializer() || GV->hasAvailableExternallyLinkage())
+      continue;
+    // llvm.used, llvm.global_ctors and friends.
+    if (GV->getName().startswith("llvm.") && GV->use_empty()) {
+      GV->eraseFromParent();
+      continue;
+    }
+    GV->setInitializer(0);
+    GV->setLinkage(GlobalValue::ExternalLinkage);
+  }
+}
+
+// GetMainExecutablePath - Used to find llc itself for the child processes.
+static sys::Path GetMainExecutablePath(const char *Argv0) {
+  void *P = (void*) (intptr_t) GetMainExecutablePath;
+  return sys::Path::GetMainExecutable(Argv0, P);
+}
+
+// RunPartitions - Start one child per partition and wait for all of them.
+static int RunPartitions(int argc, char **argv) {
+  if (InputFilename == "-" || OutputFilename == "-") {
+    errs() << argv[0] << ": -codegen-partitions needs named input and "
+           << "output files.\n";
+    return 1;
+  }
+
+  sys::Path Self = GetMainExecutablePath(argv[0]);
+  std::vector<std::string> PartArgs(CodeGenPartitions);
+  std::vector<sys::Program*> Children(CodeGenPartitions);
+  int Ret = 0;
+  for (unsigned i = 0; i != CodeGenPartitions; ++i) {
+    PartArgs[i] = "-codegen-partition=" + utostr(i);
+    std::vector<const char*> Args(argv, argv + argc);
+    Args.push_back(PartArgs[i].c_str());
+    Args.push_back(0);
+
+    std::string ErrMsg;
+    Children[i] = new sys::Program();
+    if (!Children[i]->Execute(Self, &Args[0], 0, 0, 0, &ErrMsg)) {
+      errs() << argv[0] << ": " << ErrMsg << "\n";
+      delete Children[i];
+      Children[i] = 0;
+      Ret = 1;
+    }
+  }
+
+  for (unsigned i = 0; i != CodeGenPartitions; ++i) {
+    if (!Children[i])
+      continue;
+    std::string ErrMsg;
+    if (Children[i]->Wait(0, &ErrMsg) != 0) {
+      if (!ErrMsg.empty())
+        errs() << argv[0] << ": partition " << i << ": " << ErrMsg << "\n";
+      Ret = 1;
+    }
+    delete Children[i];
+  }
+  return Ret;
+}
+
 // main - Entry point for the llc compiler.
 //
 int main(int argc, char **argv) {
@@ -204,6 +469,14 @@ int main(int argc, char **argv) {
   InitializeAllAsmParsers();
 
   cl::ParseCommandLineOptions(argc, argv, "llvm system compiler\n");
+
+  if (CodeGenPartitions == 0 ||
+      CodeGenPartition >= (int)CodeGenPartitions) {
+    errs() << argv[0] << ": invalid code generation partition.\n";
+    return 1;
+  }
+  if (CodeGenPartitions > 1 && CodeGenPartition < 0)
+    return RunPartitions(argc, argv);
   
   // Load the module to be compiled...
   SMDiagnostic Err;
@@ -216,6 +489,9 @@ int main(int argc, char **argv) {
   }
   Module &mod = *M.get();
 
+  if (CodeGenPartition >= 0)
+    splitModule(mod, CodeGenPartitions, CodeGenPartition);
+
   // If we are supposed to override the target triple, do so now.
   if (!TargetTriple.empty())
     mod.setTargetTriple(Triple::normalize(TargetTriple));